@@ -509,7 +509,7 @@ void dai_manage_airunit(struct ai_type *ait, struct player *pplayer,
         && !same_pos(unit_tile(punit), punit->goto_tile)
         && is_refuel_point(punit->goto_tile, pplayer, punit)) {
       pft_fill_unit_parameter(&parameter, nmap, punit);
-      pfm = pf_map_new(&parameter);
+      pfm = pf_map_new_goal(&parameter, punit->goto_tile);
       path = pf_map_path(pfm, punit->goto_tile);
       if (path) {
         bool alive = adv_follow_path(punit, path, punit->goto_tile);
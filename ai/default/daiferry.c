@@ -532,6 +532,8 @@ int aiferry_find_boat(struct ai_type *ait, struct unit *punit,
   param.get_TB = no_fights_or_unknown;
   param.get_EC = sea_move;
   param.get_MC = combined_land_sea_move;
+  param.get_min_MC = nullptr;
+  param.below_min_MC = nullptr;
   param.ignore_none_scopes = FALSE;
 
   search_map = pf_map_new(&param);
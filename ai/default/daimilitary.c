@@ -76,7 +76,8 @@
 static unsigned int assess_danger(struct ai_type *ait,
                                   const struct civ_map *nmap,
                                   struct city *pcity,
-                                  player_unit_list_getter ul_cb);
+                                  player_unit_list_getter ul_cb,
+                                  struct pf_threat_map **threat_maps);
 
 static adv_want dai_unit_attack_desirability(struct ai_type *ait,
                                              const struct unit_type *punittype);
@@ -535,7 +536,7 @@ action_may_happen_unit_on_city(const action_id wanted_action,
 **************************************************************************/
 static unsigned int assess_danger_unit(const struct civ_map *nmap,
                                        const struct city *pcity,
-                                       struct pf_reverse_map *pcity_map,
+                                       struct pf_threat_map *threat_map,
                                        const struct unit *punit,
                                        int *move_time)
 {
@@ -557,7 +558,7 @@ static unsigned int assess_danger_unit(const struct civ_map *nmap,
                   / punittype->paratroopers_range);
   }
 
-  if (pf_reverse_map_unit_position(pcity_map, punit, &pos)
+  if (pf_threat_map_unit_position(threat_map, punit, ptile, &pos)
       && (PF_IMPOSSIBLE_MC == *move_time
           || *move_time > pos.turn)) {
     *move_time = pos.turn;
@@ -565,7 +566,7 @@ static unsigned int assess_danger_unit(const struct civ_map *nmap,
 
   if (unit_transported(punit)
       && (ferry = unit_transport_get(punit))
-      && pf_reverse_map_unit_position(pcity_map, ferry, &pos)) {
+      && pf_threat_map_unit_position(threat_map, ferry, ptile, &pos)) {
     if ((PF_IMPOSSIBLE_MC == *move_time
          || *move_time > pos.turn)) {
       *move_time = pos.turn;
@@ -635,6 +636,18 @@ static unsigned int assess_danger_unit(const struct civ_map *nmap,
   return danger * (amod + 100) / MAX(dmod, 1);
 }
 
+/**********************************************************************//**
+  How many turns ahead assess_danger() looks for the enemy units.
+**************************************************************************/
+static int assess_danger_turns(struct player *pplayer)
+{
+  if (player_is_cpuhog(pplayer)) {
+    return 6;
+  } else {
+    return has_handicap(pplayer, H_ASSESS_DANGER_LIMITED) ? 2 : 3;
+  }
+}
+
 /**********************************************************************//**
   Call assess_danger() for all cities owned by pplayer.
 
@@ -646,9 +659,34 @@ void dai_assess_danger_player(struct ai_type *ait,
 {
   /* Do nothing if game is not running */
   if (S_S_RUNNING == server_state()) {
+    struct pf_threat_map *threat_maps[MAX_NUM_PLAYER_SLOTS];
+    int assess_turns = assess_danger_turns(pplayer);
+    bool omnimap = !has_handicap(pplayer, H_MAP);
+
+    /* The units of every dangerous player are looked at for all the
+     * cities at once. */
+    players_iterate(aplayer) {
+      struct pf_threat_map *threat_map = NULL;
+
+      if (adv_is_player_dangerous(pplayer, aplayer)) {
+        threat_map = pf_threat_map_new(nmap, aplayer, assess_turns,
+                                       omnimap);
+        city_list_iterate(pplayer->cities, pcity) {
+          pf_threat_map_add_target(threat_map, city_tile(pcity));
+        } city_list_iterate_end;
+      }
+      threat_maps[player_index(aplayer)] = threat_map;
+    } players_iterate_end;
+
     city_list_iterate(pplayer->cities, pcity) {
-      (void) assess_danger(ait, nmap, pcity, NULL);
+      (void) assess_danger(ait, nmap, pcity, NULL, threat_maps);
     } city_list_iterate_end;
+
+    players_iterate(aplayer) {
+      if (threat_maps[player_index(aplayer)] != NULL) {
+        pf_threat_map_destroy(threat_maps[player_index(aplayer)]);
+      }
+    } players_iterate_end;
   }
 }
 
@@ -705,11 +743,15 @@ static void dai_reevaluate_building(struct city *pcity, adv_want *value,
   FIXME: Due to the nature of assess_distance, a city will only be
   afraid of a boat laden with enemies if it stands on the coast (i.e.
   is directly reachable by this boat).
+
+  If 'threat_maps' is not NULL, it has the threat maps of the dangerous
+  players, by player index, with the city among their targets.
 **************************************************************************/
 static unsigned int assess_danger(struct ai_type *ait,
                                   const struct civ_map *nmap,
                                   struct city *pcity,
-                                  player_unit_list_getter ul_cb)
+                                  player_unit_list_getter ul_cb,
+                                  struct pf_threat_map **threat_maps)
 {
   struct player *pplayer = city_owner(pcity);
   struct tile *ptile = city_tile(pcity);
@@ -815,17 +857,12 @@ static unsigned int assess_danger(struct ai_type *ait,
     } unit_type_iterate_end;
   }
 
-  if (player_is_cpuhog(pplayer)) {
-    assess_turns = 6;
-  } else {
-    assess_turns = has_handicap(pplayer, H_ASSESS_DANGER_LIMITED) ? 2 : 3;
-  }
-
+  assess_turns = assess_danger_turns(pplayer);
   omnimap = !has_handicap(pplayer, H_MAP);
 
   /* Check. */
   players_iterate(aplayer) {
-    struct pf_reverse_map *pcity_map;
+    struct pf_threat_map *threat_map;
     struct unit_list *units;
 
     if (!adv_is_player_dangerous(pplayer, aplayer)) {
@@ -834,8 +871,13 @@ static unsigned int assess_danger(struct ai_type *ait,
     /* Note that we still consider the units of players we are not (yet)
      * at war with. */
 
-    pcity_map = pf_reverse_map_new_for_city(nmap, pcity, aplayer, assess_turns,
-                                            omnimap);
+    if (threat_maps != NULL) {
+      threat_map = threat_maps[player_index(aplayer)];
+      fc_assert_action(threat_map != NULL, continue);
+    } else {
+      threat_map = pf_threat_map_new(nmap, aplayer, assess_turns, omnimap);
+      pf_threat_map_add_target(threat_map, ptile);
+    }
 
     if (ul_cb != NULL) {
       units = ul_cb(aplayer);
@@ -871,7 +913,7 @@ static unsigned int assess_danger(struct ai_type *ait,
       }
 
       /* Defender unspecific vulnerability and potential move time */
-      vulnerability = assess_danger_unit(nmap, pcity, pcity_map,
+      vulnerability = assess_danger_unit(nmap, pcity, threat_map,
                                          punit, &move_time);
 
       if (PF_IMPOSSIBLE_MC == move_time) {
@@ -939,7 +981,9 @@ static unsigned int assess_danger(struct ai_type *ait,
       total_danger += vulnerability;
     } unit_list_iterate_end;
 
-    pf_reverse_map_destroy(pcity_map);
+    if (threat_maps == NULL) {
+      pf_threat_map_destroy(threat_map);
+    }
 
   } players_iterate_end;
 
@@ -1803,7 +1847,7 @@ struct adv_choice *military_advisor_choose_build(struct ai_type *ait,
   struct adv_choice *choice = adv_new_choice();
   bool allow_gold_upkeep;
 
-  urgency = assess_danger(ait, nmap, pcity, ul_cb);
+  urgency = assess_danger(ait, nmap, pcity, ul_cb, NULL);
   /* Changing to quadratic to stop AI from building piles
    * of small units -- Syela */
   /* It has to be AFTER assess_danger() thanks to wallvalue. */
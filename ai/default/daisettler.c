@@ -140,9 +140,37 @@ static void tile_data_cache_destroy(struct tile_data_cache *ptdc);
 #define SPECHASH_IDATA_FREE tile_data_cache_destroy
 #include "spechash.h"
 
+/* The state of one tile in the city radius that the want for a city
+ * spot depends on, and that changes during the turn. */
+struct settler_want_input {
+  int citymap;                  /* citymap_read() */
+  int owner;                    /* Player index + 1, or 0 if unowned */
+  bool worked;
+  bool known;                   /* Only with H_MAP */
+};
+
+/* The want for founding a city on a tile, without the parts that depend
+ * on the settler. Computed once a turn for all the settlers of a player,
+ * and again only if the player gets or loses cities, or the tiles around
+ * change. */
+struct settler_want {
+  int turn;                     /* The turn the want was calculated */
+  int cities;                   /* Number of cities of the player then */
+  int city_radius_sq;           /* City radius the inputs cover */
+  struct settler_want_input *inputs; /* One for each tile in the radius */
+  int num_inputs;
+  int inputs_size;              /* Allocated size of 'inputs' */
+  bool possible;                /* Whether a city there is any good */
+  adv_want total;               /* Total value of the position */
+};
+
 struct ai_settler {
   struct tile_data_cache_hash *tdc_hash;
 
+  /* One for each tile, or NULL before the first use */
+  struct settler_want *want_map;
+  int want_map_size;
+
 #ifdef FREECIV_DEBUG
   struct {
     int hit;
@@ -150,6 +178,10 @@ struct ai_settler {
     int miss;
     int save;
   } cache;
+  struct {
+    int hit;
+    int miss;
+  } want_cache;
 #endif /* FREECIV_DEBUG */
 };
 
@@ -206,6 +238,14 @@ static void print_cityresult(struct player *pplayer,
 struct cityresult *city_desirability(struct ai_type *ait,
                                      struct player *pplayer,
                                      struct unit *punit, struct tile *ptile);
+static bool city_spot_available(struct player *pplayer, struct unit *punit,
+                                struct tile *ptile);
+static struct cityresult *city_spot_result(struct ai_type *ait,
+                                           struct player *pplayer,
+                                           struct tile *ptile);
+static bool city_spot_want(struct ai_type *ait, struct player *pplayer,
+                           struct tile *ptile, adv_want *want,
+                           struct cityresult **pcr);
 static struct cityresult *settler_map_iterate(struct ai_type *ait,
                                               struct pf_parameter *parameter,
                                               struct unit *punit,
@@ -713,45 +753,72 @@ static void print_cityresult(struct player *pplayer,
 struct cityresult *city_desirability(struct ai_type *ait, struct player *pplayer,
                                      struct unit *punit, struct tile *ptile)
 {
-  struct city *pcity = tile_city(ptile);
-  struct cityresult *cr = NULL;
-  const struct civ_map *nmap = &(wld.map);
-
   fc_assert_ret_val(punit, NULL);
   fc_assert_ret_val(pplayer, NULL);
 
+  if (!city_spot_available(pplayer, punit, ptile)) {
+    return NULL;
+  }
+
+  return city_spot_result(ait, pplayer, ptile);
+}
+
+/*************************************************************************//**
+  Returns whether 'punit' could found a city at 'ptile', as far as the
+  unit itself and the cities reserved by the other settlers go.
+*****************************************************************************/
+static bool city_spot_available(struct player *pplayer, struct unit *punit,
+                                struct tile *ptile)
+{
+  struct city *pcity = tile_city(ptile);
+  const struct civ_map *nmap = &(wld.map);
+
   if (!city_can_be_built_here(nmap, ptile, punit, FALSE)
       || (has_handicap(pplayer, H_MAP)
           && !map_is_known(ptile, pplayer))) {
-    return NULL;
+    return FALSE;
   }
 
   /* Check if another settler has taken a spot within mindist */
   square_iterate(&(wld.map), ptile, game.info.citymindist-1, tile1) {
     if (citymap_is_reserved(tile1)) {
-      return NULL;
+      return FALSE;
     }
   } square_iterate_end;
 
   if (adv_danger_at(punit, ptile)) {
-    return NULL;
+    return FALSE;
   }
 
   if (pcity && (city_size_get(pcity) + unit_pop_value(punit)
                 > game.info.add_to_size_limit)) {
     /* Can't exceed population limit. */
-    return NULL;
+    return FALSE;
   }
 
   if (!pcity && citymap_is_reserved(ptile)) {
-    return NULL; /* reserved, go away */
+    return FALSE; /* reserved, go away */
   }
 
   /* If (x, y) is an existing city, consider immigration */
   if (pcity && city_owner(pcity) == pplayer) {
-    return NULL;
+    return FALSE;
   }
 
+  return TRUE;
+}
+
+/*************************************************************************//**
+  Calculates the desire of 'pplayer' for a city at 'ptile', which
+  city_spot_available() has accepted. The result does not depend on
+  the settler. Returns NULL if the city would not be any good.
+*****************************************************************************/
+static struct cityresult *city_spot_result(struct ai_type *ait,
+                                           struct player *pplayer,
+                                           struct tile *ptile)
+{
+  struct cityresult *cr;
+
   cr = cityresult_fill(ait, pplayer, ptile); /* Burn CPU, burn! */
   if (!cr) {
     /* Failed to find a good spot */
@@ -776,6 +843,156 @@ struct cityresult *city_desirability(struct ai_type *ait, struct player *pplayer
   return cr;
 }
 
+/*************************************************************************//**
+  Fill in the state of 'ptile1' that the want for a city spot depends on,
+  and that changes during the turn as the settlers reserve spots and
+  found cities.
+*****************************************************************************/
+static void settler_want_input_get(struct settler_want_input *input,
+                                   struct player *pplayer, bool handicap,
+                                   struct tile *ptile1)
+{
+  input->citymap = citymap_read(ptile1);
+  input->owner = (tile_owner(ptile1) != NULL
+                  ? player_index(tile_owner(ptile1)) + 1 : 0);
+  input->worked = (tile_worked(ptile1) != NULL);
+  input->known = (handicap && map_is_known(ptile1, pplayer));
+}
+
+/*************************************************************************//**
+  Store the inputs of the tiles within the city radius of 'pwant' around
+  'ptile'.
+*****************************************************************************/
+static void settler_want_inputs_store(struct settler_want *pwant,
+                                      struct player *pplayer,
+                                      struct tile *ptile)
+{
+  const struct civ_map *nmap = &(wld.map);
+  bool handicap = has_handicap(pplayer, H_MAP);
+  int size = city_map_tiles(pwant->city_radius_sq);
+
+  if (pwant->inputs_size < size) {
+    pwant->inputs = fc_realloc(pwant->inputs, size * sizeof(*pwant->inputs));
+    pwant->inputs_size = size;
+  }
+
+  pwant->num_inputs = 0;
+  city_tile_iterate(nmap, pwant->city_radius_sq, ptile, ptile1) {
+    settler_want_input_get(pwant->inputs + pwant->num_inputs++,
+                           pplayer, handicap, ptile1);
+  } city_tile_iterate_end;
+}
+
+/*************************************************************************//**
+  Returns whether the tiles within the city radius of 'pwant' around
+  'ptile' are still as they were when the want was calculated.
+*****************************************************************************/
+static bool settler_want_inputs_match(const struct settler_want *pwant,
+                                      struct player *pplayer,
+                                      struct tile *ptile)
+{
+  const struct civ_map *nmap = &(wld.map);
+  bool handicap = has_handicap(pplayer, H_MAP);
+  struct settler_want_input input;
+  int i = 0;
+
+  city_tile_iterate(nmap, pwant->city_radius_sq, ptile, ptile1) {
+    const struct settler_want_input *old = pwant->inputs + i++;
+
+    settler_want_input_get(&input, pplayer, handicap, ptile1);
+    if (input.citymap != old->citymap || input.owner != old->owner
+        || input.worked != old->worked || input.known != old->known) {
+      return FALSE;
+    }
+  } city_tile_iterate_end;
+
+  return i == pwant->num_inputs;
+}
+
+/*************************************************************************//**
+  Free the want map of the settler data, with the inputs of its entries.
+*****************************************************************************/
+static void settler_want_map_free(struct ai_settler *settler)
+{
+  int i;
+
+  for (i = 0; i < settler->want_map_size; i++) {
+    free(settler->want_map[i].inputs);
+  }
+  free(settler->want_map);
+  settler->want_map = NULL;
+  settler->want_map_size = 0;
+}
+
+/*************************************************************************//**
+  Sets 'want' to the value city_spot_result() would give for a city at
+  'ptile', and returns whether there is a result at all. The values are
+  kept in the want map of the player, so that all the settlers and
+  cities of the player that look at the same tile during the turn only
+  calculate it once.
+
+  If the want had to be calculated now, the whole result is handed over
+  to 'pcr', which is otherwise set to NULL.
+*****************************************************************************/
+static bool city_spot_want(struct ai_type *ait, struct player *pplayer,
+                           struct tile *ptile, adv_want *want,
+                           struct cityresult **pcr)
+{
+  struct ai_plr *ai = dai_plr_data_get(ait, pplayer, NULL);
+  struct ai_settler *settler;
+  struct settler_want *pwant;
+  struct cityresult *cr;
+  int i;
+
+  *pcr = NULL;
+  fc_assert_ret_val(ai != NULL, FALSE);
+  fc_assert_ret_val(ai->settler != NULL, FALSE);
+  settler = ai->settler;
+
+  if (settler->want_map_size != MAP_INDEX_SIZE) {
+    settler_want_map_free(settler);
+    settler->want_map_size = MAP_INDEX_SIZE;
+    settler->want_map = fc_malloc(settler->want_map_size
+                                  * sizeof(*settler->want_map));
+    for (i = 0; i < settler->want_map_size; i++) {
+      settler->want_map[i].turn = -1;
+      settler->want_map[i].inputs = NULL;
+      settler->want_map[i].num_inputs = 0;
+      settler->want_map[i].inputs_size = 0;
+    }
+  }
+  pwant = settler->want_map + tile_index(ptile);
+
+  if (pwant->turn == game.info.turn
+      && pwant->cities == city_list_size(pplayer->cities)
+      && settler_want_inputs_match(pwant, pplayer, ptile)) {
+#ifdef FREECIV_DEBUG
+    settler->want_cache.hit++;
+#endif /* FREECIV_DEBUG */
+    *want = pwant->total;
+
+    return pwant->possible;
+  }
+
+#ifdef FREECIV_DEBUG
+  settler->want_cache.miss++;
+#endif /* FREECIV_DEBUG */
+
+  cr = city_spot_result(ait, pplayer, ptile);
+  pwant->turn = game.info.turn;
+  pwant->cities = city_list_size(pplayer->cities);
+  pwant->possible = (cr != NULL);
+  pwant->total = (cr != NULL ? cr->total : 0);
+  pwant->city_radius_sq = (cr != NULL ? cr->city_radius_sq
+                           : game.info.init_city_radius_sq);
+  settler_want_inputs_store(pwant, pplayer, ptile);
+  *pcr = cr;
+
+  *want = pwant->total;
+
+  return pwant->possible;
+}
+
 /*************************************************************************//**
   Find nearest and best city placement in a PF iteration according to
   "parameter". The value in "boat_cost" is both the penalty to pay for
@@ -792,7 +1009,7 @@ static struct cityresult *settler_map_iterate(struct ai_type *ait,
                                               struct unit *punit,
                                               int boat_cost)
 {
-  struct cityresult *cr = NULL, *best = NULL;
+  struct cityresult *best = NULL;
   int best_turn = 0; /* Which turn we found the best fit */
   struct player *pplayer = unit_owner(punit);
   struct pf_map *pfm;
@@ -803,6 +1020,8 @@ static struct cityresult *settler_map_iterate(struct ai_type *ait,
   pfm = pf_map_new(parameter);
   pf_map_move_costs_iterate(pfm, ptile, move_cost, FALSE) {
     int turns;
+    struct cityresult *cr;
+    adv_want total, result;
 
     if (boat_cost == 0 && pclass->adv.sea_move == MOVE_NONE
         && tile_continent(ptile) != curcont) {
@@ -821,33 +1040,40 @@ static struct cityresult *settler_map_iterate(struct ai_type *ait,
       }
     }
 
-    /* Calculate worth */
-    cr = city_desirability(ait, pplayer, punit, ptile);
-
-    /* Check if actually found something */
-    if (cr == NULL) {
+    /* Calculate worth. The want for the spot itself is shared by all
+     * the settlers of the player. */
+    if (!city_spot_available(pplayer, punit, ptile)
+        || !city_spot_want(ait, pplayer, ptile, &total, &cr)) {
       continue;
     }
 
     /* This algorithm punishes long treks */
     turns = move_cost / parameter->move_rate;
-    cr->result = amortize(cr->total, PERFECTION * turns);
+    result = amortize(total, PERFECTION * turns);
 
     /* Reduce want by settler cost. Easier than amortize, but still
      * weeds out very small wants. ie we create a threshold here. */
     /* We also penalise here for using a boat (either virtual or real)
      * it's crude but what isn't?
      * Settler gets used, boat can make multiple trips. */
-    cr->result -= cost + boat_cost / 3;
+    result -= cost + boat_cost / 3;
 
     /* Find best spot */
-    if ((!best && cr->result > 0)
-        || (best && cr->result > best->result)) {
+    if ((!best && result > 0)
+        || (best && result > best->result)) {
+      /* Only the best spot needs the whole result. */
+      if (cr == NULL) {
+        cr = city_spot_result(ait, pplayer, ptile);
+        if (cr == NULL) {
+          continue;
+        }
+      }
+      cr->result = result;
+
       /* Destroy the old 'best' value. */
       cityresult_destroy(best);
       /* Save the new 'best' value. */
       best = cr;
-      cr = NULL;
       best_turn = turns;
 
       log_debug("settler map search (search): (%d, %d) " ADV_WANT_PRINTF,
@@ -855,7 +1081,6 @@ static struct cityresult *settler_map_iterate(struct ai_type *ait,
     } else {
       /* Destroy the unused result. */
       cityresult_destroy(cr);
-      cr = NULL;
     }
 
     /* Can we terminate early? We have a 'good enough' spot, and
@@ -1017,12 +1242,16 @@ void dai_auto_settler_init(struct ai_plr *ai)
 
   ai->settler = fc_calloc(1, sizeof(*ai->settler));
   ai->settler->tdc_hash = tile_data_cache_hash_new();
+  ai->settler->want_map = NULL;
+  ai->settler->want_map_size = 0;
 
 #ifdef FREECIV_DEBUG
   ai->settler->cache.hit = 0;
   ai->settler->cache.old = 0;
   ai->settler->cache.miss = 0;
   ai->settler->cache.save = 0;
+  ai->settler->want_cache.hit = 0;
+  ai->settler->want_cache.miss = 0;
 #endif /* FREECIV_DEBUG */
 }
 
@@ -1232,11 +1461,16 @@ void dai_auto_settler_reset(struct ai_type *ait, struct player *pplayer)
             player_name(pplayer), ai->settler->cache.save,
             ai->settler->cache.miss, ai->settler->cache.old,
             ai->settler->cache.hit);
+  log_debug("[aisettler want map for %s] miss: %d, hit: %d",
+            player_name(pplayer), ai->settler->want_cache.miss,
+            ai->settler->want_cache.hit);
 
   ai->settler->cache.hit = 0;
   ai->settler->cache.old = 0;
   ai->settler->cache.miss = 0;
   ai->settler->cache.save = 0;
+  ai->settler->want_cache.hit = 0;
+  ai->settler->want_cache.miss = 0;
 #endif /* FREECIV_DEBUG */
 
   tile_data_cache_hash_clear(ai->settler->tdc_hash);
@@ -1257,6 +1491,7 @@ void dai_auto_settler_free(struct ai_plr *ai)
     if (ai->settler->tdc_hash) {
       tile_data_cache_hash_destroy(ai->settler->tdc_hash);
     }
+    settler_want_map_free(ai->settler);
     free(ai->settler);
   }
   ai->settler = NULL;
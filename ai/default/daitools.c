@@ -314,7 +314,7 @@ struct tile *immediate_destination(struct unit *punit,
 
     pft_fill_unit_parameter(&parameter, nmap, punit);
     parameter.omniscience = !has_handicap(pplayer, H_MAP);
-    pfm = pf_map_new(&parameter);
+    pfm = pf_map_new_goal(&parameter, punit->goto_tile);
     path = pf_map_path(pfm, punit->goto_tile);
 
     if (path) {
@@ -404,7 +404,7 @@ bool dai_unit_goto_constrained(struct ai_type *ait, struct unit *punit,
     return TRUE;
   }
 
-  pfm = pf_map_new(parameter);
+  pfm = pf_map_new_goal(parameter, ptile);
   path = pf_map_path(pfm, ptile);
 
   if (path) {
@@ -438,12 +438,12 @@ bool goto_is_sane(struct unit *punit, struct tile *ptile)
     struct pf_map *pfm;
 
     pft_fill_unit_attack_param(&parameter, nmap, punit);
-    pfm = pf_map_new(&parameter);
+    pfm = adv_pf_map_get(punit, &parameter, ptile);
 
     if (pf_map_move_cost(pfm, ptile) != PF_IMPOSSIBLE_MC) {
       can_get_there = TRUE;
     }
-    pf_map_destroy(pfm);
+    adv_pf_map_release(pfm);
   }
   return can_get_there;
 }
@@ -439,7 +439,7 @@ static void texwai_first_activities(struct player *pplayer)
 static void texwai_restart_phase(struct player *pplayer)
 {
   TEXAI_AIT;
-  TEXAI_TFUNC(texai_first_activities, pplayer);
+  TEXAI_TFUNC(texai_restart_phase, pplayer);
 }
 
 /**********************************************************************//**
@@ -15,6 +15,10 @@
 #include <fc_config.h>
 #endif
 
+/* common */
+#include "game.h"
+#include "player.h"
+
 /* ai/tex */
 #include "texaiplayer.h"
 
@@ -58,11 +62,37 @@ void texai_send_req(enum texaireqtype type, struct player *pplayer,
 }
 
 /**********************************************************************//**
-  Time for phase first activities
+  Time for phase first activities. The players of the phase are planned
+  together, once the last of them has been told to start.
 **************************************************************************/
 void texai_first_activities(struct ai_type *ait, struct player *pplayer)
+{
+  static int pending = 0;
+
+  if (pending <= 0) {
+    pending = 0;
+    players_iterate(aplayer) {
+      if (is_player_phase(aplayer, game.info.phase)
+          && is_ai(aplayer) && aplayer->ai == ait) {
+        pending++;
+      }
+    } players_iterate_end;
+  }
+
+  texai_send_msg(TEXAI_MSG_FIRST_ACTIVITIES, pplayer, NULL);
+
+  if (--pending <= 0) {
+    texai_plan();
+  }
+}
+
+/**********************************************************************//**
+  Player gets to continue its phase, alone.
+**************************************************************************/
+void texai_restart_phase(struct ai_type *ait, struct player *pplayer)
 {
   texai_send_msg(TEXAI_MSG_FIRST_ACTIVITIES, pplayer, NULL);
+  texai_plan();
 }
 
 /**********************************************************************//**
@@ -40,6 +40,8 @@
 #define SPECENUM_VALUE11NAME "UnitDestroyed"
 #define SPECENUM_VALUE12 TEXAI_MSG_UNIT_MOVED
 #define SPECENUM_VALUE12NAME "UnitMoved"
+#define SPECENUM_VALUE13 TEXAI_MSG_PLAN
+#define SPECENUM_VALUE13NAME "Plan"
 #include "specenum_gen.h"
 
 #define SPECENUM_NAME texaireqtype
@@ -79,6 +81,7 @@ void texai_send_req(enum texaireqtype type, struct player *pplayer,
                     void *data);
 
 void texai_first_activities(struct ai_type *ait, struct player *pplayer);
+void texai_restart_phase(struct ai_type *ait, struct player *pplayer);
 void texai_phase_finished(struct ai_type *ait, struct player *pplayer);
 
 #endif /* FC__TEXAIMSG_H */
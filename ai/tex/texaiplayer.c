@@ -16,6 +16,7 @@
 #endif
 
 /* utility */
+#include "fcparallel.h"
 #include "log.h"
 
 /* common */
@@ -25,6 +26,9 @@
 #include "map.h"
 #include "unit.h"
 
+/* server */
+#include "srv_main.h"
+
 /* server/advisors */
 #include "advchoice.h"
 #include "infracache.h"
@@ -59,8 +63,24 @@ struct texai_thr
   struct texai_reqs reqs_from;
   bool thread_running;
   fc_thread ait;
+
+  /* Players whose first activities are waiting to be planned */
+  struct player *planned[MAX_NUM_PLAYER_SLOTS];
+  int num_planned;
+
+  /* Plan messages sent, and handled by the thread. The main thread
+   * waits on plans_cond until they match. Protected by msgs_to.mutex. */
+  int plans_sent;
+  int plans_done;
+  fc_thread_cond plans_cond;
 } exthrai;
 
+struct texai_planning
+{
+  struct ai_type *ait;
+  struct player **players;
+};
+
 struct texai_build_choice_req
 {
   int city_id;
@@ -75,6 +95,7 @@ void texai_init_threading(void)
   exthrai.thread_running = FALSE;
 
   exthrai.num_players = 0;
+  exthrai.num_planned = 0;
 }
 
 /**********************************************************************//**
@@ -160,6 +181,85 @@ struct unit_list *texai_player_units(struct player *pplayer)
   return plr_data->units;
 }
 
+/**********************************************************************//**
+  Plan the first activities of one player. This is a task of the
+  planning workers, run while the main thread waits in texai_plan(), so
+  the game doesn't change under it:
+  - the worker tasks and wants read the live cities of the player, the
+    main map tiles and the units on them, and write to the infrastructure
+    cache of the player and the ai data of its cities;
+  - the build choices read the tex world, which only this thread
+    updates, and the tex units of the player;
+  - the results are sent to the main thread as requests, under the mutex
+    of the request list.
+  The tasks share no writable data but the path-finding storage pool,
+  which has its own lock. The AI timers only time the main thread.
+**************************************************************************/
+static void texai_plan_player(int idx, void *data)
+{
+  struct texai_planning *planning = (struct texai_planning *)data;
+  struct ai_type *ait = planning->ait;
+  struct player *pplayer = planning->players[idx];
+
+  initialize_infrastructure_cache(pplayer);
+
+  city_list_iterate(pplayer->cities, pcity) {
+    struct adv_choice *choice;
+    struct city *tex_city = texai_map_city(pcity->id);
+
+    texai_city_worker_requests_create(ait, pplayer, pcity);
+    texai_city_worker_wants(ait, pplayer, pcity);
+
+    if (tex_city != NULL) {
+      struct texai_build_choice_req *choice_req
+        = fc_malloc(sizeof(struct texai_build_choice_req));
+
+      choice = military_advisor_choose_build(ait, texai_map_get(),
+                                             pplayer, tex_city,
+                                             texai_player_units);
+      choice_req->city_id = tex_city->id;
+      adv_choice_copy(&(choice_req->choice), choice);
+      adv_free_choice(choice);
+      texai_send_req(TEXAI_BUILD_CHOICE, pplayer, choice_req);
+    }
+  } city_list_iterate_end;
+
+  texai_send_req(TEXAI_REQ_TURN_DONE, pplayer, NULL);
+}
+
+/**********************************************************************//**
+  Plan the first activities of the players collected from the message
+  queue, one player per task, with as many threads as the server uses
+  for turn change processing. If the phase has already ended, the
+  players are just told to be done.
+
+  The tex world is not updated while the tasks run, as only this thread
+  applies the messages that update it, and the game is not updated
+  either, as the main thread waits for the plan in texai_plan().
+**************************************************************************/
+static void texai_plan_first_activities(struct ai_type *ait, bool phase_ended)
+{
+  if (exthrai.num_planned <= 0) {
+    return;
+  }
+
+  if (phase_ended) {
+    int i;
+
+    for (i = 0; i < exthrai.num_planned; i++) {
+      texai_send_req(TEXAI_REQ_TURN_DONE, exthrai.planned[i], NULL);
+    }
+  } else {
+    struct texai_planning planning = { .ait = ait,
+                                       .players = exthrai.planned };
+
+    fc_parallel_for(exthrai.num_planned, srvarg.threads,
+                    texai_plan_player, &planning);
+  }
+
+  exthrai.num_planned = 0;
+}
+
 /**********************************************************************//**
   Handle messages from message queue.
 **************************************************************************/
@@ -171,6 +271,7 @@ static enum texai_abort_msg_class texai_check_messages(struct ai_type *ait)
   while (texaimsg_list_size(exthrai.msgs_to.msglist) > 0) {
     struct texai_msg *msg;
     enum texai_abort_msg_class new_abort = TEXAI_ABORT_NONE;
+    int i;
 
     msg = texaimsg_list_get(exthrai.msgs_to.msglist, 0);
     texaimsg_list_remove(exthrai.msgs_to.msglist, msg);
@@ -178,48 +279,26 @@ static enum texai_abort_msg_class texai_check_messages(struct ai_type *ait)
 
     log_debug("Plr thr got %s", texaimsgtype_name(msg->type));
 
+    if (msg->type == TEXAI_MSG_PHASE_FINISHED
+        || msg->type == TEXAI_MSG_THR_EXIT
+        || msg->type == TEXAI_MSG_MAP_FREE) {
+      /* The collected players must not outlive the phase
+       * or the tex world. */
+      texai_plan_first_activities(ait, msg->type != TEXAI_MSG_MAP_FREE);
+    }
+
     switch (msg->type) {
     case TEXAI_MSG_FIRST_ACTIVITIES:
-      fc_mutex_allocate(&game.server.mutexes.city_list);
-
-      initialize_infrastructure_cache(msg->plr);
-
-      /* Use _safe iterate in case the main thread
-       * destroys cities while we are iterating through these. */
-      city_list_iterate_safe(msg->plr->cities, pcity) {
-        struct adv_choice *choice;
-        struct texai_build_choice_req *choice_req
-          = fc_malloc(sizeof(struct texai_build_choice_req));
-        struct city *tex_city = texai_map_city(pcity->id);
-
-        texai_city_worker_requests_create(ait, msg->plr, pcity);
-        texai_city_worker_wants(ait, msg->plr, pcity);
-
-        if (tex_city != NULL) {
-          choice = military_advisor_choose_build(ait, texai_map_get(),
-                                                 msg->plr, tex_city,
-                                                 texai_player_units);
-          choice_req->city_id = tex_city->id;
-          adv_choice_copy(&(choice_req->choice), choice);
-          adv_free_choice(choice);
-          texai_send_req(TEXAI_BUILD_CHOICE, msg->plr, choice_req);
-        }
-
-        /* Release mutex for a second in case main thread
-         * wants to do something to city list. */
-        fc_mutex_release(&game.server.mutexes.city_list);
-
-        /* Recursive message check in case phase is finished. */
-        new_abort = texai_check_messages(ait);
-        fc_mutex_allocate(&game.server.mutexes.city_list);
-        if (new_abort < TEXAI_ABORT_NONE) {
+      /* Collect the players of the phase, to plan them in parallel
+       * once all of them have asked. */
+      for (i = 0; i < exthrai.num_planned; i++) {
+        if (exthrai.planned[i] == msg->plr) {
           break;
         }
-      } city_list_iterate_safe_end;
-      fc_mutex_release(&game.server.mutexes.city_list);
-
-      texai_send_req(TEXAI_REQ_TURN_DONE, msg->plr, NULL);
-
+      }
+      if (i == exthrai.num_planned) {
+        exthrai.planned[exthrai.num_planned++] = msg->plr;
+      }
       break;
     case TEXAI_MSG_TILE_INFO:
       texai_tile_info_recv(msg->data);
@@ -253,6 +332,14 @@ static enum texai_abort_msg_class texai_check_messages(struct ai_type *ait)
     case TEXAI_MSG_MAP_FREE:
       texai_map_free_recv();
       break;
+    case TEXAI_MSG_PLAN:
+      texai_plan_first_activities(ait, FALSE);
+
+      /* We hold msgs_to.mutex, the main thread gets it back
+       * once we wait for the next messages. */
+      exthrai.plans_done++;
+      fc_thread_cond_signal(&exthrai.plans_cond);
+      break;
     default:
       log_error("Illegal message type %s (%d) for tex ai!",
                 texaimsgtype_name(msg->type), msg->type);
@@ -319,10 +406,13 @@ void texai_control_gained(struct ai_type *ait, struct player *pplayer)
   if (!exthrai.thread_running) {
     exthrai.msgs_to.msglist = texaimsg_list_new();
     exthrai.reqs_from.reqlist = texaireq_list_new();
+    exthrai.plans_sent = 0;
+    exthrai.plans_done = 0;
 
     exthrai.thread_running = TRUE;
 
     fc_thread_cond_init(&exthrai.msgs_to.thr_cond);
+    fc_thread_cond_init(&exthrai.plans_cond);
     fc_mutex_init(&exthrai.msgs_to.mutex);
     fc_thread_start(&exthrai.ait, texai_thread_start, ait);
 
@@ -354,6 +444,7 @@ void texai_control_lost(struct ai_type *ait, struct player *pplayer)
     exthrai.thread_running = FALSE;
 
     fc_thread_cond_destroy(&exthrai.msgs_to.thr_cond);
+    fc_thread_cond_destroy(&exthrai.plans_cond);
     fc_mutex_destroy(&exthrai.msgs_to.mutex);
     texaimsg_list_destroy(exthrai.msgs_to.msglist);
     texaireq_list_destroy(exthrai.reqs_from.reqlist);
@@ -419,6 +510,28 @@ void texai_msg_to_thr(struct texai_msg *msg)
   fc_mutex_release(&exthrai.msgs_to.mutex);
 }
 
+/**********************************************************************//**
+  Have the thread plan the first activities of the players that have
+  been told to start, and wait until it's done. The planning tasks read
+  the live game, so it must not change before they are finished.
+**************************************************************************/
+void texai_plan(void)
+{
+  int plan;
+
+  if (!exthrai.thread_running) {
+    return;
+  }
+
+  fc_mutex_allocate(&exthrai.msgs_to.mutex);
+  plan = ++exthrai.plans_sent;
+  texai_send_msg(TEXAI_MSG_PLAN, NULL, NULL);
+  while (exthrai.plans_done < plan) {
+    fc_thread_cond_wait(&exthrai.plans_cond, &exthrai.msgs_to.mutex);
+  }
+  fc_mutex_release(&exthrai.msgs_to.mutex);
+}
+
 /**********************************************************************//**
   Thread sends message.
 **************************************************************************/
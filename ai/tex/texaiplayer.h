@@ -62,6 +62,7 @@ void texai_control_lost(struct ai_type *ait, struct player *pplayer);
 void texai_refresh(struct ai_type *ait, struct player *pplayer);
 
 void texai_msg_to_thr(struct texai_msg *msg);
+void texai_plan(void);
 
 void texai_req_from_thr(struct texai_req *req);
 
@@ -33,6 +33,7 @@
 #include "capstr.h"
 #include "citizens.h"
 #include "counters.h"
+#include "effects.h"
 #include "events.h"
 #include "extras.h"
 #include "game.h"
@@ -3504,6 +3505,41 @@ void handle_tile_info(const struct packet_tile_info *packet)
    * case of changes in worked tiles above. */
 }
 
+/************************************************************************//**
+  Packet tile_info_bulk handler. The tiles the player does not know are
+  left out, just as the server leaves them out of separate tile_infos.
+****************************************************************************/
+void handle_tile_info_bulk(const struct packet_tile_info_bulk *packet)
+{
+  struct packet_tile_info *infos;
+  int i;
+
+  if (packet->reset) {
+    /* The server starts the bulk transfer from a clean delta state */
+    conn_reset_packet_delta_state(&client.conn, PACKET_TILE_INFO);
+  }
+
+  if (packet->count < 1 || packet->count > TILE_INFO_BULK_MAX_TILES) {
+    log_error("handle_tile_info_bulk() invalid count (%d).", packet->count);
+    return;
+  }
+
+  infos = fc_malloc(packet->count * sizeof(*infos));
+
+  if (!tile_info_bulk_decode(packet, infos)) {
+    log_error("handle_tile_info_bulk() malformed packet at tile %d.",
+              packet->first_tile);
+  } else {
+    for (i = 0; i < packet->count; i++) {
+      if (infos[i].known != TILE_UNKNOWN) {
+        handle_tile_info(&infos[i]);
+      }
+    }
+  }
+
+  free(infos);
+}
+
 /************************************************************************//**
   Received packet containing info about current scenario
 ****************************************************************************/
@@ -3693,6 +3729,9 @@ void handle_rulesets_ready(void)
   /* Setup road integrators caches */
   road_integrators_cache_init();
 
+  /* Group the effects for faster lookups */
+  effect_index_build();
+
   /* Pre calculate action related data. */
   actions_rs_pre_san_gen();
 
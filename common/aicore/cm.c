@@ -28,6 +28,7 @@
 
 /* common */
 #include "city.h"
+#include "effects.h"
 #include "game.h"
 #include "government.h"
 #include "map.h"
@@ -61,6 +62,16 @@
  * slightly faster.  It evaluates about half as many solutions, but each
  * candidate solution is more expensive due to the lack of caching.
  *
+ * The best solution of a query is remembered in the city, with what
+ * every tile and specialist produced and what the city made of the
+ * solution. When the same parameter is used again, the tiles and the
+ * specialists produce the same and the solution still gives the city
+ * the same stats, the remembered result is handed out without a search.
+ * When only a few tiles produce something else, the old solution is
+ * evaluated again and its fitness becomes a bound that the search
+ * prunes against from the start. It never becomes the best solution
+ * itself, so the search returns what it would have without it.
+ *
  * We use highly specific knowledge about how the city computes its stats
  * in two places:
  * - setting the min_production array.  Ideally the city should tell us.
@@ -79,6 +90,17 @@
  * printed if CM_LOOP_NO_LIMIT is defined. */
 #define CM_MAX_LOOP 27500
 
+/* Number of solutions with different parameters remembered per city. */
+#define CM_CACHE_SLOTS 2
+
+/* Maximal number of tiles whose production may have changed for an
+ * earlier solution to still seed the search. */
+#define CM_WARM_START_MAX_CHANGED 4
+
+/* Production recorded for the tiles and specialists the city can't
+ * use. */
+#define CM_TILE_UNAVAILABLE (-FC_INFINITY)
+
 #define CPUHOG_CM_MAX_LOOP (CM_MAX_LOOP * 4)
 
 #ifdef DEBUG_TIMERS
@@ -120,6 +142,47 @@ struct cm_fitness {
   bool sufficient; /* false => doesn't meet constraints */
 };
 
+/*
+ * What the city makes of a solution. A remembered result is only handed
+ * out again if applying it gives the city the very same stats.
+ */
+struct cm_city_stats {
+  int surplus[O_LAST];
+  int waste[O_LAST];
+  int unhappy_penalty[O_LAST];
+  int prod[O_LAST];
+  int citizen_base[O_LAST];
+  int usage[O_LAST];
+  int bonus[O_LAST];
+  int abs_bonus[O_LAST];
+  citizens feel[CITIZEN_LAST][FEELING_LAST];
+  citizens martial_law;
+  citizens unit_happy_upkeep;
+};
+
+/*
+ * A solution remembered from an earlier query, with what the tiles
+ * and specialists produced back then.
+ */
+struct cm_cache_entry {
+  bool used;
+  unsigned int last_used;
+  struct cm_parameter parameter;
+  int city_radius_sq;
+  citizens size;
+  int rates[3];
+  int *outputs;     /* See cm_get_outputs() */
+  bool *worked;     /* indexed by city map index, city center included */
+  citizens specialists[SP_MAX];
+  struct cm_city_stats stats;
+};
+
+/* Pointed to by struct city */
+struct cm_cache {
+  unsigned int clock;
+  struct cm_cache_entry entries[CM_CACHE_SLOTS];
+};
+
 
 /*
  * We have a cyclic structure here, so we need to forward-declare the
@@ -210,12 +273,22 @@ struct cm_state {
   struct partial_solution best;
   struct cm_fitness best_value;
 
+  /* fitness of the warm start solution. The search prunes the branches
+   * that can't reach it, but it doesn't replace the best solution. */
+  struct cm_fitness warm_value;
+
   /* hard constraints on production: any solution with less production than
    * this fails to satisfy the constraints, so we can stop investigating
    * this branch.  A solution with more production than this may still
    * fail (for being unhappy, for instance). */
   int min_production[O_LAST];
 
+  /* whether the weighted sum of the production bound, less the usage,
+   * bounds the fitness of the solutions in a branch. See
+   * choice_is_promising(). */
+  bool fitness_bound;
+  int usage[O_LAST];
+
   /* needed luxury to be content, this includes effects by specialists */
   int min_luxury;
 
@@ -232,6 +305,9 @@ struct cm_state {
   } choice;
 
   bool *workers_map; /* placement of the workers within the city map */
+
+  /* Production of the tiles and specialists, see cm_get_outputs() */
+  int *outputs;
 };
 
 
@@ -321,7 +397,19 @@ void cm_init_citymap(void)
 ****************************************************************************/
 void cm_clear_cache(struct city *pcity)
 {
-  /* The B&B algorithm doesn't have city caches so there's nothing to do. */
+  struct cm_cache *cache = pcity->cm_cache;
+  int i;
+
+  if (cache == nullptr) {
+    return;
+  }
+
+  for (i = 0; i < CM_CACHE_SLOTS; i++) {
+    free(cache->entries[i].outputs);
+    free(cache->entries[i].worked);
+  }
+  free(cache);
+  pcity->cm_cache = nullptr;
 }
 
 /************************************************************************//**
@@ -970,6 +1058,51 @@ static void compute_tile_production(const struct city *pcity,
   } output_type_iterate_end;
 }
 
+/************************************************************************//**
+  Number of values cm_get_outputs() fills in for the city.
+****************************************************************************/
+static int cm_outputs_size(const struct city *pcity)
+{
+  return (city_map_tiles_from_city(pcity) + SP_MAX) * O_LAST;
+}
+
+/************************************************************************//**
+  Fill in what the city would get from each tile and specialist: O_LAST
+  values for each city map index, the city center included, then for
+  each specialist type. Tiles and specialists the city can't use are
+  CM_TILE_UNAVAILABLE.
+****************************************************************************/
+static void cm_get_outputs(const struct city *pcity, int *outputs)
+{
+  struct cm_tile_type type;
+  struct tile *pcenter = city_tile(pcity);
+  const struct civ_map *nmap = &(wld.map);
+  int num_tiles = city_map_tiles_from_city(pcity);
+  int i;
+
+  for (i = 0; i < cm_outputs_size(pcity); i++) {
+    outputs[i] = CM_TILE_UNAVAILABLE;
+  }
+
+  city_tile_iterate_index(nmap, city_map_radius_sq_get(pcity), pcenter, ptile,
+                          ctindex) {
+    if (is_free_worked(pcity, ptile) || city_can_work_tile(pcity, ptile)) {
+      compute_tile_production(pcity, ptile, &type);
+      memcpy(outputs + ctindex * O_LAST, type.production,
+             sizeof(type.production));
+    }
+  } city_tile_iterate_index_end;
+
+  normal_specialist_type_iterate(sp) {
+    if (city_can_use_specialist(pcity, sp)) {
+      output_type_iterate(o) {
+        outputs[(num_tiles + sp) * O_LAST + o]
+          = get_specialist_output(pcity, sp, o);
+      } output_type_iterate_end;
+    }
+  } normal_specialist_type_iterate_end;
+}
+
 /************************************************************************//**
   Add the tile [x,y], with production indicated by type, to
   the tile-type lattice.  'newtype' can be on the stack.
@@ -1239,7 +1372,8 @@ static void sort_lattice_by_fitness(const struct cm_state *state,
   Create the lattice.
 ****************************************************************************/
 static void init_tile_lattice(struct city *pcity,
-                              struct tile_type_vector *lattice)
+                              struct tile_type_vector *lattice,
+                              const int *outputs)
 {
   struct cm_tile_type type;
   struct tile *pcenter = city_tile(pcity);
@@ -1253,7 +1387,8 @@ static void init_tile_lattice(struct city *pcity,
     if (is_free_worked(pcity, ptile)) {
       continue;
     } else if (city_can_work_tile(pcity, ptile)) {
-      compute_tile_production(pcity, ptile, &type); /* Clobbers type */
+      memcpy(type.production, outputs + ctindex * O_LAST,
+             sizeof(type.production)); /* Clobbers type */
       tile_type_lattice_add(lattice, &type, ctindex); /* Copy type if needed */
     }
   } city_tile_iterate_index_end;
@@ -1712,6 +1847,28 @@ static bool choice_is_promising(struct cm_state *state, int newchoice,
       return FALSE;
     }
   }
+
+  /* No solution in the branch can be weighted higher than the production
+     bound less the usage. Prune the branch if that doesn't beat the best
+     solution so far, or doesn't even reach the warm start solution. */
+  if (state->fitness_bound) {
+    int weighted = MAX(state->parameter.happy_factor, 0);
+
+    output_type_iterate(stat_index) {
+      weighted += (production[stat_index] - state->usage[stat_index])
+                  * state->parameter.factor[stat_index];
+    } output_type_iterate_end;
+
+    if ((state->best_value.sufficient
+         && weighted <= state->best_value.weighted)
+        || (state->warm_value.sufficient
+            && weighted < state->warm_value.weighted)) {
+      log_base(LOG_PRUNE_BRANCH, "--- pruning: fitness bound %d too low",
+               weighted);
+      return FALSE;
+    }
+  }
+
   if (!beats_best) {
     log_base(LOG_PRUNE_BRANCH, "--- pruning: best is better in all important ways");
   }
@@ -1728,6 +1885,7 @@ static void init_min_production(struct cm_state *state)
 
   output_type_iterate(o) {
     state->min_production[o] = pcity->usage[o] + state->parameter.minimal_surplus[o];
+    state->usage[o] = pcity->usage[o];
   } output_type_iterate_end;
 
   /* We could get a minimum on luxury if we knew how many luxuries were
@@ -1857,9 +2015,11 @@ static bool bb_next(struct cm_state *state, bool negative_ok)
 }
 
 /************************************************************************//**
-  Initialize the state for the branch-and-bound algorithm.
+  Initialize the state for the branch-and-bound algorithm. The state
+  takes over 'outputs', filled in by cm_get_outputs().
 ****************************************************************************/
-static struct cm_state *cm_state_init(struct city *pcity, bool negative_ok)
+static struct cm_state *cm_state_init(struct city *pcity, bool negative_ok,
+                                      int *outputs)
 {
   const int SCIENCE = 0, TAX = 1, LUXURY = 2;
   const struct player *pplayer = city_owner(pcity);
@@ -1875,8 +2035,9 @@ static struct cm_state *cm_state_init(struct city *pcity, bool negative_ok)
   state->pcity = pcity;
 
   /* create the lattice */
+  state->outputs = outputs;
   tile_type_vector_init(&state->lattice);
-  init_tile_lattice(pcity, &state->lattice);
+  init_tile_lattice(pcity, &state->lattice, state->outputs);
   numtypes = tile_type_vector_size(&state->lattice);
 
   get_tax_rates(pplayer, rates);
@@ -2003,8 +2164,21 @@ static void begin_search(struct cm_state *state,
 
   init_min_production(state);
 
+  /* Surplus waste takes a share of the surplus, so the usage depends on
+   * the solution then. A negative factor turns the bound around. */
+  state->fitness_bound
+    = (effect_list_size(get_effects(EFT_SURPLUS_WASTE_PCT)) == 0
+       && effect_list_size(get_effects(EFT_SURPLUS_WASTE_PCT_BY_REL_DISTANCE))
+          == 0);
+  output_type_iterate(o) {
+    if (state->parameter.factor[o] < 0) {
+      state->fitness_bound = FALSE;
+    }
+  } output_type_iterate_end;
+
   /* Clear out the old solution */
   state->best_value = worst_fitness();
+  state->warm_value = worst_fitness();
   destroy_partial_solution(&state->current);
   init_partial_solution(&state->current, num_types(state),
                         city_size_get(state->pcity),
@@ -2043,9 +2217,258 @@ static void cm_state_free(struct cm_state *state)
 
   FC_FREE(state->choice.stack);
   FC_FREE(state->workers_map);
+  FC_FREE(state->outputs);
   FC_FREE(state);
 }
 
+/************************************************************************//**
+  Return the remembered solution of the city for the parameter, or
+  nullptr if there is none.
+****************************************************************************/
+static struct cm_cache_entry *
+cm_cache_find(const struct city *pcity,
+              const struct cm_parameter *parameter)
+{
+  struct cm_cache *cache = pcity->cm_cache;
+  int i;
+
+  if (cache == nullptr) {
+    return nullptr;
+  }
+
+  for (i = 0; i < CM_CACHE_SLOTS; i++) {
+    struct cm_cache_entry *entry = &cache->entries[i];
+
+    if (entry->used
+        && entry->city_radius_sq == city_map_radius_sq_get(pcity)
+        && cm_are_parameter_equal(&entry->parameter, parameter)) {
+      return entry;
+    }
+  }
+
+  return nullptr;
+}
+
+/************************************************************************//**
+  Copy the stats of the city that a remembered solution is checked by.
+****************************************************************************/
+static void cm_city_stats_get(const struct city *pcity,
+                              struct cm_city_stats *stats)
+{
+  /* Clear the padding too, for memcmp() */
+  memset(stats, 0, sizeof(*stats));
+
+  memcpy(stats->surplus, pcity->surplus, sizeof(stats->surplus));
+  memcpy(stats->waste, pcity->waste, sizeof(stats->waste));
+  memcpy(stats->unhappy_penalty, pcity->unhappy_penalty,
+         sizeof(stats->unhappy_penalty));
+  memcpy(stats->prod, pcity->prod, sizeof(stats->prod));
+  memcpy(stats->citizen_base, pcity->citizen_base,
+         sizeof(stats->citizen_base));
+  memcpy(stats->usage, pcity->usage, sizeof(stats->usage));
+  memcpy(stats->bonus, pcity->bonus, sizeof(stats->bonus));
+  memcpy(stats->abs_bonus, pcity->abs_bonus, sizeof(stats->abs_bonus));
+  memcpy(stats->feel, pcity->feel, sizeof(stats->feel));
+  stats->martial_law = pcity->martial_law;
+  stats->unit_happy_upkeep = pcity->unit_happy_upkeep;
+}
+
+/************************************************************************//**
+  Hand out the remembered result for the parameter if nothing it depends
+  on has changed: the size of the city, the tax rates, what each tile and
+  specialist produces, and what the city makes of the solution. Returns
+  whether 'result' was filled in.
+****************************************************************************/
+static bool cm_cache_result(struct city *pcity,
+                            const struct cm_parameter *parameter,
+                            const int *outputs, struct cm_result *result)
+{
+  const struct civ_map *nmap = &(wld.map);
+  struct cm_cache_entry *entry;
+  struct cm_city_stats stats;
+  struct cm_fitness fitness;
+  struct city backup;
+  int rates[3];
+  bool same;
+
+  if (parameter->max_growth) {
+    /* The food surplus asked for depends on the food stock */
+    return FALSE;
+  }
+
+  entry = cm_cache_find(pcity, parameter);
+  if (entry == nullptr || entry->size != city_size_get(pcity)) {
+    return FALSE;
+  }
+
+  get_tax_rates(city_owner(pcity), rates);
+  if (memcmp(entry->rates, rates, sizeof(rates))
+      || memcmp(entry->outputs, outputs,
+                cm_outputs_size(pcity) * sizeof(*outputs))) {
+    return FALSE;
+  }
+
+  /* Apply the solution the way apply_solution() does */
+  memcpy(&backup, pcity, sizeof(backup));
+  memcpy(pcity->specialists, entry->specialists,
+         sizeof(pcity->specialists[0]) * normal_specialist_count());
+  city_refresh_from_main_map(nmap, pcity, entry->worked);
+
+  cm_city_stats_get(pcity, &stats);
+  same = !memcmp(&stats, &entry->stats, sizeof(stats));
+  if (same) {
+    cm_result_copy(result, pcity, entry->worked);
+    fitness = compute_fitness(result->surplus, result->disorder,
+                              result->happy, parameter);
+    result->found_a_valid = fitness.sufficient;
+    result->aborted = FALSE;
+    entry->last_used = ++pcity->cm_cache->clock;
+  }
+
+  memcpy(pcity, &backup, sizeof(backup));
+
+  if (same) {
+    /* Leave the city refreshed, as a search would */
+    city_refresh_from_main_map(nmap, pcity, nullptr);
+  }
+
+  return same;
+}
+
+/************************************************************************//**
+  If the city still looks enough like it did when it remembered a
+  solution for the parameter, evaluate that solution again. Its fitness
+  becomes the bound the search prunes against. This must be called after
+  begin_search(), as it evaluates the solution.
+****************************************************************************/
+static void cm_warm_start(struct cm_state *state)
+{
+  const struct cm_cache_entry *entry
+    = cm_cache_find(state->pcity, &state->parameter);
+  struct partial_solution seed;
+  citizens csize = city_size_get(state->pcity);
+  int num_outputs = cm_outputs_size(state->pcity) / O_LAST;
+  int changed = 0;
+  int *counts;
+  int total = 0;
+  int i, j;
+
+  if (entry == nullptr || entry->size != csize) {
+    return;
+  }
+
+  for (i = 0; i < num_outputs; i++) {
+    if (memcmp(entry->outputs + i * O_LAST,
+               state->outputs + i * O_LAST,
+               O_LAST * sizeof(*state->outputs))
+        && ++changed > CM_WARM_START_MAX_CHANGED) {
+      return;
+    }
+  }
+
+  /* Any tiles of the same type will do, as they produce the same. */
+  counts = fc_malloc(num_types(state) * sizeof(*counts));
+  for (i = 0; i < num_types(state); i++) {
+    const struct cm_tile_type *ptype = tile_type_get(state, i);
+
+    if (ptype->is_specialist) {
+      counts[i] = entry->specialists[ptype->spec];
+    } else {
+      counts[i] = 0;
+      for (j = 0; j < tile_type_num_tiles(ptype); j++) {
+        if (entry->worked[tile_get(ptype, j)->index]) {
+          counts[i]++;
+        }
+      }
+    }
+    total += counts[i];
+  }
+
+  if (total == csize) {
+    int min_luxury = state->min_luxury;
+    struct cm_fitness value;
+
+    init_partial_solution(&seed, num_types(state), csize, FALSE);
+    for (i = 0; i < num_types(state); i++) {
+      add_workers(&seed, i, counts[i], state);
+    }
+
+    /* The search learns about the luxury needed by itself */
+    value = evaluate_solution(state, &seed);
+    state->min_luxury = min_luxury;
+    if (value.sufficient) {
+      state->warm_value = value;
+    }
+    destroy_partial_solution(&seed);
+  } /* Else some of the tiles or specialists are not available any more */
+
+  free(counts);
+}
+
+/************************************************************************//**
+  Remember the result of the search, to hand out again or seed later
+  queries with. 'stats' are those of the city with the result applied.
+****************************************************************************/
+static void cm_cache_store(struct cm_state *state,
+                           const struct cm_result *result,
+                           const struct cm_city_stats *stats)
+{
+  struct city *pcity = state->pcity;
+  struct cm_cache_entry *entry = cm_cache_find(pcity, &state->parameter);
+  int num_tiles = city_map_tiles_from_city(pcity);
+  int i;
+
+  if (state->best.idle != 0) {
+    /* No complete solution */
+    return;
+  }
+
+  if (entry == nullptr) {
+    if (pcity->cm_cache == nullptr) {
+      pcity->cm_cache = fc_calloc(1, sizeof(*pcity->cm_cache));
+    }
+
+    /* Take a free slot, or the least recently used one */
+    for (i = 0; i < CM_CACHE_SLOTS; i++) {
+      struct cm_cache_entry *pslot = &pcity->cm_cache->entries[i];
+
+      if (!pslot->used) {
+        entry = pslot;
+        break;
+      }
+      if (entry == nullptr || pslot->last_used < entry->last_used) {
+        entry = pslot;
+      }
+    }
+
+    cm_copy_parameter(&entry->parameter, &state->parameter);
+    entry->used = TRUE;
+  }
+
+  if (entry->outputs == nullptr
+      || entry->city_radius_sq != city_map_radius_sq_get(pcity)) {
+    entry->city_radius_sq = city_map_radius_sq_get(pcity);
+    entry->outputs = fc_realloc(entry->outputs,
+                                cm_outputs_size(pcity)
+                                * sizeof(*entry->outputs));
+    entry->worked = fc_realloc(entry->worked,
+                               num_tiles * sizeof(*entry->worked));
+  }
+
+  entry->last_used = ++pcity->cm_cache->clock;
+  entry->size = city_size_get(pcity);
+  get_tax_rates(city_owner(pcity), entry->rates);
+  memcpy(entry->outputs, state->outputs,
+         cm_outputs_size(pcity) * sizeof(*entry->outputs));
+  memcpy(entry->worked, result->worker_positions,
+         num_tiles * sizeof(*entry->worked));
+  memset(entry->specialists, 0, sizeof(entry->specialists));
+  normal_specialist_type_iterate(sp) {
+    entry->specialists[sp] = result->specialists[sp];
+  } normal_specialist_type_iterate_end;
+  entry->stats = *stats;
+}
+
 /************************************************************************//**
   Run B&B until we find the best solution.
 ****************************************************************************/
@@ -2056,6 +2479,7 @@ static void cm_find_best_solution(struct cm_state *state,
   int loop_count = 0;
   int max_count;
   struct city backup;
+  struct cm_city_stats stats;
 
 #ifdef GATHER_TIME_STATS
   performance.current = &performance.opt;
@@ -2066,6 +2490,10 @@ static void cm_find_best_solution(struct cm_state *state,
   /* Make a backup of the city to restore at the very end */
   memcpy(&backup, state->pcity, sizeof(backup));
 
+  if (!negative_ok) {
+    cm_warm_start(state);
+  }
+
   if (player_is_cpuhog(city_owner(state->pcity))) {
     max_count = CPUHOG_CM_MAX_LOOP;
   } else {
@@ -2111,9 +2539,14 @@ static void cm_find_best_solution(struct cm_state *state,
 
   /* convert to the caller's format */
   convert_solution_to_result(state, &state->best, result);
+  cm_city_stats_get(state->pcity, &stats);
 
   memcpy(state->pcity, &backup, sizeof(backup));
 
+  if (!negative_ok && !result->aborted) {
+    cm_cache_store(state, result, &stats);
+  }
+
   end_search(state);
 }
 
@@ -2125,9 +2558,18 @@ void cm_query_result(struct city *pcity,
                      const struct cm_parameter *param,
                      struct cm_result *result, bool negative_ok)
 {
-  struct cm_state *state = cm_state_init(pcity, negative_ok);
+  int *outputs = fc_malloc(cm_outputs_size(pcity) * sizeof(*outputs));
+  struct cm_state *state;
   const struct civ_map *nmap = &(wld.map);
 
+  cm_get_outputs(pcity, outputs);
+  if (!negative_ok && cm_cache_result(pcity, param, outputs, result)) {
+    free(outputs);
+    return;
+  }
+
+  state = cm_state_init(pcity, negative_ok, outputs);
+
   /* Refresh the city. Otherwise the CM can give wrong results or just be
    * slower than necessary. Note that cities are often passed in in an
    * unrefreshed state (which should probably be fixed). */
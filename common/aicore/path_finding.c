@@ -15,8 +15,11 @@
 #include <fc_config.h>
 #endif
 
+#include <string.h>
+
 /* utility */
 #include "bitvector.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "support.h"
@@ -96,6 +99,31 @@ struct pf_map {
 /* Down-cast macro. */
 #define PF_MAP(pfm) ((struct pf_map *) (pfm))
 
+/* Storage of the nodes of a map. The buffers are recycled between the
+ * maps, and rather than clearing them, the generation is bumped: a node
+ * which is not stamped with the current generation is considered as
+ * zeroed, i.e. NS_UNINIT (see pf_lattice_node()). */
+struct pf_lattice {
+  unsigned char *nodes;         /* MAP_INDEX_SIZE nodes (at least). */
+  size_t nodes_size;            /* Allocated size of 'nodes', in bytes. */
+  unsigned int *stamps;         /* Generation of every node. */
+  int stamps_num;               /* Allocated number of 'stamps' and
+                                 * 'used'. */
+  int *used;                    /* Indices of the nodes in use. */
+  int used_num;                 /* Number of nodes in use. */
+  unsigned int generation;
+  struct pf_lattice *next;      /* Next unused lattice in the pool. */
+};
+
+/* Maximum number of unused lattices kept for reuse. */
+#define PF_LATTICE_POOL_SIZE 16
+
+static struct {
+  fc_mutex mutex;
+  struct pf_lattice *unused;
+  int unused_num;
+} pf_lattice_pool;
+
 /* ========================== Common functions =========================== */
 
 /************************************************************************//**
@@ -191,6 +219,127 @@ static inline void pf_finalize_position(const struct pf_parameter *param,
   }
 }
 
+/************************************************************************//**
+  Invalidate all the nodes of the lattice.
+****************************************************************************/
+static void pf_lattice_clear(struct pf_lattice *lattice)
+{
+  lattice->used_num = 0;
+  if (++lattice->generation == 0) {
+    /* Wrapped around, old stamps could be taken for current ones. */
+    memset(lattice->stamps, 0, lattice->stamps_num * sizeof(*lattice->stamps));
+    lattice->generation = 1;
+  }
+}
+
+/************************************************************************//**
+  Get a lattice of MAP_INDEX_SIZE nodes of 'node_size' bytes, all of them
+  uninitialized. Reuses a lattice from the pool if possible.
+****************************************************************************/
+static struct pf_lattice *pf_lattice_new(size_t node_size)
+{
+  struct pf_lattice *lattice;
+  size_t nodes_size = MAP_INDEX_SIZE * node_size;
+
+  fc_mutex_allocate(&pf_lattice_pool.mutex);
+  lattice = pf_lattice_pool.unused;
+  if (lattice != nullptr) {
+    pf_lattice_pool.unused = lattice->next;
+    pf_lattice_pool.unused_num--;
+  }
+  fc_mutex_release(&pf_lattice_pool.mutex);
+
+  if (lattice == nullptr) {
+    lattice = fc_calloc(1, sizeof(*lattice));
+  }
+
+  if (lattice->nodes_size < nodes_size) {
+    free(lattice->nodes);
+    lattice->nodes = fc_malloc(nodes_size);
+    lattice->nodes_size = nodes_size;
+  }
+  if (lattice->stamps_num < MAP_INDEX_SIZE) {
+    free(lattice->stamps);
+    free(lattice->used);
+    lattice->stamps = fc_calloc(MAP_INDEX_SIZE, sizeof(*lattice->stamps));
+    lattice->used = fc_malloc(MAP_INDEX_SIZE * sizeof(*lattice->used));
+    lattice->stamps_num = MAP_INDEX_SIZE;
+    lattice->generation = 0;
+  }
+  lattice->next = nullptr;
+  pf_lattice_clear(lattice);
+
+  return lattice;
+}
+
+/************************************************************************//**
+  Give the lattice back to the pool.
+****************************************************************************/
+static void pf_lattice_destroy(struct pf_lattice *lattice)
+{
+  fc_mutex_allocate(&pf_lattice_pool.mutex);
+  if (pf_lattice_pool.unused_num < PF_LATTICE_POOL_SIZE) {
+    lattice->next = pf_lattice_pool.unused;
+    pf_lattice_pool.unused = lattice;
+    pf_lattice_pool.unused_num++;
+    lattice = nullptr;
+  }
+  fc_mutex_release(&pf_lattice_pool.mutex);
+
+  if (lattice != nullptr) {
+    free(lattice->nodes);
+    free(lattice->stamps);
+    free(lattice->used);
+    free(lattice);
+  }
+}
+
+/************************************************************************//**
+  Returns whether the node at 'tindex' is in use, i.e. has been
+  initialized since the last pf_lattice_clear().
+****************************************************************************/
+static inline bool pf_lattice_node_used(const struct pf_lattice *lattice,
+                                        int tindex)
+{
+  return lattice->stamps[tindex] == lattice->generation;
+}
+
+/************************************************************************//**
+  Returns the node at 'tindex', zeroing it first if it has not been used
+  since the last pf_lattice_clear().
+****************************************************************************/
+static inline void *pf_lattice_node(struct pf_lattice *lattice, int tindex,
+                                    size_t node_size)
+{
+  void *node = lattice->nodes + tindex * node_size;
+
+  if (!pf_lattice_node_used(lattice, tindex)) {
+    memset(node, 0, node_size);
+    lattice->stamps[tindex] = lattice->generation;
+    lattice->used[lattice->used_num++] = tindex;
+  }
+
+  return node;
+}
+
+/************************************************************************//**
+  Returns the number of nodes in use, see pf_lattice_used_index().
+****************************************************************************/
+static inline int pf_lattice_used_num(const struct pf_lattice *lattice)
+{
+  return lattice->used_num;
+}
+
+/************************************************************************//**
+  Returns the index of the 'n'th node in use, in the order they were
+  first used since the last pf_lattice_clear().
+****************************************************************************/
+static inline int pf_lattice_used_index(const struct pf_lattice *lattice,
+                                        int n)
+{
+  return lattice->used[n];
+}
+
 static struct pf_path *
 pf_path_new_to_start_tile(const struct pf_parameter *param);
 static void pf_position_fill_start_tile(struct pf_position *pos,
@@ -230,8 +379,18 @@ struct pf_normal_map {
 
   struct map_index_pq *queue; /* Queue of nodes we have reached but not
                                * processed yet (NS_NEW), sorted by their
-                               * total_CC. */
-  struct pf_normal_node *lattice; /* Lattice of nodes. */
+                               * total_CC (and the estimate of the
+                               * remaining cost in goal-directed search). */
+  struct pf_lattice *lattice; /* Lattice of nodes. */
+
+  struct tile *goal;        /* Target of the goal-directed search, nullptr
+                             * for the full search. */
+  int goal_min_MC;          /* Lower bound of the cost of any step but
+                             * those into below_min_MC() tiles. */
+  int goal_min_steps;       /* Steps costing at least goal_min_MC needed
+                             * to reach the goal from anywhere. */
+  bool goal_searched;       /* Some nodes may have been processed out of
+                             * the total_CC order. */
 };
 
 /* Up-cast macro. */
@@ -251,6 +410,16 @@ pf_normal_map_check(struct pf_map *pfm, const char *file,
 #define PF_NORMAL_MAP(pfm) ((struct pf_normal_map *) (pfm))
 #endif /* PF_DEBUG */
 
+/************************************************************************//**
+  Returns the node of the map at 'tindex'.
+****************************************************************************/
+static inline struct pf_normal_node *
+pf_normal_map_node(const struct pf_normal_map *pfnm, int tindex)
+{
+  return pf_lattice_node(pfnm->lattice, tindex,
+                         sizeof(struct pf_normal_node));
+}
+
 /* ================  Specific pf_normal_* mode functions ================= */
 
 /************************************************************************//**
@@ -403,7 +572,7 @@ static void pf_normal_map_fill_position(const struct pf_normal_map *pfnm,
                                         struct pf_position *pos)
 {
   int tindex = tile_index(ptile);
-  struct pf_normal_node *node = pfnm->lattice + tindex;
+  struct pf_normal_node *node = pf_normal_map_node(pfnm, tindex);
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfnm));
 
 #ifdef PF_DEBUG
@@ -438,7 +607,8 @@ static struct pf_path *
 pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
                              struct tile *dest_tile)
 {
-  struct pf_normal_node *node = pfnm->lattice + tile_index(dest_tile);
+  struct pf_normal_node *node
+      = pf_normal_map_node(pfnm, tile_index(dest_tile));
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfnm));
   enum direction8 dir_next = direction8_invalid();
   struct pf_path *path;
@@ -463,7 +633,7 @@ pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
     }
 
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pfnm->lattice + tile_index(ptile);
+    node = pf_normal_map_node(pfnm, tile_index(ptile));
   }
 
   /* 2: Allocate the memory */
@@ -472,7 +642,7 @@ pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
 
   /* 3: Backtrack again and fill the positions this time */
   ptile = dest_tile;
-  node = pfnm->lattice + tile_index(ptile);
+  node = pf_normal_map_node(pfnm, tile_index(ptile));
 
   for (; i >= 0; i--) {
     pf_normal_map_fill_position(pfnm, ptile, &path->positions[i]);
@@ -484,7 +654,7 @@ pf_normal_map_construct_path(const struct pf_normal_map *pfnm,
     if (i > 0) {
       /* Step further back, if we haven't finished yet */
       ptile = mapstep(params->map, ptile, DIR_REVERSE(dir_next));
-      node = pfnm->lattice + tile_index(ptile);
+      node = pf_normal_map_node(pfnm, tile_index(ptile));
     }
   }
 
@@ -499,6 +669,60 @@ static int pf_normal_map_adjust_cost(int cost, int moves_left)
   return MIN(cost, moves_left);
 }
 
+/************************************************************************//**
+  Lower bound of the cost (as total_MC) still needed to reach the goal
+  from 'ptile', which has been reached with 'cost'. Every step costs at
+  least 'goal_min_MC', but never more than the moves left (see
+  pf_normal_map_adjust_cost()), after which a new turn begins. This is the
+  exact cost of that relaxed problem, so the estimate never decreases by
+  more than the cost of a step: the nodes are still processed with their
+  best cost, only in another order.
+****************************************************************************/
+static inline int pf_normal_map_estimate(const struct pf_normal_map *pfnm,
+                                         const struct tile *ptile,
+                                         int cost)
+{
+  const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfnm));
+  int min_MC = pfnm->goal_min_MC;
+  int dist = MIN(real_map_distance(ptile, pfnm->goal),
+                 pfnm->goal_min_steps);
+  int moves_left, move_rate, steps;
+
+  if (dist == 0) {
+    return 0;
+  }
+
+  /* Steps possible in the current turn. */
+  moves_left = pf_moves_left(params, cost);
+  steps = (moves_left + min_MC - 1) / min_MC;
+  if (dist <= steps) {
+    return MIN(dist * min_MC, moves_left);
+  }
+
+  /* Full turns, then the steps left in the last turn. */
+  dist -= steps;
+  move_rate = pf_move_rate(params);
+  steps = (move_rate + min_MC - 1) / min_MC;
+
+  return moves_left + (dist / steps) * move_rate + (dist % steps) * min_MC;
+}
+
+/************************************************************************//**
+  Priority of the node in the queue (lower is better). Without goal, it is
+  the cost of the path. See pf_normal_map_estimate().
+****************************************************************************/
+static inline int pf_normal_map_priority(const struct pf_normal_map *pfnm,
+                                         const struct tile *ptile,
+                                         int cost, int cost_of_path)
+{
+  if (pfnm->goal == nullptr) {
+    return cost_of_path;
+  }
+
+  return (cost_of_path
+          + PF_TURN_FACTOR * pf_normal_map_estimate(pfnm, ptile, cost));
+}
+
 /************************************************************************//**
   Bare-bones PF iterator. All Freeciv rules logic is hidden in 'get_costs'
   callback (compare to pf_normal_map_iterate function). This function is
@@ -521,7 +745,7 @@ static bool pf_jumbo_map_iterate(struct pf_map *pfm)
   struct pf_normal_map *pfnm = PF_NORMAL_MAP(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_normal_node *node = pfnm->lattice + tindex;
+  struct pf_normal_node *node = pf_normal_map_node(pfnm, tindex);
   const struct pf_parameter *params = pf_map_parameter(pfm);
 
   /* Processing Stage */
@@ -534,7 +758,7 @@ static bool pf_jumbo_map_iterate(struct pf_map *pfm)
     /* Calculate the cost of every adjacent position and set them in the
      * priority queue for next call to pf_jumbo_map_iterate(). */
     int tindex1 = tile_index(tile1);
-    struct pf_normal_node *node1 = pfnm->lattice + tindex1;
+    struct pf_normal_node *node1 = pf_normal_map_node(pfnm, tindex1);
     int priority;
     unsigned cost1;
     unsigned extra_cost1;
@@ -584,12 +808,12 @@ static bool pf_jumbo_map_iterate(struct pf_map *pfm)
   }
 
 #ifdef PF_DEBUG
-  fc_assert(NS_NEW == pfnm->lattice[tindex].status);
+  fc_assert(NS_NEW == pf_normal_map_node(pfnm, tindex)->status);
 #endif
 
   /* Change the pf_map iterator. Node status step B. to C. */
   pfm->tile = index_to_tile(params->map, tindex);
-  pfnm->lattice[tindex].status = NS_PROCESSED;
+  pf_normal_map_node(pfnm, tindex)->status = NS_PROCESSED;
 
   return TRUE;
 }
@@ -615,7 +839,7 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
   struct pf_normal_map *pfnm = PF_NORMAL_MAP(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_normal_node *node = pfnm->lattice + tindex;
+  struct pf_normal_node *node = pf_normal_map_node(pfnm, tindex);
   const struct pf_parameter *params = pf_map_parameter(pfm);
   int cost_of_path;
   enum pf_move_scope scope = node->move_scope;
@@ -634,7 +858,7 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
       /* Calculate the cost of every adjacent position and set them in the
        * priority queue for next call to pf_normal_map_iterate(). */
       int tindex1 = tile_index(tile1);
-      struct pf_normal_node *node1 = pfnm->lattice + tindex1;
+      struct pf_normal_node *node1 = pf_normal_map_node(pfnm, tindex1);
       int cost;
       unsigned extra = 0;
 
@@ -714,7 +938,9 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
         node1->cost = cost;
         node1->dir_to_here = dir;
         /* As we prefer lower costs, let's reverse the cost of the path. */
-        map_index_pq_insert(pfnm->queue, tindex1, -cost_of_path);
+        map_index_pq_insert(pfnm->queue, tindex1,
+                            -pf_normal_map_priority(pfnm, tile1, cost,
+                                                    cost_of_path));
       } else if (cost_of_path < pf_total_CC(params, node1->cost,
                                             node1->extra_cost)) {
         /* We found a better route to 'tile1'. Let's register 'tindex1' to
@@ -724,7 +950,9 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
         node1->cost = cost;
         node1->dir_to_here = dir;
         /* As we prefer lower costs, let's reverse the cost of the path. */
-        map_index_pq_replace(pfnm->queue, tindex1, -cost_of_path);
+        map_index_pq_replace(pfnm->queue, tindex1,
+                             -pf_normal_map_priority(pfnm, tile1, cost,
+                                                     cost_of_path));
       }
     } adjc_dir_iterate_end;
   }
@@ -736,16 +964,111 @@ static bool pf_normal_map_iterate(struct pf_map *pfm)
   }
 
 #ifdef PF_DEBUG
-  fc_assert(NS_NEW == pfnm->lattice[tindex].status);
+  fc_assert(NS_NEW == pf_normal_map_node(pfnm, tindex)->status);
 #endif
 
   /* Change the pf_map iterator. Node status step C. to D. */
   pfm->tile = index_to_tile(params->map, tindex);
-  pfnm->lattice[tindex].status = NS_PROCESSED;
+  pf_normal_map_node(pfnm, tindex)->status = NS_PROCESSED;
 
   return TRUE;
 }
 
+/************************************************************************//**
+  Initialize the iterator and the starting node.
+****************************************************************************/
+static void pf_normal_map_init_start(struct pf_normal_map *pfnm)
+{
+  struct pf_map *base_map = PF_MAP(pfnm);
+  const struct pf_parameter *params = pf_map_parameter(base_map);
+  struct pf_normal_node *node;
+
+  /* Initialise starting node. */
+  node = pf_normal_map_node(pfnm, tile_index(params->start_tile));
+  if (params->get_costs == nullptr) {
+    if (!pf_normal_node_init(pfnm, node, params->start_tile, PF_MS_NONE)) {
+      /* Always fails. */
+      fc_assert(pf_normal_node_init(pfnm, node, params->start_tile,
+                                    PF_MS_NONE));
+    }
+
+    if (params->transported_by_initially != nullptr) {
+      /* Overwrite. It is safe because we cannot return to start tile with
+       * pf_normal_map. */
+      node->move_scope |= PF_MS_TRANSPORT;
+      if (!utype_can_freely_unload(params->utype,
+                                   params->transported_by_initially)
+          && tile_city(params->start_tile) == nullptr
+          && !tile_has_native_base(params->start_tile,
+                                   params->transported_by_initially)) {
+        /* Cannot disembark, don't leave transporter. */
+        node->behavior = TB_DONT_LEAVE;
+      }
+    }
+  }
+
+  /* Initialise the iterator. */
+  base_map->tile = params->start_tile;
+
+  /* This makes calculations of turn/moves_left more convenient, but we
+   * need to subtract this value before we return cost to the user. Note
+   * that cost may be negative if moves_left_initially > move_rate
+   * (see pf_turns()). */
+  node->cost = pf_move_rate(params) - pf_moves_left_initially(params);
+  node->extra_cost = 0;
+  node->dir_to_here = direction8_invalid();
+  node->status = NS_PROCESSED;
+}
+
+/************************************************************************//**
+  Stop directing the search towards the goal. The nodes already processed
+  keep their (best) costs, the queued ones are sorted again by the cost of
+  their path.
+****************************************************************************/
+static void pf_normal_map_drop_goal(struct pf_normal_map *pfnm)
+{
+  const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfnm));
+  struct map_index_pq *queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
+  int tindex;
+
+  while (map_index_pq_remove(pfnm->queue, &tindex)) {
+    const struct pf_normal_node *node = pf_normal_map_node(pfnm, tindex);
+
+    map_index_pq_insert(queue, tindex,
+                        -pf_total_CC(params, node->cost, node->extra_cost));
+  }
+  map_index_pq_destroy(pfnm->queue);
+  pfnm->queue = queue;
+  pfnm->goal = nullptr;
+
+  if (!pfnm->goal_searched) {
+    /* Nothing processed out of order, no need to restart iterations. */
+    PF_MAP(pfnm)->iterate = pf_normal_map_iterate;
+  }
+}
+
+/************************************************************************//**
+  Iterator of the goal-directed maps. Iterations are expected in order of
+  increasing cost, so fall back to the full search, from the start tile
+  if some nodes have already been processed out of order.
+****************************************************************************/
+static bool pf_normal_map_goal_iterate(struct pf_map *pfm)
+{
+  struct pf_normal_map *pfnm = PF_NORMAL_MAP(pfm);
+
+  if (pfnm->goal_searched) {
+    pf_lattice_clear(pfnm->lattice);
+    map_index_pq_destroy(pfnm->queue);
+    pfnm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
+    pf_normal_map_init_start(pfnm);
+    pfnm->goal_searched = FALSE;
+  }
+  pfnm->goal = nullptr;
+  pfm->iterate = pf_normal_map_iterate;
+
+  return pf_normal_map_iterate(pfm);
+}
+
 /************************************************************************//**
   Iterate the map until 'ptile' is reached.
 ****************************************************************************/
@@ -753,7 +1076,7 @@ static inline bool pf_normal_map_iterate_until(struct pf_normal_map *pfnm,
                                                struct tile *ptile)
 {
   struct pf_map *pfm = PF_MAP(pfnm);
-  struct pf_normal_node *node = pfnm->lattice + tile_index(ptile);
+  struct pf_normal_node *node = pf_normal_map_node(pfnm, tile_index(ptile));
 
   if (pf_map_parameter(pfm)->get_costs == nullptr) {
     /* Start position is handled in every function calling this function. */
@@ -769,8 +1092,25 @@ static inline bool pf_normal_map_iterate_until(struct pf_normal_map *pfnm,
     }
   } /* Else, this is a jumbo map, not dealing with normal nodes. */
 
+  if (pfnm->goal != nullptr && pfnm->goal != ptile
+      && NS_PROCESSED != node->status) {
+    /* Not the tile the search is directed to. */
+    pf_normal_map_drop_goal(pfnm);
+  }
+
   while (NS_PROCESSED != node->status) {
-    if (!pf_map_iterate(pfm)) {
+    if (pfm->iterate == pf_normal_map_goal_iterate) {
+      /* Don't go through pf_map_iterate() which would restart the full
+       * search. */
+      if (pfm->tile == nullptr) {
+        return FALSE;
+      }
+      pfnm->goal_searched = TRUE;
+      if (!pf_normal_map_iterate(pfm)) {
+        pfm->tile = nullptr;
+        return FALSE;
+      }
+    } else if (!pf_map_iterate(pfm)) {
       /* All reachable destination have been iterated, 'ptile' is
        * unreachable. */
       return FALSE;
@@ -792,7 +1132,7 @@ static int pf_normal_map_move_cost(struct pf_map *pfm, struct tile *ptile)
   if (ptile == pfm->params.start_tile) {
     return 0;
   } else if (pf_normal_map_iterate_until(pfnm, ptile)) {
-    return (pfnm->lattice[tile_index(ptile)].cost
+    return (pf_normal_map_node(pfnm, tile_index(ptile))->cost
             - pf_move_rate(pf_map_parameter(pfm))
             + pf_moves_left_initially(pf_map_parameter(pfm)));
   } else {
@@ -846,7 +1186,7 @@ static void pf_normal_map_destroy(struct pf_map *pfm)
 {
   struct pf_normal_map *pfnm = PF_NORMAL_MAP(pfm);
 
-  free(pfnm->lattice);
+  pf_lattice_destroy(pfnm->lattice);
   map_index_pq_destroy(pfnm->queue);
   free(pfnm);
 }
@@ -859,7 +1199,6 @@ static struct pf_map *pf_normal_map_new(const struct pf_parameter *parameter)
   struct pf_normal_map *pfnm;
   struct pf_map *base_map;
   struct pf_parameter *params;
-  struct pf_normal_node *node;
 
   pfnm = fc_malloc(sizeof(*pfnm));
   base_map = &pfnm->base_map;
@@ -870,8 +1209,12 @@ static struct pf_map *pf_normal_map_new(const struct pf_parameter *parameter)
 #endif /* PF_DEBUG */
 
   /* Allocate the map. */
-  pfnm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_normal_node));
+  pfnm->lattice = pf_lattice_new(sizeof(struct pf_normal_node));
   pfnm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
+  pfnm->goal = nullptr;
+  pfnm->goal_min_MC = 0;
+  pfnm->goal_min_steps = 0;
+  pfnm->goal_searched = FALSE;
 
   if (parameter->get_costs == nullptr) {
     /* 'get_MC' callback must be set. */
@@ -895,41 +1238,7 @@ static struct pf_map *pf_normal_map_new(const struct pf_parameter *parameter)
     base_map->iterate = pf_normal_map_iterate;
   }
 
-  /* Initialise starting node. */
-  node = pfnm->lattice + tile_index(params->start_tile);
-  if (params->get_costs == nullptr) {
-    if (!pf_normal_node_init(pfnm, node, params->start_tile, PF_MS_NONE)) {
-      /* Always fails. */
-      fc_assert(pf_normal_node_init(pfnm, node, params->start_tile,
-                                    PF_MS_NONE));
-    }
-
-    if (params->transported_by_initially != nullptr) {
-      /* Overwrite. It is safe because we cannot return to start tile with
-       * pf_normal_map. */
-      node->move_scope |= PF_MS_TRANSPORT;
-      if (!utype_can_freely_unload(params->utype,
-                                   params->transported_by_initially)
-          && tile_city(params->start_tile) == nullptr
-          && !tile_has_native_base(params->start_tile,
-                                   params->transported_by_initially)) {
-        /* Cannot disembark, don't leave transporter. */
-        node->behavior = TB_DONT_LEAVE;
-      }
-    }
-  }
-
-  /* Initialise the iterator. */
-  base_map->tile = params->start_tile;
-
-  /* This makes calculations of turn/moves_left more convenient, but we
-   * need to subtract this value before we return cost to the user. Note
-   * that cost may be negative if moves_left_initially > move_rate
-   * (see pf_turns()). */
-  node->cost = pf_move_rate(params) - pf_moves_left_initially(params);
-  node->extra_cost = 0;
-  node->dir_to_here = direction8_invalid();
-  node->status = NS_PROCESSED;
+  pf_normal_map_init_start(pfnm);
 
   return PF_MAP(pfnm);
 }
@@ -982,7 +1291,7 @@ struct pf_danger_map {
                                  * processed yet (NS_NEW and NS_WAITING),
                                  * sorted by their total_CC. */
   struct map_index_pq *danger_queue; /* Dangerous positions. */
-  struct pf_danger_node *lattice; /* Lattice of nodes. */
+  struct pf_lattice *lattice; /* Lattice of nodes. */
 };
 
 /* Up-cast macro. */
@@ -1002,6 +1311,16 @@ pf_danger_map_check(struct pf_map *pfm, const char *file,
 #define PF_DANGER_MAP(pfm) ((struct pf_danger_map *) (pfm))
 #endif /* PF_DEBUG */
 
+/************************************************************************//**
+  Returns the node of the map at 'tindex'.
+****************************************************************************/
+static inline struct pf_danger_node *
+pf_danger_map_node(const struct pf_danger_map *pfdm, int tindex)
+{
+  return pf_lattice_node(pfdm->lattice, tindex,
+                         sizeof(struct pf_danger_node));
+}
+
 /* ===============  Specific pf_danger_* mode functions ================== */
 
 /************************************************************************//**
@@ -1163,7 +1482,7 @@ static void pf_danger_map_fill_position(const struct pf_danger_map *pfdm,
                                         struct pf_position *pos)
 {
   int tindex = tile_index(ptile);
-  struct pf_danger_node *node = pfdm->lattice + tindex;
+  struct pf_danger_node *node = pf_danger_map_node(pfdm, tindex);
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfdm));
 
 #ifdef PF_DEBUG
@@ -1221,7 +1540,7 @@ pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
   enum direction8 dir_next = direction8_invalid();
   struct pf_danger_pos *danger_seg = nullptr;
   bool waited = FALSE;
-  struct pf_danger_node *node = pfdm->lattice + tile_index(ptile);
+  struct pf_danger_node *node = pf_danger_map_node(pfdm, tile_index(ptile));
   unsigned length = 1;
   struct tile *iter_tile = ptile;
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pfdm));
@@ -1258,7 +1577,7 @@ pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
 
     /* Step backward. */
     iter_tile = mapstep(params->map, iter_tile, DIR_REVERSE(dir_next));
-    node = pfdm->lattice + tile_index(iter_tile);
+    node = pf_danger_map_node(pfdm, tile_index(iter_tile));
   }
 
   /* Allocate memory for path. */
@@ -1267,7 +1586,7 @@ pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
 
   /* Reset variables for main iteration. */
   iter_tile = ptile;
-  node = pfdm->lattice + tile_index(ptile);
+  node = pf_danger_map_node(pfdm, tile_index(ptile));
   danger_seg = nullptr;
   waited = FALSE;
 
@@ -1349,7 +1668,7 @@ pf_danger_map_construct_path(const struct pf_danger_map *pfdm,
 
     /* 5: Step further back. */
     iter_tile = mapstep(params->map, iter_tile, DIR_REVERSE(dir_next));
-    node = pfdm->lattice + tile_index(iter_tile);
+    node = pf_danger_map_node(pfdm, tile_index(iter_tile));
   }
 
   fc_assert_msg(FALSE, "Cannot get to the starting point!");
@@ -1379,7 +1698,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
                                          struct pf_danger_node *node1)
 {
   struct tile *ptile = PF_MAP(pfdm)->tile;
-  struct pf_danger_node *node = pfdm->lattice + tile_index(ptile);
+  struct pf_danger_node *node = pf_danger_map_node(pfdm, tile_index(ptile));
   struct pf_danger_pos *pos;
   unsigned length = 0;
   unsigned i;
@@ -1395,7 +1714,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
   while (node->is_dangerous && direction8_is_valid(node->dir_to_here)) {
     length++;
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pfdm->lattice + tile_index(ptile);
+    node = pf_danger_map_node(pfdm, tile_index(ptile));
   }
 
   /* Allocate memory for segment */
@@ -1403,7 +1722,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
 
   /* Reset tile and node pointers for main iteration */
   ptile = PF_MAP(pfdm)->tile;
-  node = pfdm->lattice + tile_index(ptile);
+  node = pf_danger_map_node(pfdm, tile_index(ptile));
 
   /* Now fill the positions */
   for (i = 0, pos = node1->danger_segment; i < length; i++, pos++) {
@@ -1418,7 +1737,7 @@ static void pf_danger_map_create_segment(struct pf_danger_map *pfdm,
 
     /* Step further down the tree */
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pfdm->lattice + tile_index(ptile);
+    node = pf_danger_map_node(pfdm, tile_index(ptile));
   }
 
 #ifdef PF_DEBUG
@@ -1495,7 +1814,7 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
   const struct pf_parameter *const params = pf_map_parameter(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_danger_node *node = pfdm->lattice + tindex;
+  struct pf_danger_node *node = pf_danger_map_node(pfdm, tindex);
   enum pf_move_scope scope = node->move_scope;
 
   /* The previous position is defined by 'tile' (tile pointer), 'node'
@@ -1536,7 +1855,7 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
         /* Calculate the cost of every adjacent position and set them in
          * the priority queues for next call to pf_danger_map_iterate(). */
         int tindex1 = tile_index(tile1);
-        struct pf_danger_node *node1 = pfdm->lattice + tindex1;
+        struct pf_danger_node *node1 = pf_danger_map_node(pfdm, tindex1);
         int cost;
         int extra = 0;
 
@@ -1707,7 +2026,7 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
       /* Change the pf_map iterator and reset data. */
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pfdm->lattice + tindex;
+      node = pf_danger_map_node(pfdm, tindex);
     } else {
       /* No dangerous nodes to process, go for a safe one. */
       if (!map_index_pq_remove(pfdm->queue, &tindex)) {
@@ -1716,13 +2035,13 @@ static bool pf_danger_map_iterate(struct pf_map *pfm)
       }
 
 #ifdef PF_DEBUG
-      fc_assert(NS_PROCESSED != pfdm->lattice[tindex].status);
+      fc_assert(NS_PROCESSED != pf_danger_map_node(pfdm, tindex)->status);
 #endif
 
       /* Change the pf_map iterator and reset data. */
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pfdm->lattice + tindex;
+      node = pf_danger_map_node(pfdm, tindex);
       if (NS_WAITING != node->status) {
         /* Node status step C. and D. */
 #ifdef PF_DEBUG
@@ -1759,7 +2078,7 @@ static inline bool pf_danger_map_iterate_until(struct pf_danger_map *pfdm,
                                                struct tile *ptile)
 {
   struct pf_map *pfm = PF_MAP(pfdm);
-  struct pf_danger_node *node = pfdm->lattice + tile_index(ptile);
+  struct pf_danger_node *node = pf_danger_map_node(pfdm, tile_index(ptile));
 
   /* Start position is handled in every function calling this function. */
 
@@ -1798,7 +2117,7 @@ static int pf_danger_map_move_cost(struct pf_map *pfm, struct tile *ptile)
   if (ptile == pfm->params.start_tile) {
     return 0;
   } else if (pf_danger_map_iterate_until(pfdm, ptile)) {
-    return (pfdm->lattice[tile_index(ptile)].cost
+    return (pf_danger_map_node(pfdm, tile_index(ptile))->cost
             - pf_move_rate(pf_map_parameter(pfm))
             + pf_moves_left_initially(pf_map_parameter(pfm)));
   } else {
@@ -1855,12 +2174,13 @@ static void pf_danger_map_destroy(struct pf_map *pfm)
   int i;
 
   /* Need to clean up the dangling danger segments. */
-  for (i = 0, node = pfdm->lattice; i < MAP_INDEX_SIZE; i++, node++) {
+  for (i = 0; i < pf_lattice_used_num(pfdm->lattice); i++) {
+    node = pf_danger_map_node(pfdm, pf_lattice_used_index(pfdm->lattice, i));
     if (node->danger_segment) {
       free(node->danger_segment);
     }
   }
-  free(pfdm->lattice);
+  pf_lattice_destroy(pfdm->lattice);
   map_index_pq_destroy(pfdm->queue);
   map_index_pq_destroy(pfdm->danger_queue);
   free(pfdm);
@@ -1885,7 +2205,7 @@ static struct pf_map *pf_danger_map_new(const struct pf_parameter *parameter)
 #endif /* PF_DEBUG */
 
   /* Allocate the map. */
-  pfdm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_danger_node));
+  pfdm->lattice = pf_lattice_new(sizeof(struct pf_danger_node));
   pfdm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
   pfdm->danger_queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
 
@@ -1909,7 +2229,7 @@ static struct pf_map *pf_danger_map_new(const struct pf_parameter *parameter)
   base_map->iterate = pf_danger_map_iterate;
 
   /* Initialise starting node. */
-  node = pfdm->lattice + tile_index(params->start_tile);
+  node = pf_danger_map_node(pfdm, tile_index(params->start_tile));
   if (!pf_danger_node_init(pfdm, node, params->start_tile, PF_MS_NONE)) {
     /* Always fails. */
     fc_assert(pf_danger_node_init(pfdm, node, params->start_tile,
@@ -2004,7 +2324,7 @@ struct pf_fuel_map {
                                  * total_CC */
   struct map_index_pq *waited_queue; /* Queue of nodes to reach farer
                                       * positions after having refueled. */
-  struct pf_fuel_node *lattice; /* Lattice of nodes */
+  struct pf_lattice *lattice; /* Lattice of nodes */
 };
 
 /* Up-cast macro. */
@@ -2024,6 +2344,16 @@ pf_fuel_map_check(struct pf_map *pfm, const char *file,
 #define PF_FUEL_MAP(pfm) ((struct pf_fuel_map *) (pfm))
 #endif /* PF_DEBUG */
 
+/************************************************************************//**
+  Returns the node of the map at 'tindex'.
+****************************************************************************/
+static inline struct pf_fuel_node *
+pf_fuel_map_node(const struct pf_fuel_map *pffm, int tindex)
+{
+  return pf_lattice_node(pffm->lattice, tindex,
+                         sizeof(struct pf_fuel_node));
+}
+
 /* =================  Specific pf_fuel_* mode functions ================== */
 
 /************************************************************************//**
@@ -2337,7 +2667,7 @@ static void pf_fuel_map_fill_position(const struct pf_fuel_map *pffm,
                                       struct pf_position *pos)
 {
   int tindex = tile_index(ptile);
-  struct pf_fuel_node *node = pffm->lattice + tindex;
+  struct pf_fuel_node *node = pf_fuel_map_node(pffm, tindex);
   struct pf_fuel_pos *head = node->segment;
   const struct pf_parameter *params = pf_map_parameter(PF_MAP(pffm));
 
@@ -2379,7 +2709,7 @@ pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
 {
   struct pf_path *path = fc_malloc(sizeof(*path));
   enum direction8 dir_next = direction8_invalid();
-  struct pf_fuel_node *node = pffm->lattice + tile_index(ptile);
+  struct pf_fuel_node *node = pf_fuel_map_node(pffm, tile_index(ptile));
   struct pf_fuel_pos *segment = node->segment;
   unsigned length = 1;
   struct tile *iter_tile = ptile;
@@ -2412,7 +2742,7 @@ pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
     /* Step backward. */
     iter_tile = mapstep(params->map, iter_tile,
                         DIR_REVERSE(segment->dir_to_here));
-    node = pffm->lattice + tile_index(iter_tile);
+    node = pf_fuel_map_node(pffm, tile_index(iter_tile));
     segment = segment->prev;
 #ifdef PF_DEBUG
     fc_assert(segment != nullptr);
@@ -2429,7 +2759,7 @@ pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
 
   /* Reset variables for main iteration. */
   iter_tile = ptile;
-  node = pffm->lattice + tile_index(ptile);
+  node = pf_fuel_map_node(pffm, tile_index(ptile));
   segment = node->segment;
 
   for (i = length - 1; i >= 0; i--) {
@@ -2482,7 +2812,7 @@ pf_fuel_map_construct_path(const struct pf_fuel_map *pffm,
 
     /* 5: Step further back. */
     iter_tile = mapstep(params->map, iter_tile, DIR_REVERSE(dir_next));
-    node = pffm->lattice + tile_index(iter_tile);
+    node = pf_fuel_map_node(pffm, tile_index(iter_tile));
     segment = segment->prev;
 #ifdef PF_DEBUG
     fc_assert(segment != nullptr);
@@ -2525,7 +2855,7 @@ static inline void pf_fuel_map_create_segment(struct pf_fuel_map *pffm,
   do {
     next = pos;
     ptile = mapstep(params->map, ptile, DIR_REVERSE(node->dir_to_here));
-    node = pffm->lattice + tile_index(ptile);
+    node = pf_fuel_map_node(pffm, tile_index(ptile));
     pos = node->pos;
     if (pos != nullptr) {
       if (pos->cost == node->cost
@@ -2636,7 +2966,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
   const struct pf_parameter *const params = pf_map_parameter(pfm);
   struct tile *tile = pfm->tile;
   int tindex = tile_index(tile);
-  struct pf_fuel_node *node = pffm->lattice + tindex;
+  struct pf_fuel_node *node = pf_fuel_map_node(pffm, tindex);
   enum pf_move_scope scope = node->move_scope;
   int priority, waited_priority;
   bool waited = FALSE;
@@ -2682,7 +3012,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
         /* Calculate the cost of every adjacent position and set them in
          * the priority queues for next call to pf_fuel_map_iterate(). */
         int tindex1 = tile_index(tile1);
-        struct pf_fuel_node *node1 = pffm->lattice + tindex1;
+        struct pf_fuel_node *node1 = pf_fuel_map_node(pffm, tindex1);
         int cost, extra = 0;
         int moves_left;
         int cost_of_path, old_cost_of_path;
@@ -2924,7 +3254,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
       /* Change the pf_map iterator and reset data. */
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pffm->lattice + tindex;
+      node = pf_fuel_map_node(pffm, tindex);
       waited = TRUE;
 #ifdef PF_DEBUG
       fc_assert(0 < node->moves_left_req);
@@ -2945,7 +3275,7 @@ static bool pf_fuel_map_iterate(struct pf_map *pfm)
       /* Change the pf_map iterator and reset data. */
       tile = index_to_tile(params->map, tindex);
       pfm->tile = tile;
-      node = pffm->lattice + tindex;
+      node = pf_fuel_map_node(pffm, tindex);
 
 #ifdef PF_DEBUG
       fc_assert(NS_PROCESSED != node->status);
@@ -2994,7 +3324,7 @@ static inline bool pf_fuel_map_iterate_until(struct pf_fuel_map *pffm,
                                              struct tile *ptile)
 {
   struct pf_map *pfm = PF_MAP(pffm);
-  struct pf_fuel_node *node = pffm->lattice + tile_index(ptile);
+  struct pf_fuel_node *node = pf_fuel_map_node(pffm, tile_index(ptile));
 
   /* Start position is handled in every function calling this function. */
 
@@ -3032,7 +3362,8 @@ static int pf_fuel_map_move_cost(struct pf_map *pfm, struct tile *ptile)
   if (ptile == pfm->params.start_tile) {
     return 0;
   } else if (pf_fuel_map_iterate_until(pffm, ptile)) {
-    const struct pf_fuel_node *node = pffm->lattice + tile_index(ptile);
+    const struct pf_fuel_node *node
+        = pf_fuel_map_node(pffm, tile_index(ptile));
 
     return (node->segment->cost
             - pf_move_rate(pf_map_parameter(pfm))
@@ -3091,11 +3422,12 @@ static void pf_fuel_map_destroy(struct pf_map *pfm)
   int i;
 
   /* Need to clean up the dangling fuel segments. */
-  for (i = 0, node = pffm->lattice; i < MAP_INDEX_SIZE; i++, node++) {
+  for (i = 0; i < pf_lattice_used_num(pffm->lattice); i++) {
+    node = pf_fuel_map_node(pffm, pf_lattice_used_index(pffm->lattice, i));
     pf_fuel_pos_unref(node->pos);
     pf_fuel_pos_unref(node->segment);
   }
-  free(pffm->lattice);
+  pf_lattice_destroy(pffm->lattice);
   map_index_pq_destroy(pffm->queue);
   map_index_pq_destroy(pffm->waited_queue);
   free(pffm);
@@ -3120,7 +3452,7 @@ static struct pf_map *pf_fuel_map_new(const struct pf_parameter *parameter)
 #endif /* PF_DEBUG */
 
   /* Allocate the map. */
-  pffm->lattice = fc_calloc(MAP_INDEX_SIZE, sizeof(struct pf_fuel_node));
+  pffm->lattice = pf_lattice_new(sizeof(struct pf_fuel_node));
   pffm->queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
   pffm->waited_queue = map_index_pq_new(INITIAL_QUEUE_SIZE);
 
@@ -3144,7 +3476,7 @@ static struct pf_map *pf_fuel_map_new(const struct pf_parameter *parameter)
   base_map->iterate = pf_fuel_map_iterate;
 
   /* Initialise starting node. */
-  node = pffm->lattice + tile_index(params->start_tile);
+  node = pf_fuel_map_node(pffm, tile_index(params->start_tile));
   if (!pf_fuel_node_init(pffm, node, params->start_tile, PF_MS_NONE)) {
     /* Always fails. */
     fc_assert(pf_fuel_node_init(pffm, node, params->start_tile,
@@ -3177,6 +3509,34 @@ static struct pf_map *pf_fuel_map_new(const struct pf_parameter *parameter)
 
 /* ====================== pf_map public functions ======================= */
 
+/************************************************************************//**
+  Initialize the pool of node storage.
+****************************************************************************/
+void pf_pool_init(void)
+{
+  fc_mutex_init(&pf_lattice_pool.mutex);
+  pf_lattice_pool.unused = nullptr;
+  pf_lattice_pool.unused_num = 0;
+}
+
+/************************************************************************//**
+  Free the pool of node storage. All the maps must have been destroyed.
+****************************************************************************/
+void pf_pool_free(void)
+{
+  struct pf_lattice *lattice;
+
+  while ((lattice = pf_lattice_pool.unused) != nullptr) {
+    pf_lattice_pool.unused = lattice->next;
+    free(lattice->nodes);
+    free(lattice->stamps);
+    free(lattice->used);
+    free(lattice);
+  }
+  pf_lattice_pool.unused_num = 0;
+  fc_mutex_destroy(&pf_lattice_pool.mutex);
+}
+
 /************************************************************************//**
   Factory function to create a new map according to the parameter.
   Does not do any iterations.
@@ -3202,6 +3562,70 @@ struct pf_map *pf_map_new(const struct pf_parameter *parameter)
   return pf_normal_map_new(parameter);
 }
 
+/************************************************************************//**
+  Factory function to create a new map, directing the search towards
+  'goal_tile'. See the comment in "path_finding.h". Does not do any
+  iterations.
+****************************************************************************/
+struct pf_map *pf_map_new_goal(const struct pf_parameter *parameter,
+                               struct tile *goal_tile)
+{
+  struct pf_map *pfm = pf_map_new(parameter);
+  struct pf_normal_map *pfnm;
+  int min_MC, min_steps;
+
+  if (pfm == nullptr || goal_tile == nullptr
+      || parameter->get_min_MC == nullptr
+      || parameter->get_costs != nullptr
+      || parameter->is_pos_dangerous != nullptr
+      || parameter->get_moves_left_req != nullptr
+      || parameter->move_rate <= 0) {
+    /* Full search. */
+    return pfm;
+  }
+
+  /* The estimate must not exceed the cost of any step, see
+   * pf_normal_map_iterate(). */
+  min_MC = MIN(parameter->get_min_MC(parameter), parameter->move_rate);
+  if (parameter->get_action != nullptr) {
+    min_MC = MIN(min_MC, SINGLE_MOVE);
+  }
+  if (!parameter->omniscience) {
+    min_MC = MIN(min_MC, parameter->utype->unknown_move_cost);
+  }
+  if (min_MC <= 0) {
+    /* No useful estimate. */
+    return pfm;
+  }
+
+  /* The steps into the tiles where moves may be cheaper cost nothing in
+   * the estimate. The steps after the last of them can't be free, so
+   * charge the distance from the goal to the nearest one. Looking
+   * further than the start tile would only raise the estimate of the
+   * tiles even further away. */
+  min_steps = real_map_distance(parameter->start_tile, goal_tile);
+  if (parameter->below_min_MC != nullptr) {
+    iterate_outward(parameter->map, goal_tile, min_steps, ptile) {
+      if (parameter->below_min_MC(ptile, parameter)) {
+        min_steps = MIN(min_steps, real_map_distance(ptile, goal_tile));
+        break;
+      }
+    } iterate_outward_end;
+  }
+  if (min_steps <= 0) {
+    /* No useful estimate. */
+    return pfm;
+  }
+
+  pfnm = PF_NORMAL_MAP(pfm);
+  pfnm->goal = goal_tile;
+  pfnm->goal_min_MC = min_MC;
+  pfnm->goal_min_steps = min_steps;
+  pfm->iterate = pf_normal_map_goal_iterate;
+
+  return pfm;
+}
+
 /************************************************************************//**
   After usage the map must be destroyed.
 ****************************************************************************/
@@ -3372,6 +3796,45 @@ const struct pf_parameter *pf_map_parameter(const struct pf_map *pfm)
   return &pfm->params;
 }
 
+/************************************************************************//**
+  Returns whether both parameters give the same maps, i.e. all their
+  fields, callbacks and user data included, are the same.
+****************************************************************************/
+bool pf_parameter_equal(const struct pf_parameter *parameter1,
+                        const struct pf_parameter *parameter2)
+{
+  return (parameter1->map == parameter2->map
+          && parameter1->start_tile == parameter2->start_tile
+          && parameter1->moves_left_initially
+             == parameter2->moves_left_initially
+          && parameter1->fuel_left_initially
+             == parameter2->fuel_left_initially
+          && parameter1->transported_by_initially
+             == parameter2->transported_by_initially
+          && parameter1->cargo_depth == parameter2->cargo_depth
+          && BV_ARE_EQUAL(parameter1->cargo_types, parameter2->cargo_types)
+          && parameter1->move_rate == parameter2->move_rate
+          && parameter1->fuel == parameter2->fuel
+          && parameter1->utype == parameter2->utype
+          && parameter1->owner == parameter2->owner
+          && parameter1->omniscience == parameter2->omniscience
+          && parameter1->get_MC == parameter2->get_MC
+          && parameter1->get_min_MC == parameter2->get_min_MC
+          && parameter1->below_min_MC == parameter2->below_min_MC
+          && parameter1->get_move_scope == parameter2->get_move_scope
+          && parameter1->ignore_none_scopes == parameter2->ignore_none_scopes
+          && parameter1->get_TB == parameter2->get_TB
+          && parameter1->get_EC == parameter2->get_EC
+          && parameter1->get_action == parameter2->get_action
+          && parameter1->actions == parameter2->actions
+          && parameter1->is_action_possible == parameter2->is_action_possible
+          && parameter1->get_zoc == parameter2->get_zoc
+          && parameter1->is_pos_dangerous == parameter2->is_pos_dangerous
+          && parameter1->get_moves_left_req == parameter2->get_moves_left_req
+          && parameter1->get_costs == parameter2->get_costs
+          && parameter1->data == parameter2->data);
+}
+
 
 /* ====================== pf_path public functions ======================= */
 
@@ -3745,7 +4208,7 @@ pf_reverse_map_pos(struct pf_reverse_map *pfrm,
   struct pf_map *pfm;
   struct pf_parameter *copy;
   struct tile *target_tile;
-  const struct pf_normal_node *lattice;
+  const struct pf_normal_map *pfnm;
   int max_cost;
 
   /* Check if we already processed something similar. */
@@ -3755,12 +4218,13 @@ pf_reverse_map_pos(struct pf_reverse_map *pfrm,
 
   /* We didn't. Build map and iterate. */
   pfm = pf_normal_map_new(param);
-  lattice = PF_NORMAL_MAP(pfm)->lattice;
+  pfnm = PF_NORMAL_MAP(pfm);
   target_tile = pfrm->target_tile;
   if (pfrm->max_turns >= 0) {
     max_cost = param->move_rate * (pfrm->max_turns + 1);
     do {
-      if (lattice[tile_index(pfm->tile)].cost >= max_cost) {
+      if (pf_normal_map_node(pfnm, tile_index(pfm->tile))->cost
+          >= max_cost) {
         break;
       } else if (pfm->tile == target_tile) {
         /* Found our position. Insert in hash, destroy map, and return. */
@@ -3908,3 +4372,312 @@ bool pf_reverse_map_unit_position(struct pf_reverse_map *pfrm,
     return FALSE;
   }
 }
+
+
+/* ====================== pf_threat_map functions ======================== */
+
+/* The path-finding threat maps are the reverse maps for several target
+ * tiles at once, like all the cities of a player. Instead of iterating
+ * one map for every unit and every target, it iterates one map for every
+ * unit (or every group of units sharing the same start tile and move
+ * rules), and gets the positions of all the targets from it.
+ *
+ * The map is iterated without any target. A target is reached by an
+ * attack from one of its adjacent tiles, as in a reverse map. As the cost
+ * of a path never decreases along it, the cheapest attack from the
+ * adjacent tiles gives the same position as a reverse map for this
+ * target alone would. */
+
+#define SPECHASH_TAG pf_threat
+#define SPECHASH_IKEY_TYPE struct pf_parameter *
+#define SPECHASH_IDATA_TYPE struct pf_position *
+#define SPECHASH_IKEY_VAL pf_pos_hash_val
+#define SPECHASH_IKEY_COMP pf_pos_hash_cmp
+#define SPECHASH_IKEY_FREE pf_reverse_map_destroy_param
+#define SPECHASH_IDATA_FREE pf_reverse_map_destroy_pos
+#include "spechash.h"
+
+/* Tile index to index in the targets. */
+#define SPECHASH_TAG pf_threat_target
+#define SPECHASH_INT_KEY_TYPE
+#define SPECHASH_INT_DATA_TYPE
+#include "spechash.h"
+
+/* Up to this number of targets, they are just looked for in the array
+ * instead of the 'target_index' hash. */
+#define PF_THREAT_TARGETS_LINEAR 8
+
+/* Special costs of the attacks on the targets, lower than any real cost. */
+#define PF_THREAT_AS_TILE (-FC_INFINITY)
+#define PF_THREAT_NEVER (-FC_INFINITY - 1)
+
+/* The threat map structure. */
+struct pf_threat_map {
+  int max_turns;                /* The maximum of turns. */
+  struct pf_parameter template; /* Keep a parameter ready for usage. */
+  struct tile **targets;        /* Where we want to go. */
+  int num_targets;
+  struct pf_threat_target_hash *target_index; /* Index in 'targets' of
+                                 * the targets, nullptr while there are
+                                 * few of them. */
+  struct pf_threat_hash *hash;  /* The positions of all the targets (an
+                                 * array of 'num_targets') for every
+                                 * parameter. */
+};
+
+/************************************************************************//**
+  'pf_threat_map' constructor. Add the targets with
+  pf_threat_map_add_target() before the first query. If 'max_turns' is
+  positive, then it won't try to iterate the maps beyond this number of
+  turns.
+****************************************************************************/
+struct pf_threat_map *pf_threat_map_new(const struct civ_map *nmap,
+                                        const struct player *attacker,
+                                        int max_turns, bool omniscient)
+{
+  struct pf_threat_map *pftm = fc_malloc(sizeof(struct pf_threat_map));
+  struct pf_parameter *param = &pftm->template;
+
+  pftm->max_turns = max_turns;
+  pftm->targets = nullptr;
+  pftm->num_targets = 0;
+  pftm->target_index = nullptr;
+
+  /* Initialize the parameter. No tile is the target of an action, the
+   * attacks on the targets are added by pf_threat_map_pos(). */
+  pft_fill_reverse_parameter(nmap, param, nullptr);
+  param->owner = attacker;
+  param->omniscience = omniscient;
+  param->map = nmap;
+
+  /* Initialize the map hash. */
+  pftm->hash = pf_threat_hash_new();
+
+  return pftm;
+}
+
+/************************************************************************//**
+  Returns the index of 'ptile' in the targets of the threat map, or -1 if
+  it is not a target.
+****************************************************************************/
+static inline int pf_threat_map_target(const struct pf_threat_map *pftm,
+                                       const struct tile *ptile)
+{
+  int i;
+
+  if (pftm->target_index != nullptr) {
+    return (pf_threat_target_hash_lookup(pftm->target_index,
+                                         tile_index(ptile), &i) ? i : -1);
+  }
+
+  for (i = 0; i < pftm->num_targets; i++) {
+    if (pftm->targets[i] == ptile) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+/************************************************************************//**
+  Add 'ptile' to the targets of the threat map.
+****************************************************************************/
+void pf_threat_map_add_target(struct pf_threat_map *pftm, struct tile *ptile)
+{
+  int i;
+
+  fc_assert_ret(pftm != nullptr);
+  /* The positions already calculated would miss the new target. */
+  fc_assert_ret(pf_threat_hash_size(pftm->hash) == 0);
+
+  if (pf_threat_map_target(pftm, ptile) >= 0) {
+    return;
+  }
+
+  pftm->targets = fc_realloc(pftm->targets, (pftm->num_targets + 1)
+                                            * sizeof(*pftm->targets));
+  pftm->targets[pftm->num_targets] = ptile;
+  pftm->num_targets++;
+
+  if (pftm->target_index != nullptr) {
+    pf_threat_target_hash_insert(pftm->target_index, tile_index(ptile),
+                                 pftm->num_targets - 1);
+  } else if (pftm->num_targets > PF_THREAT_TARGETS_LINEAR) {
+    pftm->target_index = pf_threat_target_hash_new();
+    for (i = 0; i < pftm->num_targets; i++) {
+      pf_threat_target_hash_insert(pftm->target_index,
+                                   tile_index(pftm->targets[i]), i);
+    }
+  }
+}
+
+/************************************************************************//**
+  'pf_threat_map' destructor.
+****************************************************************************/
+void pf_threat_map_destroy(struct pf_threat_map *pftm)
+{
+  fc_assert_ret(pftm != nullptr);
+
+  pf_threat_hash_destroy(pftm->hash);
+  if (pftm->target_index != nullptr) {
+    pf_threat_target_hash_destroy(pftm->target_index);
+  }
+  free(pftm->targets);
+  free(pftm);
+}
+
+/************************************************************************//**
+  Returns the positions of all the targets for the parameter. Creates them
+  if needed. The position of an unreachable target has a nullptr tile.
+****************************************************************************/
+static const struct pf_position *
+pf_threat_map_pos(struct pf_threat_map *pftm,
+                  const struct pf_parameter *param)
+{
+  struct pf_position *pos;
+  struct pf_map *pfm;
+  struct pf_parameter *copy;
+  const struct pf_normal_map *pfnm;
+  int max_cost, attack_cost, i;
+  int *attack;
+  int num_open = 0;             /* Targets not reached yet. */
+  int worst_attack = 0;         /* No attack found so far costs more. */
+
+  /* Check if we already processed something similar. */
+  if (pf_threat_hash_lookup(pftm->hash, param, &pos)) {
+    return pos;
+  }
+
+  /* All the positions start with a nullptr tile, i.e. unreachable. */
+  pos = fc_calloc(MAX(pftm->num_targets, 1), sizeof(*pos));
+
+  /* The cost of the best attack on every target found so far. The start
+   * tile and the unknown targets are entered as any other tile, and the
+   * targets we cannot invade are never entered. */
+  attack = fc_malloc(MAX(pftm->num_targets, 1) * sizeof(*attack));
+  for (i = 0; i < pftm->num_targets; i++) {
+    struct tile *ptile = pftm->targets[i];
+
+    if (ptile == param->start_tile
+        || (!param->omniscience
+            && TILE_UNKNOWN == tile_get_known(ptile, param->owner))) {
+      attack[i] = PF_THREAT_AS_TILE;
+      num_open++;
+    } else if (!utype_has_flag(param->utype, UTYF_CIVILIAN)
+               && !player_can_invade_tile(param->owner, ptile)) {
+      attack[i] = PF_THREAT_NEVER;
+    } else {
+      attack[i] = FC_INFINITY;
+      num_open++;
+    }
+  }
+
+  if (utype_action_takes_all_mp(param->utype,
+                                action_by_number(ACTION_ATTACK))
+      || utype_can_do_action(param->utype, ACTION_SUICIDE_ATTACK)) {
+    attack_cost = param->move_rate;
+  } else {
+    attack_cost = SINGLE_MOVE;
+  }
+
+  pfm = pf_normal_map_new(param);
+  pfnm = PF_NORMAL_MAP(pfm);
+  max_cost = (pftm->max_turns >= 0
+              ? param->move_rate * (pftm->max_turns + 1) : FC_INFINITY);
+  do {
+    struct tile *ptile = pfm->tile;
+    const struct pf_normal_node *node =
+      pf_normal_map_node(pfnm, tile_index(ptile));
+    int cost;
+
+    if (node->cost >= max_cost) {
+      break;
+    }
+    if (num_open == 0 && node->cost >= worst_attack) {
+      /* The attacks from here and the next tiles cannot be cheaper
+       * than the ones found already. */
+      break;
+    }
+
+    i = pf_threat_map_target(pftm, ptile);
+    if (i >= 0 && attack[i] == PF_THREAT_AS_TILE) {
+      /* Reached as any other tile. */
+      pf_normal_map_fill_position(pfnm, ptile, pos + i);
+      num_open--;
+    }
+
+    /* Attack the adjacent targets, as pf_normal_map_iterate() would. */
+    if (node->behavior == TB_DONT_LEAVE
+        || node->move_scope == PF_MS_NONE
+        || (param->move_rate <= 0 && node->cost >= 0)) {
+      continue;
+    }
+    cost = node->cost + pf_normal_map_adjust_cost(attack_cost,
+                                                   pf_moves_left(param,
+                                                                 node->cost));
+    if (cost >= max_cost) {
+      continue;
+    }
+
+    adjc_dir_iterate(param->map, ptile, tile1, dir) {
+      i = pf_threat_map_target(pftm, tile1);
+      if (i >= 0 && cost < attack[i]) {
+        if (attack[i] == FC_INFINITY) {
+          num_open--;
+        }
+        attack[i] = cost;
+        worst_attack = MAX(worst_attack, cost);
+        pos[i].tile = tile1;
+        pos[i].total_EC = 0;
+        pos[i].total_MC = (cost - pf_move_rate(param)
+                           + pf_moves_left_initially(param));
+        pos[i].turn = pf_turns(param, cost);
+        pos[i].moves_left = pf_moves_left(param, cost);
+        pos[i].fuel_left = 1;
+        pos[i].dir_to_here = dir;
+        pos[i].dir_to_next_pos = direction8_invalid();
+        if (cost > 0) {
+          pf_finalize_position(param, pos + i);
+        }
+      }
+    } adjc_dir_iterate_end;
+  } while (pfm->iterate(pfm));
+  pf_map_destroy(pfm);
+  free(attack);
+
+  copy = fc_malloc(sizeof(*copy));
+  *copy = *param;
+  pf_threat_hash_insert(pftm->hash, copy, pos);
+
+  return pos;
+}
+
+/************************************************************************//**
+  Fill the position of the unit at 'target', which must have been added
+  to the threat map. Return TRUE if the target is reachable.
+****************************************************************************/
+bool pf_threat_map_unit_position(struct pf_threat_map *pftm,
+                                 const struct unit *punit,
+                                 const struct tile *target,
+                                 struct pf_position *pos)
+{
+  struct pf_parameter *param = &pftm->template;
+  const struct pf_position *mypos;
+  int i = pf_threat_map_target(pftm, target);
+
+  fc_assert_ret_val(i >= 0, FALSE);
+
+  /* Fill parameter, as pf_reverse_map_unit_pos() does. */
+  param->start_tile = unit_tile(punit);
+  param->move_rate = unit_move_rate(punit);
+  param->moves_left_initially = param->move_rate;
+  param->utype = unit_type_get(punit);
+
+  mypos = pf_threat_map_pos(pftm, param) + i;
+  if (mypos->tile != nullptr) {
+    *pos = *mypos;
+    return TRUE;
+  } else {
+    return FALSE;
+  }
+}
@@ -194,6 +194,19 @@ extern "C" {
  *
  * You may call pf_map_path() multiple times with the same pfm.
  *
+ * When only one destination is wanted, pf_map_new_goal(&parameter, ptile)
+ * can be used instead of pf_map_new(). The search is then directed
+ * towards 'ptile' (A* with an admissible estimate of the remaining move
+ * cost) and stops as soon as the best path to it is known, instead of
+ * expanding everything closer to the start tile. The map still answers
+ * queries for other tiles and iterations correctly, but then falls back
+ * to the full search, losing the benefit. The goal is ignored when the
+ * parameter doesn't allow estimating the remaining cost (no get_min_MC
+ * callback or a zero one, jumbo get_costs callback, dangers or fuel).
+ * Every step is taken to cost at least get_min_MC(), except those into
+ * the tiles below_min_MC() reports. Those may be free, so no more steps
+ * are charged than it takes to get from the goal to the nearest of them.
+ *
  * B) the caller doesn't know the map position of the goal yet (but knows
  * what they are looking for, e.g. a port) and wants to iterate over
  * all paths in order of increasing costs (total_CC):
@@ -385,6 +398,20 @@ struct pf_parameter {
                       enum pf_move_scope dst_move_scope,
                       const struct pf_parameter *param);
 
+  /* Callback which returns a lower bound of any non-negative value
+   * get_MC() may return. It is used to estimate the remaining cost in
+   * goal-directed search (see pf_map_new_goal()). Can be nullptr, then
+   * goal-directed search is not possible. Called from any thread that
+   * does path-finding, so it must not look at the map. Moves into the
+   * tiles below_min_MC() accepts may cost less. */
+  int (*get_min_MC) (const struct pf_parameter *param);
+
+  /* Callback which returns whether moves into 'ptile' may cost less than
+   * get_min_MC() returns, e.g. because of roads that make moves free.
+   * Can be nullptr if get_min_MC() bounds every move. */
+  bool (*below_min_MC) (const struct tile *ptile,
+                        const struct pf_parameter *param);
+
   /* Callback which determines if we can move from/to 'ptile'. */
   enum pf_move_scope (*get_move_scope) (const struct tile *ptile,
                                         bool *can_disembark,
@@ -478,12 +505,22 @@ struct pf_map;
 /* The reverse map structure. Opaque type. */
 struct pf_reverse_map;
 
+/* The threat map structure. Opaque type. */
+struct pf_threat_map;
+
 
 /* ========================= Public Interface ============================ */
 
+/* Node storage shared by the maps. */
+void pf_pool_init(void);
+void pf_pool_free(void);
+
 /* Create and free. */
 struct pf_map *pf_map_new(const struct pf_parameter *parameter)
                fc__warn_unused_result;
+struct pf_map *pf_map_new_goal(const struct pf_parameter *parameter,
+                               struct tile *goal_tile)
+               fc__warn_unused_result;
 void pf_map_destroy(struct pf_map *pfm);
 
 /* Method A) functions. */
@@ -504,6 +541,8 @@ void pf_map_iter_position(struct pf_map *pfm, struct pf_position *pos);
 
 /* Other related functions. */
 const struct pf_parameter *pf_map_parameter(const struct pf_map *pfm);
+bool pf_parameter_equal(const struct pf_parameter *parameter1,
+                        const struct pf_parameter *parameter2);
 
 
 /* Paths functions. */
@@ -547,6 +586,20 @@ bool pf_reverse_map_unit_position(struct pf_reverse_map *pfrm,
                                   const struct unit *punit,
                                   struct pf_position *pos);
 
+/* Threat map functions (Costs to go to several target tiles). */
+struct pf_threat_map *pf_threat_map_new(const struct civ_map *nmap,
+                                        const struct player *attacker,
+                                        int max_turns, bool omniscient)
+                      fc__warn_unused_result;
+void pf_threat_map_add_target(struct pf_threat_map *pftm,
+                              struct tile *ptile);
+void pf_threat_map_destroy(struct pf_threat_map *pftm);
+
+bool pf_threat_map_unit_position(struct pf_threat_map *pftm,
+                                 const struct unit *punit,
+                                 const struct tile *target,
+                                 struct pf_position *pos);
+
 
 
 /* This macro iterates all reachable tiles.
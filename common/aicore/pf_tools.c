@@ -27,6 +27,8 @@
 #include "combat.h"
 #include "game.h"
 #include "movement.h"
+#include "road.h"
+#include "terrain.h"
 #include "tile.h"
 #include "unit.h"
 #include "unittype.h"
@@ -445,6 +447,34 @@ static unsigned amphibious_move(const struct tile *ptile,
   return cost;
 }
 
+/************************************************************************//**
+  Lower bound of the move costs returned by normal_move() and
+  overlap_move(), see tile_move_cost_ptrs(), except for the moves into
+  tiles with free roads. See normal_below_min_move().
+****************************************************************************/
+static int normal_min_move(const struct pf_parameter *param)
+{
+  int cost = utype_class(param->utype)->cache.min_move_cost;
+
+  if (utype_has_flag(param->utype, UTYF_IGTER)) {
+    cost = MIN(cost, MOVE_COST_IGTER);
+  }
+
+  /* overlap_move() into non-native tiles. */
+  return MIN(cost, param->move_rate);
+}
+
+/************************************************************************//**
+  Whether moves into 'ptile' may cost less than normal_min_move(), as it
+  has a road that makes them free.
+****************************************************************************/
+static bool normal_below_min_move(const struct tile *ptile,
+                                  const struct pf_parameter *param)
+{
+  return BV_CHECK_MASK(*tile_extras(ptile),
+                       utype_class(param->utype)->cache.free_roads);
+}
+
 /* ===================== Extra Cost Callbacks ======================== */
 
 /************************************************************************//**
@@ -691,11 +721,14 @@ pft_fill_default_parameter(struct pf_parameter *parameter,
   parameter->is_pos_dangerous = nullptr;
   parameter->get_moves_left_req = nullptr;
   parameter->get_costs = nullptr;
+  parameter->get_min_MC = nullptr;
+  parameter->below_min_MC = nullptr;
   parameter->get_zoc = nullptr;
   parameter->get_move_scope = pf_get_move_scope;
   parameter->get_action = nullptr;
   parameter->is_action_possible = nullptr;
   parameter->actions = PF_AA_NONE;
+  parameter->data = nullptr;
 
   parameter->utype = punittype;
 }
@@ -808,6 +841,8 @@ static inline void pft_fill_parameter(struct pf_parameter *parameter,
                                       const struct unit_type *punittype)
 {
   parameter->get_MC = normal_move;
+  parameter->get_min_MC = normal_min_move;
+  parameter->below_min_MC = normal_below_min_move;
   parameter->ignore_none_scopes = TRUE;
   pft_enable_default_actions(parameter);
 
@@ -858,6 +893,8 @@ static void pft_fill_overlap_param(struct pf_parameter *parameter,
                                    const struct unit_type *punittype)
 {
   parameter->get_MC = overlap_move;
+  parameter->get_min_MC = normal_min_move;
+  parameter->below_min_MC = normal_below_min_move;
   parameter->ignore_none_scopes = FALSE;
 
   if (!unit_type_really_ignores_zoc(punittype)) {
@@ -908,6 +945,8 @@ static void pft_fill_attack_param(struct pf_parameter *parameter,
                                   const struct unit_type *punittype)
 {
   parameter->get_MC = normal_move;
+  parameter->get_min_MC = normal_min_move;
+  parameter->below_min_MC = normal_below_min_move;
   parameter->ignore_none_scopes = TRUE;
   pft_enable_default_actions(parameter);
   /* We want known units! */
@@ -1007,6 +1046,8 @@ void pft_fill_amphibious_parameter(struct pft_amphibious *parameter)
   parameter->combined.moves_left_initially *= parameter->sea_scale;
   parameter->combined.move_rate = move_rate;
   parameter->combined.get_MC = amphibious_move;
+  parameter->combined.get_min_MC = nullptr;
+  parameter->combined.below_min_MC = nullptr;
   parameter->combined.get_move_scope = amphibious_move_scope;
   parameter->combined.get_TB = amphibious_behavior;
   parameter->combined.get_EC = amphibious_extra_cost;
@@ -73,9 +73,15 @@ struct tile_cache {
 
 static inline void city_tile_cache_update(const struct civ_map *nmap,
                                           struct city *pcity);
+static inline void city_tile_cache_calc(const struct civ_map *nmap,
+                                        const struct city *pcity,
+                                        int radius_sq,
+                                        struct tile_cache *cache);
 static inline int city_tile_cache_get_output(const struct city *pcity,
                                              int city_tile_index,
                                              enum output_type_id o);
+static void city_refresh_outputs(const struct civ_map *nmap,
+                                 struct city *pcity, bool *workers_map);
 
 static const struct city *nearest_gov_center(const struct city *pcity,
                                              int *min_dist)
@@ -2415,6 +2421,23 @@ void add_specialist_output(const struct city *pcity, int *output)
   } specialist_type_iterate_end;
 }
 
+/**********************************************************************//**
+  Calculate the values of the bonus[] and abs_bonus[] arrays of the city
+  without touching the city itself.
+**************************************************************************/
+static inline void city_bonuses_calc(const struct city *pcity,
+                                     int *bonus, int *abs_bonus)
+{
+  output_type_iterate(o) {
+    bonus[o] = get_final_city_output_bonus(pcity, o);
+    abs_bonus[o] = get_city_output_bonus(pcity, &output_types[o],
+                                         EFT_OUTPUT_BONUS_ABSOLUTE);
+    /* Total bonus cannot be negative, as that could lead to unresolvable
+     * negative balance. */
+    abs_bonus[o] = MIN(abs_bonus[o], 0);
+  } output_type_iterate_end;
+}
+
 /**********************************************************************//**
   This function sets all the values in the pcity->bonus[] and
   pcity->abs_bonus[] arrays.
@@ -2426,15 +2449,7 @@ void add_specialist_output(const struct city *pcity, int *output)
 **************************************************************************/
 static inline void set_city_bonuses(struct city *pcity)
 {
-  output_type_iterate(o) {
-    pcity->bonus[o] = get_final_city_output_bonus(pcity, o);
-    pcity->abs_bonus[o] = get_city_output_bonus(pcity,
-                                                &output_types[o],
-                                                EFT_OUTPUT_BONUS_ABSOLUTE);
-    /* Total bonus cannot be negative, as that could lead to unresolvable
-     * negative balance. */
-    pcity->abs_bonus[o] = MIN(pcity->abs_bonus[o], 0);
-  } output_type_iterate_end;
+  city_bonuses_calc(pcity, pcity->bonus, pcity->abs_bonus);
 }
 
 /**********************************************************************//**
@@ -2450,7 +2465,6 @@ static inline void set_city_bonuses(struct city *pcity)
 static inline void city_tile_cache_update(const struct civ_map *nmap,
                                           struct city *pcity)
 {
-  bool is_celebrating = base_city_celebrating(pcity);
   int radius_sq = city_map_radius_sq_get(pcity);
 
   /* Initialize tile_cache if needed */
@@ -2462,11 +2476,26 @@ static inline void city_tile_cache_update(const struct civ_map *nmap,
     pcity->tile_cache_radius_sq = radius_sq;
   }
 
+  city_tile_cache_calc(nmap, pcity, radius_sq, pcity->tile_cache);
+}
+
+/**********************************************************************//**
+  Fill 'cache', which must have room for city_map_tiles(radius_sq)
+  entries, with the tile outputs of the city as if its squared radius
+  was 'radius_sq'. The city itself is not modified.
+**************************************************************************/
+static inline void city_tile_cache_calc(const struct civ_map *nmap,
+                                        const struct city *pcity,
+                                        int radius_sq,
+                                        struct tile_cache *cache)
+{
+  bool is_celebrating = base_city_celebrating(pcity);
+
   /* Any unreal tiles are skipped - these values should have been memset
    * to 0 when the city was created. */
   city_tile_iterate_index(nmap, radius_sq, pcity->tile, ptile, city_tile_index) {
     output_type_iterate(o) {
-      (pcity->tile_cache[city_tile_index]).output[o]
+      (cache[city_tile_index]).output[o]
         = city_tile_output(pcity, ptile, is_celebrating, o);
     } output_type_iterate_end;
   } city_tile_iterate_index_end;
@@ -3254,6 +3283,117 @@ void city_refresh_from_main_map(const struct civ_map *nmap,
     city_support(nmap, pcity);
   }
 
+  city_refresh_outputs(nmap, pcity, workers_map);
+}
+
+/**********************************************************************//**
+  Initialize a city_precalc structure.
+**************************************************************************/
+void city_precalc_init(struct city_precalc *pre)
+{
+  pre->radius_sq = -1;
+  pre->tile_cache = nullptr;
+  pre->tile_cache_radius_sq = -1;
+}
+
+/**********************************************************************//**
+  Free the data held by a city_precalc structure.
+**************************************************************************/
+void city_precalc_free(struct city_precalc *pre)
+{
+  FC_FREE(pre->tile_cache);
+  pre->tile_cache_radius_sq = -1;
+  pre->radius_sq = -1;
+}
+
+/**********************************************************************//**
+  Calculate the effect dependent part of a full city refresh, the bonus[]
+  and tile_cache[] values, for the city having squared radius 'radius_sq'.
+
+  This only reads game state, so several cities can be handled at
+  the same time from different threads as long as nothing modifies
+  the game meanwhile. The result is valid for as long as the state it was
+  calculated from stays unchanged; see city_refresh_from_precalc().
+**************************************************************************/
+void city_precalc_calc(const struct civ_map *nmap,
+                       const struct city *pcity, int radius_sq,
+                       struct city_precalc *pre)
+{
+  if (pre->tile_cache == nullptr
+      || pre->tile_cache_radius_sq != radius_sq) {
+    pre->tile_cache = fc_realloc(pre->tile_cache,
+                                 city_map_tiles(radius_sq)
+                                 * sizeof(*(pre->tile_cache)));
+    memset(pre->tile_cache, 0,
+           city_map_tiles(radius_sq) * sizeof(*(pre->tile_cache)));
+    pre->tile_cache_radius_sq = radius_sq;
+  }
+
+  pre->radius_sq = radius_sq;
+  city_bonuses_calc(pcity, pre->bonus, pre->abs_bonus);
+  city_tile_cache_calc(nmap, pcity, radius_sq, pre->tile_cache);
+}
+
+/**********************************************************************//**
+  Full refresh of the city like city_refresh_from_main_map() does, but
+  taking the effect dependent values from 'pre' instead of evaluating
+  the effects again. The caller is responsible for making sure that
+  nothing 'pre' was calculated from has changed since.
+**************************************************************************/
+void city_refresh_from_precalc(const struct civ_map *nmap,
+                               struct city *pcity,
+                               const struct city_precalc *pre)
+{
+  int radius_sq = city_map_radius_sq_get(pcity);
+  int tiles = city_map_tiles(radius_sq);
+
+  fc_assert_action(pre->radius_sq == radius_sq,
+                   city_refresh_from_main_map(nmap, pcity, nullptr); return);
+
+  output_type_iterate(o) {
+    pcity->bonus[o] = pre->bonus[o];
+    pcity->abs_bonus[o] = pre->abs_bonus[o];
+  } output_type_iterate_end;
+
+  if (pcity->tile_cache == nullptr || pcity->tile_cache_radius_sq == -1
+      || pcity->tile_cache_radius_sq != radius_sq) {
+    pcity->tile_cache = fc_realloc(pcity->tile_cache,
+                                   tiles * sizeof(*(pcity->tile_cache)));
+    pcity->tile_cache_radius_sq = radius_sq;
+  }
+  memcpy(pcity->tile_cache, pre->tile_cache,
+         tiles * sizeof(*(pcity->tile_cache)));
+
+#ifdef FREECIV_DEBUG
+  {
+    /* The result must be exactly what evaluating the effects now gives */
+    struct tile_cache check[tiles];
+    int bonus[O_LAST], abs_bonus[O_LAST];
+
+    city_bonuses_calc(pcity, bonus, abs_bonus);
+    memcpy(check, pre->tile_cache, sizeof(check));
+    city_tile_cache_calc(nmap, pcity, radius_sq, check);
+
+    output_type_iterate(o) {
+      fc_assert(bonus[o] == pre->bonus[o]);
+      fc_assert(abs_bonus[o] == pre->abs_bonus[o]);
+    } output_type_iterate_end;
+    fc_assert(memcmp(check, pre->tile_cache, sizeof(check)) == 0);
+  }
+#endif /* FREECIV_DEBUG */
+
+  city_support(nmap, pcity);
+
+  city_refresh_outputs(nmap, pcity, nullptr);
+}
+
+/**********************************************************************//**
+  The part of the city refresh that depends on worker placement.
+  bonus[] and tile_cache[] must be up to date.
+**************************************************************************/
+static void city_refresh_outputs(const struct civ_map *nmap,
+                                 struct city *pcity, bool *workers_map)
+{
   /* Calculate output from citizens (uses city_tile_cache_get_output()). */
   get_worked_tile_output(nmap, pcity, pcity->citizen_base, workers_map);
   add_specialist_output(pcity, pcity->citizen_base);
@@ -3440,6 +3580,7 @@ void city_add_improvement(struct city *pcity,
                           const struct impr_type *pimprove)
 {
   pcity->built[improvement_index(pimprove)].turn = game.info.turn; /*I_ACTIVE*/
+  bonus_cache_invalidate();
 
   if (is_server() && is_wonder(pimprove)) {
     /* Client just read the info from the packets. */
@@ -3457,6 +3598,7 @@ void city_remove_improvement(struct city *pcity,
             improvement_rule_name(pimprove), pcity->name);
 
   pcity->built[improvement_index(pimprove)].turn = I_DESTROYED;
+  bonus_cache_invalidate();
 
   if (is_server() && is_wonder(pimprove)) {
     /* Client just read the info from the packets. */
@@ -3625,6 +3767,7 @@ void destroy_city_virtual(struct city *pcity)
   if (pcity->cm_parameter) {
     free(pcity->cm_parameter);
   }
+  cm_clear_cache(pcity);
 
   if (pcity->counter_values) {
     free(pcity->counter_values);
@@ -311,6 +311,7 @@ struct tile_cache; /* defined and only used within city.c */
 struct adv_city; /* defined in ./server/advisors/infracache.h */
 
 struct cm_parameter; /* defined in ./common/aicore/cm.h */
+struct cm_cache;     /* defined in ./common/aicore/cm.c */
 
 #ifdef FREECIV_WEB
 #pragma pack(push, 1)
@@ -422,6 +423,9 @@ struct city {
 
   struct cm_parameter *cm_parameter;
 
+  /* Governor solutions to start later queries from */
+  struct cm_cache *cm_cache;
+
   union {
     struct {
       /* Only used in the server (./ai/ and ./server/). */
@@ -798,6 +802,28 @@ void city_remove_improvement(struct city *pcity,
 void city_refresh_from_main_map(const struct civ_map *nmap,
                                 struct city *pcity, bool *workers_map);
 
+/* The effect dependent part of a full city refresh, calculated in
+ * advance. See city_precalc_calc(). */
+struct city_precalc {
+  int radius_sq;
+  int bonus[O_LAST];
+  int abs_bonus[O_LAST];
+
+  struct tile_cache *tile_cache;
+  /* The memory allocated for tile_cache is valid for this squared
+   * city radius. */
+  int tile_cache_radius_sq;
+};
+
+void city_precalc_init(struct city_precalc *pre);
+void city_precalc_free(struct city_precalc *pre);
+void city_precalc_calc(const struct civ_map *nmap,
+                       const struct city *pcity, int radius_sq,
+                       struct city_precalc *pre);
+void city_refresh_from_precalc(const struct civ_map *nmap,
+                               struct city *pcity,
+                               const struct city_precalc *pre);
+
 int city_waste(const struct city *pcity, Output_type_id otype, int total,
                int *breakdown);
 Specialist_type_id best_specialist(Output_type_id otype,
@@ -20,6 +20,7 @@
 /* utility */
 #include "astring.h"
 #include "fcintl.h"
+#include "fcthread.h"
 #include "log.h"
 #include "mem.h"
 #include "support.h"
@@ -38,6 +39,8 @@
 
 #include "effects.h"
 
+/* Number of entries in the bonus cache. Must be a power of two. */
+#define BONUS_CACHE_SIZE 8192
 
 static bool initialized = FALSE;
 
@@ -136,6 +139,76 @@ static struct {
   } reqs;
 } ruleset_cache;
 
+/**************************************************************************
+  Bonus cache. Remembers the results of get_target_bonus_effects() calls
+  whose requirements depend only on the objects in the req_context, and
+  on game state whose changes bump game.effects_epoch or call
+  bonus_cache_invalidate(). Server only, as the client updates its copy
+  of the game state without going through those. Only the main thread,
+  the one that initialized the ruleset cache, uses it. The other ones,
+  like the tex AI thread and the workers of parallel loops, always
+  evaluate the requirements.
+**************************************************************************/
+struct bonus_cache_entry {
+  unsigned int epoch;
+  unsigned int generation;
+  enum effect_type type;
+  const struct player *player;
+  const struct city *city;
+  const struct tile *tile;
+  const struct output_type *output;
+  const struct specialist *specialist;
+  const struct player *other_player;
+  const struct government *government;
+  int ai_level;
+  int city_size;
+  int city_radius_sq;
+  int value;
+};
+
+static struct {
+  /* The only thread using the cache */
+  fc_thread_id owner;
+
+  /* Entries are valid only when both their stamps match the current
+   * ones, so dropping all of them is just a matter of bumping the
+   * generation. It never goes back to zero, the value of unused entries. */
+  unsigned int generation;
+  struct bonus_cache_entry entries[BONUS_CACHE_SIZE];
+
+  /* Whether the requirements of all the effects of the type are such
+   * that their values can be cached. Only valid when 'types_checked' */
+  bool types_checked;
+  bool cacheable[EFT_COUNT];
+} bonus_cache = { .generation = 1 };
+
+/**************************************************************************
+  Effect index. The effects of each type are grouped by a requirement
+  they share, so that a single evaluation of that requirement rules out
+  the whole group. Built by effect_index_build() in the main thread once
+  the effects are all there, and only read after that, so that any
+  thread can use it. Changing the effects drops it.
+**************************************************************************/
+struct effect_group {
+  /* Requirement all the effects of the group have */
+  struct requirement req;
+  struct effect_list *effects;
+};
+
+struct effect_type_index {
+  /* Effects that share no requirement with other effects of the type */
+  struct effect_list *ungrouped;
+  int num_groups;
+  struct effect_group *groups;
+};
+
+static struct {
+  bool built;
+  struct effect_type_index types[EFT_COUNT];
+} effect_index;
+
+static void effects_changed(void);
+
 
 /**********************************************************************//**
   Get a list of effects of this type.
@@ -199,6 +272,7 @@ struct effect *effect_new(enum effect_type type, int value,
   /* Now add the effect to the ruleset cache. */
   effect_list_append(ruleset_cache.tracker, peffect);
   effect_list_append(get_effects(type), peffect);
+  effects_changed();
 
   /* Only relevant for ruledit and other rulesave users. */
   peffect->rulesave.do_not_save = FALSE;
@@ -231,6 +305,7 @@ void effect_remove(struct effect *peffect)
 {
   effect_list_remove(ruleset_cache.tracker, peffect);
   effect_list_remove(get_effects(peffect->type), peffect);
+  effects_changed();
 }
 
 /**********************************************************************//**
@@ -268,6 +343,7 @@ void effect_req_append(struct effect *peffect, struct requirement req)
   struct effect_list *eff_list = get_req_source_effects(&req.source);
 
   requirement_vector_append(&peffect->reqs, req);
+  effects_changed();
 
   if (eff_list != nullptr) {
     effect_list_append(eff_list, peffect);
@@ -320,6 +396,10 @@ void ruleset_cache_init(void)
   for (i = EFT_USER_EFFECT_1 ; i <= EFT_USER_EFFECT_LAST; i++) {
     ueffects[USER_EFFECT_NUMBER(i)].ai_value_as = i;
   }
+
+  effects_changed();
+  bonus_cache.owner = fc_thread_self();
+  bonus_cache_invalidate();
 }
 
 /**********************************************************************//**
@@ -375,9 +455,379 @@ void ruleset_cache_free(void)
     }
   }
 
+  effects_changed();
+  bonus_cache_invalidate();
+
   initialized = FALSE;
 }
 
+/**********************************************************************//**
+  Free the effect index.
+**************************************************************************/
+static void effect_index_free(void)
+{
+  int i, j;
+
+  if (!effect_index.built) {
+    return;
+  }
+
+  for (i = 0; i < EFT_COUNT; i++) {
+    struct effect_type_index *pindex = &effect_index.types[i];
+
+    effect_list_destroy(pindex->ungrouped);
+    for (j = 0; j < pindex->num_groups; j++) {
+      effect_list_destroy(pindex->groups[j].effects);
+    }
+    free(pindex->groups);
+    pindex->ungrouped = nullptr;
+    pindex->groups = nullptr;
+    pindex->num_groups = 0;
+  }
+
+  effect_index.built = FALSE;
+}
+
+/**********************************************************************//**
+  Build the effect index of one effect type. Each effect joins the group
+  of its present requirement that the most effects of the type have,
+  if there are at least two of them.
+**************************************************************************/
+static void effect_index_build_type(enum effect_type effect_type,
+                                    struct effect_type_index *pindex)
+{
+  struct effect_list *plist = get_effects(effect_type);
+  int max_groups = 0;
+
+  pindex->ungrouped = effect_list_new();
+  pindex->num_groups = 0;
+  pindex->groups = nullptr;
+
+  effect_list_iterate(plist, peffect) {
+    max_groups += requirement_vector_size(&peffect->reqs);
+  } effect_list_iterate_end;
+  if (max_groups > 0) {
+    pindex->groups = fc_malloc(max_groups * sizeof(*pindex->groups));
+  }
+
+  effect_list_iterate(plist, peffect) {
+    const struct requirement *best = nullptr;
+    int best_count = 1;
+    int i;
+
+    requirement_vector_iterate(&peffect->reqs, preq) {
+      int count = 0;
+
+      if (!preq->present) {
+        /* Usually true, so rules out little */
+        continue;
+      }
+
+      effect_list_iterate(plist, pother) {
+        requirement_vector_iterate(&pother->reqs, pother_req) {
+          if (are_requirements_equal(preq, pother_req)) {
+            count++;
+            break;
+          }
+        } requirement_vector_iterate_end;
+      } effect_list_iterate_end;
+
+      if (count > best_count) {
+        best = preq;
+        best_count = count;
+      }
+    } requirement_vector_iterate_end;
+
+    if (best == nullptr) {
+      effect_list_append(pindex->ungrouped, peffect);
+      continue;
+    }
+
+    for (i = 0; i < pindex->num_groups; i++) {
+      if (are_requirements_equal(best, &pindex->groups[i].req)) {
+        break;
+      }
+    }
+    if (i == pindex->num_groups) {
+      pindex->groups[i].req = *best;
+      pindex->groups[i].effects = effect_list_new();
+      pindex->num_groups++;
+    }
+    effect_list_append(pindex->groups[i].effects, peffect);
+  } effect_list_iterate_end;
+}
+
+/**********************************************************************//**
+  Build the effect index. To be called in the main thread when the
+  effects of the ruleset are all there, and before any other thread
+  starts looking up effects.
+**************************************************************************/
+void effect_index_build(void)
+{
+  int i;
+
+  effect_index_free();
+
+  for (i = 0; i < EFT_COUNT; i++) {
+    effect_index_build_type(i, &effect_index.types[i]);
+  }
+  effect_index.built = TRUE;
+}
+
+/**********************************************************************//**
+  Returns the effect index of the effect type, or nullptr if it has not
+  been built since the effects last changed.
+**************************************************************************/
+static const struct effect_type_index *
+effect_index_get(enum effect_type effect_type)
+{
+  if (!effect_index.built) {
+    return nullptr;
+  }
+
+  return &effect_index.types[effect_type];
+}
+
+/**********************************************************************//**
+  Called when effects or their requirements change, to make the
+  structures derived from them be rebuilt.
+**************************************************************************/
+static void effects_changed(void)
+{
+  bonus_cache.types_checked = FALSE;
+  effect_index_free();
+}
+
+/**********************************************************************//**
+  Drop all the values in the bonus cache. To be called when something
+  the cached values may depend on changes without bumping
+  game.effects_epoch, like the buildings of a city or the extras of
+  a tile.
+**************************************************************************/
+void bonus_cache_invalidate(void)
+{
+  bonus_cache.generation++;
+  if (bonus_cache.generation == 0) {
+    /* Wrapped around. Make sure that no old entry becomes valid again. */
+    memset(bonus_cache.entries, 0, sizeof(bonus_cache.entries));
+    bonus_cache.generation = 1;
+  }
+}
+
+/**********************************************************************//**
+  Returns whether the value of a requirement is known to change only when
+  the bonus cache gets invalidated, or when something in its key changes.
+  'obsoletion' tells that the requirement is one of the obsolete_by ones
+  of a building.
+**************************************************************************/
+static bool bonus_cache_req_ok(const struct requirement *preq,
+                               bool obsoletion)
+{
+  if (preq->range == REQ_RANGE_TRADE_ROUTE) {
+    /* Depends on the partner cities too */
+    return FALSE;
+  }
+
+  switch (preq->source.kind) {
+  case VUT_NONE:
+  case VUT_ADVANCE:
+  case VUT_TECHFLAG:
+  case VUT_MINTECHS:
+  case VUT_FUTURETECHS:
+  case VUT_GOVERNMENT:
+  case VUT_GOVFLAG:
+  case VUT_EXTRA:
+  case VUT_EXTRAFLAG:
+  case VUT_ROADFLAG:
+  case VUT_TERRAIN:
+  case VUT_TERRAINCLASS:
+  case VUT_TERRFLAG:
+  case VUT_TERRAINALTER:
+  case VUT_OTYPE:
+  case VUT_SPECIALIST:
+  case VUT_MINSIZE:
+  case VUT_NATION:
+  case VUT_NATIONGROUP:
+  case VUT_MINLATITUDE:
+  case VUT_MAXLATITUDE:
+  case VUT_TOPO:
+  case VUT_WRAP:
+  case VUT_MINCITIES:
+    return TRUE;
+  case VUT_CITYTILE:
+    /* Claimed and worked tiles change all the time */
+    return preq->source.value.citytile == CITYT_CENTER;
+  case VUT_AI_LEVEL:
+    return preq->range == REQ_RANGE_PLAYER;
+  case VUT_IMPROVEMENT:
+  case VUT_IMPR_GENUS:
+  case VUT_IMPR_FLAG:
+    if (obsoletion) {
+      /* The obsolete_by requirements of this building get checked
+       * anyway, with the ones of all the other buildings. */
+      return TRUE;
+    }
+    /* Whether a building is active depends on its obsoletion too */
+    improvement_iterate(pimprove) {
+      requirement_vector_iterate(&pimprove->obsolete_by, pobs) {
+        if (!bonus_cache_req_ok(pobs, TRUE)) {
+          return FALSE;
+        }
+      } requirement_vector_iterate_end;
+    } improvement_iterate_end;
+    return TRUE;
+  default:
+    break;
+  }
+
+  return FALSE;
+}
+
+/**********************************************************************//**
+  Returns whether the values of the effect type can be cached.
+**************************************************************************/
+static bool bonus_cache_type_ok(enum effect_type effect_type)
+{
+  if (!bonus_cache.types_checked) {
+    int i;
+
+    for (i = 0; i < EFT_COUNT; i++) {
+      bool ok = TRUE;
+
+      effect_list_iterate(get_effects(i), peffect) {
+        if (peffect->multiplier != nullptr) {
+          /* Player can change the multiplier at any time */
+          ok = FALSE;
+        } else {
+          requirement_vector_iterate(&peffect->reqs, preq) {
+            if (!bonus_cache_req_ok(preq, FALSE)) {
+              ok = FALSE;
+              break;
+            }
+          } requirement_vector_iterate_end;
+        }
+        if (!ok) {
+          break;
+        }
+      } effect_list_iterate_end;
+
+      bonus_cache.cacheable[i] = ok;
+    }
+
+    bonus_cache.types_checked = TRUE;
+  }
+
+  return bonus_cache.cacheable[effect_type];
+}
+
+/**********************************************************************//**
+  Returns whether the context refers only to objects the bonus cache
+  can use as its key.
+**************************************************************************/
+static bool bonus_cache_context_ok(const struct req_context *context)
+{
+  return (context->unit == nullptr
+          && context->unittype == nullptr
+          && context->building == nullptr
+          && context->extra == nullptr
+          && context->action == nullptr
+          && context->activity == ACTIVITY_IDLE
+          /* Virtual cities and tiles can be reused for something else
+           * at the same address. */
+          && (context->city == nullptr
+              || context->city->id != IDENTITY_NUMBER_ZERO)
+          && (context->tile == nullptr
+              || context->tile == index_to_tile(&(wld.map),
+                                                tile_index(context->tile))));
+}
+
+/**********************************************************************//**
+  Returns the bonus cache entry for the key built from the arguments,
+  or nullptr if the lookup can't use the cache. The entry is filled
+  with the key, and its value is valid only if *hit is set.
+**************************************************************************/
+static struct bonus_cache_entry *
+bonus_cache_lookup(const struct req_context *context,
+                   const struct req_context *other_context,
+                   enum effect_type effect_type, bool *hit)
+{
+  struct bonus_cache_entry key, *entry;
+  uintptr_t hash;
+
+  if (!is_server()
+      || !fc_threads_equal(fc_thread_self(), bonus_cache.owner)
+      || !bonus_cache_context_ok(context)
+      || (other_context != nullptr
+          && (other_context->city != nullptr
+              || other_context->tile != nullptr
+              || other_context->output != nullptr
+              || other_context->specialist != nullptr
+              || !bonus_cache_context_ok(other_context)))
+      || !bonus_cache_type_ok(effect_type)) {
+    return nullptr;
+  }
+
+  key.epoch = game.effects_epoch;
+  key.generation = bonus_cache.generation;
+  key.type = effect_type;
+  key.player = context->player;
+  key.city = context->city;
+  key.tile = context->tile;
+  key.output = context->output;
+  key.specialist = context->specialist;
+  key.other_player = other_context != nullptr ? other_context->player
+                                              : nullptr;
+  if (context->player != nullptr) {
+    /* Not all government changes bump game.effects_epoch */
+    key.government = context->player->government;
+    key.ai_level = is_ai(context->player)
+      ? context->player->ai_common.skill_level : -1;
+  } else {
+    key.government = nullptr;
+    key.ai_level = -1;
+  }
+  if (context->city != nullptr) {
+    key.city_size = city_size_get(context->city);
+    key.city_radius_sq = city_map_radius_sq_get(context->city);
+  } else {
+    key.city_size = 0;
+    key.city_radius_sq = 0;
+  }
+  key.value = 0;
+
+  hash = (uintptr_t) key.type;
+  hash = hash * 31 + (uintptr_t) key.player;
+  hash = hash * 31 + (uintptr_t) key.city;
+  hash = hash * 31 + (uintptr_t) key.tile;
+  hash = hash * 31 + (uintptr_t) key.output;
+  hash = hash * 31 + (uintptr_t) key.specialist;
+  hash = hash * 31 + (uintptr_t) key.other_player;
+  hash ^= hash >> 16;
+  hash *= 0x45d9f3b;
+  hash ^= hash >> 16;
+
+  entry = &bonus_cache.entries[hash & (BONUS_CACHE_SIZE - 1)];
+  *hit = (entry->epoch == key.epoch
+          && entry->generation == key.generation
+          && entry->type == key.type
+          && entry->player == key.player
+          && entry->city == key.city
+          && entry->tile == key.tile
+          && entry->output == key.output
+          && entry->specialist == key.specialist
+          && entry->other_player == key.other_player
+          && entry->government == key.government
+          && entry->ai_level == key.ai_level
+          && entry->city_size == key.city_size
+          && entry->city_radius_sq == key.city_radius_sq);
+  if (!*hit) {
+    *entry = key;
+  }
+
+  return entry;
+}
+
+
 /**********************************************************************//**
   Get the maximum effect value in this ruleset for the universal
   (that is, the sum of all positive effects clauses that apply specifically
@@ -727,6 +1177,63 @@ bool is_building_replaced(const struct city *pcity,
   return TRUE;
 }
 
+/**********************************************************************//**
+  Returns the value an active effect adds to the bonus of the target.
+**************************************************************************/
+static int effect_target_value(const struct effect *peffect,
+                               const struct req_context *context)
+{
+  /* If there's multiplier for effect and target_player aren't null,
+   * then value is multiplied by player's multiplier factor. */
+  if (peffect->multiplier) {
+    if (context->player) {
+      return (peffect->value
+              * player_multiplier_effect_value(context->player,
+                                               peffect->multiplier)) / 100;
+    }
+
+    return 0;
+  }
+
+  return peffect->value;
+}
+
+/**********************************************************************//**
+  Returns the sum of the values of the active effects in the index.
+**************************************************************************/
+static int effect_index_bonus(const struct effect_type_index *pindex,
+                              const struct req_context *context,
+                              const struct req_context *other_context)
+{
+  int bonus = 0;
+  int i;
+
+  effect_list_iterate(pindex->ungrouped, peffect) {
+    if (are_reqs_active(context, other_context,
+                        &peffect->reqs, RPT_CERTAIN)) {
+      bonus += effect_target_value(peffect, context);
+    }
+  } effect_list_iterate_end;
+
+  for (i = 0; i < pindex->num_groups; i++) {
+    const struct effect_group *pgroup = &pindex->groups[i];
+
+    if (!is_req_active(context, other_context, &pgroup->req,
+                       RPT_CERTAIN)) {
+      continue;
+    }
+
+    effect_list_iterate(pgroup->effects, peffect) {
+      if (are_reqs_active(context, other_context,
+                          &peffect->reqs, RPT_CERTAIN)) {
+        bonus += effect_target_value(peffect, context);
+      }
+    } effect_list_iterate_end;
+  }
+
+  return bonus;
+}
+
 /**********************************************************************//**
   Returns the effect bonus of a given type for any target.
 
@@ -747,34 +1254,45 @@ int get_target_bonus_effects(struct effect_list *plist,
                              enum effect_type effect_type)
 {
   int bonus = 0;
+  struct bonus_cache_entry *cached = nullptr;
+  const struct effect_type_index *pindex;
 
   if (context == nullptr) {
     context = req_context_empty();
   }
 
-  /* Loop over all effects of this type. */
-  effect_list_iterate(get_effects(effect_type), peffect) {
-    /* For each effect, see if it is active. */
-    if (are_reqs_active(context, other_context,
-                        &peffect->reqs, RPT_CERTAIN)) {
-      /* This code will add value of effect. If there's multiplier for
-       * effect and target_player aren't null, then value is multiplied
-       * by player's multiplier factor. */
-      if (peffect->multiplier) {
-        if (context->player) {
-          bonus += (peffect->value
-            * player_multiplier_effect_value(context->player,
-                                             peffect->multiplier)) / 100;
+  if (plist == nullptr) {
+    bool hit;
+
+    cached = bonus_cache_lookup(context, other_context, effect_type, &hit);
+    if (cached != nullptr && hit) {
+      return cached->value;
+    }
+  }
+
+  if (plist == nullptr
+      && (pindex = effect_index_get(effect_type)) != nullptr) {
+    /* Active effects need not be listed in order, so only the groups
+     * that can apply need to be looked at. */
+    bonus = effect_index_bonus(pindex, context, other_context);
+  } else {
+    /* Loop over all effects of this type. */
+    effect_list_iterate(get_effects(effect_type), peffect) {
+      /* For each effect, see if it is active. */
+      if (are_reqs_active(context, other_context,
+                          &peffect->reqs, RPT_CERTAIN)) {
+        bonus += effect_target_value(peffect, context);
+
+        if (plist) {
+          effect_list_append(plist, peffect);
         }
-      } else {
-        bonus += peffect->value;
       }
+    } effect_list_iterate_end;
+  }
 
-      if (plist) {
-        effect_list_append(plist, peffect);
-      }
-    }
-  } effect_list_iterate_end;
+  if (cached != nullptr) {
+    cached->value = bonus;
+  }
 
   return bonus;
 }
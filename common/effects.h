@@ -99,6 +99,8 @@ struct packet_ruleset_effect;
 
 void ruleset_cache_init(void);
 void ruleset_cache_free(void);
+void bonus_cache_invalidate(void);
+void effect_index_build(void);
 void recv_ruleset_effect(const struct packet_ruleset_effect *packet);
 void send_ruleset_cache(struct conn_list *dest);
 
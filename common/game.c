@@ -25,6 +25,7 @@
 
 /* aicore */
 #include "cm.h"
+#include "path_finding.h"
 
 /* common */
 #include "ai.h"
@@ -405,6 +406,7 @@ static void game_defaults(bool keep_ruleset_value)
     }
     game.server.save_compress_level = GAME_DEFAULT_COMPRESS_LEVEL;
     game.server.save_compress_type = GAME_DEFAULT_COMPRESS_TYPE;
+    game.server.save_compress_threads = GAME_DEFAULT_COMPRESS_THREADS;
     sz_strlcpy(game.server.save_name, GAME_DEFAULT_SAVE_NAME);
     game.server.save_nturns       = GAME_DEFAULT_SAVETURNS;
     game.server.save_options.save_known = TRUE;
@@ -452,6 +454,7 @@ void game_init(bool keep_ruleset_value)
   game_ruleset_init();
   idex_init(&wld);
   cm_init();
+  pf_pool_init();
   researches_init();
   universal_found_functions_init();
   treaties_init();
@@ -485,6 +488,7 @@ void game_free(void)
   game_ruleset_free();
   researches_free();
   cm_free();
+  pf_pool_free();
 }
 
 /**********************************************************************//**
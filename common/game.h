@@ -104,6 +104,13 @@ struct civ_game {
 
   int lua_timeout;
 
+  /* Incremented whenever something changes that effect requirements
+   * of any city may depend on beyond the city's own area: techs,
+   * wonders, governments, diplomatic states, number of cities, players
+   * and terrain. Lets effect values calculated in advance detect they
+   * are stale. */
+  unsigned int effects_epoch;
+
   struct {
     /* Items given to all players at game start.
      * Client gets this info for help purposes only. */
@@ -185,8 +192,10 @@ struct civ_game {
       int revolution_length;
       int spaceship_travel_pct;
       bool threaded_save;
+      bool binary_save;
       int save_compress_level;
       enum fz_method save_compress_type;
+      int save_compress_threads;
       int save_nturns;
       int save_frequency;
       unsigned autosaves; /* FIXME: char would be enough, but current settings.c code wants to
@@ -696,6 +705,7 @@ static inline bool is_ruleset_compat_mode(void)
 #endif /* FREECIV_WEB */
 
 #define GAME_DEFAULT_THREADED_SAVE   FALSE
+#define GAME_DEFAULT_BINARY_SAVE     FALSE
 
 #define GAME_DEFAULT_USER_META_MESSAGE ""
 
@@ -726,6 +736,10 @@ static inline bool is_ruleset_compat_mode(void)
 #define GAME_MIN_COMPRESS_LEVEL     1
 #define GAME_MAX_COMPRESS_LEVEL     9
 
+#define GAME_DEFAULT_COMPRESS_THREADS 1
+#define GAME_MIN_COMPRESS_THREADS     1
+#define GAME_MAX_COMPRESS_THREADS     16
+
 #if defined(FREECIV_HAVE_LIBZSTD)
 #  define GAME_DEFAULT_COMPRESS_TYPE FZ_ZSTD
 #elif defined(FREECIV_HAVE_LIBLZMA)
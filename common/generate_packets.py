@@ -2960,7 +2960,7 @@ if (different == 0) {{
 {log_discard}\
 {stats_discard}\
 {before_return}\
-  SEND_PACKET_DISCARD();
+  SEND_PACKET_DISCARD({self.type});
 }}
 """
         else:
@@ -2977,6 +2977,7 @@ struct genhash **hash = pc->phs.sent + {self.type};
 if (nullptr == *hash) {{
   *hash = genhash_new_full(hash_{self.name}, cmp_{self.name},
                            nullptr, nullptr, nullptr, destroy_{self.packet_name});
+  genhash_set_backend(*hash, GENHASH_OPEN);
 }}
 BV_CLR_ALL(fields);
 
@@ -3140,6 +3141,7 @@ struct genhash **hash = pc->phs.received + {self.type};
 if (nullptr == *hash) {{
   *hash = genhash_new_full(hash_{self.name}, cmp_{self.name},
                            nullptr, nullptr, nullptr, destroy_{self.packet_name});
+  genhash_set_backend(*hash, GENHASH_OPEN);
 }}
 
 if (genhash_lookup(*hash, real_packet, (void **) &old)) {{
@@ -4293,6 +4295,7 @@ def write_common_impl(path: "str | Path | None", packets: PacketsDefinition):
 #include "dataio.h"
 #include "game.h"
 
+#include "packet_trace.h"
 #include "packets.h"
 
 """)
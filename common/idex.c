@@ -46,6 +46,10 @@ void idex_init(struct world *iworld)
 {
   iworld->cities = city_hash_new();
   iworld->units = unit_hash_new();
+
+  /* Looked up all the time, by small integer keys. */
+  city_hash_set_backend(iworld->cities, GENHASH_OPEN);
+  unit_hash_set_backend(iworld->units, GENHASH_OPEN);
 }
 
 /**********************************************************************//**
@@ -840,6 +840,7 @@ void wonder_built(const struct city *pcity, const struct impr_type *pimprove)
 
   pplayer = city_owner(pcity);
   pplayer->wonders[windex] = pcity->id;
+  game.effects_epoch++;
 
   if (is_great_wonder(pimprove)) {
     game.info.great_wonder_owners[windex] = player_number(pplayer);
@@ -861,6 +862,7 @@ void wonder_destroyed(const struct city *pcity,
   pplayer = city_owner(pcity);
   fc_assert_ret(pplayer->wonders[windex] == pcity->id);
   pplayer->wonders[windex] = WONDER_LOST;
+  game.effects_epoch++;
 
   if (is_great_wonder(pimprove)) {
     fc_assert_ret(game.info.great_wonder_owners[windex]
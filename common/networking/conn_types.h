@@ -65,6 +65,15 @@ enum report_type {
  */
 #define ATTRIBUTE_CHUNK_SIZE    (1400)
 
+/* The room for run-length coded tile data in PACKET_TILE_INFO_BULK, and
+ * the most tiles one such packet may describe. The data size leaves room
+ * for the other fields of the packet within MAX_LEN_PACKET.
+ *
+ * Used in network protocol.
+ */
+#define TILE_INFO_BULK_SIZE      (4000)
+#define TILE_INFO_BULK_MAX_TILES (1024)
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -46,6 +46,10 @@
 
 #include "connection.h"
 
+#ifdef USE_COMPRESSION
+#include <zlib.h>
+#endif /* USE_COMPRESSION */
+
 
 static void default_conn_close_callback(struct connection *pconn);
 
@@ -159,18 +163,29 @@ int read_socket_data(int sock, struct socket_packet_buffer *buffer)
 }
 
 /**********************************************************************//**
-  Write wrapper function -vasc
+  Whether the socket of the connection can be written without asking
+  select() first. Server sockets are non-blocking, and with the epoll
+  backend they may be past FD_SETSIZE, so select() must not see them.
+  Whatever does not fit stays in the buffer until the server finds the
+  socket writable again.
 **************************************************************************/
-static int write_socket_data(struct connection *pc,
-                             struct socket_packet_buffer *buf, int limit)
+static bool write_without_select(const struct connection *pc)
 {
-  int start, nput, nblock;
-
-  if (is_server() && pc->server.is_closing) {
-    return 0;
-  }
+#if defined(HAVE_SYS_EPOLL_H) && defined(NONBLOCKING_SOCKETS)
+  return is_server();
+#else  /* HAVE_SYS_EPOLL_H && NONBLOCKING_SOCKETS */
+  return FALSE;
+#endif /* HAVE_SYS_EPOLL_H && NONBLOCKING_SOCKETS */
+}
 
-  for (start = 0; buf->ndata-start > limit;) {
+/**********************************************************************//**
+  Check with select() whether the socket of the connection can be
+  written right now. Returns 1 if it can, 0 if it can't, and -1 if the
+  connection got closed.
+**************************************************************************/
+static int wait_socket_writable(struct connection *pc)
+{
+  for (;;) {
     fd_set writefs, exceptfs;
     fc_timeval tv;
 
@@ -183,7 +198,7 @@ static int write_socket_data(struct connection *pc,
 
     if (fc_select(pc->sock + 1, nullptr, &writefs, &exceptfs, &tv) <= 0) {
       if (errno != EINTR) {
-        break;
+        return 0;
       } else {
         /* EINTR can happen sometimes, especially when compiling with -pg.
          * Generally we just want to run select again. */
@@ -197,20 +212,54 @@ static int write_socket_data(struct connection *pc,
     }
 
     if (FD_ISSET(pc->sock, &writefs)) {
-      nblock = MIN(buf->ndata-start, MAX_LEN_PACKET);
-      log_debug("trying to write %d limit=%d", nblock, limit);
-      if ((nput = fc_writesocket(pc->sock,
-                                 (const char *)buf->data+start, nblock)) == -1) {
+      return 1;
+    }
+  }
+}
+
+/**********************************************************************//**
+  Write wrapper function -vasc
+**************************************************************************/
+static int write_socket_data(struct connection *pc,
+                             struct socket_packet_buffer *buf, int limit)
+{
+  int start, nput, nblock;
+  bool use_select;
+
+  if (is_server() && pc->server.is_closing) {
+    return 0;
+  }
+
+  use_select = !write_without_select(pc);
+
+  for (start = 0; buf->ndata-start > limit;) {
+    if (use_select) {
+      int ready = wait_socket_writable(pc);
+
+      if (ready < 0) {
+        return -1;
+      }
+      if (ready == 0) {
+        break;
+      }
+    }
+
+    nblock = MIN(buf->ndata-start, MAX_LEN_PACKET);
+    log_debug("trying to write %d limit=%d", nblock, limit);
+    if ((nput = fc_writesocket(pc->sock,
+                               (const char *)buf->data+start, nblock)) == -1) {
 #ifdef NONBLOCKING_SOCKETS
-        if (errno == EWOULDBLOCK || errno == EAGAIN) {
-          break;
-        }
+      if (errno == EWOULDBLOCK || errno == EAGAIN) {
+        break;
+      }
 #endif /* NONBLOCKING_SOCKETS */
-        connection_close(pc, _("lagging connection"));
-        return -1;
+      if (!use_select && errno == EINTR) {
+        continue;
       }
-      start += nput;
+      connection_close(pc, _("lagging connection"));
+      return -1;
     }
+    start += nput;
   }
 
   if (start > 0) {
@@ -550,6 +599,15 @@ void free_compression_queue(struct connection *pc)
 {
 #ifdef USE_COMPRESSION
   byte_vector_free(&pc->compression.queue);
+
+  if (pc->compression.send_stream != nullptr) {
+    deflateEnd(pc->compression.send_stream);
+    FC_FREE(pc->compression.send_stream);
+  }
+  if (pc->compression.recv_stream != nullptr) {
+    inflateEnd(pc->compression.recv_stream);
+    FC_FREE(pc->compression.recv_stream);
+  }
 #endif /* USE_COMPRESSION */
 }
 
@@ -621,6 +679,8 @@ void connection_common_init(struct connection *pconn)
 #ifdef USE_COMPRESSION
   byte_vector_init(&pconn->compression.queue);
   pconn->compression.frozen_level = 0;
+  pconn->compression.send_stream = nullptr;
+  pconn->compression.recv_stream = nullptr;
 #endif /* USE_COMPRESSION */
 
   pconn->client_gui = GUI_STUB;
@@ -688,6 +748,24 @@ void conn_reset_delta_state(struct connection *pc)
   }
 }
 
+/**********************************************************************//**
+  Remove the cached packets of one type from the connection, so that
+  the next packets of that type are sent or received in full. Both ends
+  must do this at the same point of the packet stream. The packet_type
+  argument is an "enum packet_type", see incoming_packet_notify.
+**************************************************************************/
+void conn_reset_packet_delta_state(struct connection *pc,
+                                   int packet_type)
+{
+  if (pc->phs.sent != nullptr && pc->phs.sent[packet_type] != nullptr) {
+    genhash_clear(pc->phs.sent[packet_type]);
+  }
+  if (pc->phs.received != nullptr
+      && pc->phs.received[packet_type] != nullptr) {
+    genhash_clear(pc->phs.received[packet_type]);
+  }
+}
+
 /**********************************************************************//**
   Freeze the connection. Then the packets sent to it won't be sent
   immediately, but later, using a compression method. See further details
@@ -270,6 +270,12 @@ struct connection {
     int frozen_level;
 
     struct byte_vector queue;
+
+    /* DEFLATE streams living as long as the connection, so that every
+     * chunk is compressed against the data sent before it. Created
+     * when first needed. */
+    struct z_stream_s *send_stream;
+    struct z_stream_s *recv_stream;
   } compression;
 #endif
   struct {
@@ -304,6 +310,8 @@ void connection_common_close(struct connection *pconn);
 void conn_set_capability(struct connection *pconn, const char *capability);
 void free_compression_queue(struct connection *pconn);
 void conn_reset_delta_state(struct connection *pconn);
+void conn_reset_packet_delta_state(struct connection *pc,
+                                   int packet_type);
 
 void conn_compression_freeze(struct connection *pconn);
 bool conn_compression_thaw(struct connection *pconn);
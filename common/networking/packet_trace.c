@@ -60,6 +60,37 @@ static long trace_total_bytes = 0;
 static int trace_type_count[PACKET_LAST];
 static long trace_type_bytes[PACKET_LAST];
 
+/*
+ * Latency histograms are log-linear, like HdrHistogram: values below
+ * LATENCY_SUB_BUCKETS nanoseconds get a bucket each, and every further
+ * power of two is split into LATENCY_SUB_BUCKETS buckets, so that the
+ * error of a reported percentile stays below 1/16th of its value.
+ * Values at or above 2^(LATENCY_MAX_BIT + 1) ns (about 36 minutes) land
+ * in the last bucket.
+ */
+#define LATENCY_SUB_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_BIT 41
+#define LATENCY_BUCKETS \
+  ((LATENCY_MAX_BIT - LATENCY_SUB_BITS + 2) * LATENCY_SUB_BUCKETS)
+
+struct latency_histogram {
+  enum packet_type type;
+  uint64_t count;
+  uint64_t total;
+  uint64_t max;
+  uint64_t buckets[LATENCY_BUCKETS];
+};
+
+static bool latency_active = FALSE;
+
+/* Allocated on the first record of each packet type */
+static struct latency_histogram *latency_hist[PACKET_LATENCY_COUNT][PACKET_LAST];
+
+static const char *latency_kind_name[PACKET_LATENCY_COUNT] = {
+  "handle", "send"
+};
+
 /**********************************************************************//**
   Get current time in microseconds since epoch.
   Falls back to seconds precision if gettimeofday is not available.
@@ -76,6 +107,21 @@ static uint64_t get_timestamp_usec(void)
 #endif
 }
 
+/**********************************************************************//**
+  Get a monotonic timestamp in nanoseconds, for latency measurements.
+**************************************************************************/
+static uint64_t get_timestamp_nsec(void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#else
+  return get_timestamp_usec() * 1000ULL;
+#endif
+}
+
 /**********************************************************************//**
   Disable tracing due to a write error. Logs the error and closes
   the trace file so no further writes are attempted.
@@ -159,8 +205,16 @@ static void write_file_header(FILE *fp)
 void packet_trace_init(const char *trace_dir)
 {
   const char *dir = trace_dir;
+  const char *latency = getenv("FREECIV_PACKET_LATENCY");
   char filepath[1024];
 
+  if (!latency_active && latency != nullptr && latency[0] != '\0'
+      && strcmp(latency, "0") != 0) {
+    memset(latency_hist, 0, sizeof(latency_hist));
+    latency_active = TRUE;
+    log_normal("packet_trace: collecting packet latency histograms");
+  }
+
   if (trace_active) {
     /* Already initialized */
     return;
@@ -197,6 +251,129 @@ void packet_trace_init(const char *trace_dir)
   log_normal("packet_trace: tracing enabled, writing to '%s'", filepath);
 }
 
+/**********************************************************************//**
+  Return the histogram bucket of a latency value.
+**************************************************************************/
+static int latency_bucket(uint64_t value)
+{
+  int msb;
+
+  if (value < LATENCY_SUB_BUCKETS) {
+    return value;
+  }
+  if (value >> (LATENCY_MAX_BIT + 1) != 0) {
+    return LATENCY_BUCKETS - 1;
+  }
+
+  for (msb = LATENCY_SUB_BITS; value >> (msb + 1) != 0; msb++) {
+    /* Find the most significant bit */
+  }
+
+  return (msb - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS
+    + (int)(value >> (msb - LATENCY_SUB_BITS)) - LATENCY_SUB_BUCKETS;
+}
+
+/**********************************************************************//**
+  Return the highest latency value that falls into the bucket.
+**************************************************************************/
+static uint64_t latency_bucket_limit(int bucket)
+{
+  int shift;
+
+  if (bucket < LATENCY_SUB_BUCKETS) {
+    return bucket;
+  }
+
+  shift = bucket / LATENCY_SUB_BUCKETS - 1;
+
+  return (((uint64_t)(LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS)
+           + 1) << shift) - 1;
+}
+
+/**********************************************************************//**
+  Return the latency below which the given percentage of the values of
+  the histogram lie. Precise to a bucket; never above the maximum.
+**************************************************************************/
+static uint64_t latency_percentile(const struct latency_histogram *hist,
+                                   int percent)
+{
+  uint64_t wanted = (hist->count * percent + 99) / 100;
+  uint64_t seen = 0;
+  int i;
+
+  if (wanted == 0) {
+    wanted = 1;
+  }
+
+  for (i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += hist->buckets[i];
+    if (seen >= wanted) {
+      return MIN(latency_bucket_limit(i), hist->max);
+    }
+  }
+
+  return hist->max;
+}
+
+/**********************************************************************//**
+  Sort packet types by decreasing total time in their histograms.
+**************************************************************************/
+static int latency_total_cmp(const void *a, const void *b)
+{
+  const struct latency_histogram *ha = *(struct latency_histogram *const *)a;
+  const struct latency_histogram *hb = *(struct latency_histogram *const *)b;
+
+  if (ha->total != hb->total) {
+    return ha->total < hb->total ? 1 : -1;
+  }
+
+  return 0;
+}
+
+/**********************************************************************//**
+  Log the percentiles of every latency histogram and free them. The
+  packet types that took the most time overall come first.
+**************************************************************************/
+static void latency_dump(void)
+{
+  struct latency_histogram *sorted[PACKET_LAST];
+  int kind, i;
+
+  for (kind = 0; kind < PACKET_LATENCY_COUNT; kind++) {
+    int num = 0;
+
+    for (i = 0; i < PACKET_LAST; i++) {
+      if (latency_hist[kind][i] != nullptr) {
+        sorted[num++] = latency_hist[kind][i];
+      }
+    }
+    qsort(sorted, num, sizeof(sorted[0]), latency_total_cmp);
+
+    log_normal("packet_trace: === %s latency (usec) ===",
+               latency_kind_name[kind]);
+    for (i = 0; i < num; i++) {
+      const struct latency_histogram *hist = sorted[i];
+
+      log_normal("packet_trace:   type %3d (%-30s): %7lu calls,"
+                 " p50 %9.1f, p90 %9.1f, p99 %9.1f, max %9.1f,"
+                 " total %11.1f",
+                 hist->type, packet_name(hist->type),
+                 (unsigned long)hist->count,
+                 latency_percentile(hist, 50) / 1000.0,
+                 latency_percentile(hist, 90) / 1000.0,
+                 latency_percentile(hist, 99) / 1000.0,
+                 hist->max / 1000.0, hist->total / 1000.0);
+    }
+  }
+
+  for (kind = 0; kind < PACKET_LATENCY_COUNT; kind++) {
+    for (i = 0; i < PACKET_LAST; i++) {
+      FC_FREE(latency_hist[kind][i]);
+    }
+  }
+  latency_active = FALSE;
+}
+
 /**********************************************************************//**
   Finalize and close trace files. Print summary statistics including
   total packets, bytes, and per-type breakdown.
@@ -206,6 +383,10 @@ void packet_trace_done(void)
   int i;
   int types_seen = 0;
 
+  if (latency_active) {
+    latency_dump();
+  }
+
   if (!trace_active) {
     return;
   }
@@ -327,6 +508,51 @@ bool packet_trace_is_active(void)
   return trace_active;
 }
 
+/**********************************************************************//**
+  Start timing the handling or the encoding of a packet. Returns the
+  start time to pass to packet_latency_record(), or 0 when latency
+  histograms are not being collected.
+**************************************************************************/
+uint64_t packet_latency_start(void)
+{
+  if (!latency_active) {
+    return 0;
+  }
+
+  return get_timestamp_nsec();
+}
+
+/**********************************************************************//**
+  Add the time passed since 'start' to the latency histogram of
+  the packet type. 'kind' is PACKET_LATENCY_HANDLE or PACKET_LATENCY_SEND.
+**************************************************************************/
+void packet_latency_record(int kind, enum packet_type type, uint64_t start)
+{
+  struct latency_histogram *hist;
+  uint64_t elapsed;
+
+  if (!latency_active || start == 0) {
+    return;
+  }
+
+  fc_assert_ret(kind >= 0 && kind < PACKET_LATENCY_COUNT);
+  fc_assert_ret(type >= 0 && type < PACKET_LAST);
+
+  elapsed = get_timestamp_nsec() - start;
+
+  hist = latency_hist[kind][type];
+  if (hist == nullptr) {
+    hist = fc_calloc(1, sizeof(*hist));
+    hist->type = type;
+    latency_hist[kind][type] = hist;
+  }
+
+  hist->count++;
+  hist->total += elapsed;
+  hist->max = MAX(hist->max, elapsed);
+  hist->buckets[latency_bucket(elapsed)]++;
+}
+
 /**********************************************************************//**
   Get total count of packets traced so far.
 **************************************************************************/
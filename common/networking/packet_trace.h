@@ -24,7 +24,8 @@ extern "C" {
 /* Packet trace recording for testing and debugging.
  *
  * Captures all packets sent/received to a binary trace file for
- * later analysis. Controlled via FREECIV_PACKET_TRACE_DIR env var.
+ * later analysis, or for replaying the received packets to a server
+ * with freeciv-replay. Controlled via FREECIV_PACKET_TRACE_DIR env var.
  * Zero-cost when tracing is not active.
  */
 
@@ -36,6 +37,17 @@ extern "C" {
 #define PACKET_TRACE_DIR_SEND 0
 #define PACKET_TRACE_DIR_RECV 1
 
+/* Latency histograms.
+ *
+ * When the FREECIV_PACKET_LATENCY env var is set, the time spent
+ * handling each received packet and encoding each sent packet is
+ * collected per packet type into log-linear histograms, and their
+ * percentiles are logged by packet_trace_done(). Works with or without
+ * a trace file. */
+#define PACKET_LATENCY_HANDLE 0
+#define PACKET_LATENCY_SEND   1
+#define PACKET_LATENCY_COUNT  2
+
 /* Initialize packet tracing. If trace_dir is NULL, checks the
  * FREECIV_PACKET_TRACE_DIR environment variable. If neither is set,
  * tracing remains inactive (zero-cost). */
@@ -59,6 +71,13 @@ void packet_trace_record_recv(enum packet_type type,
 /* Check if tracing is active */
 bool packet_trace_is_active(void);
 
+/* Start timing a handler or an encoder. Returns 0 when latency
+ * histograms are not being collected. */
+uint64_t packet_latency_start(void);
+
+/* Add the time since 'start' to the histogram of the packet type */
+void packet_latency_record(int kind, enum packet_type type, uint64_t start);
+
 /* Get count of packets traced */
 int packet_trace_get_count(void);
 
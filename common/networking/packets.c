@@ -66,7 +66,11 @@
 #define log_compress    log_debug
 #define log_compress2   log_debug
 
-#define MAX_DECOMPRESSION 400
+/*
+ * The sender flushes its queue before it grows past MAX_LEN_BUFFER / 2,
+ * so no chunk decompresses to more than this.
+ */
+#define MAX_DECOMPRESSION MAX_LEN_BUFFER
 
 #endif /* USE_COMPRESSION */
 
@@ -90,7 +94,6 @@ static struct packet_handler_hash *packet_handlers = nullptr;
 static int stat_size_alone = 0;
 static int stat_size_uncompressed = 0;
 static int stat_size_compressed = 0;
-static int stat_size_no_compression = 0;
 
 /**********************************************************************//**
   Returns the compression level. Initialize it if needed.
@@ -110,78 +113,148 @@ static inline int get_compression_level(void)
   return level;
 }
 
+/**********************************************************************//**
+  Returns the DEFLATE stream compressing the data sent to the connection.
+  The stream is created when first needed, and ends only when the
+  connection is closed.
+**************************************************************************/
+static z_stream *conn_compression_send_stream(struct connection *pconn)
+{
+  if (pconn->compression.send_stream == nullptr) {
+    z_stream *stream = fc_calloc(1, sizeof(*stream));
+
+    if (deflateInit(stream, get_compression_level()) != Z_OK) {
+      log_error("Cannot initialize compression for %s: %s",
+                conn_description(pconn),
+                stream->msg != nullptr ? stream->msg : "-");
+      free(stream);
+      return nullptr;
+    }
+    pconn->compression.send_stream = stream;
+  }
+
+  return pconn->compression.send_stream;
+}
+
+/**********************************************************************//**
+  Returns the INFLATE stream decompressing the data received from the
+  connection. See conn_compression_send_stream().
+**************************************************************************/
+static z_stream *conn_compression_recv_stream(struct connection *pconn)
+{
+  if (pconn->compression.recv_stream == nullptr) {
+    z_stream *stream = fc_calloc(1, sizeof(*stream));
+
+    if (inflateInit(stream) != Z_OK) {
+      log_error("Cannot initialize decompression for %s: %s",
+                conn_description(pconn),
+                stream->msg != nullptr ? stream->msg : "-");
+      free(stream);
+      return nullptr;
+    }
+    pconn->compression.recv_stream = stream;
+  }
+
+  return pconn->compression.recv_stream;
+}
+
 /**********************************************************************//**
   Send all waiting data. Return TRUE on success.
+
+  The queue is compressed as the next part of the DEFLATE stream of the
+  connection, and the stream is sync flushed so that the receiver can
+  decompress the chunk right away. As the chunk refers back to the data
+  of the earlier chunks, it has to be sent compressed even when that
+  does not make it any smaller.
 **************************************************************************/
 static bool conn_compression_flush(struct connection *pconn)
 {
-  int compression_level = get_compression_level();
-  uLongf compressed_size = 12 + 1.001 * pconn->compression.queue.size;
-  Bytef compressed[compressed_size];
+  size_t queue_size = byte_vector_size(&pconn->compression.queue);
+  z_stream *stream;
+  Bytef *compressed;
+  uLong compressed_space;
+  uLong compressed_size = 0;
   bool jumbo;
-  unsigned long compressed_packet_len;
-
-#ifndef FREECIV_NDEBUG
-  int error =
-#endif
-  compress2(compressed, &compressed_size,
-            pconn->compression.queue.p,
-            pconn->compression.queue.size,
-            compression_level);
+  struct raw_data_out dout;
 
-  fc_assert_ret_val(error == Z_OK, FALSE);
+  if (0 == queue_size) {
+    return pconn->used;
+  }
 
   /* Compression signalling currently assumes a 2-byte packet length; if that
    * changes, the protocol should probably be changed */
   fc_assert_ret_val(data_type_size(pconn->packet_header.length) == 2, FALSE);
 
-  /* Include normal length field in decision */
-  jumbo = (compressed_size+2 >= JUMBO_BORDER);
+  stream = conn_compression_send_stream(pconn);
+  if (stream == nullptr) {
+    connection_close(pconn, _("compression error"));
+    return FALSE;
+  }
 
-  compressed_packet_len = compressed_size + (jumbo ? 6 : 2);
-  if (compressed_packet_len < pconn->compression.queue.size) {
-    struct raw_data_out dout;
+  /* Leave room for the sync flush marker too. */
+  compressed_space = deflateBound(stream, queue_size) + 16;
+  compressed = fc_malloc(compressed_space);
 
-    log_compress("COMPRESS: compressed %lu bytes to %ld (level %d)",
-                 (unsigned long) pconn->compression.queue.size,
-                 compressed_size, compression_level);
-    stat_size_uncompressed += pconn->compression.queue.size;
-    stat_size_compressed += compressed_size;
+  stream->next_in = pconn->compression.queue.p;
+  stream->avail_in = queue_size;
+  do {
+    int error;
 
-    if (!jumbo) {
-      unsigned char header[2];
+    if (compressed_size == compressed_space) {
+      compressed_space *= 2;
+      compressed = fc_realloc(compressed, compressed_space);
+    }
+    stream->next_out = compressed + compressed_size;
+    stream->avail_out = compressed_space - compressed_size;
+
+    error = deflate(stream, Z_SYNC_FLUSH);
+    compressed_size = compressed_space - stream->avail_out;
+
+    if (error != Z_OK && error != Z_BUF_ERROR) {
+      log_error("Compressing the packet stream for %s failed: %s",
+                conn_description(pconn),
+                stream->msg != nullptr ? stream->msg : "-");
+      free(compressed);
+      connection_close(pconn, _("compression error"));
+      return FALSE;
+    }
+  } while (stream->avail_out == 0);
 
-      FC_STATIC_ASSERT(COMPRESSION_BORDER > MAX_LEN_PACKET,
-                       uncompressed_compressed_packet_len_overlap);
+  log_compress("COMPRESS: compressed %lu bytes to %lu (level %d)",
+               (unsigned long) queue_size, compressed_size,
+               get_compression_level());
+  stat_size_uncompressed += queue_size;
+  stat_size_compressed += compressed_size;
 
-      log_compress("COMPRESS: sending %ld as normal", compressed_size);
+  /* Include normal length field in decision */
+  jumbo = (compressed_size+2 >= JUMBO_BORDER);
 
-      dio_output_init(&dout, header, sizeof(header));
-      dio_put_uint16_raw(&dout, 2 + compressed_size + COMPRESSION_BORDER);
-      connection_send_data(pconn, header, sizeof(header));
-      connection_send_data(pconn, compressed, compressed_size);
-    } else {
-      unsigned char header[6];
+  if (!jumbo) {
+    unsigned char header[2];
 
-      FC_STATIC_ASSERT(JUMBO_SIZE >= JUMBO_BORDER+COMPRESSION_BORDER,
-                       compressed_normal_jumbo_packet_len_overlap);
+    FC_STATIC_ASSERT(COMPRESSION_BORDER > MAX_LEN_PACKET,
+                     uncompressed_compressed_packet_len_overlap);
 
-      log_compress("COMPRESS: sending %ld as jumbo", compressed_size);
-      dio_output_init(&dout, header, sizeof(header));
-      dio_put_uint16_raw(&dout, JUMBO_SIZE);
-      dio_put_uint32_raw(&dout, 6 + compressed_size);
-      connection_send_data(pconn, header, sizeof(header));
-      connection_send_data(pconn, compressed, compressed_size);
-    }
+    log_compress("COMPRESS: sending %lu as normal", compressed_size);
+
+    dio_output_init(&dout, header, sizeof(header));
+    dio_put_uint16_raw(&dout, 2 + compressed_size + COMPRESSION_BORDER);
+    connection_send_data(pconn, header, sizeof(header));
   } else {
-    log_compress("COMPRESS: would enlarge %lu bytes to %ld; "
-                 "sending uncompressed",
-                 (unsigned long) pconn->compression.queue.size,
-                 compressed_packet_len);
-    connection_send_data(pconn, pconn->compression.queue.p,
-                         pconn->compression.queue.size);
-    stat_size_no_compression += pconn->compression.queue.size;
+    unsigned char header[6];
+
+    FC_STATIC_ASSERT(JUMBO_SIZE >= JUMBO_BORDER+COMPRESSION_BORDER,
+                     compressed_normal_jumbo_packet_len_overlap);
+
+    log_compress("COMPRESS: sending %lu as jumbo", compressed_size);
+    dio_output_init(&dout, header, sizeof(header));
+    dio_put_uint16_raw(&dout, JUMBO_SIZE);
+    dio_put_uint32_raw(&dout, 6 + compressed_size);
+    connection_send_data(pconn, header, sizeof(header));
   }
+  connection_send_data(pconn, compressed, compressed_size);
+
+  free(compressed);
 
   return pconn->used;
 }
@@ -277,9 +350,9 @@ int send_packet_data(struct connection *pc, unsigned char *data, int len,
       connection_send_data(pc, data, len);
     }
 
-    log_compress2("COMPRESS: STATS: alone=%d compression-expand=%d "
+    log_compress2("COMPRESS: STATS: alone=%d "
                   "compression (before/after) = %d/%d",
-                  stat_size_alone, stat_size_no_compression,
+                  stat_size_alone,
                   stat_size_uncompressed, stat_size_compressed);
   }
 #else  /* USE_COMPRESSION */
@@ -447,34 +520,51 @@ void *get_packet_from_connection_raw(struct connection *pc,
 
   if (compressed_packet) {
     uLong compressed_size = whole_packet_len - header_size;
-    int decompress_factor = 80;
-    unsigned long int decompressed_size = decompress_factor * compressed_size;
-    int error = Z_BUF_ERROR;
+    uLong decompressed_space = 8 * compressed_size + 1024;
+    uLong decompressed_size = 0;
     struct socket_packet_buffer *buffer = pc->buffer;
-    void *decompressed = fc_malloc(decompressed_size);
+    z_stream *stream = conn_compression_recv_stream(pc);
+    Bytef *decompressed;
+
+    if (stream == nullptr) {
+      connection_close(pc, _("decoding error"));
+      return nullptr;
+    }
 
+    decompressed = fc_malloc(decompressed_space);
+    stream->next_in = ADD_TO_POINTER(buffer->data, header_size);
+    stream->avail_in = compressed_size;
+
+    /* The chunk ends in a sync flush, so all of its data comes out now. */
     do {
-      error =
-        uncompress(decompressed, &decompressed_size,
-                   ADD_TO_POINTER(buffer->data, header_size),
-                   compressed_size);
-
-      if (error == Z_BUF_ERROR) {
-        decompress_factor += 50;
-        decompressed_size = decompress_factor * compressed_size;
-        decompressed = fc_realloc(decompressed, decompressed_size);
+      int error;
+
+      if (decompressed_size == decompressed_space) {
+        decompressed_space *= 2;
+        decompressed = fc_realloc(decompressed, decompressed_space);
       }
+      stream->next_out = decompressed + decompressed_size;
+      stream->avail_out = decompressed_space - decompressed_size;
 
-      if (error != Z_OK) {
-        if (error != Z_BUF_ERROR || decompress_factor > MAX_DECOMPRESSION ) {
-          log_verbose("Uncompressing of the packet stream failed. "
-                      "The connection will be closed now.");
-          connection_close(pc, _("decoding error"));
-          return nullptr;
-        }
+      error = inflate(stream, Z_SYNC_FLUSH);
+      decompressed_size = decompressed_space - stream->avail_out;
+
+      if (error == Z_BUF_ERROR && stream->avail_in == 0) {
+        /* No more output. The chunk inflated to exactly the space
+         * the previous round had, and this round was asked for more. */
+        break;
       }
 
-    } while (error != Z_OK);
+      if ((error != Z_OK && error != Z_BUF_ERROR)
+          || (error == Z_BUF_ERROR && stream->avail_out > 0)
+          || decompressed_size > MAX_DECOMPRESSION) {
+        log_verbose("Uncompressing of the packet stream failed. "
+                    "The connection will be closed now.");
+        free(decompressed);
+        connection_close(pc, _("decoding error"));
+        return nullptr;
+      }
+    } while (stream->avail_in > 0 || stream->avail_out == 0);
 
     buffer->ndata -= whole_packet_len;
     /*
@@ -503,7 +593,7 @@ void *get_packet_from_connection_raw(struct connection *pc,
 
     buffer->ndata += decompressed_size;
 
-    log_compress("COMPRESS: decompressed %ld into %ld",
+    log_compress("COMPRESS: decompressed %lu into %lu",
                  compressed_size, decompressed_size);
 
     return get_packet_from_connection(pc, ptype);
@@ -799,6 +889,297 @@ void send_attribute_block(const struct player *pplayer,
   connection_do_unbuffer(pconn);
 }
 
+/* The integer fields of PACKET_TILE_INFO_BULK data, in coding order.
+ * The extras follow them. */
+enum tile_bulk_column {
+  TBC_KNOWN,
+  TBC_CONTINENT,
+  TBC_OWNER,
+  TBC_EXTRAS_OWNER,
+  TBC_WORKED,
+  TBC_TERRAIN,
+  TBC_RESOURCE,
+  TBC_ALTITUDE,
+  TBC_COUNT
+};
+
+static const enum data_type tile_bulk_column_type[TBC_COUNT] = {
+  DIOT_UINT8,   /* TBC_KNOWN */
+  DIOT_SINT16,  /* TBC_CONTINENT */
+  DIOT_SINT16,  /* TBC_OWNER */
+  DIOT_SINT16,  /* TBC_EXTRAS_OWNER */
+  DIOT_UINT32,  /* TBC_WORKED */
+  DIOT_UINT8,   /* TBC_TERRAIN */
+  DIOT_UINT8,   /* TBC_RESOURCE */
+  DIOT_SINT16   /* TBC_ALTITUDE */
+};
+
+/* Longest run of equal values */
+#define TILE_BULK_MAX_RUN 255
+
+/**********************************************************************//**
+  Return the value of a column of PACKET_TILE_INFO_BULK data for a tile.
+**************************************************************************/
+static int tile_bulk_value(const struct packet_tile_info *info,
+                           enum tile_bulk_column column)
+{
+  switch (column) {
+  case TBC_KNOWN:
+    return info->known;
+  case TBC_CONTINENT:
+    return info->continent;
+  case TBC_OWNER:
+    return info->owner;
+  case TBC_EXTRAS_OWNER:
+    return info->extras_owner;
+  case TBC_WORKED:
+    return info->worked;
+  case TBC_TERRAIN:
+    return info->terrain;
+  case TBC_RESOURCE:
+    return info->resource;
+  case TBC_ALTITUDE:
+    return info->altitude;
+  case TBC_COUNT:
+    break;
+  }
+
+  fc_assert_msg(FALSE, "Tile bulk column %d not handled.", column);
+
+  return 0;
+}
+
+/**********************************************************************//**
+  Set the value of a column of PACKET_TILE_INFO_BULK data for a tile.
+**************************************************************************/
+static void tile_bulk_set(struct packet_tile_info *info,
+                          enum tile_bulk_column column, int value)
+{
+  switch (column) {
+  case TBC_KNOWN:
+    info->known = value;
+    return;
+  case TBC_CONTINENT:
+    info->continent = value;
+    return;
+  case TBC_OWNER:
+    info->owner = value;
+    return;
+  case TBC_EXTRAS_OWNER:
+    info->extras_owner = value;
+    return;
+  case TBC_WORKED:
+    info->worked = value;
+    return;
+  case TBC_TERRAIN:
+    info->terrain = value;
+    return;
+  case TBC_RESOURCE:
+    info->resource = value;
+    return;
+  case TBC_ALTITUDE:
+    info->altitude = value;
+    return;
+  case TBC_COUNT:
+    break;
+  }
+
+  fc_assert_msg(FALSE, "Tile bulk column %d not handled.", column);
+}
+
+/**********************************************************************//**
+  Return the length of the run of tiles starting at infos[0] that can
+  share the value of the column. Unknown tiles only have a known
+  column, so they fit in any run of the other columns. The value of
+  the run is stored in *value.
+**************************************************************************/
+static int tile_bulk_run(const struct packet_tile_info *infos, int count,
+                         enum tile_bulk_column column, int *value)
+{
+  bool have_value = FALSE;
+  int run;
+
+  *value = 0;
+  for (run = 0; run < MIN(count, TILE_BULK_MAX_RUN); run++) {
+    if (column == TBC_KNOWN || infos[run].known != TILE_UNKNOWN) {
+      int this_value = tile_bulk_value(&infos[run], column);
+
+      if (!have_value) {
+        *value = this_value;
+        have_value = TRUE;
+      } else if (this_value != *value) {
+        break;
+      }
+    }
+  }
+
+  return run;
+}
+
+/**********************************************************************//**
+  Return the length of the run of tiles starting at infos[0] that can
+  share the extras. The extras of the run are stored in *extras.
+**************************************************************************/
+static int tile_bulk_extras_run(const struct packet_tile_info *infos,
+                                int count, bv_extras *extras)
+{
+  bool have_value = FALSE;
+  int run;
+
+  BV_CLR_ALL(*extras);
+  for (run = 0; run < MIN(count, TILE_BULK_MAX_RUN); run++) {
+    if (infos[run].known != TILE_UNKNOWN) {
+      if (!have_value) {
+        *extras = infos[run].extras;
+        have_value = TRUE;
+      } else if (!BV_ARE_EQUAL(infos[run].extras, *extras)) {
+        break;
+      }
+    }
+  }
+
+  return run;
+}
+
+/**********************************************************************//**
+  Code the first 'count' tile infos into the packet. Returns FALSE if
+  they do not fit.
+**************************************************************************/
+static bool tile_bulk_code(struct packet_tile_info_bulk *packet,
+                           const struct packet_tile_info *infos, int count)
+{
+  struct raw_data_out dout;
+  int column, i, run;
+
+  dio_output_init(&dout, packet->data, sizeof(packet->data));
+
+  for (column = 0; column < TBC_COUNT; column++) {
+    for (i = 0; i < count && !dout.too_short; i += run) {
+      int value;
+
+      run = tile_bulk_run(infos + i, count - i, column, &value);
+      dio_put_uint8_raw(&dout, run);
+      dio_put_type_raw(&dout, tile_bulk_column_type[column], value);
+    }
+  }
+
+  for (i = 0; i < count && !dout.too_short; i += run) {
+    bv_extras extras;
+
+    run = tile_bulk_extras_run(infos + i, count - i, &extras);
+    dio_put_uint8_raw(&dout, run);
+    dio_put_memory_raw(&dout, extras.vec, sizeof(extras.vec));
+  }
+
+  if (dout.too_short) {
+    return FALSE;
+  }
+
+  packet->count = count;
+  packet->length = dio_output_used(&dout);
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Code as many of the 'count' tile infos as fit into the data of the
+  packet, and return how many that is. infos[i] describes the tile
+  first_tile + i; the caller sets first_tile and reset. Only the known
+  field of TILE_UNKNOWN tiles is coded. Labels, sprites and the extras
+  being placed are never coded.
+
+  The data is a column for each enum tile_bulk_column, then one for the
+  extras. A column is a series of runs: the uint8 number of tiles in
+  the run followed by their value.
+**************************************************************************/
+int tile_info_bulk_encode(struct packet_tile_info_bulk *packet,
+                          const struct packet_tile_info *infos, int count)
+{
+  /* 'fits' tiles are known to fit into the packet, 'fails' are not */
+  int fits = 0, fails, tried;
+  bool coded = FALSE;
+
+  count = MIN(count, TILE_INFO_BULK_MAX_TILES);
+  fails = count + 1;
+  tried = count;
+
+  while (fails - fits > 1) {
+    coded = tile_bulk_code(packet, infos, tried);
+    if (coded) {
+      fits = tried;
+    } else {
+      fails = tried;
+    }
+    tried = (fits + fails) / 2;
+  }
+
+  fc_assert_ret_val(fits > 0, 0);
+
+  if (!coded) {
+    /* The last attempt did not fit, code the tiles that do again. */
+    tile_bulk_code(packet, infos, fits);
+  }
+
+  return fits;
+}
+
+/**********************************************************************//**
+  Decode the tile infos of the packet into infos, which must have room
+  for packet->count of them. Returns FALSE if the data is malformed.
+**************************************************************************/
+bool tile_info_bulk_decode(const struct packet_tile_info_bulk *packet,
+                           struct packet_tile_info *infos)
+{
+  struct data_in din;
+  int column, i, j;
+
+  if (packet->count < 1 || packet->count > TILE_INFO_BULK_MAX_TILES) {
+    return FALSE;
+  }
+
+  for (i = 0; i < packet->count; i++) {
+    infos[i].tile = packet->first_tile + i;
+    infos[i].placing = -1;
+    infos[i].place_turn = 0;
+    infos[i].spec_sprite[0] = '\0';
+    infos[i].label[0] = '\0';
+  }
+
+  dio_input_init(&din, packet->data, packet->length);
+
+  for (column = 0; column < TBC_COUNT; column++) {
+    for (i = 0; i < packet->count; i += j) {
+      int run, value;
+
+      if (!dio_get_uint8_raw(&din, &run)
+          || run < 1 || run > packet->count - i
+          || !dio_get_type_raw(&din, tile_bulk_column_type[column],
+                               &value)) {
+        return FALSE;
+      }
+      for (j = 0; j < run; j++) {
+        tile_bulk_set(&infos[i + j], column, value);
+      }
+    }
+  }
+
+  for (i = 0; i < packet->count; i += j) {
+    bv_extras extras;
+    int run;
+
+    if (!dio_get_uint8_raw(&din, &run)
+        || run < 1 || run > packet->count - i
+        || !dio_get_memory_raw(&din, extras.vec, sizeof(extras.vec))) {
+      return FALSE;
+    }
+    for (j = 0; j < run; j++) {
+      infos[i + j].extras = extras;
+    }
+  }
+
+  return dio_input_remaining(&din) == 0;
+}
+
 /**********************************************************************//**
   Test and log for sending player attribute_block
 **************************************************************************/
@@ -98,6 +98,11 @@ void generic_handle_player_attribute_chunk(struct player *pplayer,
 					   const struct
 					   packet_player_attribute_chunk
 					   *chunk);
+int tile_info_bulk_encode(struct packet_tile_info_bulk *packet,
+                          const struct packet_tile_info *infos, int count);
+bool tile_info_bulk_decode(const struct packet_tile_info_bulk *packet,
+                           struct packet_tile_info *infos);
+
 void packet_handlers_fill_initial(struct packet_handlers *phandlers);
 void packet_handlers_fill_capability(struct packet_handlers *phandlers,
                                      const char *capability);
@@ -127,6 +132,7 @@ void packets_deinit(void);
 #else
 
 #define SEND_PACKET_START(packet_type) \
+  uint64_t latency_start = packet_latency_start(); \
   unsigned char buffer[MAX_LEN_PACKET]; \
   struct raw_data_out dout; \
   \
@@ -141,11 +147,15 @@ void packets_deinit(void);
     dio_output_rewind(&dout); \
     dio_put_type_raw(&dout, pc->packet_header.length, size); \
     fc_assert(!dout.too_short); \
+    packet_latency_record(PACKET_LATENCY_SEND, packet_type, latency_start); \
     return send_packet_data(pc, buffer, size, packet_type); \
   }
 
-#define SEND_PACKET_DISCARD() \
-  return 0
+#define SEND_PACKET_DISCARD(packet_type) \
+  { \
+    packet_latency_record(PACKET_LATENCY_SEND, packet_type, latency_start); \
+    return 0; \
+  }
 
 #define RECEIVE_PACKET_START(packet_type, result) \
   struct data_in din; \
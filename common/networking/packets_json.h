@@ -25,6 +25,7 @@ void *get_packet_from_connection_json(struct connection *pc,
                                       enum packet_type *ptype);
 
 #define SEND_PACKET_START(packet_type)                                  \
+  uint64_t latency_start = packet_latency_start();                      \
   unsigned char buffer[MAX_LEN_PACKET * 5];                             \
   struct plocation *pid_addr;                                           \
   char *json_buffer = nullptr;                                          \
@@ -64,15 +65,17 @@ void *get_packet_from_connection_json(struct connection *pc,
       dio_put_type_raw(&dout.raw, pc->packet_header.length, size);      \
     }                                                                   \
     fc_assert(!dout.raw.too_short);                                     \
+    packet_latency_record(PACKET_LATENCY_SEND, packet_type, latency_start); \
     return send_packet_data(pc, buffer, size, packet_type);             \
   }
 
-#define SEND_PACKET_DISCARD() \
-  {                           \
-    if (pc->json_mode) {      \
-      json_decref(dout.json); \
-    }                         \
-    return 0;                 \
+#define SEND_PACKET_DISCARD(packet_type)                                \
+  {                                                                     \
+    if (pc->json_mode) {                                                \
+      json_decref(dout.json);                                           \
+    }                                                                   \
+    packet_latency_record(PACKET_LATENCY_SEND, packet_type, latency_start); \
+    return 0;                                                           \
   }
 
 #define RECEIVE_PACKET_START(packet_type, result)                           \
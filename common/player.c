@@ -25,6 +25,7 @@
 /* common */
 #include "ai.h"
 #include "city.h"
+#include "effects.h"
 #include "fc_interface.h"
 #include "featured_text.h"
 #include "game.h"
@@ -858,6 +859,7 @@ bool player_set_nation(struct player *pplayer, struct nation_type *pnation)
       pnation->player = pplayer;
     }
     pplayer->nation = pnation;
+    bonus_cache_invalidate();
 
     return TRUE;
   }
@@ -322,6 +322,7 @@ struct player
       bv_pstatus status;
 
       struct player_tile *private_map;
+      struct player_tile_seen *private_seen;
 
       /* Player can see inside their borders. */
       bool border_vision;
@@ -650,6 +650,10 @@ enum tech_state research_invention_set(struct research *presearch,
     return old;
   }
   presearch->inventions[tech].state = value;
+  if (old == TECH_KNOWN || value == TECH_KNOWN) {
+    /* Requirements care only about the known techs */
+    game.effects_epoch++;
+  }
 
   if (value == TECH_KNOWN) {
     if (!game.info.global_advances[tech]) {
@@ -22,6 +22,7 @@
 
 /* common */
 #include "fc_interface.h"
+#include "effects.h"
 #include "game.h"
 #include "map.h"
 #include "movement.h"
@@ -63,6 +64,17 @@ struct tile *tile_claimer(const struct tile *ptile)
 }
 #endif
 
+/************************************************************************//**
+  Drops the cached effect values that may depend on the tile. Virtual
+  tiles, like the ones the AI uses to try out changes, are never cached.
+****************************************************************************/
+static void tile_bonuses_changed(const struct tile *ptile)
+{
+  if (ptile == index_to_tile(&(wld.map), tile_index(ptile))) {
+    bonus_cache_invalidate();
+  }
+}
+
 /************************************************************************//**
   Set the owner of a tile (may be nullptr).
 ****************************************************************************/
@@ -151,6 +163,7 @@ void tile_set_terrain(struct tile *ptile, struct terrain *pterrain)
 #endif /* 0 */
 
   ptile->terrain = pterrain;
+  tile_bonuses_changed(ptile);
   if (ptile->resource != nullptr) {
     if (pterrain != nullptr
         && terrain_has_resource(pterrain, ptile->resource)) {
@@ -497,6 +510,8 @@ static void tile_destroy_extra(struct tile *ptile, struct extra_type *pextra)
 void tile_change_terrain(struct tile *ptile, struct terrain *pterrain)
 {
   tile_set_terrain(ptile, pterrain);
+  /* Can change the size of the continent or ocean */
+  game.effects_epoch++;
 
   /* Remove unsupported extras */
   extra_type_iterate(pextra) {
@@ -957,6 +972,7 @@ void tile_add_extra(struct tile *ptile, const struct extra_type *pextra)
 {
   if (pextra != nullptr) {
     BV_SET(ptile->extras, extra_index(pextra));
+    tile_bonuses_changed(ptile);
   }
 }
 
@@ -967,6 +983,7 @@ void tile_remove_extra(struct tile *ptile, const struct extra_type *pextra)
 {
   if (pextra != nullptr) {
     BV_CLR(ptile->extras, extra_index(pextra));
+    tile_bonuses_changed(ptile);
     if (ptile->resource == pextra) {
       ptile->resource = nullptr;
     }
@@ -2816,6 +2816,38 @@ void set_unit_class_caches(struct unit_class *pclass)
     }
   } extra_type_iterate_end;
 
+  /* Moves from or to non-native tiles cost SINGLE_MOVE,
+   * see tile_move_cost_ptrs() */
+  pclass->cache.min_move_cost = SINGLE_MOVE;
+  BV_CLR_ALL(pclass->cache.free_roads);
+  if (uclass_has_flag(pclass, UCF_TERRAIN_SPEED)) {
+    terrain_type_iterate(pterrain) {
+      /* Some extras may make also the other terrains native, unless
+       * nothing can ever get there. */
+      if (is_native_to_class(pclass, pterrain, nullptr)
+          || (extra_type_list_size(pclass->cache.native_tile_extras) > 0
+              && BV_ISSET_ANY(pterrain->native_to))) {
+        pclass->cache.min_move_cost
+          = MIN(pclass->cache.min_move_cost,
+                pterrain->movement_cost * SINGLE_MOVE);
+      }
+    } terrain_type_iterate_end;
+
+    /* A road only makes moves cheaper into the tiles that have it.
+     * Keep the free ones apart, so that they don't spoil the bound
+     * everywhere else. */
+    extra_type_list_iterate(pclass->cache.bonus_roads, pextra) {
+      int move_cost = extra_road_get(pextra)->move_cost;
+
+      if (move_cost <= 0) {
+        BV_SET(pclass->cache.free_roads, extra_index(pextra));
+      } else {
+        pclass->cache.min_move_cost
+          = MIN(pclass->cache.min_move_cost, move_cost);
+      }
+    } extra_type_list_iterate_end;
+  }
+
   unit_class_iterate(pcharge) {
     bool subset_mover = TRUE;
 
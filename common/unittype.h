@@ -171,6 +171,12 @@ struct unit_class {
     struct extra_type_list *bonus_roads;
     struct extra_type_list *hiding_extras;
     struct unit_class_list *subset_movers;
+    /* Bonus roads that make moves into their tiles cost nothing */
+    bv_extras free_roads;
+    /* Lower bound of the cost of a single move into a tile without any
+     * of the free_roads, for any terrain and extras the ruleset has.
+     * See also MOVE_COST_IGTER. */
+    int min_move_cost;
   } cache;
 };
 
@@ -40,6 +40,8 @@ struct vision *vision_new(struct player *pplayer, struct tile *ptile)
   vision->radius_sq[V_MAIN] = -1;
   vision->radius_sq[V_INVIS] = -1;
   vision->radius_sq[V_SUBSURFACE] = -1;
+  vision->successor = nullptr;
+  vision->predecessor = nullptr;
 
   return vision;
 }
@@ -52,6 +54,8 @@ void vision_free(struct vision *vision)
   fc_assert(-1 == vision->radius_sq[V_MAIN]);
   fc_assert(-1 == vision->radius_sq[V_INVIS]);
   fc_assert(-1 == vision->radius_sq[V_SUBSURFACE]);
+  fc_assert(vision->successor == nullptr);
+  fc_assert(vision->predecessor == nullptr);
   free(vision);
 }
 
@@ -89,6 +89,12 @@ struct vision {
 
   /* The radius of the vision source. */
   v_radius_t radius_sq;
+
+  /* While a moving unit hands its sight over from the vision at the old
+   * tile to the vision at the new tile, the sight points of the tiles
+   * seen by both are counted only once. See vision_take_over_sight(). */
+  struct vision *successor;
+  struct vision *predecessor;
 };
 
 /* Initialize a vision radius array. */
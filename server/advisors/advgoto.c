@@ -37,6 +37,30 @@
 
 #include "advgoto.h"
 
+/* A path-finding map kept for reuse by adv_pf_map_get(). */
+struct adv_pf_map {
+  int unit_id;
+  struct pf_parameter parameter;
+  struct tile *goal_tile;
+  struct pf_map *pfm;
+  int users;                    /* Callers that have not released it. */
+  bool stale;                   /* The world changed since it was made. */
+};
+
+#define SPECLIST_TAG adv_pf_map
+#define SPECLIST_TYPE struct adv_pf_map
+#include "speclist.h"
+
+#define adv_pf_map_list_iterate(maplist, pmap) \
+  TYPED_LIST_ITERATE(struct adv_pf_map, maplist, pmap)
+#define adv_pf_map_list_iterate_end LIST_ITERATE_END
+
+/* Maps made since the last change of the world, or still in use. */
+static struct adv_pf_map_list *adv_pf_maps = NULL;
+
+/* Bound on the number of maps kept; the oldest unused one goes first. */
+#define ADV_PF_MAPS_MAX 16
+
 static bool adv_unit_move(struct unit *punit, struct tile *ptile);
 
 /**********************************************************************//**
@@ -609,3 +633,117 @@ void adv_avoid_risks(struct pf_parameter *parameter,
 
   risk_cost->enemy_zoc_cost = PF_TURN_FACTOR * 20;
 }
+
+/**********************************************************************//**
+  Destroy a kept path-finding map.
+**************************************************************************/
+static void adv_pf_map_destroy(struct adv_pf_map *pmap)
+{
+  adv_pf_map_list_remove(adv_pf_maps, pmap);
+  pf_map_destroy(pmap->pfm);
+  free(pmap);
+}
+
+/**********************************************************************//**
+  Return a path-finding map of punit with the given parameter, directed
+  towards goal_tile if it is not NULL (see pf_map_new_goal()). A map
+  made earlier for the same unit, parameter and goal is reused as long
+  as the world has not changed since, so the parameter callbacks must
+  depend on the world only, and the user data must not change behind
+  the same pointer.
+
+  The map may already have been searched by another caller, so only
+  query it with pf_map_move_cost(), pf_map_position() and
+  pf_map_path(), never with the iteration functions. Give it back with
+  adv_pf_map_release() instead of destroying it. Main thread only.
+**************************************************************************/
+struct pf_map *adv_pf_map_get(const struct unit *punit,
+                              const struct pf_parameter *parameter,
+                              struct tile *goal_tile)
+{
+  struct adv_pf_map *pmap;
+
+  if (adv_pf_maps == NULL) {
+    adv_pf_maps = adv_pf_map_list_new();
+  }
+
+  adv_pf_map_list_iterate(adv_pf_maps, pcached) {
+    if (!pcached->stale
+        && pcached->unit_id == punit->id
+        && pcached->goal_tile == goal_tile
+        && pf_parameter_equal(&pcached->parameter, parameter)) {
+      pcached->users++;
+
+      return pcached->pfm;
+    }
+  } adv_pf_map_list_iterate_end;
+
+  if (adv_pf_map_list_size(adv_pf_maps) >= ADV_PF_MAPS_MAX) {
+    adv_pf_map_list_iterate(adv_pf_maps, pcached) {
+      if (pcached->users == 0) {
+        adv_pf_map_destroy(pcached);
+        break;
+      }
+    } adv_pf_map_list_iterate_end;
+  }
+
+  pmap = fc_malloc(sizeof(*pmap));
+  pmap->unit_id = punit->id;
+  pmap->parameter = *parameter;
+  pmap->goal_tile = goal_tile;
+  pmap->pfm = (goal_tile != NULL ? pf_map_new_goal(parameter, goal_tile)
+               : pf_map_new(parameter));
+  pmap->users = 1;
+  pmap->stale = FALSE;
+  adv_pf_map_list_append(adv_pf_maps, pmap);
+
+  return pmap->pfm;
+}
+
+/**********************************************************************//**
+  Give back a map got from adv_pf_map_get().
+**************************************************************************/
+void adv_pf_map_release(struct pf_map *pfm)
+{
+  fc_assert_ret(adv_pf_maps != NULL);
+
+  adv_pf_map_list_iterate(adv_pf_maps, pcached) {
+    if (pcached->pfm == pfm) {
+      fc_assert(pcached->users > 0);
+      pcached->users--;
+      if (pcached->users == 0 && pcached->stale) {
+        adv_pf_map_destroy(pcached);
+      }
+
+      return;
+    }
+  } adv_pf_map_list_iterate_end;
+
+  fc_assert_msg(FALSE, "Released path-finding map was not kept.");
+}
+
+/**********************************************************************//**
+  The world changed in a way that may change paths: a unit moved,
+  appeared or disappeared, a tile or its knowledge changed, a city
+  changed hands, or a diplomatic state changed. Forget the kept maps.
+**************************************************************************/
+void adv_pf_maps_invalidate(void)
+{
+  if (adv_pf_maps == NULL) {
+    return;
+  }
+
+  adv_pf_map_list_iterate(adv_pf_maps, pcached) {
+    if (pcached->users > 0) {
+      /* Destroyed once released. */
+      pcached->stale = TRUE;
+    } else {
+      adv_pf_map_destroy(pcached);
+    }
+  } adv_pf_map_list_iterate_end;
+
+  if (adv_pf_map_list_size(adv_pf_maps) == 0) {
+    adv_pf_map_list_destroy(adv_pf_maps);
+    adv_pf_maps = NULL;
+  }
+}
@@ -43,6 +43,13 @@ void adv_avoid_risks(struct pf_parameter *parameter,
                      struct unit *punit,
                      const double fearfulness);
 
+struct pf_map *adv_pf_map_get(const struct unit *punit,
+                              const struct pf_parameter *parameter,
+                              struct tile *goal_tile)
+               fc__warn_unused_result;
+void adv_pf_map_release(struct pf_map *pfm);
+void adv_pf_maps_invalidate(void);
+
 int adv_unittype_att_rating(const struct unit_type *punittype, int veteran,
                             int moves_left, int hp);
 int adv_unit_att_rating(const struct unit *punit);
@@ -299,6 +299,102 @@ adv_want adv_workers_road_bonus(const struct civ_map *nmap,
   return bonus;
 }
 
+/**********************************************************************//**
+  Returns whether an action changing the value of a tile from
+  old_tile_value to new_tile_value, with the additional value extra,
+  can be chosen by consider_worker_action() at all.
+**************************************************************************/
+static inline bool worker_action_useful(adv_want new_tile_value,
+                                        adv_want old_tile_value,
+                                        adv_want extra)
+{
+  return new_tile_value > old_tile_value || extra > 0;
+}
+
+/**********************************************************************//**
+  Returns the additional value of building (or removing) pextra on ptile
+  that is not part of the tile output: the movement bonus of roads and
+  the effect on global warming and nuclear winter.
+**************************************************************************/
+static adv_want worker_extra_bonus(const struct civ_map *nmap,
+                                   const struct player *pplayer,
+                                   struct tile *ptile,
+                                   struct extra_type *pextra,
+                                   bool removing)
+{
+  struct road_type *proad = extra_road_get(pextra);
+  adv_want extra;
+
+  if (proad != NULL && road_provides_move_bonus(proad)) {
+    int mc_multiplier = 1;
+    int mc_divisor = 1;
+    int old_move_cost = tile_terrain(ptile)->movement_cost * SINGLE_MOVE;
+
+    /* Here 'old' means actually 'without the evaluated': In case of
+     * removal activity it's the value after the removal. */
+
+    extra_type_by_cause_iterate(EC_ROAD, pold) {
+      if (tile_has_extra(ptile, pold) && pold != pextra) {
+        struct road_type *po_road = extra_road_get(pold);
+
+        /* This ignores the fact that new road may be native to units that
+         * old road is not. */
+        if (po_road->move_cost < old_move_cost) {
+          old_move_cost = po_road->move_cost;
+        }
+      }
+    } extra_type_by_cause_iterate_end;
+
+    if (proad->move_cost < old_move_cost) {
+      if (proad->move_cost >= terrain_control.move_fragments) {
+        mc_divisor = proad->move_cost / terrain_control.move_fragments;
+      } else {
+        if (proad->move_cost == 0) {
+          mc_multiplier = 2;
+        } else {
+          mc_multiplier = 1 - proad->move_cost;
+        }
+        mc_multiplier += old_move_cost;
+      }
+    }
+
+    extra = adv_workers_road_bonus(nmap, ptile, proad)
+      * mc_multiplier / mc_divisor;
+
+  } else {
+    extra = 0;
+  }
+
+  if (extra_has_flag(pextra, EF_GLOBAL_WARMING)) {
+    extra -= pplayer->ai_common.warmth;
+  }
+  if (extra_has_flag(pextra, EF_NUCLEAR_WINTER)) {
+    extra -= pplayer->ai_common.frost;
+  }
+
+  if (removing) {
+    extra = -extra;
+  }
+
+  return extra;
+}
+
+/**********************************************************************//**
+  Returns whether building pextra requires some other extra to be
+  present on the tile first.
+**************************************************************************/
+static bool worker_extra_has_deps(const struct extra_type *pextra)
+{
+  requirement_vector_iterate(&(pextra->reqs), preq) {
+    /* Same test as in extra_deps_iterate() */
+    if (preq->source.kind == VUT_EXTRA && preq->present) {
+      return TRUE;
+    }
+  } requirement_vector_iterate_end;
+
+  return FALSE;
+}
+
 /**********************************************************************//**
   Compares the best known tile improvement action with improving ptile
   with activity act. Calculates the value of improving the tile by
@@ -342,7 +438,7 @@ static void consider_worker_action(const struct player *pplayer,
   }
 
   /* find the present value of the future benefit of this action */
-  if (improves || extra > 0) {
+  if (worker_action_useful(new_tile_value, old_tile_value, extra)) {
     if (!(*improve_worked) && !in_use) {
       /* Going to improve tile that is not yet in use.
        * Getting the best possible total for next citizen to work on is more
@@ -438,6 +534,11 @@ autoworker_tile_behavior(const struct tile *ptile,
   and the eta of this worker (if any). This information
   is used to possibly displace this previously assigned worker.
   if this array is NULL, workers are never displaced.
+
+  Most of the time goes to asking whether the worker can do an action,
+  so actions that could never be chosen are skipped before that. The
+  rest are scored as they are found: scoring is a few comparisons, and
+  gathering the actions for a separate scoring pass gained nothing.
 **************************************************************************/
 adv_want worker_evaluate_improvements(const struct civ_map *nmap,
                                       struct unit *punit,
@@ -466,7 +567,8 @@ adv_want worker_evaluate_improvements(const struct civ_map *nmap,
   pft_fill_unit_parameter(&parameter, nmap, punit);
   parameter.omniscience = !has_handicap(pplayer, H_MAP);
   parameter.get_TB = autoworker_tile_behavior;
-  pfm = pf_map_new(&parameter);
+  /* Shared with worker_evaluate_city_requests() */
+  pfm = adv_pf_map_get(punit, &parameter, NULL);
 
   city_list_iterate(pplayer->cities, pcity) {
     struct tile *pcenter = city_tile(pcity);
@@ -539,6 +641,15 @@ adv_want worker_evaluate_improvements(const struct civ_map *nmap,
                 activity_to_extra_cause(action_id_get_activity(act));
             enum extra_rmcause rmcause =
                 activity_to_extra_rmcause(action_id_get_activity(act));
+            adv_want base_value
+              = adv_city_worker_act_get(pcity, cindex,
+                                        action_id_get_activity(act));
+
+            if (base_value < 0
+                || !worker_action_useful(base_value, oldv, 0.0)) {
+              /* Not worth finding out whether the worker could do it. */
+              continue;
+            }
 
             if (cause != EC_NONE) {
               target = next_extra_for_tile(ptile, cause, pplayer,
@@ -548,18 +659,12 @@ adv_want worker_evaluate_improvements(const struct civ_map *nmap,
                                           punit);
             }
 
-            if (adv_city_worker_act_get(pcity, cindex,
-                                        action_id_get_activity(act)) >= 0
-                && action_prob_possible(
+            if (action_prob_possible(
                   action_speculate_unit_on_tile(nmap, act,
                                                 punit, unit_home(punit),
                                                 ptile,
                                                 parameter.omniscience,
                                                 ptile, target))) {
-              adv_want base_value
-                = adv_city_worker_act_get(pcity, cindex,
-                                          action_id_get_activity(act));
-
               turns = pos.turn
                   + get_turns_for_activity_at(punit,
                                               action_id_get_activity(act),
@@ -585,8 +690,29 @@ adv_want worker_evaluate_improvements(const struct civ_map *nmap,
             enum unit_activity act = ACTIVITY_LAST;
             enum unit_activity eval_act = ACTIVITY_LAST;
             adv_want base_value;
+            adv_want extra;
             bool removing = tile_has_extra(ptile, pextra);
 
+            if (removing) {
+              base_value = adv_city_worker_rmextra_get(pcity, cindex, pextra);
+            } else {
+              base_value = adv_city_worker_extra_get(pcity, cindex, pextra);
+            }
+
+            if (base_value < 0) {
+              continue;
+            }
+
+            extra = worker_extra_bonus(nmap, pplayer, ptile, pextra,
+                                       removing);
+
+            if (!worker_action_useful(base_value, oldv, extra)
+                && (removing || !worker_extra_has_deps(pextra))) {
+              /* Neither doing it nor building a dependency for it first
+               * could be chosen, so don't ask whether the worker could. */
+              continue;
+            }
+
             if (removing) {
               aw_rmextra_action_iterate(try_act) {
                 struct action *taction = action_by_number(try_act);
@@ -632,167 +758,103 @@ adv_want worker_evaluate_improvements(const struct civ_map *nmap,
               continue;
             }
 
-            if (removing) {
-              base_value = adv_city_worker_rmextra_get(pcity, cindex, pextra);
-            } else {
-              base_value = adv_city_worker_extra_get(pcity, cindex, pextra);
+            turns = pos.turn + get_turns_for_activity_at(punit, eval_act,
+                                                         ptile, pextra);
+            if (pos.moves_left == 0) {
+              /* We need moves left to begin activity immediately. */
+              turns++;
             }
 
-            if (base_value >= 0) {
-              adv_want extra;
-              struct road_type *proad;
-
-              turns = pos.turn + get_turns_for_activity_at(punit, eval_act,
-                                                           ptile, pextra);
-              if (pos.moves_left == 0) {
-                /* We need moves left to begin activity immediately. */
-                turns++;
-              }
-
-              proad = extra_road_get(pextra);
-
-              if (proad != NULL && road_provides_move_bonus(proad)) {
-                int mc_multiplier = 1;
-                int mc_divisor = 1;
-                int old_move_cost = tile_terrain(ptile)->movement_cost * SINGLE_MOVE;
+            if (act != ACTIVITY_LAST) {
+              consider_worker_action(pplayer, act, pextra, extra, base_value,
+                                     oldv, in_use, turns,
+                                     &best_newv, &best_oldv, &best_extra,
+                                     &improve_worked,
+                                     &best_delay, best_act, best_target,
+                                     best_tile, ptile);
+            } else {
+              fc_assert(!removing);
+
+              road_deps_iterate(&(pextra->reqs), pdep) {
+                struct extra_type *dep_tgt;
+
+                dep_tgt = road_extra_get(pdep);
+
+                if (action_prob_possible(
+                      action_speculate_unit_on_tile(nmap, ACTION_ROAD,
+                                                    punit, unit_home(punit), ptile,
+                                                    parameter.omniscience,
+                                                    ptile, dep_tgt))) {
+                  /* Consider building dependency road for later upgrade to target extra.
+                   * Here we set value to be sum of dependency
+                   * road and target extra values, which increases want, and turns is sum
+                   * of dependency and target build turns, which decreases want. This can
+                   * result in either bigger or lesser want than when checking dependency
+                   * road for the sake of itself when its turn in extra_type_iterate() is. */
+                  int dep_turns
+                    = turns + get_turns_for_activity_at(punit,
+                                                        ACTIVITY_GEN_ROAD,
+                                                        ptile, dep_tgt);
+                  adv_want dep_value
+                    = base_value + adv_city_worker_extra_get(pcity, cindex,
+                                                             dep_tgt);
+
+                  consider_worker_action(pplayer, ACTIVITY_GEN_ROAD,
+                                         dep_tgt, extra, dep_value,
+                                         oldv, in_use, dep_turns,
+                                         &best_newv, &best_oldv, &best_extra,
+                                         &improve_worked,
+                                         &best_delay, best_act, best_target,
+                                         best_tile, ptile);
+                }
+              } road_deps_iterate_end;
 
-                /* Here 'old' means actually 'without the evaluated': In case of
-                 * removal activity it's the value after the removal. */
+              extra_deps_iterate(&(pextra->reqs), pdep) {
+                /* Roads handled above already */
+                if (!is_extra_caused_by(pdep, EC_ROAD)) {
+                  enum unit_activity eval_dep_act = ACTIVITY_LAST;
+                  action_id eval_dep_action;
 
-                extra_type_by_cause_iterate(EC_ROAD, pold) {
-                  if (tile_has_extra(ptile, pold) && pold != pextra) {
-                    struct road_type *po_road = extra_road_get(pold);
+                  aw_extra_action_iterate(try_act) {
+                    struct action *taction = action_by_number(try_act);
 
-                    /* This ignores the fact that new road may be native to units that
-                     * old road is not. */
-                    if (po_road->move_cost < old_move_cost) {
-                      old_move_cost = po_road->move_cost;
+                    if (is_extra_caused_by_action(pdep, taction)) {
+                      eval_dep_action = try_act;
+                      eval_dep_act = action_id_get_activity(try_act);
+                      break;
                     }
-                  }
-                } extra_type_by_cause_iterate_end;
-
-                if (proad->move_cost < old_move_cost) {
-                  if (proad->move_cost >= terrain_control.move_fragments) {
-                    mc_divisor = proad->move_cost / terrain_control.move_fragments;
-                  } else {
-                    if (proad->move_cost == 0) {
-                      mc_multiplier = 2;
-                    } else {
-                      mc_multiplier = 1 - proad->move_cost;
+                  } aw_extra_action_iterate_end;
+
+                  if (eval_dep_act != ACTIVITY_LAST) {
+                    if (action_prob_possible(
+                          action_speculate_unit_on_tile(nmap, eval_dep_action,
+                                                        punit, unit_home(punit), ptile,
+                                                        parameter.omniscience,
+                                                        ptile, pdep))) {
+                      /* Consider building dependency extra for later upgrade to
+                       * target extra. See similar road implementation above for
+                       * extended commentary. */
+                      int dep_turns
+                        = turns + get_turns_for_activity_at(punit,
+                                                            eval_dep_act,
+                                                            ptile, pdep);
+                      adv_want dep_value
+                        = base_value + adv_city_worker_extra_get(pcity,
+                                                                 cindex,
+                                                                 pdep);
+
+                      consider_worker_action(pplayer, eval_dep_act, pdep,
+                                             0.0, dep_value, oldv, in_use,
+                                             dep_turns, &best_newv,
+                                             &best_oldv,
+                                             &best_extra, &improve_worked,
+                                             &best_delay,
+                                             best_act, best_target,
+                                             best_tile, ptile);
                     }
-                    mc_multiplier += old_move_cost;
                   }
                 }
-
-                extra = adv_workers_road_bonus(nmap, ptile, proad)
-                  * mc_multiplier / mc_divisor;
-
-              } else {
-                extra = 0;
-              }
-
-              if (extra_has_flag(pextra, EF_GLOBAL_WARMING)) {
-                extra -= pplayer->ai_common.warmth;
-              }
-              if (extra_has_flag(pextra, EF_NUCLEAR_WINTER)) {
-                extra -= pplayer->ai_common.frost;
-              }
-
-              if (removing) {
-                extra = -extra;
-              }
-
-              if (act != ACTIVITY_LAST) {
-                consider_worker_action(pplayer, act, pextra, extra, base_value,
-                                       oldv, in_use, turns,
-                                       &best_newv, &best_oldv, &best_extra,
-                                       &improve_worked,
-                                       &best_delay, best_act, best_target,
-                                       best_tile, ptile);
-              } else {
-                fc_assert(!removing);
-
-                road_deps_iterate(&(pextra->reqs), pdep) {
-                  struct extra_type *dep_tgt;
-
-                  dep_tgt = road_extra_get(pdep);
-
-                  if (action_prob_possible(
-                        action_speculate_unit_on_tile(nmap, ACTION_ROAD,
-                                                      punit, unit_home(punit), ptile,
-                                                      parameter.omniscience,
-                                                      ptile, dep_tgt))) {
-                    /* Consider building dependency road for later upgrade to target extra.
-                     * Here we set value to be sum of dependency
-                     * road and target extra values, which increases want, and turns is sum
-                     * of dependency and target build turns, which decreases want. This can
-                     * result in either bigger or lesser want than when checking dependency
-                     * road for the sake of itself when its turn in extra_type_iterate() is. */
-                    int dep_turns
-                      = turns + get_turns_for_activity_at(punit,
-                                                          ACTIVITY_GEN_ROAD,
-                                                          ptile, dep_tgt);
-                    adv_want dep_value
-                      = base_value + adv_city_worker_extra_get(pcity, cindex,
-                                                               dep_tgt);
-
-                    consider_worker_action(pplayer, ACTIVITY_GEN_ROAD,
-                                           dep_tgt, extra, dep_value,
-                                           oldv, in_use, dep_turns,
-                                           &best_newv, &best_oldv, &best_extra,
-                                           &improve_worked,
-                                           &best_delay, best_act, best_target,
-                                           best_tile, ptile);
-                  }
-                } road_deps_iterate_end;
-
-                extra_deps_iterate(&(pextra->reqs), pdep) {
-                  /* Roads handled above already */
-                  if (!is_extra_caused_by(pdep, EC_ROAD)) {
-                    enum unit_activity eval_dep_act = ACTIVITY_LAST;
-                    action_id eval_dep_action;
-
-                    aw_extra_action_iterate(try_act) {
-                      struct action *taction = action_by_number(try_act);
-
-                      if (is_extra_caused_by_action(pdep, taction)) {
-                        eval_dep_action = try_act;
-                        eval_dep_act = action_id_get_activity(try_act);
-                        break;
-                      }
-                    } aw_extra_action_iterate_end;
-
-                    if (eval_dep_act != ACTIVITY_LAST) {
-                      if (action_prob_possible(
-                            action_speculate_unit_on_tile(nmap, eval_dep_action,
-                                                          punit, unit_home(punit), ptile,
-                                                          parameter.omniscience,
-                                                          ptile, pdep))) {
-                        /* Consider building dependency extra for later upgrade to
-                         * target extra. See similar road implementation above for
-                         * extended commentary. */
-                        int dep_turns
-                          = turns + get_turns_for_activity_at(punit,
-                                                              eval_dep_act,
-                                                              ptile, pdep);
-                        adv_want dep_value
-                          = base_value + adv_city_worker_extra_get(pcity,
-                                                                   cindex,
-                                                                   pdep);
-
-                        consider_worker_action(pplayer, eval_dep_act, pdep,
-                                               0.0, dep_value, oldv, in_use,
-                                               dep_turns, &best_newv,
-                                               &best_oldv,
-                                               &best_extra, &improve_worked,
-                                               &best_delay,
-                                               best_act, best_target,
-                                               best_tile, ptile);
-                      }
-                    }
-                  }
-                } extra_deps_iterate_end;
-              }
+              } extra_deps_iterate_end;
             }
           } extra_type_iterate_end;
         } /* endif: can we arrive sooner than current worker, if any? */
@@ -829,7 +891,7 @@ adv_want worker_evaluate_improvements(const struct civ_map *nmap,
     *ppath = *best_tile ? pf_map_path(pfm, *best_tile) : NULL;
   }
 
-  pf_map_destroy(pfm);
+  adv_pf_map_release(pfm);
 
   return best_newv;
 }
@@ -855,7 +917,7 @@ struct city *worker_evaluate_city_requests(struct unit *punit,
   pft_fill_unit_parameter(&parameter, nmap, punit);
   parameter.omniscience = !has_handicap(pplayer, H_MAP);
   parameter.get_TB = autoworker_tile_behavior;
-  pfm = pf_map_new(&parameter);
+  pfm = adv_pf_map_get(punit, &parameter, NULL);
 
   /* Have nearby cities requests? */
   city_list_iterate(pplayer->cities, pcity) {
@@ -922,7 +984,7 @@ struct city *worker_evaluate_city_requests(struct unit *punit,
     *ppath = best ? pf_map_path(pfm, best->ptile) : NULL;
   }
 
-  pf_map_destroy(pfm);
+  adv_pf_map_release(pfm);
 
   return taskcity;
 }
@@ -1104,7 +1166,7 @@ bool auto_worker_setup_work(const struct civ_map *nmap,
       pft_fill_unit_parameter(&parameter, nmap, punit);
       parameter.omniscience = !has_handicap(pplayer, H_MAP);
       parameter.get_TB = autoworker_tile_behavior;
-      pfm = pf_map_new(&parameter);
+      pfm = pf_map_new_goal(&parameter, best_tile);
       *ppath = pf_map_path(pfm, best_tile);
     }
 
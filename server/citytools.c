@@ -35,6 +35,7 @@
 #include "city.h"
 #include "counters.h"
 #include "culture.h"
+#include "effects.h"
 #include "events.h"
 #include "game.h"
 #include "government.h"
@@ -1165,6 +1166,7 @@ bool transfer_city(struct player *ptaker, struct city *pcity,
       }
       /* Note: internal turn here, next city_built_iterate(). */
       pcity->built[improvement_index(pimprove)].turn = game.info.turn; /*I_ACTIVE*/
+      bonus_cache_invalidate();
     }
   } city_built_iterate_end;
 
@@ -1201,6 +1203,7 @@ bool transfer_city(struct player *ptaker, struct city *pcity,
   pcity->acquire_t = CACQ_CONQUEST;
   map_claim_ownership(pcenter, ptaker, pcenter, TRUE);
   city_list_prepend(ptaker->cities, pcity);
+  game.effects_epoch++;
 
   if (could_see_unit != nullptr) {
     /* Hide/reveal units. Do it after vision have been given to taker, city
@@ -1420,6 +1423,8 @@ bool transfer_city(struct player *ptaker, struct city *pcity,
 
   sync_cities();
 
+  adv_pf_maps_invalidate();
+
   CALL_FUNC_EACH_AI(city_info, pcity);
 
   return city_remains;
@@ -1607,6 +1612,7 @@ void create_city(struct player *pplayer, struct tile *ptile,
   vision_reveal_tiles(pcity->server.vision, game.server.vision_reveal_tiles);
   city_refresh_vision(pcity);
   city_list_prepend(pplayer->cities, pcity);
+  game.effects_epoch++;
 
   /* This is dependent on the current vision, so must be done after
    * vision is prepared and before arranging workers. */
@@ -1666,6 +1672,8 @@ void create_city(struct player *pplayer, struct tile *ptile,
 
   sanity_check_city(pcity);
 
+  adv_pf_maps_invalidate();
+
   script_server_signal_emit("city_built", pcity);
 
   CALL_FUNC_EACH_AI(city_created, pcity);
@@ -1728,6 +1736,8 @@ void remove_city(struct city *pcity)
   CALL_PLR_AI_FUNC(city_lost, powner, powner, pcity);
   CALL_FUNC_EACH_AI(city_destroyed, pcity);
 
+  game.effects_epoch++;
+
   BV_CLR_ALL(had_small_wonders);
   city_built_iterate(pcity, pimprove) {
     building_removed(pcity, pimprove, "city_destroyed", nullptr);
@@ -1967,6 +1977,8 @@ void remove_city(struct city *pcity)
 
   sync_cities();
 
+  adv_pf_maps_invalidate();
+
   /* At least sentried helicopters need to go idle, maybe others.
    * In alien ruleset, city center might have provided water source
    * for adjacent tile. */
@@ -3474,22 +3486,43 @@ void refresh_player_cities_vision(struct player *pplayer)
 }
 
 /************************************************************************//**
-  Updates the squared city radius. Returns if the radius is changed.
+  Returns the squared city radius city_map_update_radius_sq() would set
+  for the city. A change of the squared radius that doesn't change
+  the number of city tiles is not made, so then the current one is
+  returned.
 ****************************************************************************/
-bool city_map_update_radius_sq(struct city *pcity)
+int city_map_radius_sq_wanted(const struct city *pcity)
 {
-  fc_assert_ret_val(pcity != nullptr, FALSE);
-
-  int city_tiles_old, city_tiles_new;
   int city_radius_sq_old = city_map_radius_sq_get(pcity);
   int city_radius_sq_new = game.info.init_city_radius_sq
                            + get_city_bonus(pcity, EFT_CITY_RADIUS_SQ);
-  const struct civ_map *nmap = &(wld.map);
 
   /* Check minimum / maximum allowed city radii */
   city_radius_sq_new = CLIP(CITY_MAP_MIN_RADIUS_SQ, city_radius_sq_new,
                             CITY_MAP_MAX_RADIUS_SQ);
 
+  if (city_map_tiles(city_radius_sq_new)
+      == city_map_tiles(city_radius_sq_old)) {
+    /* A change of the squared city radius but no change of the number of
+     * city tiles */
+    return city_radius_sq_old;
+  }
+
+  return city_radius_sq_new;
+}
+
+/************************************************************************//**
+  Updates the squared city radius. Returns if the radius is changed.
+****************************************************************************/
+bool city_map_update_radius_sq(struct city *pcity)
+{
+  fc_assert_ret_val(pcity != nullptr, FALSE);
+
+  int city_tiles_old, city_tiles_new;
+  int city_radius_sq_old = city_map_radius_sq_get(pcity);
+  int city_radius_sq_new = city_map_radius_sq_wanted(pcity);
+  const struct civ_map *nmap = &(wld.map);
+
   if (city_radius_sq_new == city_radius_sq_old) {
     /* No change */
     return FALSE;
@@ -3499,12 +3532,6 @@ bool city_map_update_radius_sq(struct city *pcity)
   city_tiles_old = city_map_tiles(city_radius_sq_old);
   city_tiles_new = city_map_tiles(city_radius_sq_new);
 
-  if (city_tiles_old == city_tiles_new) {
-    /* A change of the squared city radius but no change of the number of
-     * city tiles */
-    return FALSE;
-  }
-
   log_debug("[%s (%d)] city_map_radius_sq: %d => %d", city_name_get(pcity),
             pcity->id, city_radius_sq_old, city_radius_sq_new);
 
@@ -25,6 +25,7 @@
 
 /* utility */
 #include "fcintl.h"
+#include "fcparallel.h"
 #include "log.h"
 #include "mem.h"
 #include "rand.h"
@@ -45,6 +46,7 @@
 #include "culture.h"
 #include "events.h"
 #include "disaster.h"
+#include "effects.h"
 #include "game.h"
 #include "government.h"
 #include "map.h"
@@ -96,6 +98,27 @@ static struct unit_list *uk_rem_gold = nullptr;
 static void check_pollution(struct city *pcity);
 static void city_populate(struct city *pcity, struct player *nationality);
 
+/* Snapshot of the game state the effect dependent values of a city are
+ * calculated from. Compared byte by byte. */
+struct city_stamp {
+  unsigned char *data;
+  size_t len;
+  size_t size;
+};
+
+/* Effect dependent refresh data of a city, calculated in advance by
+ * worker threads before the cities of a player get their turn
+ * processed. */
+struct city_turn_precalc {
+  struct city *pcity;
+  bool usable;
+  struct city_precalc data;
+  struct city_stamp stamp;
+};
+
+static bool city_refresh_precalc(struct city *pcity,
+                                 const struct city_precalc *pre);
+
 static bool worklist_change_build_target(struct player *pplayer,
                                          struct city *pcity);
 
@@ -143,7 +166,8 @@ static bool city_balance_treasury_units(struct city *pcity);
 static bool disband_city(struct city *pcity);
 
 static void define_orig_production_values(struct city *pcity);
-static void update_city_activity(struct city *pcity);
+static void update_city_activity(struct city *pcity,
+                                 struct city_turn_precalc *pre);
 static void nullify_caravan_and_disband_plus(struct city *pcity);
 static bool city_illness_check(const struct city * pcity);
 
@@ -157,6 +181,17 @@ static bool check_city_migrations_player(const struct player *pplayer);
   city radius has changed.
 **************************************************************************/
 bool city_refresh(struct city *pcity)
+{
+  return city_refresh_precalc(pcity, nullptr);
+}
+
+/**********************************************************************//**
+  city_refresh() using effect dependent values calculated in advance
+  when 'pre' is given. The values are used only if the city radius
+  stays the same.
+**************************************************************************/
+static bool city_refresh_precalc(struct city *pcity,
+                                 const struct city_precalc *pre)
 {
   bool retval;
   const struct civ_map *nmap = &(wld.map);
@@ -165,7 +200,11 @@ bool city_refresh(struct city *pcity)
 
   retval = city_map_update_radius_sq(pcity);
   city_units_upkeep(pcity); /* Update unit upkeep */
-  city_refresh_from_main_map(nmap, pcity, nullptr);
+  if (pre != nullptr && pre->radius_sq == city_map_radius_sq_get(pcity)) {
+    city_refresh_from_precalc(nmap, pcity, pre);
+  } else {
+    city_refresh_from_main_map(nmap, pcity, nullptr);
+  }
   city_style_refresh(pcity);
 
   if (retval) {
@@ -398,7 +437,6 @@ void auto_arrange_workers(struct city *pcity)
   city_refresh(pcity);
 
   sanity_check_city(pcity);
-  cm_clear_cache(pcity);
 
   if (pcity->cm_parameter) {
     pcmp = pcity->cm_parameter;
@@ -597,6 +635,248 @@ void send_city_turn_notifications(struct connection *pconn)
   }
 }
 
+/**********************************************************************//**
+  Append 'len' bytes to the stamp.
+**************************************************************************/
+static void city_stamp_add(struct city_stamp *stamp, const void *data,
+                           size_t len)
+{
+  if (stamp->len + len > stamp->size) {
+    stamp->size = MAX(stamp->size * 2, stamp->len + len);
+    stamp->data = fc_realloc(stamp->data, stamp->size);
+  }
+  memcpy(stamp->data + stamp->len, data, len);
+  stamp->len += len;
+}
+
+#define city_stamp_add_value(_stamp, _value) \
+  city_stamp_add(_stamp, &(_value), sizeof(_value))
+
+/**********************************************************************//**
+  Record everything the effect dependent values of the city (bonus[],
+  tile_cache[] and the squared radius) can depend on: the city itself,
+  the tiles of the city area and the ones adjacent to them, including
+  the types of the units on them, and the global effects epoch covering
+  the rest.
+  Only reads game state.
+**************************************************************************/
+static void city_stamp_make(const struct civ_map *nmap,
+                            const struct city *pcity,
+                            struct city_stamp *stamp)
+{
+  const struct player *owner = city_owner(pcity);
+  citizens size = city_size_get(pcity);
+  int radius_sq = city_map_radius_sq_get(pcity);
+  int range = (int) sqrt((double) radius_sq) + 1;
+
+  stamp->len = 0;
+
+  city_stamp_add_value(stamp, game.effects_epoch);
+  city_stamp_add_value(stamp, owner);
+  city_stamp_add_value(stamp, size);
+  city_stamp_add_value(stamp, radius_sq);
+  city_stamp_add_value(stamp, pcity->history);
+  city_stamp_add_value(stamp, pcity->was_happy);
+  city_stamp_add_value(stamp, pcity->rapture);
+  city_stamp_add_value(stamp, pcity->style);
+  city_stamp_add_value(stamp, pcity->capital);
+  city_stamp_add_value(stamp, pcity->original);
+  city_stamp_add_value(stamp, pcity->anarchy);
+  city_stamp_add_value(stamp, pcity->had_famine);
+  city_stamp_add(stamp, pcity->specialists, sizeof(pcity->specialists));
+  city_stamp_add(stamp, pcity->counter_values,
+                 counters_get_city_counters_count()
+                 * sizeof(*pcity->counter_values));
+
+  city_built_iterate(pcity, pimprove) {
+    int idx = improvement_index(pimprove);
+
+    city_stamp_add_value(stamp, idx);
+  } city_built_iterate_end;
+
+  citizens_iterate(pcity, pslot, nationality) {
+    int idx = player_slot_index(pslot);
+
+    city_stamp_add_value(stamp, idx);
+    city_stamp_add_value(stamp, nationality);
+  } citizens_iterate_end;
+
+  square_iterate(nmap, city_tile(pcity), range, ptile) {
+    const struct terrain *pterrain = tile_terrain(ptile);
+    const struct extra_type *resource = tile_resource(ptile);
+    const struct player *tile_own = tile_owner(ptile);
+    const struct player *extras_own = extra_owner(ptile);
+    const struct city *worked = tile_worked(ptile);
+    Continent_id continent = tile_continent(ptile);
+    int units = unit_list_size(ptile->units);
+
+    city_stamp_add_value(stamp, pterrain);
+    city_stamp_add_value(stamp, resource);
+    city_stamp_add_value(stamp, ptile->extras);
+    city_stamp_add_value(stamp, tile_own);
+    city_stamp_add_value(stamp, extras_own);
+    city_stamp_add_value(stamp, worked);
+    city_stamp_add_value(stamp, continent);
+    city_stamp_add_value(stamp, units);
+    unit_list_iterate(ptile->units, punit) {
+      const struct unit_type *ptype = unit_type_get(punit);
+
+      city_stamp_add_value(stamp, ptype);
+    } unit_list_iterate_end;
+  } square_iterate_end;
+}
+
+/**********************************************************************//**
+  Worker thread callback calculating the effect dependent values of one
+  city in advance.
+**************************************************************************/
+static void city_turn_precalc_cb(int idx, void *data)
+{
+  struct city_turn_precalc *pre = &((struct city_turn_precalc *) data)[idx];
+  const struct civ_map *nmap = &(wld.map);
+  int radius_sq = city_map_radius_sq_wanted(pre->pcity);
+
+  if (radius_sq != city_map_radius_sq_get(pre->pcity)) {
+    /* Workers get rearranged before the refresh. */
+    pre->usable = FALSE;
+    return;
+  }
+
+  city_precalc_calc(nmap, pre->pcity, radius_sq, &pre->data);
+  city_stamp_make(nmap, pre->pcity, &pre->stamp);
+  pre->usable = TRUE;
+}
+
+/**********************************************************************//**
+  Does the effect make city effect values calculated in advance depend on
+  the turn processing of other cities in ways the city stamp does not
+  notice?
+**************************************************************************/
+static bool effect_blocks_precalc(struct effect *peffect, void *data)
+{
+  /* Effects city_precalc_calc() evaluates */
+  static const enum effect_type precalc_effects[] = {
+    EFT_CITY_RADIUS_SQ,
+    EFT_OUTPUT_BONUS,
+    EFT_OUTPUT_BONUS_2,
+    EFT_OUTPUT_BONUS_ABSOLUTE,
+    EFT_MINING_PCT,
+    EFT_IRRIGATION_PCT,
+    EFT_OUTPUT_ADD_TILE,
+    EFT_OUTPUT_PENALTY_TILE,
+    EFT_OUTPUT_INC_TILE,
+    EFT_OUTPUT_INC_TILE_CELEBRATE,
+    EFT_OUTPUT_PER_TILE,
+    EFT_OUTPUT_TILE_PUNISH_PCT
+  };
+  bool evaluated = FALSE;
+  int i;
+
+  for (i = 0; i < ARRAY_SIZE(precalc_effects); i++) {
+    if (peffect->type == precalc_effects[i]) {
+      evaluated = TRUE;
+      break;
+    }
+  }
+
+  if (!evaluated) {
+    return TRUE;
+  }
+
+  requirement_vector_iterate(&peffect->reqs, preq) {
+    if (preq->source.kind == VUT_MINCULTURE
+        && preq->range > REQ_RANGE_CITY) {
+      /* Player culture grows as each city gains history. */
+      *((bool *) data) = TRUE;
+
+      return FALSE;
+    }
+  } requirement_vector_iterate_end;
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Return the precalculated values of the city if they are still valid,
+  i.e., if nothing they were calculated from has changed since.
+**************************************************************************/
+static const struct city_precalc *
+city_turn_precalc_get(struct city_turn_precalc *pre)
+{
+  struct city_stamp now = { nullptr, 0, 0 };
+  bool valid;
+
+  if (pre == nullptr || !pre->usable) {
+    return nullptr;
+  }
+
+  city_stamp_make(&(wld.map), pre->pcity, &now);
+  valid = (now.len == pre->stamp.len
+           && memcmp(now.data, pre->stamp.data, now.len) == 0);
+  free(now.data);
+
+  return valid ? &pre->data : nullptr;
+}
+
+/**********************************************************************//**
+  Calculate the effect dependent refresh values of the cities with
+  srvarg.threads worker threads. Cities with trade routes are left out,
+  as their values depend on the partner cities processed in between.
+  Returns nullptr when there is nothing to gain.
+**************************************************************************/
+static struct city_turn_precalc *city_turn_precalc_new(struct city **cities,
+                                                       int n)
+{
+  struct city_turn_precalc *pres;
+  bool blocked = FALSE;
+  int i;
+
+  if (srvarg.threads <= 1 || n <= 1) {
+    return nullptr;
+  }
+
+  iterate_effect_cache(effect_blocks_precalc, &blocked);
+  if (blocked) {
+    return nullptr;
+  }
+
+  pres = fc_calloc(n, sizeof(*pres));
+  for (i = 0; i < n; i++) {
+    pres[i].pcity = cities[i];
+    city_precalc_init(&pres[i].data);
+  }
+
+  /* Only read access from the workers, results go to separate entries,
+   * so calculation order does not matter. */
+  fc_parallel_for(n, srvarg.threads, city_turn_precalc_cb, pres);
+
+  for (i = 0; i < n; i++) {
+    if (trade_route_list_size(cities[i]->routes) > 0) {
+      pres[i].usable = FALSE;
+    }
+  }
+
+  return pres;
+}
+
+/**********************************************************************//**
+  Free precalculated city values.
+**************************************************************************/
+static void city_turn_precalc_destroy(struct city_turn_precalc *pres, int n)
+{
+  int i;
+
+  if (pres == nullptr) {
+    return;
+  }
+
+  for (i = 0; i < n; i++) {
+    city_precalc_free(&pres[i].data);
+    free(pres[i].stamp.data);
+  }
+  free(pres);
+}
+
 /**********************************************************************//**
   Update all cities of one nation (costs for buildings, unit upkeep, ...).
 **************************************************************************/
@@ -610,6 +890,8 @@ void update_city_activities(struct player *pplayer)
 
   if (n > 0) {
     struct city *cities[n];
+    struct city_turn_precalc *pres;
+    struct city_turn_precalc *pre[n];
     int i = 0, r;
 
     city_list_iterate(pplayer->cities, pcity) {
@@ -661,14 +943,26 @@ void update_city_activities(struct player *pplayer)
      *                     the treasury is not balance units and buildings
      *                     are sold. */
 
+    /* Effect evaluation for the first refresh of each city can be done
+     * in parallel. The cities are still processed one by one in the
+     * random order below, with values that turned stale in the meantime
+     * recalculated, so the result is the same as without. */
+    pres = city_turn_precalc_new(cities, n);
+    for (r = 0; r < n; r++) {
+      pre[r] = pres != nullptr ? &pres[r] : nullptr;
+    }
+
     /* Iterate over cities in a random order. */
     while (i > 0) {
       r = fc_rand(i);
       /* update unit upkeep */
       city_units_upkeep(cities[r]);
-      update_city_activity(cities[r]);
+      update_city_activity(cities[r], pre[r]);
       cities[r] = cities[--i];
+      pre[r] = pre[i];
     }
+
+    city_turn_precalc_destroy(pres, n);
   }
 }
 
@@ -3743,8 +4037,11 @@ void nullify_prechange_production(struct city *pcity)
 
 /**********************************************************************//**
   Called every turn, at end of turn, for every city.
+  'pre' holds values calculated in advance for the first refresh,
+  if any.
 **************************************************************************/
-static void update_city_activity(struct city *pcity)
+static void update_city_activity(struct city *pcity,
+                                 struct city_turn_precalc *pre)
 {
   struct player *pplayer;
   struct government *gov;
@@ -3760,7 +4057,7 @@ static void update_city_activity(struct city *pcity)
   is_happy = city_happy(pcity);
   is_celebrating = city_celebrating(pcity);
 
-  if (city_refresh(pcity)) {
+  if (city_refresh_precalc(pcity, city_turn_precalc_get(pre))) {
     auto_arrange_workers(pcity);
   }
 
@@ -47,6 +47,9 @@
 #include "techtools.h"
 #include "unittools.h"
 
+/* server/advisors */
+#include "advgoto.h"
+
 /* server/scripting */
 #include "script_server.h"
 
@@ -137,6 +140,9 @@ void set_diplstate_type(struct player_diplstate *state1,
   state2->type = type;
   state1->max_state = max;
   state2->max_state = max;
+
+  game.effects_epoch++;
+  adv_pf_maps_invalidate();
 }
 
 /**********************************************************************//**
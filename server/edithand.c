@@ -1156,6 +1156,7 @@ void handle_edit_player(struct connection *pc,
       if (turns >= 0) {
         pplayer->government = gov;
         pplayer->revolution_finishes = game.info.turn + turns;
+        game.effects_epoch++;
       }
     }
 
@@ -29,6 +29,7 @@
 #include "nation.h"
 #include "rand.h"
 #include "shared.h"
+#include "timing.h"
 
 /* common */
 #include "game.h"
@@ -53,6 +54,9 @@ static void mapgenerator4(void);
 static bool map_generate_fair_islands(void);
 static void adjust_terrain_param(void);
 
+/* Times the stages of map_fractal_generate(), see mapgen_stage_done() */
+static struct timer *mapgen_stage_timer = nullptr;
+
 /* Common variables for generator 2, 3 and 4 */
 struct gen234_state {
   int isleindex, n, e, s, w;
@@ -1045,6 +1049,22 @@ static void make_rivers(void)
   destroy_placed_map();
 }
 
+/**********************************************************************//**
+  Log how long the map generation stage that just ended took, and start
+  timing the next one.
+**************************************************************************/
+static void mapgen_stage_done(const char *stage)
+{
+  if (mapgen_stage_timer == nullptr) {
+    return;
+  }
+
+  log_verbose("Map generation: %-18s %8.3f seconds", stage,
+              timer_read_seconds(mapgen_stage_timer));
+  timer_clear(mapgen_stage_timer);
+  timer_start(mapgen_stage_timer);
+}
+
 /**********************************************************************//**
   Make land simply does it all based on a generated heightmap
   1) with map.server.landpercent it generates a ocean/unknown map
@@ -1127,11 +1147,13 @@ static void make_land(void)
   if (HAS_POLES) {
     renormalize_hmap_poles();
   }
+  mapgen_stage_done("oceans");
 
   /* Destroy old dummy temperature map ... */
   destroy_tmap();
   /* ... and create a real temperature map (needs hmap and oceans) */
   create_tmap(TRUE);
+  mapgen_stage_done("temperature map");
 
   if (HAS_POLES) { /* This is a hack to terrains set with not frizzed oceans*/
     make_polar_land(); /* Make extra land at poles*/
@@ -1146,8 +1168,10 @@ static void make_land(void)
   }
   make_terrains(); /* Place all except mountains and hill */
   destroy_placed_map();
+  mapgen_stage_done("terrains");
 
   make_rivers(); /* Use a new placed_map. Destroy older before call */
+  mapgen_stage_done("rivers");
 }
 
 /**********************************************************************//**
@@ -1293,6 +1317,10 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
 
   fc_srand(wld.map.server.seed);
 
+  mapgen_stage_timer = timer_renew(mapgen_stage_timer, TIMER_USER,
+                                   TIMER_ACTIVE, "mapgen stage");
+  timer_start(mapgen_stage_timer);
+
   /* Don't generate tiles with mapgen == MAPGEN_SCENARIO as we've loaded *
      them from file.
      Also, don't delete (the handcrafted!) tiny islands in a scenario */
@@ -1311,6 +1339,7 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
 
     /* Create a temperature map */
     create_tmap(FALSE);
+    mapgen_stage_done("topology");
 
     if (MAPGEN_FAIR == wld.map.server.generator
         && !map_generate_fair_islands()) {
@@ -1356,6 +1385,7 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
     if (MAPGEN_FRACTURE == wld.map.server.generator) {
       make_fracture_map();
     }
+    mapgen_stage_done("height map");
 
     /* If hmap only generator make anything else */
     if (MAPGEN_RANDOM == wld.map.server.generator
@@ -1380,6 +1410,7 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
     if (wld.map.num_oceans > 0) {
       regenerate_lakes();
     }
+    mapgen_stage_done("continents");
 
   } else {
     assign_continent_numbers();
@@ -1398,6 +1429,7 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
   if (!wld.map.server.have_huts) {
     make_huts(wld.map.server.huts * map_num_tiles() / 1000);
   }
+  mapgen_stage_done("resources and huts");
 
   /* Restore previous random state: */
   fc_rand_set_state(rstate);
@@ -1472,10 +1504,15 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
         default:
           log_error(_("The server couldn't allocate starting positions."));
           destroy_tmap();
+          timer_destroy(mapgen_stage_timer);
+          mapgen_stage_timer = nullptr;
           return FALSE;
       }
     }
   }
+  mapgen_stage_done("start positions");
+  timer_destroy(mapgen_stage_timer);
+  mapgen_stage_timer = nullptr;
 
   /* Destroy temperature map */
   destroy_tmap();
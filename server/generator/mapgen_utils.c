@@ -21,11 +21,15 @@
 #include "support.h"            /* bool type */
 
 /* common */
+#include "effects.h"
 #include "map.h"
 #include "packets.h"
 #include "terrain.h"
 #include "tile.h"
 
+/* server */
+#include "srv_main.h"
+
 #include "mapgen_utils.h"
 
 /**************************************************************************
@@ -182,6 +186,47 @@ bool is_normal_nat_pos(int x, int y)
   return is_normal_map_pos(x, y);
 }
 
+/**********************************************************************//**
+  Call cb(nat_y, data) for every native row of the map, spreading the
+  rows over the turn change threads of the server. The callbacks may only
+  write to the tiles of their own row, and must not use random numbers,
+  so that a map seed gives the same map whatever the number of threads.
+**************************************************************************/
+void mapgen_rows_parallel(fc_parallel_cb *cb, void *data)
+{
+  fc_parallel_for(MAP_NATIVE_HEIGHT, srvarg.threads, cb, data);
+}
+
+/* One pass of smooth_int_map() */
+struct smooth_pass {
+  const int *source_map;
+  int *target_map;
+  const float *weight;
+  bool axe;
+  bool zeroes_at_edges;
+};
+
+/**********************************************************************//**
+  Smooth one native row of the map along one axis.
+**************************************************************************/
+static void smooth_int_map_row(int nat_y, void *data)
+{
+  const struct smooth_pass *pass = (const struct smooth_pass *) data;
+
+  native_row_iterate(&(wld.map), nat_y, ptile) {
+    float N = 0, D = 0;
+
+    axis_iterate(&(wld.map), ptile, pnear, i, 2, pass->axe) {
+      D += pass->weight[i + 2];
+      N += pass->weight[i + 2] * pass->source_map[tile_index(pnear)];
+    } axis_iterate_end;
+    if (pass->zeroes_at_edges) {
+      D = 1;
+    }
+    pass->target_map[tile_index(ptile)] = (float)N / D;
+  } native_row_iterate_end;
+}
+
 /**********************************************************************//**
   Apply a Gaussian diffusion filter on the map. The size of the map is
   MAP_INDEX_SIZE and the map is indexed by native_pos_to_index function.
@@ -192,41 +237,31 @@ void smooth_int_map(int *int_map, bool zeroes_at_edges)
 {
   static const float weight_standard[5] = { 0.13, 0.19, 0.37, 0.19, 0.13 };
   static const float weight_isometric[5] = { 0.15, 0.21, 0.29, 0.21, 0.15 };
-  const float *weight;
-  bool axe = TRUE;
-  int *target_map, *source_map;
+  struct smooth_pass pass;
   int *alt_int_map = fc_calloc(MAP_INDEX_SIZE, sizeof(*alt_int_map));
 
   fc_assert_ret(NULL != int_map);
 
-  weight = weight_standard;
-  target_map = alt_int_map;
-  source_map = int_map;
+  pass.weight = weight_standard;
+  pass.axe = TRUE;
+  pass.zeroes_at_edges = zeroes_at_edges;
+  pass.target_map = alt_int_map;
+  pass.source_map = int_map;
 
   do {
-    whole_map_iterate(&(wld.map), ptile) {
-      float N = 0, D = 0;
-
-      axis_iterate(&(wld.map), ptile, pnear, i, 2, axe) {
-        D += weight[i + 2];
-        N += weight[i + 2] * source_map[tile_index(pnear)];
-      } axis_iterate_end;
-      if (zeroes_at_edges) {
-        D = 1;
-      }
-      target_map[tile_index(ptile)] = (float)N / D;
-    } whole_map_iterate_end;
+    /* Every tile only depends on the source map */
+    mapgen_rows_parallel(smooth_int_map_row, &pass);
 
     if (MAP_IS_ISOMETRIC) {
-      weight = weight_isometric;
+      pass.weight = weight_isometric;
     }
 
-    axe = !axe;
+    pass.axe = !pass.axe;
 
-    source_map = alt_int_map;
-    target_map = int_map;
+    pass.source_map = alt_int_map;
+    pass.target_map = int_map;
 
-  } while (!axe);
+  } while (!pass.axe);
 
   FC_FREE(alt_int_map);
 }
@@ -430,6 +465,9 @@ void regenerate_lakes(void)
 **************************************************************************/
 void assign_continent_numbers(void)
 {
+  /* Continent ranged effects may change */
+  bonus_cache_invalidate();
+
   /* Initialize */
   wld.map.num_continents = 0;
   wld.map.num_oceans = 0;
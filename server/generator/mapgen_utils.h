@@ -13,6 +13,9 @@
 #ifndef FC__MAPGEN_UTILS_H
 #define FC__MAPGEN_UTILS_H
 
+/* utility */
+#include "fcparallel.h"
+
 typedef void (*tile_knowledge_cb)(struct tile *ptile);
 
 #define MG_UNUSED mapgen_terrain_property_invalid()
@@ -92,6 +95,23 @@ struct extra_type *pick_resource(const struct terrain *pterrain);
   } whole_map_iterate_end;						\
 }
 
+/***************************************************************************
+  Iterate over the tiles of one native row of the map, from west to east.
+***************************************************************************/
+#define native_row_iterate(nmap, nat_y, _tile)                           \
+{                                                                        \
+  const int _tile##_y = (nat_y);                                         \
+  int _tile##_x;                                                         \
+                                                                         \
+  for (_tile##_x = 0; _tile##_x < MAP_NATIVE_WIDTH; _tile##_x++) {       \
+    struct tile *_tile = native_pos_to_tile(nmap, _tile##_x, _tile##_y);
+
+#define native_row_iterate_end                                           \
+  }                                                                      \
+}
+
+void mapgen_rows_parallel(fc_parallel_cb *cb, void *data);
+
 bool is_normal_nat_pos(int x, int y);
 
 /* int maps tools */
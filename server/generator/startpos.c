@@ -117,6 +117,56 @@ static int get_tile_value(struct tile *ptile)
   return value;
 }
 
+/* Tile values of create_start_positions() */
+struct start_values {
+  int *tile_value_aux;
+  int *tile_value;
+};
+
+/************************************************************************//**
+  Calculate the values of the tiles of one native row of the map.
+****************************************************************************/
+static void start_tile_value_row(int nat_y, void *data)
+{
+  struct start_values *values = (struct start_values *) data;
+
+  native_row_iterate(&(wld.map), nat_y, value_tile) {
+    values->tile_value_aux[tile_index(value_tile)]
+      = get_tile_value(value_tile);
+  } native_row_iterate_end;
+}
+
+/************************************************************************//**
+  Keep the value of the tiles of one native row of the map that are
+  better than most tiles within the default city radius, and zero the
+  others.
+****************************************************************************/
+static void start_best_tile_row(int nat_y, void *data)
+{
+  struct start_values *values = (struct start_values *) data;
+  const struct civ_map *nmap = &(wld.map);
+
+  native_row_iterate(nmap, nat_y, value_tile) {
+    int this_tile_value = values->tile_value_aux[tile_index(value_tile)];
+    int lcount = 0, bcount = 0;
+
+    /* Check all tiles within the default city radius */
+    city_tile_iterate(nmap, CITY_MAP_DEFAULT_RADIUS_SQ, value_tile, ptile1) {
+      if (this_tile_value > values->tile_value_aux[tile_index(ptile1)]) {
+        lcount++;
+      } else if (this_tile_value
+                 < values->tile_value_aux[tile_index(ptile1)]) {
+        bcount++;
+      }
+    } city_tile_iterate_end;
+
+    if (lcount <= bcount) {
+      this_tile_value = 0;
+    }
+    values->tile_value[tile_index(value_tile)] = 100 * this_tile_value;
+  } native_row_iterate_end;
+}
+
 struct start_filter_data {
   int min_value;
   struct unit_type *initial_unit;
@@ -303,7 +353,7 @@ bool create_start_positions(enum map_startpos mode,
   struct tile *ptile;
   int k, sum;
   struct start_filter_data data;
-  int *tile_value_aux = NULL;
+  struct start_values values;
   int *tile_value = NULL;
   int min_goodies_per_player = 1500;
   int total_goodies = 0;
@@ -311,7 +361,6 @@ bool create_start_positions(enum map_startpos mode,
   float efactor =  player_count() / map_size_checked() / 4;
   bool failure = FALSE;
   bool is_tmap = temperature_is_initialized();
-  const struct civ_map *nmap = &(wld.map);
 
   if (wld.map.num_continents < 1) {
     /* Currently we can only place starters on land terrain, so fail
@@ -335,33 +384,16 @@ bool create_start_positions(enum map_startpos mode,
     mode = MAPSTARTPOS_VARIABLE;
   }
 
-  tile_value_aux = fc_calloc(MAP_INDEX_SIZE, sizeof(*tile_value_aux));
-  tile_value = fc_calloc(MAP_INDEX_SIZE, sizeof(*tile_value));
+  values.tile_value_aux = fc_calloc(MAP_INDEX_SIZE,
+                                    sizeof(*values.tile_value_aux));
+  values.tile_value = fc_calloc(MAP_INDEX_SIZE, sizeof(*values.tile_value));
+  tile_value = values.tile_value;
 
   /* Get the tile value */
-  whole_map_iterate(&(wld.map), value_tile) {
-    tile_value_aux[tile_index(value_tile)] = get_tile_value(value_tile);
-  } whole_map_iterate_end;
+  mapgen_rows_parallel(start_tile_value_row, &values);
 
   /* Select the best tiles */
-  whole_map_iterate(&(wld.map), value_tile) {
-    int this_tile_value = tile_value_aux[tile_index(value_tile)];
-    int lcount = 0, bcount = 0;
-
-    /* Check all tiles within the default city radius */
-    city_tile_iterate(nmap, CITY_MAP_DEFAULT_RADIUS_SQ, value_tile, ptile1) {
-      if (this_tile_value > tile_value_aux[tile_index(ptile1)]) {
-        lcount++;
-      } else if (this_tile_value < tile_value_aux[tile_index(ptile1)]) {
-        bcount++;
-      }
-    } city_tile_iterate_end;
-
-    if (lcount <= bcount) {
-      this_tile_value = 0;
-    }
-    tile_value[tile_index(value_tile)] = 100 * this_tile_value;
-  } whole_map_iterate_end;
+  mapgen_rows_parallel(start_best_tile_row, &values);
   /* Get an average value */
   smooth_int_map(tile_value, TRUE);
 
@@ -514,7 +546,7 @@ bool create_start_positions(enum map_startpos mode,
     destroy_tmap();
   }
 
-  FC_FREE(tile_value_aux);
+  FC_FREE(values.tile_value_aux);
   FC_FREE(tile_value);
 
   return !failure;
@@ -112,21 +112,14 @@ void destroy_tmap(void)
 }
 
 /**********************************************************************//**
-  Initialize the temperature_map
-  if arg is FALSE, create a dummy tmap == map_colatitude
-  to be used if hmap or oceans are not placed gen 2-4
+  Calculate the temperatures of one native row of the map. 'data' points
+  to the 'real' argument of create_tmap().
 **************************************************************************/
-void create_tmap(bool real)
+static void create_tmap_row(int nat_y, void *data)
 {
-  int i;
-
-  /* If map is defined this is not changed. */
-  /* TODO: Load if from scenario game with tmap */
-  /* to debug, never load at this time */
-  fc_assert_ret(NULL == temperature_map);
+  const bool real = *(const bool *) data;
 
-  temperature_map = fc_malloc(sizeof(*temperature_map) * MAP_INDEX_SIZE);
-  whole_map_iterate(&(wld.map), ptile) {
+  native_row_iterate(&(wld.map), nat_y, ptile) {
     /* The base temperature is equal to base map_colatitude */
     int t = map_colatitude(ptile);
 
@@ -145,7 +138,25 @@ void create_tmap(bool real)
 
       tmap(ptile) =  t * (1.0 + temperate) * (1.0 + height);
     }
-  } whole_map_iterate_end;
+  } native_row_iterate_end;
+}
+
+/**********************************************************************//**
+  Initialize the temperature_map
+  if arg is FALSE, create a dummy tmap == map_colatitude
+  to be used if hmap or oceans are not placed gen 2-4
+**************************************************************************/
+void create_tmap(bool real)
+{
+  int i;
+
+  /* If map is defined this is not changed. */
+  /* TODO: Load if from scenario game with tmap */
+  /* to debug, never load at this time */
+  fc_assert_ret(NULL == temperature_map);
+
+  temperature_map = fc_malloc(sizeof(*temperature_map) * MAP_INDEX_SIZE);
+  mapgen_rows_parallel(create_tmap_row, &real);
 
   /* Adjust to get evenly distributed frequencies.
    * Only call adjust when the colatitude range is large enough for this to
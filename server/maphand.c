@@ -17,6 +17,7 @@
 
 /* utility */
 #include "bitvector.h"
+#include "capability.h"
 #include "fcintl.h"
 #include "log.h"
 #include "mem.h"
@@ -53,6 +54,7 @@
 
 /* server/advisors */
 #include "advdata.h"
+#include "advgoto.h"
 
 /* server/generator */
 #include "mapgen_utils.h"
@@ -62,6 +64,7 @@
 /* Suppress send_tile_info() during game_load() */
 static bool send_tile_suppressed = FALSE;
 
+static void send_all_known_tiles_bulk(struct connection *pconn);
 static void player_tile_init(struct tile *ptile, struct player *pplayer);
 static void player_tile_free(struct tile *ptile, struct player *pplayer);
 static bool give_tile_info_from_player_to_player(struct player *pfrom,
@@ -441,30 +444,45 @@ void give_citymap_from_player_to_player(struct city *pcity,
 **************************************************************************/
 void send_all_known_tiles(struct conn_list *dest)
 {
+  struct conn_list *tile_by_tile;
   int tiles_sent;
 
   if (!dest) {
     dest = game.est_connections;
   }
 
+  /* Clients that can take the map in bulk get it so, the others
+   * one tile at a time. */
+  tile_by_tile = conn_list_new();
+  conn_list_iterate(dest, pconn) {
+    if (has_capability("tilebulk", pconn->capability)) {
+      send_all_known_tiles_bulk(pconn);
+      flush_packets();
+    } else {
+      conn_list_append(tile_by_tile, pconn);
+    }
+  } conn_list_iterate_end;
+
   /* Send whole map piece by piece to each player to balance the load
      of the send buffers better */
   tiles_sent = 0;
-  conn_list_do_buffer(dest);
+  conn_list_do_buffer(tile_by_tile);
 
   whole_map_iterate(&(wld.map), ptile) {
     tiles_sent++;
     if ((tiles_sent % MAP_NATIVE_WIDTH) == 0) {
-      conn_list_do_unbuffer(dest);
+      conn_list_do_unbuffer(tile_by_tile);
       flush_packets();
-      conn_list_do_buffer(dest);
+      conn_list_do_buffer(tile_by_tile);
     }
 
-    send_tile_info(dest, ptile, FALSE);
+    send_tile_info(tile_by_tile, ptile, FALSE);
   } whole_map_iterate_end;
 
-  conn_list_do_unbuffer(dest);
+  conn_list_do_unbuffer(tile_by_tile);
   flush_packets();
+
+  conn_list_destroy(tile_by_tile);
 }
 
 /**********************************************************************//**
@@ -479,156 +497,255 @@ bool send_tile_suppression(bool now)
 }
 
 /**********************************************************************//**
-  Send tile information to all the clients in dest which know and see
-  the tile. If dest is NULL, sends to all clients (game.est_connections)
-  which know and see tile.
-
-  Note that this function does not update the playermap. For that call
-  update_tile_knowledge().
+  Fill in the tile info of the tile as the connection knows it. Returns
+  FALSE if the connection does not know the tile, and send_unknown is
+  not set either.
 **************************************************************************/
-void send_tile_info(struct conn_list *dest, struct tile *ptile,
-                    bool send_unknown)
+static bool tile_info_for_conn(struct packet_tile_info *info,
+                               struct tile *ptile,
+                               const struct connection *pconn,
+                               bool send_unknown)
 {
-  struct packet_tile_info info;
+  struct player *pplayer = pconn->playing;
   const struct player *owner;
   const struct player *eowner;
+  bool known;
 
-  if (dest == NULL) {
-    CALL_FUNC_EACH_AI(tile_info, ptile);
+  if (NULL == pplayer && !pconn->observer) {
+    return FALSE;
   }
 
-  if (send_tile_suppressed) {
-    return;
+  info->tile = tile_index(ptile);
+
+  if (ptile->spec_sprite) {
+    sz_strlcpy(info->spec_sprite, ptile->spec_sprite);
+  } else {
+    info->spec_sprite[0] = '\0';
   }
 
-  if (!dest) {
-    dest = game.est_connections;
+  if (pplayer != NULL) {
+    known = map_is_known(ptile, pplayer);
   }
 
-  info.tile = tile_index(ptile);
+  if (pplayer == NULL || (known && map_is_also_seen(ptile, pplayer, V_MAIN))) {
+    struct extra_type *resource;
 
-  if (ptile->spec_sprite) {
-    sz_strlcpy(info.spec_sprite, ptile->spec_sprite);
-  } else {
-    info.spec_sprite[0] = '\0';
-  }
+    info->known = TILE_KNOWN_SEEN;
+    info->continent = tile_continent(ptile);
+    owner = tile_owner(ptile);
+    eowner = extra_owner(ptile);
+    info->owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
+    info->extras_owner = (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
+    info->worked = (NULL != tile_worked(ptile))
+                   ? tile_worked(ptile)->id
+                   : IDENTITY_NUMBER_ZERO;
 
-  conn_list_iterate(dest, pconn) {
-    struct player *pplayer = pconn->playing;
-    bool known;
+    info->terrain = (NULL != tile_terrain(ptile))
+                    ? terrain_number(tile_terrain(ptile))
+                    : terrain_count();
 
-    if (NULL == pplayer && !pconn->observer) {
-      continue;
+    resource = tile_resource(ptile);
+    if (resource != NULL
+        && (pplayer == NULL
+            || player_knows_extra_exist(pplayer, resource, ptile))) {
+      info->resource = extra_number(resource);
+    } else {
+      info->resource = MAX_EXTRA_TYPES;
     }
 
+    info->placing = (NULL != ptile->placing)
+                    ? extra_number(ptile->placing)
+                    : -1;
+    info->place_turn = (NULL != ptile->placing)
+                       ? game.info.turn + ptile->infra_turns
+                       : 0;
+
     if (pplayer != NULL) {
-      known = map_is_known(ptile, pplayer);
-    }
-
-    if (pplayer == NULL || (known && map_is_also_seen(ptile, pplayer, V_MAIN))) {
-      struct extra_type *resource;
-
-      info.known = TILE_KNOWN_SEEN;
-      info.continent = tile_continent(ptile);
-      owner = tile_owner(ptile);
-      eowner = extra_owner(ptile);
-      info.owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
-      info.extras_owner = (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
-      info.worked = (NULL != tile_worked(ptile))
-                     ? tile_worked(ptile)->id
-                     : IDENTITY_NUMBER_ZERO;
-
-      info.terrain = (NULL != tile_terrain(ptile))
-                      ? terrain_number(tile_terrain(ptile))
-                      : terrain_count();
-
-      resource = tile_resource(ptile);
-      if (resource != NULL
-          && (pplayer == NULL
-              || player_knows_extra_exist(pplayer, resource, ptile))) {
-        info.resource = extra_number(resource);
-      } else {
-        info.resource = MAX_EXTRA_TYPES;
-      }
+      info->extras = map_get_player_tile(ptile, pplayer)->extras;
+    } else {
+      info->extras = ptile->extras;
+    }
 
-      info.placing = (NULL != ptile->placing)
-                      ? extra_number(ptile->placing)
-                      : -1;
-      info.place_turn = (NULL != ptile->placing)
-                         ? game.info.turn + ptile->infra_turns
-                         : 0;
+    if (ptile->label != NULL) {
+      /* Always leave final '\0' in place */
+      strncpy(info->label, ptile->label, sizeof(info->label) - 1);
+      info->label[sizeof(info->label) - 1] = '\0';
+    } else {
+      info->label[0] = '\0';
+    }
 
-      if (pplayer != NULL) {
-        dbv_to_bv(info.extras.vec, &(map_get_player_tile(ptile, pplayer)->extras));
-      } else {
-	info.extras = ptile->extras;
-      }
+    info->altitude = ptile->altitude;
 
-      if (ptile->label != NULL) {
-        /* Always leave final '\0' in place */
-        strncpy(info.label, ptile->label, sizeof(info.label) - 1);
-      } else {
-        info.label[0] = '\0';
+    return TRUE;
+  } else if (pplayer != NULL && known) {
+    struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+    struct vision_site *psite = map_get_playermap_site(plrtile);
+
+    info->known = TILE_KNOWN_UNSEEN;
+    info->continent = tile_continent(ptile);
+    owner = (game.server.foggedborders
+             ? plrtile->owner
+             : tile_owner(ptile));
+    eowner = plrtile->extras_owner;
+    info->owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
+    info->extras_owner = (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
+    info->worked = (NULL != psite)
+                   ? psite->identity
+                   : IDENTITY_NUMBER_ZERO;
+
+    info->terrain = (NULL != plrtile->terrain)
+                    ? terrain_number(plrtile->terrain)
+                    : terrain_count();
+    info->resource = (NULL != plrtile->resource)
+                     ? extra_number(plrtile->resource)
+                     : MAX_EXTRA_TYPES;
+    info->placing = -1;
+    info->place_turn = 0;
+
+    info->extras = plrtile->extras;
+
+    /* Labels never change, so they are not subject to fog of war */
+    if (ptile->label != NULL) {
+      sz_strlcpy(info->label, ptile->label);
+    } else {
+      info->label[0] = '\0';
+    }
+
+    info->altitude = ptile->altitude;
+
+    return TRUE;
+  } else if (send_unknown) {
+    info->known = TILE_UNKNOWN;
+    info->continent = 0;
+    info->owner = MAP_TILE_OWNER_NULL;
+    info->extras_owner = MAP_TILE_OWNER_NULL;
+    info->worked = IDENTITY_NUMBER_ZERO;
+
+    info->terrain = terrain_count();
+    info->resource = MAX_EXTRA_TYPES;
+    info->placing = -1;
+    info->place_turn = 0;
+
+    BV_CLR_ALL(info->extras);
+
+    info->label[0] = '\0';
+
+    info->altitude = 0;
+
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+/**********************************************************************//**
+  Send the whole map as the connection knows it in PACKET_TILE_INFO_BULK
+  packets. Tiles with a label, a sprite or an extra being placed do not
+  fit the bulk coding, and get a PACKET_TILE_INFO of their own after it.
+**************************************************************************/
+static void send_all_known_tiles_bulk(struct connection *pconn)
+{
+  struct packet_tile_info_bulk packet;
+  struct packet_tile_info *infos;
+  int buffered = 0, first = 0, next = 0;
+
+  if (send_tile_suppressed
+      || (NULL == pconn->playing && !pconn->observer)) {
+    return;
+  }
+
+  infos = fc_malloc(TILE_INFO_BULK_MAX_TILES * sizeof(*infos));
+
+  packet.reset = TRUE;
+
+  connection_do_buffer(pconn);
+
+  while (first < MAP_INDEX_SIZE) {
+    int coded;
+
+    /* infos[i] describes the tile first + i */
+    for (; next < MAP_INDEX_SIZE && buffered < TILE_INFO_BULK_MAX_TILES;
+         next++, buffered++) {
+      struct packet_tile_info *info = &infos[buffered];
+
+      if (!tile_info_for_conn(info, index_to_tile(&(wld.map), next),
+                              pconn, FALSE)
+          || info->spec_sprite[0] != '\0' || info->label[0] != '\0'
+          || info->placing != -1) {
+        info->known = TILE_UNKNOWN;
       }
+    }
 
-      info.altitude = ptile->altitude;
+    packet.first_tile = first;
+    coded = tile_info_bulk_encode(&packet, infos, buffered);
+    fc_assert_action(coded > 0, break);
+    send_packet_tile_info_bulk(pconn, &packet);
+    if (packet.reset) {
+      /* The client forgets its tile info delta state on the reset packet */
+      conn_reset_packet_delta_state(pconn, PACKET_TILE_INFO);
+      packet.reset = FALSE;
+    }
 
+    first += coded;
+    buffered -= coded;
+    memmove(infos, infos + coded, buffered * sizeof(*infos));
+  }
+
+  free(infos);
+
+  /* Should the bulk coding fail, send the rest one tile at a time */
+  for (; first < MAP_INDEX_SIZE; first++) {
+    struct tile *ptile = index_to_tile(&(wld.map), first);
+    struct packet_tile_info info;
+
+    if (ptile->spec_sprite == NULL && ptile->label == NULL
+        && ptile->placing == NULL
+        && tile_info_for_conn(&info, ptile, pconn, FALSE)) {
       send_packet_tile_info(pconn, &info);
-    } else if (pplayer != NULL && known) {
-      struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
-      struct vision_site *psite = map_get_playermap_site(plrtile);
-
-      info.known = TILE_KNOWN_UNSEEN;
-      info.continent = tile_continent(ptile);
-      owner = (game.server.foggedborders
-               ? plrtile->owner
-               : tile_owner(ptile));
-      eowner = plrtile->extras_owner;
-      info.owner = (owner ? player_number(owner) : MAP_TILE_OWNER_NULL);
-      info.extras_owner = (eowner ? player_number(eowner) : MAP_TILE_OWNER_NULL);
-      info.worked = (NULL != psite)
-                    ? psite->identity
-                    : IDENTITY_NUMBER_ZERO;
-
-      info.terrain = (NULL != plrtile->terrain)
-                      ? terrain_number(plrtile->terrain)
-                      : terrain_count();
-      info.resource = (NULL != plrtile->resource)
-                       ? extra_number(plrtile->resource)
-                       : MAX_EXTRA_TYPES;
-      info.placing = -1;
-      info.place_turn = 0;
-
-      dbv_to_bv(info.extras.vec, &(plrtile->extras));
-
-      /* Labels never change, so they are not subject to fog of war */
-      if (ptile->label != NULL) {
-        sz_strlcpy(info.label, ptile->label);
-      } else {
-        info.label[0] = '\0';
+    }
+  }
+
+  whole_map_iterate(&(wld.map), ptile) {
+    if (ptile->spec_sprite != NULL || ptile->label != NULL
+        || ptile->placing != NULL) {
+      struct packet_tile_info info;
+
+      if (tile_info_for_conn(&info, ptile, pconn, FALSE)) {
+        send_packet_tile_info(pconn, &info);
       }
+    }
+  } whole_map_iterate_end;
 
-      info.altitude = ptile->altitude;
+  connection_do_unbuffer(pconn);
+}
 
-      send_packet_tile_info(pconn, &info);
-    } else if (send_unknown) {
-      info.known = TILE_UNKNOWN;
-      info.continent = 0;
-      info.owner = MAP_TILE_OWNER_NULL;
-      info.extras_owner = MAP_TILE_OWNER_NULL;
-      info.worked = IDENTITY_NUMBER_ZERO;
+/**********************************************************************//**
+  Send tile information to all the clients in dest which know and see
+  the tile. If dest is NULL, sends to all clients (game.est_connections)
+  which know and see tile.
 
-      info.terrain = terrain_count();
-      info.resource = MAX_EXTRA_TYPES;
-      info.placing = -1;
-      info.place_turn = 0;
+  Note that this function does not update the playermap. For that call
+  update_tile_knowledge().
+**************************************************************************/
+void send_tile_info(struct conn_list *dest, struct tile *ptile,
+                    bool send_unknown)
+{
+  struct packet_tile_info info;
 
-      BV_CLR_ALL(info.extras);
+  if (dest == NULL) {
+    CALL_FUNC_EACH_AI(tile_info, ptile);
+  }
 
-      info.label[0] = '\0';
+  if (send_tile_suppressed) {
+    return;
+  }
 
-      info.altitude = 0;
+  if (!dest) {
+    dest = game.est_connections;
+  }
 
+  conn_list_iterate(dest, pconn) {
+    if (tile_info_for_conn(&info, ptile, pconn, send_unknown)) {
       send_packet_tile_info(pconn, &info);
     }
   }
@@ -940,7 +1057,7 @@ static inline int map_get_seen(const struct player *pplayer,
                                const struct tile *ptile,
                                enum vision_layer vlayer)
 {
-  return map_get_player_tile(ptile, pplayer)->seen_count[vlayer];
+  return map_get_player_tile_seen(ptile, pplayer)->seen_count[vlayer];
 }
 
 /**********************************************************************//**
@@ -954,16 +1071,18 @@ void map_change_seen(struct player *pplayer,
                      const v_radius_t change,
                      bool can_reveal_tiles)
 {
-  struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+  struct player_tile_seen *plrseen = map_get_player_tile_seen(ptile, pplayer);
   bool revealing_tile = FALSE;
 
+  adv_pf_maps_invalidate();
+
 #ifdef FREECIV_DEBUG
   log_debug("%s() for player %s (nb %d) at (%d, %d).",
             __FUNCTION__, player_name(pplayer), player_number(pplayer),
             TILE_XY(ptile));
   vision_layer_iterate(v) {
     log_debug("  vision layer %d is changing from %d to %d.",
-              v, plrtile->seen_count[v], plrtile->seen_count[v] + change[v]);
+              v, plrseen->seen_count[v], plrseen->seen_count[v] + change[v]);
   } vision_layer_iterate_end;
 #endif /* FREECIV_DEBUG */
 
@@ -971,14 +1090,14 @@ void map_change_seen(struct player *pplayer,
    * we must remove all units before fog of war because clients expect
    * the tile is empty when it is fogged. */
   if (0 > change[V_INVIS]
-      && plrtile->seen_count[V_INVIS] == -change[V_INVIS]) {
+      && plrseen->seen_count[V_INVIS] == -change[V_INVIS]) {
     log_debug("(%d, %d): hiding invisible units to player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer), player_number(pplayer));
 
     unit_list_iterate(ptile->units, punit) {
       if (unit_is_on_layer(punit, V_INVIS)
           && can_player_see_unit(pplayer, punit)
-          && (plrtile->seen_count[V_MAIN] + change[V_MAIN] <= 0
+          && (plrseen->seen_count[V_MAIN] + change[V_MAIN] <= 0
               || !pplayers_allied(pplayer, unit_owner(punit)))) {
         /* Allied units on seen tiles (V_MAIN) are always seen.
          * That's how can_player_see_unit_at() works. */
@@ -987,7 +1106,7 @@ void map_change_seen(struct player *pplayer,
     } unit_list_iterate_end;
   }
   if (0 > change[V_SUBSURFACE]
-      && plrtile->seen_count[V_SUBSURFACE] == -change[V_SUBSURFACE]) {
+      && plrseen->seen_count[V_SUBSURFACE] == -change[V_SUBSURFACE]) {
     log_debug("(%d, %d): hiding subsurface units to player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer), player_number(pplayer));
 
@@ -1000,7 +1119,7 @@ void map_change_seen(struct player *pplayer,
   }
 
   if (0 > change[V_MAIN]
-      && plrtile->seen_count[V_MAIN] == -change[V_MAIN]) {
+      && plrseen->seen_count[V_MAIN] == -change[V_MAIN]) {
     log_debug("(%d, %d): hiding visible units to player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer), player_number(pplayer));
 
@@ -1014,8 +1133,8 @@ void map_change_seen(struct player *pplayer,
 
   vision_layer_iterate(v) {
     /* Avoid underflow. */
-    fc_assert(0 <= change[v] || -change[v] <= plrtile->seen_count[v]);
-    plrtile->seen_count[v] += change[v];
+    fc_assert(0 <= change[v] || -change[v] <= plrseen->seen_count[v]);
+    plrseen->seen_count[v] += change[v];
   } vision_layer_iterate_end;
 
   /* V_MAIN vision ranges must always be more than invisible ranges
@@ -1023,13 +1142,13 @@ void map_change_seen(struct player *pplayer,
    * seen count cannot be inferior to V_INVIS or V_SUBSURFACE seen count.
    * Moreover, when the fog of war is disabled, V_MAIN has an extra
    * seen count point. */
-  fc_assert(plrtile->seen_count[V_INVIS] + !game.info.fogofwar
-            <= plrtile->seen_count[V_MAIN]);
-  fc_assert(plrtile->seen_count[V_SUBSURFACE] + !game.info.fogofwar
-            <= plrtile->seen_count[V_MAIN]);
+  fc_assert(plrseen->seen_count[V_INVIS] + !game.info.fogofwar
+            <= plrseen->seen_count[V_MAIN]);
+  fc_assert(plrseen->seen_count[V_SUBSURFACE] + !game.info.fogofwar
+            <= plrseen->seen_count[V_MAIN]);
 
   if (!map_is_known(ptile, pplayer)) {
-    if (0 < plrtile->seen_count[V_MAIN] && can_reveal_tiles) {
+    if (0 < plrseen->seen_count[V_MAIN] && can_reveal_tiles) {
       log_debug("(%d, %d): revealing tile to player %s (nb %d).",
                 TILE_XY(ptile), player_name(pplayer),
                 player_number(pplayer));
@@ -1042,7 +1161,8 @@ void map_change_seen(struct player *pplayer,
   }
 
   /* Fog the tile. */
-  if (0 > change[V_MAIN] && 0 == plrtile->seen_count[V_MAIN]) {
+  if (0 > change[V_MAIN] && 0 == plrseen->seen_count[V_MAIN]) {
+    struct player_tile *plrtile;
     struct city *pcity;
 
     log_debug("(%d, %d): fogging tile for player %s (nb %d).",
@@ -1059,6 +1179,7 @@ void map_change_seen(struct player *pplayer,
     }
 
     update_player_tile_last_seen(pplayer, ptile);
+    plrtile = map_get_player_tile(ptile, pplayer);
     if (game.server.foggedborders) {
       plrtile->owner = tile_owner(ptile);
     }
@@ -1066,12 +1187,12 @@ void map_change_seen(struct player *pplayer,
     send_tile_info(pplayer->connections, ptile, FALSE);
   }
 
-  if ((revealing_tile && 0 < plrtile->seen_count[V_MAIN])
+  if ((revealing_tile && 0 < plrseen->seen_count[V_MAIN])
       || (0 < change[V_MAIN]
-          /* plrtile->seen_count[V_MAIN] Always set to 1
+          /* plrseen->seen_count[V_MAIN] Always set to 1
             * when the fog of war is disabled. */
           && (change[V_MAIN] + !game.info.fogofwar
-              == (plrtile->seen_count[V_MAIN])))) {
+              == (plrseen->seen_count[V_MAIN])))) {
     struct city *pcity;
 
     log_debug("(%d, %d): unfogging tile for player %s (nb %d).",
@@ -1103,9 +1224,9 @@ void map_change_seen(struct player *pplayer,
     }
   }
 
-  if ((revealing_tile && 0 < plrtile->seen_count[V_INVIS])
+  if ((revealing_tile && 0 < plrseen->seen_count[V_INVIS])
       || (0 < change[V_INVIS]
-          && change[V_INVIS] == plrtile->seen_count[V_INVIS])) {
+          && change[V_INVIS] == plrseen->seen_count[V_INVIS])) {
     log_debug("(%d, %d): revealing invisible units to player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer),
               player_number(pplayer));
@@ -1116,9 +1237,9 @@ void map_change_seen(struct player *pplayer,
       }
     } unit_list_iterate_end;
   }
-  if ((revealing_tile && 0 < plrtile->seen_count[V_SUBSURFACE])
+  if ((revealing_tile && 0 < plrseen->seen_count[V_SUBSURFACE])
       || (0 < change[V_SUBSURFACE]
-          && change[V_SUBSURFACE] == plrtile->seen_count[V_SUBSURFACE])) {
+          && change[V_SUBSURFACE] == plrseen->seen_count[V_SUBSURFACE])) {
     log_debug("(%d, %d): revealing subsurface units to player %s (nb %d).",
               TILE_XY(ptile), player_name(pplayer),
               player_number(pplayer));
@@ -1138,10 +1259,10 @@ void map_change_seen(struct player *pplayer,
   @param vlayer  Vision layer which we want the count for
   @return        Own seen count
 **************************************************************************/
-static inline int player_tile_own_seen(const struct player_tile *plrtile,
+static inline int player_tile_own_seen(const struct player_tile_seen *plrseen,
                                        enum vision_layer vlayer)
 {
-  return plrtile->own_seen[vlayer];
+  return plrseen->own_seen[vlayer];
 }
 
 /**********************************************************************//**
@@ -1151,10 +1272,10 @@ static void map_change_own_seen(struct player *pplayer,
                                 struct tile *ptile,
                                 const v_radius_t change)
 {
-  struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+  struct player_tile_seen *plrseen = map_get_player_tile_seen(ptile, pplayer);
 
   vision_layer_iterate(v) {
-    plrtile->own_seen[v] += change[v];
+    plrseen->own_seen[v] += change[v];
   } vision_layer_iterate_end;
 }
 
@@ -1183,6 +1304,7 @@ void change_playertile_site(struct player_tile *ptile,
 void map_set_known(struct tile *ptile, struct player *pplayer)
 {
   dbv_set(&pplayer->tile_known, tile_index(ptile));
+  adv_pf_maps_invalidate();
 }
 
 /**********************************************************************//**
@@ -1191,6 +1313,7 @@ void map_set_known(struct tile *ptile, struct player *pplayer)
 void map_clear_known(struct tile *ptile, struct player *pplayer)
 {
   dbv_clr(&pplayer->tile_known, tile_index(ptile));
+  adv_pf_maps_invalidate();
 }
 
 /**********************************************************************//**
@@ -1228,6 +1351,9 @@ void player_map_init(struct player *pplayer)
   pplayer->server.private_map
     = fc_realloc(pplayer->server.private_map,
                  MAP_INDEX_SIZE * sizeof(*pplayer->server.private_map));
+  pplayer->server.private_seen
+    = fc_realloc(pplayer->server.private_seen,
+                 MAP_INDEX_SIZE * sizeof(*pplayer->server.private_seen));
 
   whole_map_iterate(&(wld.map), ptile) {
     player_tile_init(ptile, pplayer);
@@ -1251,6 +1377,8 @@ void player_map_free(struct player *pplayer)
 
   free(pplayer->server.private_map);
   pplayer->server.private_map = NULL;
+  free(pplayer->server.private_seen);
+  pplayer->server.private_seen = NULL;
 
   dbv_free(&pplayer->tile_known);
 }
@@ -1333,23 +1461,24 @@ void remove_player_from_maps(struct player *pplayer)
 static void player_tile_init(struct tile *ptile, struct player *pplayer)
 {
   struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+  struct player_tile_seen *plrseen = map_get_player_tile_seen(ptile, pplayer);
 
   plrtile->terrain = T_UNKNOWN;
   plrtile->resource = NULL;
   plrtile->owner = NULL;
   plrtile->extras_owner = NULL;
   plrtile->site = NULL;
-  dbv_init(&(plrtile->extras), extra_count());
+  BV_CLR_ALL(plrtile->extras);
   if (!game.server.last_updated_year) {
     plrtile->last_updated = game.info.turn;
   } else {
     plrtile->last_updated = game.info.year;
   }
 
-  plrtile->seen_count[V_MAIN] = !game.server.fogofwar_old;
-  plrtile->seen_count[V_INVIS] = 0;
-  plrtile->seen_count[V_SUBSURFACE] = 0;
-  memcpy(plrtile->own_seen, plrtile->seen_count, sizeof(v_radius_t));
+  plrseen->seen_count[V_MAIN] = !game.server.fogofwar_old;
+  plrseen->seen_count[V_INVIS] = 0;
+  plrseen->seen_count[V_SUBSURFACE] = 0;
+  memcpy(plrseen->own_seen, plrseen->seen_count, sizeof(v_radius_t));
 }
 
 /**********************************************************************//**
@@ -1362,8 +1491,6 @@ static void player_tile_free(struct tile *ptile, struct player *pplayer)
   if (plrtile->site != NULL) {
     vision_site_destroy(plrtile->site);
   }
-
-  dbv_free(&(plrtile->extras));
 }
 
 /**********************************************************************//**
@@ -1392,6 +1519,18 @@ struct player_tile *map_get_player_tile(const struct tile *ptile,
   return pplayer->server.private_map + tile_index(ptile);
 }
 
+/**********************************************************************//**
+  Returns the vision counts of the given tile for the player. They are
+  kept apart from the rest of the player tile; see map_get_player_tile().
+**************************************************************************/
+struct player_tile_seen *map_get_player_tile_seen(const struct tile *ptile,
+                                                  const struct player *pplayer)
+{
+  fc_assert_ret_val(pplayer->server.private_seen, NULL);
+
+  return pplayer->server.private_seen + tile_index(ptile);
+}
+
 /**********************************************************************//**
   Give pplayer the correct knowledge about tile; return TRUE iff
   knowledge changed.
@@ -1405,16 +1544,16 @@ bool update_player_tile_knowledge(struct player *pplayer, struct tile *ptile)
   struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
 
   if (plrtile->terrain != ptile->terrain
-      || !bv_match_dbv(&(plrtile->extras), ptile->extras.vec)
+      || !BV_ARE_EQUAL(plrtile->extras, ptile->extras)
       || plrtile->resource != ptile->resource
       || plrtile->owner != tile_owner(ptile)
       || plrtile->extras_owner != extra_owner(ptile)) {
     plrtile->terrain = ptile->terrain;
     extra_type_iterate(pextra) {
       if (player_knows_extra_exist(pplayer, pextra, ptile)) {
-	dbv_set(&(plrtile->extras), extra_number(pextra));
+	BV_SET(plrtile->extras, extra_number(pextra));
       } else {
-	dbv_clr(&(plrtile->extras), extra_number(pextra));
+	BV_CLR(plrtile->extras, extra_number(pextra));
       }
     } extra_type_iterate_end;
     if (ptile->resource != NULL
@@ -1447,6 +1586,8 @@ void update_tile_knowledge(struct tile *ptile)
     return;
   }
 
+  adv_pf_maps_invalidate();
+
   /* Players */
   players_iterate(pplayer) {
     if (map_is_known_and_seen(ptile, pplayer, V_MAIN)) {
@@ -1511,7 +1652,7 @@ static bool really_give_tile_info_from_player_to_player(struct player *pfrom,
       /* Update and send tile knowledge */
       map_set_known(ptile, pdest);
       dest_tile->terrain = from_tile->terrain;
-      dbv_copy(&(dest_tile->extras), &(from_tile->extras));
+      dest_tile->extras = from_tile->extras;
       dest_tile->resource = from_tile->resource;
       dest_tile->owner    = from_tile->owner;
       dest_tile->extras_owner = from_tile->extras_owner;
@@ -1667,11 +1808,12 @@ void give_shared_vision(struct player *pfrom, struct player *pto)
         log_debug("really giving shared vision from %s to %s",
                   player_name(pplayer), player_name(pplayer2));
         whole_map_iterate(&(wld.map), ptile) {
-          const struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+          const struct player_tile_seen *plrseen
+            = map_get_player_tile_seen(ptile, pplayer);
           const v_radius_t change =
-              V_RADIUS(player_tile_own_seen(plrtile, V_MAIN),
-                       player_tile_own_seen(plrtile, V_INVIS),
-                       player_tile_own_seen(plrtile, V_SUBSURFACE));
+              V_RADIUS(player_tile_own_seen(plrseen, V_MAIN),
+                       player_tile_own_seen(plrseen, V_INVIS),
+                       player_tile_own_seen(plrseen, V_SUBSURFACE));
 
           if (0 < change[V_MAIN] || 0 < change[V_INVIS]) {
             map_change_seen(pplayer2, ptile, change,
@@ -1726,11 +1868,12 @@ void remove_shared_vision(struct player *pfrom, struct player *pto)
         log_debug("really removing shared vision from %s to %s",
                   player_name(pplayer), player_name(pplayer2));
         whole_map_iterate(&(wld.map), ptile) {
-          const struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
+          const struct player_tile_seen *plrseen
+            = map_get_player_tile_seen(ptile, pplayer);
           const v_radius_t change =
-              V_RADIUS(-player_tile_own_seen(plrtile, V_MAIN),
-                       -player_tile_own_seen(plrtile, V_INVIS),
-                       -player_tile_own_seen(plrtile, V_SUBSURFACE));
+              V_RADIUS(-player_tile_own_seen(plrseen, V_MAIN),
+                       -player_tile_own_seen(plrseen, V_INVIS),
+                       -player_tile_own_seen(plrseen, V_SUBSURFACE));
 
           if (0 > change[V_MAIN] || 0 > change[V_INVIS]) {
             map_change_seen(pplayer2, ptile, change, FALSE);
@@ -2148,6 +2291,7 @@ static void map_claim_border_ownership(struct tile *ptile,
   }
 
   tile_set_owner(ptile, powner, psource);
+  adv_pf_maps_invalidate();
 
   /* Needed only when foggedborders enabled, but we do it unconditionally
    * in case foggedborders ever gets enabled later. Better to have correct
@@ -2468,6 +2612,78 @@ void map_claim_base(struct tile *ptile, struct extra_type *pextra,
   }
 }
 
+/**********************************************************************//**
+  Is the tile within the sight of the vision source on the layer?
+**************************************************************************/
+static inline bool vision_covers_tile(const struct vision *vision,
+                                      const struct tile *ptile,
+                                      enum vision_layer vlayer)
+{
+  return (vision->radius_sq[vlayer] >= 0
+          && sq_map_distance(vision->tile, ptile)
+             <= vision->radius_sq[vlayer]);
+}
+
+/**********************************************************************//**
+  Change the seen count by 'change' on the tiles within the sight of the
+  vision source that also are (if 'shared') or are not (if not 'shared')
+  within the sight of the 'other' vision source, layer by layer.
+**************************************************************************/
+static void vision_change_sight_part(struct vision *vision,
+                                     const struct vision *other,
+                                     bool shared, int change)
+{
+  int max_radius = -1;
+
+  vision_layer_iterate(v) {
+    if (max_radius < vision->radius_sq[v]) {
+      max_radius = vision->radius_sq[v];
+    }
+  } vision_layer_iterate_end;
+
+  if (max_radius < 0) {
+    return;
+  }
+
+  buffer_shared_vision(vision->player);
+  circle_dxyr_iterate(&(wld.map), vision->tile, max_radius, ptile,
+                      dx, dy, dr) {
+    v_radius_t tile_change;
+    bool changed = FALSE;
+
+    vision_layer_iterate(v) {
+      if (dr <= vision->radius_sq[v]
+          && vision_covers_tile(other, ptile, v) == shared) {
+        tile_change[v] = change;
+        changed = TRUE;
+      } else {
+        tile_change[v] = 0;
+      }
+    } vision_layer_iterate_end;
+
+    if (changed) {
+      shared_vision_change_seen(vision->player, ptile, tile_change,
+                                vision->can_reveal_tiles);
+    }
+  } circle_dxyr_iterate_end;
+  unbuffer_shared_vision(vision->player);
+}
+
+/**********************************************************************//**
+  End the sight hand over between the vision sources. Both of them get
+  their own sight points to the tiles they share again.
+**************************************************************************/
+static void vision_split_sight(struct vision *old_vision,
+                               struct vision *new_vision)
+{
+  fc_assert_ret(old_vision->successor == new_vision);
+  fc_assert_ret(new_vision->predecessor == old_vision);
+
+  old_vision->successor = nullptr;
+  new_vision->predecessor = nullptr;
+  vision_change_sight_part(new_vision, old_vision, TRUE, +1);
+}
+
 /**********************************************************************//**
   Change the sight points for the vision source, fogging or unfogging tiles
   as needed.
@@ -2476,11 +2692,51 @@ void map_claim_base(struct tile *ptile, struct extra_type *pextra,
 **************************************************************************/
 void vision_change_sight(struct vision *vision, const v_radius_t radius_sq)
 {
+  if (vision->successor != nullptr) {
+    vision_split_sight(vision, vision->successor);
+  }
+  if (vision->predecessor != nullptr) {
+    vision_split_sight(vision->predecessor, vision);
+  }
+
   map_vision_update(vision->player, vision->tile, vision->radius_sq,
                     radius_sq, vision->can_reveal_tiles);
   memcpy(vision->radius_sq, radius_sq, sizeof(v_radius_t));
 }
 
+/**********************************************************************//**
+  Give the sight of 'old_vision' over to 'new_vision', which is to have
+  the sight 'radius_sq'. This is what happens when a unit moves, and
+  'old_vision' is to be cleared soon after.
+
+  Instead of adding the whole new sight now and removing the whole old
+  sight later, only the tiles entering the sight get sight points now,
+  and only the tiles leaving the sight lose them when 'old_vision' is
+  cleared. The tiles seen by both are left alone, which also means
+  that they never get their tile info resent in between.
+**************************************************************************/
+void vision_take_over_sight(struct vision *new_vision,
+                            const v_radius_t radius_sq,
+                            struct vision *old_vision)
+{
+  fc_assert_ret(new_vision->predecessor == nullptr);
+  fc_assert_ret(new_vision->radius_sq[V_MAIN] == -1);
+
+  if (old_vision == nullptr
+      || old_vision->successor != nullptr
+      || old_vision->predecessor != nullptr
+      || old_vision->player != new_vision->player
+      || old_vision->can_reveal_tiles != new_vision->can_reveal_tiles) {
+    vision_change_sight(new_vision, radius_sq);
+    return;
+  }
+
+  memcpy(new_vision->radius_sq, radius_sq, sizeof(v_radius_t));
+  vision_change_sight_part(new_vision, old_vision, FALSE, +1);
+  old_vision->successor = new_vision;
+  new_vision->predecessor = old_vision;
+}
+
 /**********************************************************************//**
   Clear all sight points from this vision source.
 
@@ -2490,7 +2746,15 @@ void vision_clear_sight(struct vision *vision)
 {
   const v_radius_t vision_radius_sq = V_RADIUS(-1, -1, -1);
 
-  vision_change_sight(vision, vision_radius_sq);
+  if (vision->successor != nullptr) {
+    /* Only the tiles not seen by the successor are left behind. */
+    vision->successor->predecessor = nullptr;
+    vision_change_sight_part(vision, vision->successor, FALSE, -1);
+    vision->successor = nullptr;
+    memcpy(vision->radius_sq, vision_radius_sq, sizeof(v_radius_t));
+  } else {
+    vision_change_sight(vision, vision_radius_sq);
+  }
 
   /* Owner of some city might have lost vision of a tile previously worked */
   players_iterate(pplayer) {
@@ -33,15 +33,20 @@ struct player_tile {
   struct terrain *terrain;		/* NULL for unknown tiles */
   struct player *owner; 		/* NULL for unowned */
   struct player *extras_owner;
-  struct dbv extras;
+  bv_extras extras;
+  short last_updated;
+};
 
+/* Vision counts of a player tile. These change much more often than
+ * the rest of the player's knowledge of the tile, so they are stored
+ * in an array of their own, parallel to the player_tile array. */
+struct player_tile_seen {
   /* If you build a city with an unknown square within city radius
      the square stays unknown. However, we still have to keep count
      of the seen points, so they are kept in here. When the tile
      then becomes known they are moved to seen. */
   v_radius_t own_seen;
   v_radius_t seen_count;
-  short last_updated;
 };
 
 void global_warming(int effect);
@@ -95,6 +100,8 @@ struct vision_site *map_get_player_city(const struct tile *ptile,
 
 struct player_tile *map_get_player_tile(const struct tile *ptile,
                                         const struct player *pplayer);
+struct player_tile_seen *map_get_player_tile_seen(const struct tile *ptile,
+                                                  const struct player *pplayer);
 bool update_player_tile_knowledge(struct player *pplayer, struct tile *ptile);
 void update_tile_knowledge(struct tile *ptile);
 void update_player_tile_last_seen(struct player *pplayer, struct tile *ptile);
@@ -133,6 +140,9 @@ void bounce_units_on_terrain_change(struct tile *ptile);
 void vision_change_sight(struct vision *vision,
                          const v_radius_t radius_sq);
 void vision_clear_sight(struct vision *vision);
+void vision_take_over_sight(struct vision *new_vision,
+                            const v_radius_t radius_sq,
+                            struct vision *old_vision);
 
 void change_playertile_site(struct player_tile *ptile,
                             struct vision_site *new_site);
@@ -69,6 +69,7 @@
 
 /* server/advisors */
 #include "advdata.h"
+#include "advgoto.h"
 
 /* server/scripting */
 #include "script_server.h"
@@ -128,6 +129,7 @@ void kill_player(struct player *pplayer)
   struct player *barbarians = nullptr;
 
   pplayer->is_alive = FALSE;
+  game.effects_epoch++;
 
   /* Reset player status */
   player_status_reset(pplayer);
@@ -349,6 +351,7 @@ void government_change(struct player *pplayer, struct government *gov,
 
   pplayer->government = gov;
   pplayer->target_government = nullptr;
+  game.effects_epoch++;
 
   if (revolution_finished) {
     log_debug("Revolution finished for %s. Government is %s. "
@@ -615,6 +618,7 @@ void handle_player_change_government(struct player *pplayer,
   pplayer->government = game.government_during_revolution;
   pplayer->target_government = gov;
   pplayer->revolution_finishes = game.info.turn + turns;
+  game.effects_epoch++;
 
   log_debug("Revolution started for %s. Target government is %s. "
             "Revofin %d (%d).", player_name(pplayer),
@@ -971,6 +975,8 @@ void handle_diplomacy_cancel_pact(struct player *pplayer,
   /* Do the change */
   ds_plrplr2->type = ds_plr2plr->type = new_type;
   ds_plrplr2->turns_left = ds_plr2plr->turns_left = 16;
+  game.effects_epoch++;
+  adv_pf_maps_invalidate();
 
   if (new_type == DS_WAR) {
     player_update_last_war_action(pplayer);
@@ -1630,6 +1636,7 @@ void server_player_init(struct player *pplayer, bool initmap,
 
   player_map_free(pplayer);
   pplayer->server.private_map = nullptr;
+  pplayer->server.private_seen = nullptr;
 
   if (initmap) {
     player_map_init(pplayer);
@@ -1933,6 +1940,8 @@ struct player *server_create_player(int player_id, const char *ai_tname,
     player_set_color(pplayer, prgbcolor);
   } /* Else caller must ensure a color is assigned if game has started */
 
+  game.effects_epoch++;
+
   return pplayer;
 }
 
@@ -2037,6 +2046,7 @@ void server_remove_player(struct player *pplayer)
   ai_traits_close(pplayer);
   adv_data_close(pplayer);
   player_destroy(pplayer);
+  game.effects_epoch++;
 
   send_updated_vote_totals(nullptr);
   /* Must be called after the player was destroyed */
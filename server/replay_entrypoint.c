@@ -0,0 +1,231 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include "fc_prehdrs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* utility */
+#include "executable.h"
+#include "fc_cmdline.h"
+#include "fciconv.h"
+#include "fcintl.h"
+#include "log.h"
+#include "support.h"
+
+/* common */
+#include "capstr.h"
+#include "fc_cmdhelp.h"
+#include "game.h"
+#include "version.h"
+
+/* server */
+#include "aiiface.h"
+#include "console.h"
+#include "srv_main.h"
+#include "srv_replay.h"
+#include "srv_signal.h"
+
+/**********************************************************************//**
+ Entry point for the packet trace replay. Loads the game like the server
+ that recorded the trace did, replays the packets the clients sent to it,
+ and writes the time spent handling them as JSON.
+**************************************************************************/
+int main(int argc, char *argv[])
+{
+  int inx;
+  float speed = 0.0;
+  bool showhelp = FALSE;
+  bool showvers = FALSE;
+  char *trace = nullptr;
+  char *output = nullptr;
+  char *option = nullptr;
+
+  executable_init();
+  setup_interrupt_handlers();
+
+  /* Initialize server */
+  srv_init();
+
+  srvarg.announce = ANNOUNCE_NONE;
+  srvarg.exit_on_end = TRUE;
+
+  game.server.meta_info.type[0] = '\0';
+
+  inx = 1;
+  while (inx < argc) {
+    if ((option = get_option_malloc("--file", argv, &inx, argc,
+                                    FALSE))) {
+      sz_strlcpy(srvarg.load_filename, option);
+      free(option);
+    } else if ((option = get_option_malloc("--trace", argv, &inx, argc,
+                                           FALSE))) {
+      free(trace);
+      trace = option;
+    } else if ((option = get_option_malloc("--Speed", argv, &inx, argc,
+                                           FALSE))) {
+      int whole;
+
+      if (str_to_int(option, &whole)) {
+        speed = whole;
+      } else if (!str_to_float(option, &speed)) {
+        speed = -1.0;
+      }
+      if (speed < 0.0) {
+        fc_fprintf(stderr, _("Invalid replay speed \"%s\".\n"), option);
+        showhelp = TRUE;
+        free(option);
+        break;
+      }
+      free(option);
+    } else if ((option = get_option_malloc("--output", argv, &inx, argc,
+                                           FALSE))) {
+      output = option;
+    } else if ((option = get_option_malloc("--Threads", argv, &inx, argc,
+                                           FALSE))) {
+      if (!str_to_int(option, &srvarg.threads) || srvarg.threads < 1) {
+        fc_fprintf(stderr, _("Invalid number of threads \"%s\".\n"), option);
+        showhelp = TRUE;
+        free(option);
+        break;
+      }
+      free(option);
+    } else if (is_option("--help", argv[inx])) {
+      showhelp = TRUE;
+      break;
+    } else if ((option = get_option_malloc("--log", argv, &inx, argc, TRUE))) {
+      srvarg.log_filename = option;
+    } else if ((option = get_option_malloc("--debug", argv, &inx, argc, FALSE))) {
+      if (!log_parse_level_str(option, &srvarg.loglevel)) {
+        showhelp = TRUE;
+        break;
+      }
+      free(option);
+    } else if ((option = get_option_malloc("--read", argv, &inx, argc, TRUE))) {
+      srvarg.script_filename = option;
+    } else if ((option = get_option_malloc("--saves", argv, &inx, argc, TRUE))) {
+      srvarg.saves_pathname = option;
+    } else if ((option = get_option_malloc("--ruleset", argv, &inx, argc, TRUE))) {
+      srvarg.ruleset = option;
+    } else if (is_option("--version", argv[inx])) {
+      showvers = TRUE;
+#ifdef AI_MODULES
+    } else if ((option = get_option_malloc("--LoadAI", argv, &inx, argc, FALSE))) {
+      if (!load_ai_module(option)) {
+        fc_fprintf(stderr, _("Failed to load AI module \"%s\"\n"), option);
+        exit(EXIT_FAILURE);
+      }
+      free(option);
+#endif /* AI_MODULES */
+    } else {
+      fc_fprintf(stderr, _("Error: unknown option '%s'\n"), argv[inx]);
+      showhelp = TRUE;
+      break;
+    }
+    inx++;
+  }
+
+  if (showvers && !showhelp) {
+    fc_fprintf(stderr, "%s \n", freeciv_name_version());
+    exit(EXIT_SUCCESS);
+  }
+
+  if (trace == nullptr && !showhelp && !showvers) {
+    fc_fprintf(stderr, _("No packet trace to replay given.\n"));
+    showhelp = TRUE;
+  }
+
+  if (showhelp) {
+    struct cmdhelp *help = cmdhelp_new(argv[0]);
+
+    cmdhelp_add(help, "d",
+                /* TRANS: "debug" is exactly what user must type, do not translate. */
+                _("debug LEVEL"),
+                _("Set debug log level"));
+    cmdhelp_add(help, "f",
+                /* TRANS: "file" is exactly what user must type, do not translate. */
+                _("file FILE"),
+                _("Load saved game FILE"));
+    cmdhelp_add(help, "h", "help",
+                _("Print a summary of the options"));
+    cmdhelp_add(help, "l",
+                /* TRANS: "log" is exactly what user must type, do not translate. */
+                _("log FILE"),
+                _("Use FILE as logfile"));
+    cmdhelp_add(help, "o",
+                /* TRANS: "output" is exactly what user must type, do not translate. */
+                _("output FILE"),
+                _("Write JSON report to FILE instead of stdout"));
+    cmdhelp_add(help, "r",
+                /* TRANS: "read" is exactly what user must type, do not translate. */
+                _("read FILE"),
+                _("Read startup script FILE"));
+    cmdhelp_add(help, NULL,
+                /* TRANS: "ruleset" is exactly what user must type, do not translate. */
+                _("ruleset RULESET"),
+                _("Load ruleset RULESET"));
+    cmdhelp_add(help, "s",
+                /* TRANS: "saves" is exactly what user must type, do not translate. */
+                _("saves DIR"),
+                _("Save games to directory DIR"));
+    cmdhelp_add(help, "S",
+                /* TRANS: "Speed" is exactly what user must type, do not translate. */
+                _("Speed FACTOR"),
+                _("Replay at FACTOR times the recorded pace, "
+                  "or as fast as possible if 0 (default)"));
+    cmdhelp_add(help, "t",
+                /* TRANS: "trace" is exactly what user must type, do not translate. */
+                _("trace FILE"),
+                _("Replay the packet trace FILE"));
+    cmdhelp_add(help, "T",
+                /* TRANS: "Threads" is exactly what user must type, do not translate. */
+                _("Threads NUMBER"),
+                _("Use NUMBER threads in turn change processing, "
+                  "map generation and tex AI planning"));
+#ifdef AI_MODULES
+    cmdhelp_add(help, "L",
+                /* TRANS: "LoadAI" is exactly what user must type, do not translate. */
+                _("LoadAI MODULE"),
+                _("Load ai module MODULE. Can appear multiple times"));
+#endif /* AI_MODULES */
+    cmdhelp_add(help, "v", "version",
+                _("Print the version number"));
+
+    cmdhelp_display(help, TRUE, FALSE, TRUE);
+    cmdhelp_destroy(help);
+
+    exit(EXIT_SUCCESS);
+  }
+
+  /* disallow running as root -- too dangerous */
+  dont_run_as_root(argv[0], "freeciv_replay");
+
+  init_our_capability();
+
+  if (!replay_init(trace, speed, output)) {
+    exit(EXIT_FAILURE);
+  }
+  free(trace);
+  free(output);
+
+  srv_main();
+
+  /* Technically, we won't ever get here. We exit via server_quit. */
+
+  exit(EXIT_SUCCESS);
+}
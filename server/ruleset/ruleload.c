@@ -27,6 +27,7 @@
 #include "log.h"
 #include "mem.h"
 #include "registry.h"
+#include "registry_bin.h"
 #include "shared.h"
 #include "string_vector.h"
 #include "support.h"
@@ -85,6 +86,10 @@
 /* RULESET_SUFFIX already used, no leading dot here */
 #define RULES_SUFFIX "ruleset"
 #define SCRIPT_SUFFIX "lua"
+#define IMAGE_SUFFIX RULES_SUFFIX BINFILE_SUFFIX
+/* Section of a ruleset image listing the files the text file includes.
+ * It is removed before the image is handed to the loaders. */
+#define IMAGE_INCLUDES_SECTION "ruleset_image"
 
 #define ADVANCE_SECTION_PREFIX "advance_"
 #define TECH_CLASS_SECTION_PREFIX "techclass_"
@@ -578,9 +583,99 @@ char *get_parser_buffer(void)
   return parser_buffer;
 }
 
+/**********************************************************************//**
+  Returns whether some of the files the ruleset image includes have been
+  modified after the image was written at 'image_time', or can't be
+  found any more.
+**************************************************************************/
+static bool ruleset_image_includes_changed(struct section_file *secfile,
+                                           time_t image_time)
+{
+  const char **includes;
+  size_t num_includes, i;
+  bool changed = FALSE;
+
+  if (secfile_section_by_name(secfile, IMAGE_INCLUDES_SECTION) == NULL) {
+    return FALSE;
+  }
+
+  includes = secfile_lookup_str_vec(secfile, &num_includes, "%s.files",
+                                    IMAGE_INCLUDES_SECTION);
+  for (i = 0; i < num_includes && !changed; i++) {
+    const char *dfilename = fileinfoname(get_data_dirs(), includes[i]);
+    struct stat include_buf;
+
+    if (dfilename == NULL
+        || fc_stat(dfilename, &include_buf) != 0
+        || image_time < include_buf.st_mtime) {
+      changed = TRUE;
+    }
+  }
+  free(includes);
+
+  return changed;
+}
+
+/**********************************************************************//**
+  Load the precompiled image of a ruleset file, written by
+  save_ruleset_images(), if there is one in the data path for the
+  ruleset directory. An image older than the text file "sfilename", or
+  than any of the files it includes, is ignored. Returns NULL if there
+  is no usable image.
+**************************************************************************/
+static struct section_file *openload_ruleset_image(const char *whichset,
+                                                   const char *rsdir,
+                                                   const char *sfilename)
+{
+  char filename[512], dfilename[2048];
+  const char *found;
+  struct stat text_buf, image_buf;
+  struct section_file *secfile;
+  struct section *psection;
+
+  fc_snprintf(filename, sizeof(filename), "%s" DIR_SEPARATOR "%s.%s",
+              rsdir, whichset, IMAGE_SUFFIX);
+  found = fileinfoname(get_data_dirs(), filename);
+  if (found == NULL) {
+    return NULL;
+  }
+  /* Looking for the included files reuses the buffer. */
+  sz_strlcpy(dfilename, found);
+
+  if (fc_stat(dfilename, &image_buf) != 0
+      || fc_stat(sfilename, &text_buf) != 0
+      || image_buf.st_mtime < text_buf.st_mtime) {
+    log_verbose("Ignoring outdated ruleset image \"%s\".", dfilename);
+    return NULL;
+  }
+
+  secfile = binfile_load(dfilename, FALSE);
+  if (secfile == NULL) {
+    log_error("Could not load ruleset image \"%s\": %s",
+              dfilename, secfile_error());
+    return NULL;
+  }
+
+  if (ruleset_image_includes_changed(secfile, image_buf.st_mtime)) {
+    log_verbose("Ignoring outdated ruleset image \"%s\".", dfilename);
+    secfile_destroy(secfile);
+    return NULL;
+  }
+
+  psection = secfile_section_by_name(secfile, IMAGE_INCLUDES_SECTION);
+  if (psection != NULL) {
+    section_destroy(psection);
+  }
+  log_verbose("Loaded ruleset image \"%s\".", dfilename);
+
+  return secfile;
+}
+
 /**********************************************************************//**
   Do initial section_file_load on a ruleset file.
   "whichset" = "techs", "units", "buildings", "terrain", ...
+  A precompiled image of the file is used instead of the text file
+  when there is an up to date one.
 **************************************************************************/
 static struct section_file *openload_ruleset_file(const char *whichset,
                                                   const char *rsdir)
@@ -597,6 +692,11 @@ static struct section_file *openload_ruleset_file(const char *whichset,
   /* Need to save a copy of the filename for following message, since
      section_file_load() may call datafilename() for includes. */
   sz_strlcpy(sfilename, dfilename);
+  secfile = openload_ruleset_image(whichset, rsdir, sfilename);
+  if (secfile != NULL) {
+    return secfile;
+  }
+
   secfile = secfile_load(sfilename, FALSE);
 
   if (secfile == NULL) {
@@ -607,6 +707,78 @@ static struct section_file *openload_ruleset_file(const char *whichset,
   return secfile;
 }
 
+/**********************************************************************//**
+  Write precompiled images of the ruleset files of the ruleset directory
+  to "tgt_dir" DIR_SEPARATOR "rsdir". Adding "tgt_dir" to the data path
+  makes the server load the images instead of parsing the text files.
+  The images are in the binary section file format, so the server maps
+  them to the memory, and the processes that load the same ruleset share
+  the pages of the images. Each image lists the files its text file
+  includes, and is ignored once one of them, or the text file itself,
+  is newer than the image.
+  Returns TRUE if all the images were written.
+**************************************************************************/
+bool save_ruleset_images(const char *rsdir, const char *tgt_dir)
+{
+  const char *whichsets[] = {
+    "game", "techs", "actions", "buildings", "governments", "units",
+    "terrain", "styles", "cities", "nations", "effects", NULL
+  };
+  char dirname[2048];
+  int i;
+
+  fc_snprintf(dirname, sizeof(dirname), "%s" DIR_SEPARATOR "%s",
+              tgt_dir, rsdir);
+  if (!make_dir(dirname, DIRMODE_DEFAULT)) {
+    log_error(_("Failed to create directory %s"), dirname);
+    return FALSE;
+  }
+
+  for (i = 0; whichsets[i] != NULL; i++) {
+    char sfilename[512], ifilename[2560];
+    const char *dfilename = valid_ruleset_filename(rsdir, whichsets[i],
+                                                   RULES_SUFFIX, FALSE);
+    struct section_file *secfile;
+    struct strvec *includes;
+    bool saved;
+
+    if (dfilename == NULL) {
+      return FALSE;
+    }
+
+    /* Always compile the text file, not an earlier image of it. */
+    sz_strlcpy(sfilename, dfilename);
+    includes = strvec_new();
+    secfile = secfile_load_with_includes(sfilename, FALSE, includes);
+    if (secfile == NULL) {
+      log_error("Could not load ruleset '%s':\n%s",
+                sfilename, secfile_error());
+      strvec_destroy(includes);
+      return FALSE;
+    }
+
+    strvec_remove_duplicate(includes, strcmp);
+    if (strvec_size(includes) > 0) {
+      secfile_insert_str_vec(secfile, (const char **) strvec_data(includes),
+                             strvec_size(includes), "%s.files",
+                             IMAGE_INCLUDES_SECTION);
+    }
+    strvec_destroy(includes);
+
+    fc_snprintf(ifilename, sizeof(ifilename), "%s" DIR_SEPARATOR "%s.%s",
+                dirname, whichsets[i], IMAGE_SUFFIX);
+    saved = binfile_save(secfile, ifilename);
+    secfile_destroy(secfile);
+    if (!saved) {
+      log_error("Could not save ruleset image '%s':\n%s",
+                ifilename, secfile_error());
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
 /**********************************************************************//**
   Parse script file.
 **************************************************************************/
@@ -9706,6 +9878,9 @@ static bool load_rulesetdir(const char *rsdir, bool compat_mode,
 
   if (ok) {
     rscompat_postprocess(&compat_info);
+
+    /* The effects don't change any more */
+    effect_index_build();
   }
 
   if (ok) {
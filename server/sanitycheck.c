@@ -121,7 +121,7 @@ static void check_fow(const char *file, const char *function, int line)
 
   whole_map_iterate(&(wld.map), ptile) {
     players_iterate(pplayer) {
-      struct player_tile *plr_tile = map_get_player_tile(ptile, pplayer);
+      struct player_tile_seen *plr_tile = map_get_player_tile_seen(ptile, pplayer);
 
       vision_layer_iterate(v) {
         /* underflow of unsigned int */
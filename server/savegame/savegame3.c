@@ -44,7 +44,18 @@
 
   Creating a savegame:
 
-  (nothing at the moment)
+  - The map sized parts of the savegame (the map layers and the private
+    maps of the players) are not inserted into the section file by the
+    sg_save_*() functions. They only copy the data into compact arrays,
+    using sg_defer_*(), SAVE_MAP_CHAR and sg_snapshot_new().
+    savegame3_save_deferred() encodes them into lines of the section file
+    later, in the saving thread if there is one, so that the game does
+    not wait for it. It must not look at the game state or the rulesets,
+    which may change meanwhile.
+
+  - The deferred entries are inserted in the order they were made in, so
+    everything saved after the first deferred entry of a section has to
+    be deferred too.
 
   Loading a savegame:
 
@@ -66,6 +77,7 @@
 #endif
 
 #include <ctype.h>
+#include <limits.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -160,36 +172,41 @@ extern bool sg_success;
 #endif
 
 /*
- * This loops over the entire map to save data. It collects all the data of
- * a line using GET_XY_CHAR and then executes the macro SECFILE_INSERT_LINE.
+ * This loops over the entire map to save data. It collects the character
+ * of every position using GET_XY_CHAR, and defers the insertion of the
+ * lines into the secfile with sg_defer_chars().
  *
  * Parameters:
  *   ptile:         current tile within the line (used by GET_XY_CHAR)
  *   GET_XY_CHAR:   macro returning the map character for each position
- *   secfile:       a secfile struct
- *   secpath, ...:  path as used for sprintf() with arguments; the last item
- *                  will be the y coordinate
+ *   saving:        a savedata struct
+ *   secpath, ...:  path as used for sprintf() with arguments, without the
+ *                  y coordinate; "%04d" of it is appended for each line
  * Example:
- *   SAVE_MAP_CHAR(ptile, terrain2char(ptile->terrain), file, "map.t%04d");
+ *   SAVE_MAP_CHAR(ptile, terrain2char(ptile->terrain), saving, "map.t");
  */
-#define SAVE_MAP_CHAR(ptile, GET_XY_CHAR, secfile, secpath, ...)            \
+#define SAVE_MAP_CHAR(ptile, GET_XY_CHAR, saving, secpath, ...)             \
 {                                                                           \
-  char _line[MAP_NATIVE_WIDTH + 1];                                         \
+  char *_chars = fc_malloc(MAP_INDEX_SIZE);                                 \
   int _nat_x, _nat_y;                                                       \
                                                                             \
   for (_nat_y = 0; _nat_y < MAP_NATIVE_HEIGHT; _nat_y++) {                  \
     for (_nat_x = 0; _nat_x < MAP_NATIVE_WIDTH; _nat_x++) {                 \
       struct tile *ptile = native_pos_to_tile(&(wld.map), _nat_x, _nat_y);  \
+      char _ch;                                                             \
+                                                                            \
       fc_assert_action(ptile != NULL, continue);                            \
-      _line[_nat_x] = (GET_XY_CHAR);                                        \
-      sg_failure_ret(fc_isprint(_line[_nat_x] & 0x7f),                      \
-                     "Trying to write invalid map data at position "        \
-                     "(%d, %d) for path %s: '%c' (%d)", _nat_x, _nat_y,     \
-                     secpath, _line[_nat_x], _line[_nat_x]);                \
+      _ch = (GET_XY_CHAR);                                                  \
+      if (!fc_isprint(_ch & 0x7f)) {                                        \
+        free(_chars);                                                       \
+        sg_failure_ret(FALSE, "Trying to write invalid map data at "        \
+                       "position (%d, %d) for path %s: '%c' (%d)",          \
+                       _nat_x, _nat_y, secpath, _ch, _ch);                  \
+      }                                                                     \
+      _chars[_nat_y * MAP_NATIVE_WIDTH + _nat_x] = _ch;                     \
     }                                                                       \
-    _line[MAP_NATIVE_WIDTH] = '\0';                                         \
-    secfile_insert_str(secfile, _line, secpath, ## __VA_ARGS__, _nat_y);    \
   }                                                                         \
+  sg_defer_chars(saving, _chars, secpath, ## __VA_ARGS__);                  \
 }
 
 /*
@@ -274,6 +291,70 @@ struct savedata {
 
   /* Set in sg_save_game(); needed in sg_save_map_*(); ... */
   bool save_players;
+
+  /* Filled by sg_defer_*() */
+  struct savegame3_deferred *deferred;
+};
+
+/* An entry of the savegame, or a map sized layer of lines, whose insertion
+ * into the secfile is left to savegame3_save_deferred(). */
+enum sg_deferred_type {
+  SGD_CHARS,            /* A line of 'chars' for every native row */
+  SGD_NUMBERS,          /* Comma separated 'numbers' for every native row */
+  SGD_STR,
+  SGD_INT,
+  SGD_BOOL
+};
+
+/* Written as "-" in SGD_NUMBERS lines */
+#define SGD_NONE INT_MIN
+
+/* The extras of a tile, or of a player's view of it, for encoding them
+ * in the saving thread */
+struct sg_tile_snapshot {
+  bv_extras extras;
+  int resource;         /* Extra number, or -1 */
+  int last_updated;
+};
+
+struct sg_deferred_entry;
+
+/* Returns the SGD_CHARS character of the tile with the given index */
+typedef char (*sg_tile_char_fn)(const struct sg_deferred_entry *pentry,
+                                int tile);
+
+struct sg_deferred_entry {
+  enum sg_deferred_type type;
+  char *path;
+
+  /* SGD_CHARS; one per tile in native order, or tile_char() of the
+   * snapshot data */
+  char *chars;
+  sg_tile_char_fn tile_char;
+  const void *data;
+  int args[4];
+
+  int *numbers;         /* SGD_NUMBERS; one per tile, in native order */
+  bool trailing_comma;  /* SGD_NUMBERS; a comma after the last number too */
+  char *str;            /* SGD_STR */
+  int value;            /* SGD_INT, SGD_BOOL */
+};
+
+#define SPECLIST_TAG sg_deferred_entry
+#define SPECLIST_TYPE struct sg_deferred_entry
+#include "speclist.h"
+
+#define sg_deferred_entry_list_iterate(entries, pentry) \
+    TYPED_LIST_ITERATE(struct sg_deferred_entry, entries, pentry)
+#define sg_deferred_entry_list_iterate_end  LIST_ITERATE_END
+
+struct savegame3_deferred {
+  /* The size of the map when it was saved */
+  int width;
+  int height;
+
+  struct sg_deferred_entry_list *entries;
+  struct genlist *snapshots;
 };
 
 #define TOKEN_SIZE 10
@@ -284,9 +365,9 @@ static const char savefile_options_default[] =
  *  - nothing at current version
  * See also calls to sg_save_savefile_options(). */
 
-static void savegame3_save_real(struct section_file *file,
-                                const char *save_reason,
-                                bool scenario);
+static struct savegame3_deferred *
+savegame3_save_real(struct section_file *file, const char *save_reason,
+                    bool scenario);
 static struct loaddata *loaddata_new(struct section_file *file);
 static void loaddata_destroy(struct loaddata *loading);
 
@@ -295,6 +376,33 @@ static struct savedata *savedata_new(struct section_file *file,
                                      bool scenario);
 static void savedata_destroy(struct savedata *saving);
 
+static void sg_defer_chars(struct savedata *saving, char *chars,
+                           const char *path, ...)
+                           fc__attribute((__format__ (__printf__, 3, 4)));
+static void *sg_snapshot_new(struct savedata *saving, size_t size);
+static void sg_defer_tile_chars(struct savedata *saving, const void *data,
+                                sg_tile_char_fn tile_char, const int *args,
+                                const char *path, ...)
+                                fc__attribute((__format__ (__printf__, 5, 6)));
+static char sg_tile_extras_char(const struct sg_deferred_entry *pentry,
+                                int tile);
+static char sg_tile_updated_char(const struct sg_deferred_entry *pentry,
+                                 int tile);
+static char sg_tile_known_char(const struct sg_deferred_entry *pentry,
+                               int tile);
+static void sg_defer_numbers(struct savedata *saving, int *numbers,
+                             bool trailing_comma, const char *path, ...)
+                             fc__attribute((__format__ (__printf__, 4, 5)));
+static void sg_defer_str(struct savedata *saving, const char *str,
+                         const char *path, ...)
+                         fc__attribute((__format__ (__printf__, 3, 4)));
+static void sg_defer_int(struct savedata *saving, int value,
+                         const char *path, ...)
+                         fc__attribute((__format__ (__printf__, 3, 4)));
+static void sg_defer_bool(struct savedata *saving, bool value,
+                          const char *path, ...)
+                          fc__attribute((__format__ (__printf__, 3, 4)));
+
 static enum unit_orders char2order(char order);
 static char order2char(enum unit_orders order);
 static enum direction8 char2dir(char dir);
@@ -311,12 +419,7 @@ static void worklist_save(struct section_file *file,
                           int max_length, const char *path, ...);
 static void unit_ordering_calc(void);
 static void unit_ordering_apply(void);
-static void sg_extras_set_dbv(struct dbv *extras, char ch, struct extra_type **idx);
 static void sg_extras_set_bv(bv_extras *extras, char ch, struct extra_type **idx);
-static char sg_extras_get_dbv(struct dbv *extras, struct extra_type *presource,
-                              const int *idx);
-static char sg_extras_get_bv(bv_extras extras, struct extra_type *presource,
-                             const int *idx);
 static struct terrain *char2terrain(char ch);
 static char terrain2char(const struct terrain *pterrain);
 static Tech_type_id technology_load(struct section_file *file,
@@ -429,12 +532,17 @@ static void sg_save_sanitycheck(struct savedata *saving);
 
 
 /************************************************************************//**
-  Main entry point for saving a game in savegame3 format.
+  Main entry point for saving a game in savegame3 format. The map sized
+  parts of the game are returned, to be added to the sfile with
+  savegame3_save_deferred().
 ****************************************************************************/
-void savegame3_save(struct section_file *sfile, const char *save_reason,
-                    bool scenario)
+struct savegame3_deferred *savegame3_save(struct section_file *sfile,
+                                          const char *save_reason,
+                                          bool scenario)
 {
-  fc_assert_ret(sfile != NULL);
+  struct savegame3_deferred *deferred;
+
+  fc_assert_ret_val(sfile != NULL, nullptr);
 
 #ifdef DEBUG_TIMERS
   struct timer *savetimer = timer_new(TIMER_CPU, TIMER_DEBUG, "save");
@@ -442,13 +550,181 @@ void savegame3_save(struct section_file *sfile, const char *save_reason,
 #endif
 
   log_verbose("saving game in new format ...");
-  savegame3_save_real(sfile, save_reason, scenario);
+  deferred = savegame3_save_real(sfile, save_reason, scenario);
 
 #ifdef DEBUG_TIMERS
   timer_stop(savetimer);
   log_debug("Creating secfile in %.3f seconds.", timer_read_seconds(savetimer));
   timer_destroy(savetimer);
 #endif /* DEBUG_TIMERS */
+
+  return deferred;
+}
+
+/************************************************************************//**
+  Insert a deferred entry into the sfile. 'line' has room for a row of
+  the map.
+****************************************************************************/
+static void sg_deferred_insert(struct section_file *sfile,
+                               const struct savegame3_deferred *deferred,
+                               const struct sg_deferred_entry *pentry,
+                               char *line)
+{
+  int x, y;
+
+  switch (pentry->type) {
+  case SGD_CHARS:
+    for (y = 0; y < deferred->height; y++) {
+      int tile = y * deferred->width;
+
+      if (pentry->chars != nullptr) {
+        memcpy(line, pentry->chars + tile, deferred->width);
+      } else {
+        for (x = 0; x < deferred->width; x++) {
+          line[x] = pentry->tile_char(pentry, tile + x);
+        }
+      }
+      line[deferred->width] = '\0';
+      secfile_insert_str(sfile, line, "%s%04d", pentry->path, y);
+    }
+    break;
+  case SGD_NUMBERS:
+    for (y = 0; y < deferred->height; y++) {
+      const int *numbers = pentry->numbers + y * deferred->width;
+      char *pline = line;
+
+      for (x = 0; x < deferred->width; x++) {
+        if (numbers[x] == SGD_NONE) {
+          *pline++ = '-';
+        } else {
+          fc_snprintf(pline, TOKEN_SIZE, "%d", numbers[x]);
+          pline += strlen(pline);
+        }
+        if (x + 1 < deferred->width || pentry->trailing_comma) {
+          *pline++ = ',';
+        }
+      }
+      *pline = '\0';
+      secfile_insert_str(sfile, line, "%s%04d", pentry->path, y);
+    }
+    break;
+  case SGD_STR:
+    secfile_insert_str(sfile, pentry->str, "%s", pentry->path);
+    break;
+  case SGD_INT:
+    secfile_insert_int(sfile, pentry->value, "%s", pentry->path);
+    break;
+  case SGD_BOOL:
+    secfile_insert_bool(sfile, pentry->value, "%s", pentry->path);
+    break;
+  }
+}
+
+/************************************************************************//**
+  Free a deferred entry.
+****************************************************************************/
+static void sg_deferred_entry_free(struct sg_deferred_entry *pentry)
+{
+  free(pentry->path);
+  free(pentry->chars);
+  free(pentry->numbers);
+  free(pentry->str);
+  free(pentry);
+}
+
+/************************************************************************//**
+  Insert the deferred entries of the named section into the sfile, and
+  drop them from the deferred ones.
+****************************************************************************/
+static void sg_deferred_insert_section(struct section_file *sfile,
+                                       struct savegame3_deferred *deferred,
+                                       const char *name, char *line)
+{
+  size_t len = strlen(name);
+
+  sg_deferred_entry_list_iterate(deferred->entries, pentry) {
+    if (!strncmp(pentry->path, name, len) && pentry->path[len] == '.') {
+      sg_deferred_insert(sfile, deferred, pentry, line);
+      sg_deferred_entry_list_remove(deferred->entries, pentry);
+      sg_deferred_entry_free(pentry);
+    }
+  } sg_deferred_entry_list_iterate_end;
+}
+
+/************************************************************************//**
+  Insert the map sized parts of the game returned by savegame3_save() into
+  the sfile, and free them. Does not touch the game state, so it can be
+  called from the saving thread.
+****************************************************************************/
+void savegame3_save_deferred(struct section_file *sfile,
+                             struct savegame3_deferred *deferred)
+{
+  char line[deferred->width * TOKEN_SIZE + 1];
+
+  sg_deferred_entry_list_iterate(deferred->entries, pentry) {
+    sg_deferred_insert(sfile, deferred, pentry, line);
+  } sg_deferred_entry_list_iterate_end;
+
+  savegame3_deferred_destroy(deferred);
+}
+
+/************************************************************************//**
+  Write the sfile and the map sized parts of the game returned by
+  savegame3_save() with the writer, one section at a time, and free the
+  map sized parts. The map rows of a section are only built right before
+  it is written, and the entries of each section are dropped as soon as
+  it has been written, so the whole text of the savegame is never in
+  memory at once. Writes the same file as savegame3_save_deferred()
+  followed by secfile_save() would. Like savegame3_save_deferred(), does
+  not touch the game state.
+****************************************************************************/
+void savegame3_save_stream(struct section_file *sfile,
+                           struct savegame3_deferred *deferred,
+                           struct secfile_writer *writer)
+{
+  char line[deferred->width * TOKEN_SIZE + 1];
+
+  section_list_iterate(secfile_sections(sfile), psection) {
+    sg_deferred_insert_section(sfile, deferred, section_name(psection),
+                               line);
+    secfile_writer_push(writer, psection);
+    section_clear_all(psection);
+  } section_list_iterate_end;
+
+  /* Sections that only have deferred entries come last, in the order
+   * they were first used in. */
+  while (sg_deferred_entry_list_size(deferred->entries) > 0) {
+    const char *path = sg_deferred_entry_list_get(deferred->entries, 0)->path;
+    const char *dot = strchr(path, '.');
+    char name[64];
+    struct section *psection;
+
+    fc_assert_action(dot != nullptr && dot - path < (int) sizeof(name), break);
+    fc_strlcpy(name, path, dot - path + 1);
+    sg_deferred_insert_section(sfile, deferred, name, line);
+
+    psection = secfile_section_by_name(sfile, name);
+    fc_assert_action(psection != nullptr, break);
+    secfile_writer_push(writer, psection);
+    section_clear_all(psection);
+  }
+
+  savegame3_deferred_destroy(deferred);
+}
+
+/************************************************************************//**
+  Free the map sized parts of the game returned by savegame3_save()
+  without saving them.
+****************************************************************************/
+void savegame3_deferred_destroy(struct savegame3_deferred *deferred)
+{
+  sg_deferred_entry_list_iterate(deferred->entries, pentry) {
+    sg_deferred_entry_free(pentry);
+  } sg_deferred_entry_list_iterate_end;
+
+  sg_deferred_entry_list_destroy(deferred->entries);
+  genlist_destroy(deferred->snapshots);
+  free(deferred);
 }
 
 /* =======================================================================
@@ -524,11 +800,12 @@ void savegame3_load(struct section_file *file)
 /************************************************************************//**
   Really save the game to a file.
 ****************************************************************************/
-static void savegame3_save_real(struct section_file *file,
-                                const char *save_reason,
-                                bool scenario)
+static struct savegame3_deferred *
+savegame3_save_real(struct section_file *file, const char *save_reason,
+                    bool scenario)
 {
   struct savedata *saving;
+  struct savegame3_deferred *deferred;
 
   /* initialise loading */
   saving = savedata_new(file, save_reason, scenario);
@@ -571,11 +848,14 @@ static void savegame3_save_real(struct section_file *file,
   sg_save_sanitycheck(saving);
 
   /* deinitialise saving */
+  deferred = saving->deferred;
   savedata_destroy(saving);
 
   if (!sg_success) {
     log_error("Failure saving savegame!");
   }
+
+  return deferred;
 }
 
 /************************************************************************//**
@@ -689,6 +969,12 @@ static struct savedata *savedata_new(struct section_file *file,
 
   saving->save_players = FALSE;
 
+  saving->deferred = fc_malloc(sizeof(*saving->deferred));
+  saving->deferred->width = MAP_NATIVE_WIDTH;
+  saving->deferred->height = MAP_NATIVE_HEIGHT;
+  saving->deferred->entries = sg_deferred_entry_list_new();
+  saving->deferred->snapshots = genlist_new_full(free);
+
   return saving;
 }
 
@@ -700,6 +986,198 @@ static void savedata_destroy(struct savedata *saving)
   free(saving);
 }
 
+/************************************************************************//**
+  Add an entry of the given type to the deferred entries of the savegame.
+****************************************************************************/
+static struct sg_deferred_entry *sg_defer(struct savedata *saving,
+                                          enum sg_deferred_type type,
+                                          const char *path, va_list args)
+{
+  struct sg_deferred_entry *pentry = fc_calloc(1, sizeof(*pentry));
+  char buf[512];
+
+  fc_vsnprintf(buf, sizeof(buf), path, args);
+  pentry->type = type;
+  pentry->path = fc_strdup(buf);
+  sg_deferred_entry_list_append(saving->deferred->entries, pentry);
+
+  return pentry;
+}
+
+/************************************************************************//**
+  Defer saving a line of the MAP_INDEX_SIZE chars, in native order, for
+  every native row. The row number is appended to the path of each line.
+  Takes the ownership of the chars.
+****************************************************************************/
+static void sg_defer_chars(struct savedata *saving, char *chars,
+                           const char *path, ...)
+{
+  va_list args;
+
+  va_start(args, path);
+  sg_defer(saving, SGD_CHARS, path, args)->chars = chars;
+  va_end(args);
+}
+
+/************************************************************************//**
+  Return a new zeroed block of snapshot data, which is freed with the
+  deferred entries of the savegame.
+****************************************************************************/
+static void *sg_snapshot_new(struct savedata *saving, size_t size)
+{
+  void *data = fc_calloc(1, size);
+
+  genlist_append(saving->deferred->snapshots, data);
+
+  return data;
+}
+
+/************************************************************************//**
+  Defer saving a line for every native row, with the characters that
+  tile_char() encodes from the snapshot data. The args are passed to it
+  in the entry. The row number is appended to the path of each line.
+****************************************************************************/
+static void sg_defer_tile_chars(struct savedata *saving, const void *data,
+                                sg_tile_char_fn tile_char, const int *args,
+                                const char *path, ...)
+{
+  struct sg_deferred_entry *pentry;
+  va_list args_list;
+
+  va_start(args_list, path);
+  pentry = sg_defer(saving, SGD_CHARS, path, args_list);
+  va_end(args_list);
+
+  pentry->tile_char = tile_char;
+  pentry->data = data;
+  memcpy(pentry->args, args, sizeof(pentry->args));
+}
+
+/************************************************************************//**
+  Encodes the extras of the tile for saving them. The data is a struct
+  sg_tile_snapshot for each tile.
+
+  Extras are packed in four to a character in hex notation. The args of
+  the entry specify which set of extras are included in this character.
+****************************************************************************/
+static char sg_tile_extras_char(const struct sg_deferred_entry *pentry,
+                                int tile)
+{
+  const struct sg_tile_snapshot *ptile
+    = (const struct sg_tile_snapshot *) pentry->data + tile;
+  int i, bin = 0;
+
+  for (i = 0; i < 4; i++) {
+    int extra = pentry->args[i];
+
+    if (extra < 0) {
+      break;
+    }
+
+    if (BV_ISSET(ptile->extras, extra)
+        /* An invalid resource, a resource that can't exist at the tile's
+         * current terrain, isn't in the bit extra vector. Save it so it
+         * can return if the tile's terrain changes to something it can
+         * exist on. */
+        || extra == ptile->resource) {
+      bin |= (1 << i);
+    }
+  }
+
+  return hex_chars[bin];
+}
+
+/************************************************************************//**
+  Encodes the halfbyte args[0] of the update turn of the tile. The data
+  is a struct sg_tile_snapshot for each tile.
+****************************************************************************/
+static char sg_tile_updated_char(const struct sg_deferred_entry *pentry,
+                                 int tile)
+{
+  const struct sg_tile_snapshot *ptile
+    = (const struct sg_tile_snapshot *) pentry->data + tile;
+
+  return bin2ascii_hex(ptile->last_updated, pentry->args[0]);
+}
+
+/************************************************************************//**
+  Encodes whether the four players of a halfbyte know the tile. The data
+  is a copy of the tile_known vector of each of them, args[0] bytes long.
+****************************************************************************/
+static char sg_tile_known_char(const struct sg_deferred_entry *pentry,
+                               int tile)
+{
+  const unsigned char *known = pentry->data;
+  int i, bin = 0;
+
+  for (i = 0; i < 4; i++) {
+    if (known[i * pentry->args[0] + _BV_BYTE_INDEX(tile)]
+        & _BV_BITMASK(tile)) {
+      bin |= (1 << i);
+    }
+  }
+
+  return hex_chars[bin];
+}
+
+/************************************************************************//**
+  Defer saving a line of the MAP_INDEX_SIZE numbers, in native order, for
+  every native row. SGD_NONE is written as "-". The row number is
+  appended to the path of each line. Takes the ownership of the numbers.
+****************************************************************************/
+static void sg_defer_numbers(struct savedata *saving, int *numbers,
+                             bool trailing_comma, const char *path, ...)
+{
+  struct sg_deferred_entry *pentry;
+  va_list args;
+
+  va_start(args, path);
+  pentry = sg_defer(saving, SGD_NUMBERS, path, args);
+  va_end(args);
+
+  pentry->numbers = numbers;
+  pentry->trailing_comma = trailing_comma;
+}
+
+/************************************************************************//**
+  Defer saving a string entry.
+****************************************************************************/
+static void sg_defer_str(struct savedata *saving, const char *str,
+                         const char *path, ...)
+{
+  va_list args;
+
+  va_start(args, path);
+  sg_defer(saving, SGD_STR, path, args)->str = fc_strdup(str);
+  va_end(args);
+}
+
+/************************************************************************//**
+  Defer saving an integer entry.
+****************************************************************************/
+static void sg_defer_int(struct savedata *saving, int value,
+                         const char *path, ...)
+{
+  va_list args;
+
+  va_start(args, path);
+  sg_defer(saving, SGD_INT, path, args)->value = value;
+  va_end(args);
+}
+
+/************************************************************************//**
+  Defer saving a boolean entry.
+****************************************************************************/
+static void sg_defer_bool(struct savedata *saving, bool value,
+                          const char *path, ...)
+{
+  va_list args;
+
+  va_start(args, path);
+  sg_defer(saving, SGD_BOOL, path, args)->value = value;
+  va_end(args);
+}
+
 /* =======================================================================
  * Helper functions.
  * ======================================================================= */
@@ -1090,39 +1568,6 @@ static void unit_ordering_apply(void)
   } whole_map_iterate_end;
 }
 
-/************************************************************************//**
-  Helper function for loading extras from a savegame.
-
-  'ch' gives the character loaded from the savegame. Extras are packed
-  in four to a character in hex notation. 'index' is a mapping of
-  savegame bit -> base bit.
-****************************************************************************/
-static void sg_extras_set_dbv(struct dbv *extras, char ch,
-                              struct extra_type **idx)
-{
-  int i, bin;
-  const char *pch = strchr(hex_chars, ch);
-
-  if (!pch || ch == '\0') {
-    log_sg("Unknown hex value: '%c' (%d)", ch, ch);
-    bin = 0;
-  } else {
-    bin = pch - hex_chars;
-  }
-
-  for (i = 0; i < 4; i++) {
-    struct extra_type *pextra = idx[i];
-
-    if (pextra == NULL) {
-      continue;
-    }
-    if ((bin & (1 << i))
-        && (wld.map.server.have_huts || !is_extra_caused_by(pextra, EC_HUT))) {
-      dbv_set(extras, extra_index(pextra));
-    }
-  }
-}
-
 /************************************************************************//**
   Helper function for loading extras from a savegame.
 
@@ -1156,70 +1601,6 @@ static void sg_extras_set_bv(bv_extras *extras, char ch,
   }
 }
 
-/************************************************************************//**
-  Helper function for saving extras into a savegame.
-
-  Extras are packed in four to a character in hex notation. 'index'
-  specifies which set of extras are included in this character.
-****************************************************************************/
-static char sg_extras_get_dbv(struct dbv *extras, struct extra_type *presource,
-                              const int *idx)
-{
-  int i, bin = 0;
-  int max = dbv_bits(extras);
-
-  for (i = 0; i < 4; i++) {
-    int extra = idx[i];
-
-    if (extra < 0) {
-      break;
-    }
-
-    if (extra < max
-        && (dbv_isset(extras, extra)
-            /* An invalid resource, a resource that can't exist at the tile's
-             * current terrain, isn't in the bit extra vector. Save it so it
-             * can return if the tile's terrain changes to something it can
-             * exist on. */
-            || extra_by_number(extra) == presource)) {
-      bin |= (1 << i);
-    }
-  }
-
-  return hex_chars[bin];
-}
-
-/************************************************************************//**
-  Helper function for saving extras into a savegame.
-
-  Extras are packed in four to a character in hex notation. 'index'
-  specifies which set of extras are included in this character.
-****************************************************************************/
-static char sg_extras_get_bv(bv_extras extras, struct extra_type *presource,
-                             const int *idx)
-{
-  int i, bin = 0;
-
-  for (i = 0; i < 4; i++) {
-    int extra = idx[i];
-
-    if (extra < 0) {
-      break;
-    }
-
-    if (BV_ISSET(extras, extra)
-        /* An invalid resource, a resource that can't exist at the tile's
-         * current terrain, isn't in the bit extra vector. Save it so it
-         * can return if the tile's terrain changes to something it can
-         * exist on. */
-        || extra_by_number(extra) == presource) {
-      bin |= (1 << i);
-    }
-  }
-
-  return hex_chars[bin];
-}
-
 /************************************************************************//**
   Dereferences the terrain character.  See terrains[].identifier
     example: char2terrain('a') => T_ARCTIC
@@ -2962,8 +3343,7 @@ static void sg_save_map_tiles(struct savedata *saving)
   sg_check_ret();
 
   /* Save the terrain type. */
-  SAVE_MAP_CHAR(ptile, terrain2char(ptile->terrain), saving->file,
-                "map.t%04d");
+  SAVE_MAP_CHAR(ptile, terrain2char(ptile->terrain), saving, "map.t");
 
   /* Save special tile sprites. */
   whole_map_iterate(&(wld.map), ptile) {
@@ -2971,12 +3351,11 @@ static void sg_save_map_tiles(struct savedata *saving)
 
     index_to_native_pos(&nat_x, &nat_y, tile_index(ptile));
     if (ptile->spec_sprite) {
-      secfile_insert_str(saving->file, ptile->spec_sprite,
-                         "map.spec_sprite_%d_%d", nat_x, nat_y);
+      sg_defer_str(saving, ptile->spec_sprite,
+                   "map.spec_sprite_%d_%d", nat_x, nat_y);
     }
     if (ptile->label != NULL) {
-      secfile_insert_str(saving->file, ptile->label,
-                         "map.label_%d_%d", nat_x, nat_y);
+      sg_defer_str(saving, ptile->label, "map.label_%d_%d", nat_x, nat_y);
     }
   } whole_map_iterate_end;
 }
@@ -3019,30 +3398,17 @@ static void sg_load_map_altitude(struct loaddata *loading)
 ****************************************************************************/
 static void sg_save_map_altitude(struct savedata *saving)
 {
-  int y;
+  int *altitude;
 
   /* Check status and return if not OK (sg_success FALSE). */
   sg_check_ret();
 
-  for (y = 0; y < MAP_NATIVE_HEIGHT; y++) {
-    char line[MAP_NATIVE_WIDTH * TOKEN_SIZE];
-    int x;
-
-    line[0] = '\0';
-    for (x = 0; x < MAP_NATIVE_WIDTH; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-
-      fc_snprintf(token, sizeof(token), "%d", ptile->altitude);
-
-      strcat(line, token);
-      if (x + 1 < MAP_NATIVE_WIDTH) {
-        strcat(line, ",");
-      }
-    }
+  altitude = fc_malloc(MAP_INDEX_SIZE * sizeof(*altitude));
+  whole_map_iterate(&(wld.map), ptile) {
+    altitude[tile_index(ptile)] = ptile->altitude;
+  } whole_map_iterate_end;
 
-    secfile_insert_str(saving->file, line, "map.alt%04d", y);
-  }
+  sg_defer_numbers(saving, altitude, FALSE, "map.alt");
 }
 
 /************************************************************************//**
@@ -3082,9 +3448,18 @@ static void sg_load_map_tiles_extras(struct loaddata *loading)
 ****************************************************************************/
 static void sg_save_map_tiles_extras(struct savedata *saving)
 {
+  struct sg_tile_snapshot *tiles;
+
   /* Check status and return if not OK (sg_success FALSE). */
   sg_check_ret();
 
+  tiles = sg_snapshot_new(saving, MAP_INDEX_SIZE * sizeof(*tiles));
+  whole_map_iterate(&(wld.map), ptile) {
+    tiles[tile_index(ptile)].extras = ptile->extras;
+    tiles[tile_index(ptile)].resource
+      = ptile->resource != nullptr ? extra_number(ptile->resource) : -1;
+  } whole_map_iterate_end;
+
   /* Save extras. */
   halfbyte_iterate_extras(j, game.control.num_extra_types) {
     int mod[4];
@@ -3097,8 +3472,8 @@ static void sg_save_map_tiles_extras(struct savedata *saving)
         mod[l] = 4 * j + l;
       }
     }
-    SAVE_MAP_CHAR(ptile, sg_extras_get_bv(ptile->extras, ptile->resource, mod),
-                  saving->file, "map.e%02d_%04d", j);
+    sg_defer_tile_chars(saving, tiles, sg_tile_extras_char, mod,
+                        "map.e%02d_", j);
   } halfbyte_iterate_extras_end;
 }
 
@@ -3206,8 +3581,7 @@ static void sg_save_map_startpos(struct savedata *saving)
     return;
   }
 
-  secfile_insert_int(saving->file, map_startpos_count(),
-                     "map.startpos_count");
+  sg_defer_int(saving, map_startpos_count(), "map.startpos_count");
 
   map_startpos_iterate(psp) {
     int nat_x, nat_y;
@@ -3215,13 +3589,13 @@ static void sg_save_map_startpos(struct savedata *saving)
     ptile = startpos_tile(psp);
 
     index_to_native_pos(&nat_x, &nat_y, tile_index(ptile));
-    secfile_insert_int(saving->file, nat_x, "map.startpos%d.x", i);
-    secfile_insert_int(saving->file, nat_y, "map.startpos%d.y", i);
+    sg_defer_int(saving, nat_x, "map.startpos%d.x", i);
+    sg_defer_int(saving, nat_y, "map.startpos%d.y", i);
 
-    secfile_insert_bool(saving->file, startpos_is_excluding(psp),
-                        "map.startpos%d.exclude", i);
+    sg_defer_bool(saving, startpos_is_excluding(psp),
+                  "map.startpos%d.exclude", i);
     if (startpos_allows_all(psp)) {
-      secfile_insert_str(saving->file, "", "map.startpos%d.nations", i);
+      sg_defer_str(saving, "", "map.startpos%d.nations", i);
     } else {
       const struct nation_hash *nations = startpos_raw_nations(psp);
       char nation_names[MAX_LEN_NAME * nation_hash_size(nations)];
@@ -3236,8 +3610,7 @@ static void sg_save_map_startpos(struct savedata *saving)
                        "%c%s", SEPARATOR, nation_rule_name(pnation));
         }
       } nation_hash_iterate_end;
-      secfile_insert_str(saving->file, nation_names,
-                         "map.startpos%d.nations", i);
+      sg_defer_str(saving, nation_names, "map.startpos%d.nations", i);
     }
     i++;
   } map_startpos_iterate_end;
@@ -3372,7 +3745,7 @@ static void sg_load_map_owner(struct loaddata *loading)
 ****************************************************************************/
 static void sg_save_map_owner(struct savedata *saving)
 {
-  int y;
+  int *owner, *source, *eowner, *placing, *infra_turns;
 
   /* Check status and return if not OK (sg_success FALSE). */
   sg_check_ret();
@@ -3382,125 +3755,48 @@ static void sg_save_map_owner(struct savedata *saving)
     return;
   }
 
-  /* Store owner and ownership source as plain numbers. */
-  for (y = 0; y < MAP_NATIVE_HEIGHT; y++) {
-    char line[MAP_NATIVE_WIDTH * TOKEN_SIZE];
-    int x;
-
-    line[0] = '\0';
-    for (x = 0; x < MAP_NATIVE_WIDTH; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-
-      if (!saving->save_players || tile_owner(ptile) == NULL) {
-        strcpy(token, "-");
-      } else {
-        fc_snprintf(token, sizeof(token), "%d",
-                    player_number(tile_owner(ptile)));
-      }
-      strcat(line, token);
-      if (x + 1 < MAP_NATIVE_WIDTH) {
-        strcat(line, ",");
-      }
-    }
-
-    secfile_insert_str(saving->file, line, "map.owner%04d", y);
-  }
-
-  for (y = 0; y < MAP_NATIVE_HEIGHT; y++) {
-    char line[MAP_NATIVE_WIDTH * TOKEN_SIZE];
-    int x;
+  owner = fc_malloc(MAP_INDEX_SIZE * sizeof(*owner));
+  source = fc_malloc(MAP_INDEX_SIZE * sizeof(*source));
+  eowner = fc_malloc(MAP_INDEX_SIZE * sizeof(*eowner));
+  placing = fc_malloc(MAP_INDEX_SIZE * sizeof(*placing));
+  infra_turns = fc_malloc(MAP_INDEX_SIZE * sizeof(*infra_turns));
 
-    line[0] = '\0';
-    for (x = 0; x < MAP_NATIVE_WIDTH; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
+  /* Store owner and ownership source as plain numbers. */
+  whole_map_iterate(&(wld.map), ptile) {
+    int i = tile_index(ptile);
 
-      if (ptile->claimer == NULL) {
-        strcpy(token, "-");
-      } else {
-        fc_snprintf(token, sizeof(token), "%d", tile_index(ptile->claimer));
-      }
-      strcat(line, token);
-      if (x + 1 < MAP_NATIVE_WIDTH) {
-        strcat(line, ",");
-      }
+    if (!saving->save_players || tile_owner(ptile) == NULL) {
+      owner[i] = SGD_NONE;
+    } else {
+      owner[i] = player_number(tile_owner(ptile));
     }
 
-    secfile_insert_str(saving->file, line, "map.source%04d", y);
-  }
-
-  for (y = 0; y < MAP_NATIVE_HEIGHT; y++) {
-    char line[MAP_NATIVE_WIDTH * TOKEN_SIZE];
-    int x;
-
-    line[0] = '\0';
-    for (x = 0; x < MAP_NATIVE_WIDTH; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-
-      if (!saving->save_players || extra_owner(ptile) == NULL) {
-        strcpy(token, "-");
-      } else {
-        fc_snprintf(token, sizeof(token), "%d",
-                    player_number(extra_owner(ptile)));
-      }
-      strcat(line, token);
-      if (x + 1 < MAP_NATIVE_WIDTH) {
-        strcat(line, ",");
-      }
+    if (ptile->claimer == NULL) {
+      source[i] = SGD_NONE;
+    } else {
+      source[i] = tile_index(ptile->claimer);
     }
 
-    secfile_insert_str(saving->file, line, "map.eowner%04d", y);
-  }
-
-  for (y = 0; y < MAP_NATIVE_HEIGHT; y++) {
-    char line[MAP_NATIVE_WIDTH * TOKEN_SIZE];
-    int x;
-
-    line[0] = '\0';
-    for (x = 0; x < MAP_NATIVE_WIDTH; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-
-      if (ptile->placing == NULL) {
-        strcpy(token, "-");
-      } else {
-        fc_snprintf(token, sizeof(token), "%d",
-                    extra_number(ptile->placing));
-      }
-      strcat(line, token);
-      if (x + 1 < MAP_NATIVE_WIDTH) {
-        strcat(line, ",");
-      }
+    if (!saving->save_players || extra_owner(ptile) == NULL) {
+      eowner[i] = SGD_NONE;
+    } else {
+      eowner[i] = player_number(extra_owner(ptile));
     }
 
-    secfile_insert_str(saving->file, line, "map.placing%04d", y);
-  }
-
-  for (y = 0; y < MAP_NATIVE_HEIGHT; y++) {
-    char line[MAP_NATIVE_WIDTH * TOKEN_SIZE];
-    int x;
-
-    line[0] = '\0';
-    for (x = 0; x < MAP_NATIVE_WIDTH; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-
-      if (ptile->placing != NULL) {
-        fc_snprintf(token, sizeof(token), "%d",
-                    ptile->infra_turns);
-      } else {
-        fc_snprintf(token, sizeof(token), "0");
-      }
-      strcat(line, token);
-      if (x + 1 < MAP_NATIVE_WIDTH) {
-        strcat(line, ",");
-      }
+    if (ptile->placing == NULL) {
+      placing[i] = SGD_NONE;
+      infra_turns[i] = 0;
+    } else {
+      placing[i] = extra_number(ptile->placing);
+      infra_turns[i] = ptile->infra_turns;
     }
+  } whole_map_iterate_end;
 
-    secfile_insert_str(saving->file, line, "map.infra_turns%04d", y);
-  }
+  sg_defer_numbers(saving, owner, FALSE, "map.owner");
+  sg_defer_numbers(saving, source, FALSE, "map.source");
+  sg_defer_numbers(saving, eowner, FALSE, "map.eowner");
+  sg_defer_numbers(saving, placing, FALSE, "map.placing");
+  sg_defer_numbers(saving, infra_turns, FALSE, "map.infra_turns");
 }
 
 /************************************************************************//**
@@ -3552,7 +3848,7 @@ static void sg_load_map_worked(struct loaddata *loading)
 ****************************************************************************/
 static void sg_save_map_worked(struct savedata *saving)
 {
-  int x, y;
+  int *worked;
 
   /* Check status and return if not OK (sg_success FALSE). */
   sg_check_ret();
@@ -3563,27 +3859,14 @@ static void sg_save_map_worked(struct savedata *saving)
   }
 
   /* Additionally save the tiles worked by the cities */
-  for (y = 0; y < MAP_NATIVE_HEIGHT; y++) {
-    char line[MAP_NATIVE_WIDTH * TOKEN_SIZE];
+  worked = fc_malloc(MAP_INDEX_SIZE * sizeof(*worked));
+  whole_map_iterate(&(wld.map), ptile) {
+    struct city *pcity = tile_worked(ptile);
 
-    line[0] = '\0';
-    for (x = 0; x < MAP_NATIVE_WIDTH; x++) {
-      char token[TOKEN_SIZE];
-      struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-      struct city *pcity = tile_worked(ptile);
+    worked[tile_index(ptile)] = pcity == NULL ? SGD_NONE : pcity->id;
+  } whole_map_iterate_end;
 
-      if (pcity == NULL) {
-        strcpy(token, "-");
-      } else {
-        fc_snprintf(token, sizeof(token), "%d", pcity->id);
-      }
-      strcat(line, token);
-      if (x < MAP_NATIVE_WIDTH) {
-        strcat(line, ",");
-      }
-    }
-    secfile_insert_str(saving->file, line, "map.worked%04d", y);
-  }
+  sg_defer_numbers(saving, worked, TRUE, "map.worked");
 }
 
 /************************************************************************//**
@@ -3660,40 +3943,39 @@ static void sg_save_map_known(struct savedata *saving)
     secfile_insert_bool(saving->file, game.server.save_options.save_known,
                         "game.save_known");
     if (game.server.save_options.save_known) {
-      int j, p, l, i;
-      unsigned int *known = fc_calloc(lines * MAP_INDEX_SIZE, sizeof(*known));
-
-      /* HACK: we convert the data into a 32-bit integer, and then save it as
-       * hex. */
-
-      whole_map_iterate(&(wld.map), ptile) {
-        players_iterate(pplayer) {
-          if (map_is_known(ptile, pplayer)) {
-            p = player_index(pplayer);
-            l = p / 32;
-            known[l * MAP_INDEX_SIZE + tile_index(ptile)]
-              |= (1u << (p % 32)); /* "p % 32" = "p - l * 32" */
-          }
-        } players_iterate_end;
-      } whole_map_iterate_end;
+      int bytes = _BV_BYTES(MAP_INDEX_SIZE);
+      int j, l, i;
 
+      /* The known tiles of the players are saved as hex digits, one for
+       * the players of each 4 slots. */
       for (l = 0; l < lines; l++) {
         for (j = 0; j < 8; j++) {
+          unsigned char *known = nullptr;
+
           for (i = 0; i < 4; i++) {
+            struct player_slot *pslot
+              = player_slot_by_number(l * 32 + j * 4 + i);
+
             /* Only bother saving the map for this halfbyte if at least one
              * of the corresponding player slots is in use */
-            if (player_slot_is_used(player_slot_by_number(l*32 + j*4 + i))) {
-              /* put 4-bit segments of the 32-bit "known" field */
-              SAVE_MAP_CHAR(ptile, bin2ascii_hex(known[l * MAP_INDEX_SIZE
-                                                       + tile_index(ptile)], j),
-                            saving->file, "map.k%02d_%04d", l * 8 + j);
-              break;
+            if (player_slot_is_used(pslot)) {
+              struct player *pplayer = player_slot_get_player(pslot);
+
+              if (known == nullptr) {
+                known = sg_snapshot_new(saving, 4 * bytes);
+              }
+              memcpy(known + i * bytes, pplayer->tile_known.vec, bytes);
             }
           }
+
+          if (known != nullptr) {
+            int args[4] = { bytes };
+
+            sg_defer_tile_chars(saving, known, sg_tile_known_char, args,
+                                "map.k%02d_", l * 8 + j);
+          }
         }
       }
-
-      FC_FREE(known);
     }
   }
 }
@@ -7244,8 +7526,8 @@ static void sg_load_player_vision(struct loaddata *loading,
   /* Load player map (extras). */
   halfbyte_iterate_extras(j, loading->extra.size) {
     LOAD_MAP_CHAR(ch, ptile,
-                  sg_extras_set_dbv(&(map_get_player_tile(ptile, plr)->extras),
-                                    ch, loading->extra.order + 4 * j),
+                  sg_extras_set_bv(&(map_get_player_tile(ptile, plr)->extras),
+                                   ch, loading->extra.order + 4 * j),
                   loading->file, "player%d.map_e%02d_%04d", plrno, j);
   } halfbyte_iterate_extras_end;
 
@@ -7507,6 +7789,7 @@ static bool sg_load_player_vision_city(struct loaddata *loading,
 static void sg_save_player_vision(struct savedata *saving,
                                   struct player *plr)
 {
+  struct sg_tile_snapshot *tiles;
   int i, plrno = player_number(plr);
 
   /* Check status and return if not OK (sg_success FALSE). */
@@ -7520,60 +7803,44 @@ static void sg_save_player_vision(struct savedata *saving,
   /* Save the map (terrain). */
   SAVE_MAP_CHAR(ptile,
                 terrain2char(map_get_player_tile(ptile, plr)->terrain),
-                saving->file, "player%d.map_t%04d", plrno);
+                saving, "player%d.map_t", plrno);
 
   if (game.server.foggedborders) {
     /* Save the map (borders). */
-    int x, y;
+    int *owner = fc_malloc(MAP_INDEX_SIZE * sizeof(*owner));
+    int *extras_owner = fc_malloc(MAP_INDEX_SIZE * sizeof(*extras_owner));
 
-    for (y = 0; y < MAP_NATIVE_HEIGHT; y++) {
-      char line[MAP_NATIVE_WIDTH * TOKEN_SIZE];
+    whole_map_iterate(&(wld.map), ptile) {
+      struct player_tile *plrtile = map_get_player_tile(ptile, plr);
+      int tile = tile_index(ptile);
 
-      line[0] = '\0';
-      for (x = 0; x < MAP_NATIVE_WIDTH; x++) {
-        char token[TOKEN_SIZE];
-        struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-        struct player_tile *plrtile = map_get_player_tile(ptile, plr);
+      if (plrtile == NULL || plrtile->owner == NULL) {
+        owner[tile] = SGD_NONE;
+      } else {
+        owner[tile] = player_number(plrtile->owner);
+      }
 
-        if (plrtile == NULL || plrtile->owner == NULL) {
-          strcpy(token, "-");
-        } else {
-          fc_snprintf(token, sizeof(token), "%d",
-                      player_number(plrtile->owner));
-        }
-        strcat(line, token);
-        if (x < MAP_NATIVE_WIDTH) {
-          strcat(line, ",");
-        }
+      if (plrtile == NULL || plrtile->extras_owner == NULL) {
+        extras_owner[tile] = SGD_NONE;
+      } else {
+        extras_owner[tile] = player_number(plrtile->extras_owner);
       }
-      secfile_insert_str(saving->file, line, "player%d.map_owner%04d",
-                         plrno, y);
-    }
+    } whole_map_iterate_end;
 
-    for (y = 0; y < MAP_NATIVE_HEIGHT; y++) {
-      char line[MAP_NATIVE_WIDTH * TOKEN_SIZE];
+    sg_defer_numbers(saving, owner, TRUE, "player%d.map_owner", plrno);
+    sg_defer_numbers(saving, extras_owner, TRUE, "player%d.extras_owner",
+                     plrno);
+  }
 
-      line[0] = '\0';
-      for (x = 0; x < MAP_NATIVE_WIDTH; x++) {
-        char token[TOKEN_SIZE];
-        struct tile *ptile = native_pos_to_tile(&(wld.map), x, y);
-        struct player_tile *plrtile = map_get_player_tile(ptile, plr);
+  tiles = sg_snapshot_new(saving, MAP_INDEX_SIZE * sizeof(*tiles));
+  whole_map_iterate(&(wld.map), ptile) {
+    struct player_tile *plrtile = map_get_player_tile(ptile, plr);
 
-        if (plrtile == NULL || plrtile->extras_owner == NULL) {
-          strcpy(token, "-");
-        } else {
-          fc_snprintf(token, sizeof(token), "%d",
-                      player_number(plrtile->extras_owner));
-        }
-        strcat(line, token);
-        if (x < MAP_NATIVE_WIDTH) {
-          strcat(line, ",");
-        }
-      }
-      secfile_insert_str(saving->file, line, "player%d.extras_owner%04d",
-                         plrno, y);
-    }
-  }
+    tiles[tile_index(ptile)].extras = plrtile->extras;
+    tiles[tile_index(ptile)].resource
+      = plrtile->resource != nullptr ? extra_number(plrtile->resource) : -1;
+    tiles[tile_index(ptile)].last_updated = plrtile->last_updated;
+  } whole_map_iterate_end;
 
   /* Save the map (extras). */
   halfbyte_iterate_extras(j, game.control.num_extra_types) {
@@ -7588,20 +7855,17 @@ static void sg_save_player_vision(struct savedata *saving,
       }
     }
 
-    SAVE_MAP_CHAR(ptile,
-                  sg_extras_get_dbv(&(map_get_player_tile(ptile, plr)->extras),
-                                    map_get_player_tile(ptile, plr)->resource,
-                                    mod),
-                  saving->file, "player%d.map_e%02d_%04d", plrno, j);
+    sg_defer_tile_chars(saving, tiles, sg_tile_extras_char, mod,
+                        "player%d.map_e%02d_", plrno, j);
   } halfbyte_iterate_extras_end;
 
   /* Save the map (update time). */
   for (i = 0; i < 4; i++) {
+    int halfbyte[4] = { i };
+
     /* put 4-bit segments of 16-bit "updated" field */
-    SAVE_MAP_CHAR(ptile,
-                  bin2ascii_hex(
-                    map_get_player_tile(ptile, plr)->last_updated, i),
-                  saving->file, "player%d.map_u%02d_%04d", plrno, i);
+    sg_defer_tile_chars(saving, tiles, sg_tile_updated_char, halfbyte,
+                        "player%d.map_u%02d_", plrno, i);
   }
 
   /* Save known cities. */
@@ -7617,31 +7881,29 @@ static void sg_save_player_vision(struct savedata *saving,
       int nat_x, nat_y;
 
       index_to_native_pos(&nat_x, &nat_y, tile_index(ptile));
-      secfile_insert_int(saving->file, nat_y, "%s.y", buf);
-      secfile_insert_int(saving->file, nat_x, "%s.x", buf);
+      sg_defer_int(saving, nat_y, "%s.y", buf);
+      sg_defer_int(saving, nat_x, "%s.x", buf);
 
-      secfile_insert_int(saving->file, pdcity->identity, "%s.id", buf);
-      secfile_insert_int(saving->file, player_number(vision_site_owner(pdcity)),
-                         "%s.owner", buf);
+      sg_defer_int(saving, pdcity->identity, "%s.id", buf);
+      sg_defer_int(saving, player_number(vision_site_owner(pdcity)),
+                   "%s.owner", buf);
       if (pdcity->original != nullptr) {
-        secfile_insert_int(saving->file, player_number(pdcity->original),
-                           "%s.original", buf);
+        sg_defer_int(saving, player_number(pdcity->original),
+                     "%s.original", buf);
       } else {
-        secfile_insert_int(saving->file, -1, "%s.original", buf);
+        sg_defer_int(saving, -1, "%s.original", buf);
       }
 
-      secfile_insert_int(saving->file, vision_site_size_get(pdcity),
-                         "%s.size", buf);
-      secfile_insert_bool(saving->file, pdcity->occupied,
-                          "%s.occupied", buf);
-      secfile_insert_bool(saving->file, pdcity->walls, "%s.walls", buf);
-      secfile_insert_bool(saving->file, pdcity->happy, "%s.happy", buf);
-      secfile_insert_bool(saving->file, pdcity->unhappy, "%s.unhappy", buf);
-      secfile_insert_str(saving->file, city_style_rule_name(pdcity->style),
-                         "%s.style", buf);
-      secfile_insert_int(saving->file, pdcity->city_image, "%s.city_image", buf);
-      secfile_insert_str(saving->file, capital_type_name(pdcity->capital),
-                         "%s.capital", buf);
+      sg_defer_int(saving, vision_site_size_get(pdcity), "%s.size", buf);
+      sg_defer_bool(saving, pdcity->occupied, "%s.occupied", buf);
+      sg_defer_bool(saving, pdcity->walls, "%s.walls", buf);
+      sg_defer_bool(saving, pdcity->happy, "%s.happy", buf);
+      sg_defer_bool(saving, pdcity->unhappy, "%s.unhappy", buf);
+      sg_defer_str(saving, city_style_rule_name(pdcity->style),
+                   "%s.style", buf);
+      sg_defer_int(saving, pdcity->city_image, "%s.city_image", buf);
+      sg_defer_str(saving, capital_type_name(pdcity->capital),
+                   "%s.capital", buf);
 
       /* Save improvement list as bitvector. Note that improvement order
        * is saved in savefile.improvement.order. */
@@ -7655,16 +7917,16 @@ static void sg_save_player_vision(struct savedata *saving,
                      "Invalid size of the improvement vector (%s.improvements: "
                      SIZE_T_PRINTF " < " SIZE_T_PRINTF" ).",
                      buf, strlen(impr_buf), sizeof(impr_buf));
-      secfile_insert_str(saving->file, impr_buf, "%s.improvements", buf);
+      sg_defer_str(saving, impr_buf, "%s.improvements", buf);
       if (pdcity->name != NULL) {
-        secfile_insert_str(saving->file, pdcity->name, "%s.name", buf);
+        sg_defer_str(saving, pdcity->name, "%s.name", buf);
       }
 
       i++;
     }
   } whole_map_iterate_end;
 
-  secfile_insert_int(saving->file, i, "player%d.dc_total", plrno);
+  sg_defer_int(saving, i, "player%d.dc_total", plrno);
 }
 
 /* =======================================================================
@@ -13,8 +13,18 @@
 #ifndef FC__SAVEGAME3_H
 #define FC__SAVEGAME3_H
 
+struct savegame3_deferred;
+struct secfile_writer;
+
 void savegame3_load(struct section_file *sfile);
-void savegame3_save(struct section_file *sfile, const char *save_reason,
-                    bool scenario);
+struct savegame3_deferred *savegame3_save(struct section_file *sfile,
+                                          const char *save_reason,
+                                          bool scenario);
+void savegame3_save_deferred(struct section_file *sfile,
+                             struct savegame3_deferred *deferred);
+void savegame3_save_stream(struct section_file *sfile,
+                           struct savegame3_deferred *deferred,
+                           struct secfile_writer *writer);
+void savegame3_deferred_destroy(struct savegame3_deferred *deferred);
 
 #endif /* FC__SAVEGAME3_H */
@@ -19,10 +19,12 @@
 #include "log.h"
 #include "mem.h"
 #include "registry.h"
+#include "registry_bin.h"
 
 /* common */
 #include "ai.h"
 #include "capability.h"
+#include "effects.h"
 #include "game.h"
 #include "research.h"
 
@@ -77,6 +79,9 @@ void savegame_load(struct section_file *sfile)
     return;
   }
 
+  /* Map and cities were loaded bypassing the setters */
+  bonus_cache_invalidate();
+
   players_iterate(pplayer) {
     unit_list_iterate(pplayer->units, punit) {
       CALL_FUNC_EACH_AI(unit_created, punit);
@@ -97,20 +102,25 @@ void savegame_load(struct section_file *sfile)
 }
 
 /************************************************************************//**
-  Main entry point for saving a game.
+  Main entry point for saving a game. The map sized parts of the game are
+  only copied; savegame3_save_deferred() adds them to the sfile.
 ****************************************************************************/
-void savegame_save(struct section_file *sfile, const char *save_reason,
-                   bool scenario)
+struct savegame3_deferred *savegame_save(struct section_file *sfile,
+                                         const char *save_reason,
+                                         bool scenario)
 {
-  savegame3_save(sfile, save_reason, scenario);
+  return savegame3_save(sfile, save_reason, scenario);
 }
 
 struct save_thread_data
 {
   struct section_file *sfile;
+  struct savegame3_deferred *deferred;
   char filepath[600];
   int save_compress_level;
   enum fz_method save_compress_type;
+  int save_compress_threads;
+  bool binary;
 };
 
 /************************************************************************//**
@@ -118,6 +128,9 @@ struct save_thread_data
 ****************************************************************************/
 static void save_thread_data_free(struct save_thread_data *stdata)
 {
+  if (stdata->deferred != nullptr) {
+    savegame3_deferred_destroy(stdata->deferred);
+  }
   secfile_destroy(stdata->sfile);
   free(stdata);
 }
@@ -128,9 +141,31 @@ static void save_thread_data_free(struct save_thread_data *stdata)
 static void save_thread_run(void *arg)
 {
   struct save_thread_data *stdata = (struct save_thread_data *)arg;
+  bool saved;
+
+  /* Building the map sized parts of the sfile is left to this thread,
+   * as it does not need the game state. */
+  if (stdata->binary) {
+    savegame3_save_deferred(stdata->sfile, stdata->deferred);
+    stdata->deferred = nullptr;
+    saved = binfile_save(stdata->sfile, stdata->filepath);
+  } else {
+    struct secfile_writer *writer
+      = secfile_writer_open(stdata->filepath, stdata->save_compress_level,
+                            stdata->save_compress_type,
+                            stdata->save_compress_threads);
+
+    if (writer != nullptr) {
+      /* Each section is built, written and freed in turn. */
+      savegame3_save_stream(stdata->sfile, stdata->deferred, writer);
+      stdata->deferred = nullptr;
+      saved = secfile_writer_close(writer);
+    } else {
+      saved = FALSE;
+    }
+  }
 
-  if (!secfile_save(stdata->sfile, stdata->filepath, stdata->save_compress_level,
-                    stdata->save_compress_type)) {
+  if (!saved) {
     con_write(C_FAIL, _("Failed saving game as %s"), stdata->filepath);
     log_error("Game saving failed: %s", secfile_error());
     notify_conn(nullptr, nullptr, E_LOG_ERROR, ftc_warning,
@@ -157,6 +192,8 @@ void save_game(const char *orig_filename, const char *save_reason,
 
   stdata->save_compress_type = game.server.save_compress_type;
   stdata->save_compress_level = game.server.save_compress_level;
+  stdata->save_compress_threads = game.server.save_compress_threads;
+  stdata->binary = game.server.binary_save;
 
   if (orig_filename == nullptr) {
     stdata->filepath[0] = '\0';
@@ -179,7 +216,7 @@ void save_game(const char *orig_filename, const char *save_reason,
     } else {
       char *end_dot;
       char *strip_extensions[] = {
-        ".sav", ".gz", ".bz2", ".xz", ".zst", nullptr };
+        ".sav", ".gz", ".bz2", ".xz", ".zst", BINFILE_SUFFIX, nullptr };
       bool stripped = TRUE;
 
       while ((end_dot = strrchr(dot, '.')) && stripped) {
@@ -212,17 +249,20 @@ void save_game(const char *orig_filename, const char *save_reason,
   /* Allowing duplicates shouldn't be allowed. However, it takes very too
    * long time for huge game saving... */
   stdata->sfile = secfile_new(TRUE);
-  savegame_save(stdata->sfile, save_reason, scenario);
+  stdata->deferred = savegame_save(stdata->sfile, save_reason, scenario);
 
-  /* We have consistent game state in stdata->sfile now, so
-   * we could pass it to the saving thread already. We want to
+  /* We have consistent game state in stdata->sfile and stdata->deferred
+   * now, so we could pass them to the saving thread already. We want to
    * handle below notify_conn() and directory creation in
    * main thread, though. */
 
   /* Append ".sav" to filename. */
   sz_strlcat(stdata->filepath, ".sav");
 
-  if (stdata->save_compress_level > 0) {
+  if (stdata->binary) {
+    /* Binary saves are not compressed. */
+    sz_strlcat(stdata->filepath, BINFILE_SUFFIX);
+  } else if (stdata->save_compress_level > 0) {
     switch (stdata->save_compress_type) {
 #ifdef FREECIV_HAVE_LIBZ
     case FZ_ZLIB:
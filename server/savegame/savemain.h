@@ -17,10 +17,12 @@
 #include "support.h"
 
 struct section_file;
+struct savegame3_deferred;
 
 void savegame_load(struct section_file *sfile);
-void savegame_save(struct section_file *sfile, const char *save_reason,
-                   bool scenario);
+struct savegame3_deferred *savegame_save(struct section_file *sfile,
+                                         const char *save_reason,
+                                         bool scenario);
 
 void save_game(const char *orig_filename, const char *save_reason,
                bool scenario);
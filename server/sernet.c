@@ -45,6 +45,9 @@
 #include <readline/history.h>
 #include <readline/readline.h>
 #endif
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 #ifdef HAVE_SYS_SELECT_H
 #include <sys/select.h>
 #endif
@@ -73,6 +76,7 @@
 #include "dataio.h"
 #include "events.h"
 #include "game.h"
+#include "packet_trace.h"
 #include "packets.h"
 
 /* server/scripting */
@@ -86,6 +90,7 @@
 #include "meta.h"
 #include "plrhand.h"
 #include "srv_main.h"
+#include "srv_replay.h"
 #include "stdinhand.h"
 #include "voting.h"
 
@@ -97,6 +102,33 @@ static int *listen_socks;
 static int listen_count;
 static int socklan;
 
+/* Readiness of the sockets, as reported by sernet_wait(). With select()
+ * all the flags are recomputed by every wait. With the edge-triggered
+ * epoll backend, the connection flags stay set until the socket would
+ * block, and are cleared by the code that finds that out. */
+static struct {
+  bool stdin_read;
+  bool listen_except;
+  bool *listen_read;
+  struct {
+    bool read;
+    bool write;
+    bool except;
+  } conns[MAX_NUM_CONNECTIONS];
+} sock_ready;
+
+#ifdef HAVE_SYS_EPOLL_H
+/* The epoll instance, or -1 when falling back to select(). */
+static int epoll_fd = -1;
+static bool epoll_stdin = FALSE;        /* stdin registered to epoll_fd */
+static bool epoll_stdin_file = FALSE;   /* stdin can't be polled */
+
+/* epoll event data: connection index, or one of these. */
+#define EPOLL_TAG_STDIN (MAX_NUM_CONNECTIONS)
+#define EPOLL_TAG_LISTEN (MAX_NUM_CONNECTIONS + 1) /* + listen socket index */
+#define EPOLL_MAX_EVENTS 64
+#endif /* HAVE_SYS_EPOLL_H */
+
 #if defined(__VMS)
 #  if defined(_VAX_)
 #    define lib$stop LIB$STOP
@@ -123,6 +155,7 @@ static void start_processing_request(struct connection *pconn,
 static void finish_processing_request(struct connection *pconn);
 static void connection_ping(struct connection *pconn);
 static void send_ping_times_to_all(void);
+static void sernet_unwatch_connection(int sock);
 
 static void get_lanserver_announcement(void);
 static void send_lanserver_response(void);
@@ -243,6 +276,9 @@ static void close_connection(struct connection *pconn)
   pconn->playing = NULL;
   pconn->client_gui = GUI_STUB;
   pconn->access_level = ALLOW_NONE;
+  if (pconn->used) {
+    sernet_unwatch_connection(pconn->sock);
+  }
   connection_common_close(pconn);
 
   send_updated_vote_totals(NULL);
@@ -275,6 +311,16 @@ void close_connections_and_socket(void)
     fc_closesocket(listen_socks[i]);
   }
   FC_FREE(listen_socks);
+  FC_FREE(sock_ready.listen_read);
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (epoll_fd >= 0) {
+    close(epoll_fd);
+    epoll_fd = -1;
+    epoll_stdin = FALSE;
+    epoll_stdin_file = FALSE;
+  }
+#endif /* HAVE_SYS_EPOLL_H */
 
   if (srvarg.announce != ANNOUNCE_NONE) {
     fc_closesocket(socklan);
@@ -369,6 +415,288 @@ static void cut_lagging_connection(struct connection *pconn)
   }
 }
 
+/*************************************************************************//**
+  Wait with select() for up to 'timeout' seconds. When 'sniff' is set,
+  wait for input from stdin, listening sockets and connections, and for
+  pending output of the connections. Otherwise only wait for pending output.
+*****************************************************************************/
+static int sernet_select(bool sniff, int timeout)
+{
+  fd_set readfs, writefs, exceptfs;
+  fc_timeval tv;
+  int i, max_desc, ret;
+
+  tv.tv_sec = timeout;
+  tv.tv_usec = 0;
+
+  FC_FD_ZERO(&readfs);
+  FC_FD_ZERO(&writefs);
+  FC_FD_ZERO(&exceptfs);
+  max_desc = -1;
+
+  if (sniff) {
+#if !defined(FREECIV_SOCKET_ZERO_NOT_STDIN) && !defined(__VMS)
+    if (!no_input) {
+      FD_SET(0, &readfs);
+    }
+#endif /* !FREECIV_SOCKET_ZERO_NOT_STDIN && !__VMS */
+
+    max_desc = 0;
+    for (i = 0; i < listen_count; i++) {
+      FD_SET(listen_socks[i], &readfs);
+      FD_SET(listen_socks[i], &exceptfs);
+      max_desc = MAX(max_desc, listen_socks[i]);
+    }
+  }
+
+  for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+    struct connection *pconn = connections + i;
+
+    if (pconn->used && !pconn->server.is_closing) {
+      if (sniff) {
+        FD_SET(pconn->sock, &readfs);
+      }
+      if (0 < pconn->send_buffer->ndata) {
+        FD_SET(pconn->sock, &writefs);
+      } else if (!sniff) {
+        continue;
+      }
+      FD_SET(pconn->sock, &exceptfs);
+      max_desc = MAX(pconn->sock, max_desc);
+    }
+  }
+
+  ret = fc_select(max_desc + 1, sniff ? &readfs : NULL, &writefs, &exceptfs,
+                  &tv);
+
+  sock_ready.stdin_read = FALSE;
+#if !defined(FREECIV_SOCKET_ZERO_NOT_STDIN) && !defined(__VMS)
+  sock_ready.stdin_read = (ret > 0 && FD_ISSET(0, &readfs));
+#endif /* !FREECIV_SOCKET_ZERO_NOT_STDIN && !__VMS */
+  sock_ready.listen_except = FALSE;
+  for (i = 0; i < listen_count; i++) {
+    sock_ready.listen_read[i] = (ret > 0 && sniff
+                                 && FD_ISSET(listen_socks[i], &readfs));
+    if (ret > 0 && sniff && FD_ISSET(listen_socks[i], &exceptfs)) {
+      sock_ready.listen_except = TRUE;
+    }
+  }
+  for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
+    struct connection *pconn = connections + i;
+    bool polled = (ret > 0 && pconn->used && !pconn->server.is_closing);
+
+    sock_ready.conns[i].read = (polled && sniff
+                                && FD_ISSET(pconn->sock, &readfs));
+    sock_ready.conns[i].write = (polled && FD_ISSET(pconn->sock, &writefs));
+    sock_ready.conns[i].except = (polled
+                                  && FD_ISSET(pconn->sock, &exceptfs));
+  }
+
+  return ret;
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+/*************************************************************************//**
+  Create the epoll instance and register the listening sockets. Leaves
+  epoll_fd at -1 if epoll cannot be used.
+*****************************************************************************/
+static void sernet_epoll_open(void)
+{
+  struct epoll_event ev;
+  int i;
+
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd < 0) {
+    log_verbose("epoll_create1() failed: %s; using select()",
+                fc_strerror(fc_get_errno()));
+    return;
+  }
+
+  for (i = 0; i < listen_count; i++) {
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = EPOLL_TAG_LISTEN + i;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_socks[i], &ev) < 0) {
+      log_error("Cannot poll the server socket: %s; using select()",
+                fc_strerror(fc_get_errno()));
+      close(epoll_fd);
+      epoll_fd = -1;
+      return;
+    }
+  }
+}
+
+/*************************************************************************//**
+  Register or unregister stdin, depending on whether input is read.
+  Regular files cannot be polled; they are always ready, as for select().
+*****************************************************************************/
+static void sernet_epoll_stdin(void)
+{
+#if !defined(FREECIV_SOCKET_ZERO_NOT_STDIN) && !defined(__VMS)
+  struct epoll_event ev;
+
+  if (no_input) {
+    if (epoll_stdin) {
+      epoll_ctl(epoll_fd, EPOLL_CTL_DEL, 0, NULL);
+      epoll_stdin = FALSE;
+    }
+    epoll_stdin_file = FALSE;
+    return;
+  }
+
+  if (epoll_stdin || epoll_stdin_file) {
+    return;
+  }
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.u32 = EPOLL_TAG_STDIN;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, 0, &ev) == 0) {
+    epoll_stdin = TRUE;
+  } else {
+    epoll_stdin_file = TRUE;
+  }
+#endif /* !FREECIV_SOCKET_ZERO_NOT_STDIN && !__VMS */
+}
+
+/*************************************************************************//**
+  epoll counterpart of sernet_select(). Connections are registered
+  edge-triggered for both directions once, so nothing needs to be rebuilt
+  here. If some connection is already known to be ready for what we
+  want, don't block.
+*****************************************************************************/
+static int sernet_epoll_wait(bool sniff, int timeout)
+{
+  struct epoll_event events[EPOLL_MAX_EVENTS];
+  bool pending = FALSE;
+  int i, num;
+
+  /* Level-triggered; reported again if still ready. */
+  sock_ready.stdin_read = FALSE;
+  sock_ready.listen_except = FALSE;
+  for (i = 0; i < listen_count; i++) {
+    sock_ready.listen_read[i] = FALSE;
+  }
+
+  if (sniff) {
+    sernet_epoll_stdin();
+    if (epoll_stdin_file) {
+      sock_ready.stdin_read = TRUE;
+      pending = TRUE;
+    }
+  }
+
+  for (i = 0; i < MAX_NUM_CONNECTIONS && !pending; i++) {
+    struct connection *pconn = connections + i;
+
+    if (pconn->used && !pconn->server.is_closing
+        && ((sniff && sock_ready.conns[i].read)
+            || sock_ready.conns[i].except
+            || (sock_ready.conns[i].write
+                && 0 < pconn->send_buffer->ndata))) {
+      pending = TRUE;
+    }
+  }
+
+  num = epoll_wait(epoll_fd, events, ARRAY_SIZE(events),
+                   pending ? 0 : timeout * 1000);
+  if (num < 0) {
+    return num;
+  }
+
+  for (i = 0; i < num; i++) {
+    unsigned int tag = events[i].data.u32;
+
+    if (tag < MAX_NUM_CONNECTIONS) {
+      if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+        /* Errors and hangups are found out by reading. */
+        sock_ready.conns[tag].read = TRUE;
+      }
+      if (events[i].events & EPOLLOUT) {
+        sock_ready.conns[tag].write = TRUE;
+      }
+      if (events[i].events & EPOLLPRI) {
+        sock_ready.conns[tag].except = TRUE;
+      }
+    } else if (tag == EPOLL_TAG_STDIN) {
+      sock_ready.stdin_read = TRUE;
+    } else if (tag - EPOLL_TAG_LISTEN < (unsigned int) listen_count) {
+      sock_ready.listen_read[tag - EPOLL_TAG_LISTEN] = TRUE;
+    }
+  }
+
+  return pending ? MAX(num, 1) : num;
+}
+#endif /* HAVE_SYS_EPOLL_H */
+
+/*************************************************************************//**
+  Wait for network events for up to 'timeout' seconds, and store them in
+  sock_ready. See sernet_select() for 'sniff'. Returns like select().
+*****************************************************************************/
+static int sernet_wait(bool sniff, int timeout)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  if (epoll_fd >= 0) {
+    return sernet_epoll_wait(sniff, timeout);
+  }
+#endif /* HAVE_SYS_EPOLL_H */
+
+  return sernet_select(sniff, timeout);
+}
+
+/*************************************************************************//**
+  Start watching the new connection socket.
+  Returns FALSE if it cannot be watched.
+*****************************************************************************/
+static bool sernet_watch_connection(int idx, int sock)
+{
+  sock_ready.conns[idx].read = FALSE;
+  sock_ready.conns[idx].write = FALSE;
+  sock_ready.conns[idx].except = FALSE;
+
+#ifdef HAVE_SYS_EPOLL_H
+  if (epoll_fd >= 0) {
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLPRI | EPOLLRDHUP | EPOLLET;
+    ev.data.u32 = idx;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock, &ev) < 0) {
+      log_error("Cannot poll the connection socket: %s",
+                fc_strerror(fc_get_errno()));
+      return FALSE;
+    }
+  }
+#endif /* HAVE_SYS_EPOLL_H */
+
+  return TRUE;
+}
+
+/*************************************************************************//**
+  Stop watching the connection socket, before closing it.
+*****************************************************************************/
+static void sernet_unwatch_connection(int sock)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  if (epoll_fd >= 0) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, sock, NULL);
+  }
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/*************************************************************************//**
+  Write out the send buffer of the connection that was reported writable.
+*****************************************************************************/
+static void sernet_flush_connection(struct connection *pconn)
+{
+  flush_connection_send_buffer_all(pconn);
+
+  /* Whatever is left did not fit; wait until writable again. */
+  if (pconn->send_buffer != NULL && 0 < pconn->send_buffer->ndata) {
+    sock_ready.conns[pconn - connections].write = FALSE;
+  }
+}
+
 /*************************************************************************//**
   Attempt to flush all information in the send buffers for upto 'netwait'
   seconds.
@@ -376,9 +704,7 @@ static void cut_lagging_connection(struct connection *pconn)
 void flush_packets(void)
 {
   int i;
-  int max_desc;
-  fd_set writefs, exceptfs;
-  fc_timeval tv;
+  bool pending;
   time_t start;
 
   (void) time(&start);
@@ -391,30 +717,23 @@ void flush_packets(void)
       return;
     }
 
-    tv.tv_usec = 0;
-    tv.tv_sec = signsecs;
-
-    FC_FD_ZERO(&writefs);
-    FC_FD_ZERO(&exceptfs);
-    max_desc = -1;
-
+    pending = FALSE;
     for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
       struct connection *pconn = &connections[i];
 
       if (pconn->used
           && !pconn->server.is_closing
           && 0 < pconn->send_buffer->ndata) {
-        FD_SET(pconn->sock, &writefs);
-        FD_SET(pconn->sock, &exceptfs);
-        max_desc = MAX(pconn->sock, max_desc);
+        pending = TRUE;
+        break;
       }
     }
 
-    if (max_desc == -1) {
+    if (!pending) {
       return;
     }
 
-    if (fc_select(max_desc + 1, NULL, &writefs, &exceptfs, &tv) <= 0) {
+    if (sernet_wait(FALSE, signsecs) <= 0) {
       return;
     }
 
@@ -422,14 +741,14 @@ void flush_packets(void)
       struct connection *pconn = &connections[i];
 
       if (pconn->used && !pconn->server.is_closing) {
-        if (FD_ISSET(pconn->sock, &exceptfs)) {
+        if (sock_ready.conns[i].except) {
           log_verbose("connection (%s) cut due to exception data",
                       conn_description(pconn));
           connection_close_server(pconn, _("network exception"));
         } else {
           if (pconn->send_buffer && pconn->send_buffer->ndata > 0) {
-            if (FD_ISSET(pconn->sock, &writefs)) {
-              flush_connection_send_buffer_all(pconn);
+            if (sock_ready.conns[i].write) {
+              sernet_flush_connection(pconn);
             } else {
               cut_lagging_connection(pconn);
             }
@@ -470,6 +789,7 @@ static void incoming_client_packets(struct connection *pconn)
 
   while (get_packet(pconn, &packet)) {
     bool command_ok;
+    uint64_t latency_start;
 
 #if PROCESSING_TIME_STATISTICS
     int request_id;
@@ -489,7 +809,9 @@ static void incoming_client_packets(struct connection *pconn)
     connection_do_buffer(pconn);
     start_processing_request(pconn, pconn->server.last_request_id_seen);
 
+    latency_start = packet_latency_start();
     command_ok = server_packet_input(pconn, packet.data, packet.type);
+    packet_latency_record(PACKET_LATENCY_HANDLE, packet.type, latency_start);
     packet_destroy(packet.data, packet.type);
 
     finish_processing_request(pconn);
@@ -522,10 +844,6 @@ static void incoming_client_packets(struct connection *pconn)
 enum server_events server_sniff_all_input(void)
 {
   int i, s;
-  int max_desc;
-  bool excepting;
-  fd_set readfs, writefs, exceptfs;
-  fc_timeval tv;
 #ifdef FREECIV_SOCKET_ZERO_NOT_STDIN
   char *bufptr;
 #endif
@@ -576,6 +894,12 @@ enum server_events server_sniff_all_input(void)
 
     con_prompt_on();   /* accepting new input */
 
+    if (replay_is_active()) {
+      /* The packet trace stands in for all the network input. */
+      con_prompt_off();
+      return replay_sniff();
+    }
+
     if (force_end_of_sniff) {
       force_end_of_sniff = FALSE;
       con_prompt_off();
@@ -687,45 +1011,15 @@ enum server_events server_sniff_all_input(void)
       return S_E_END_OF_TURN_TIMEOUT;
     }
 
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
-
-    FC_FD_ZERO(&readfs);
-    FC_FD_ZERO(&writefs);
-    FC_FD_ZERO(&exceptfs);
-
-    if (!no_input) {
 #ifdef FREECIV_SOCKET_ZERO_NOT_STDIN
+    if (!no_input) {
       fc_init_console();
-#else /* FREECIV_SOCKET_ZERO_NOT_STDIN */
-#   if !defined(__VMS)
-      FD_SET(0, &readfs);
-#   endif /* VMS */
-#endif /* FREECIV_SOCKET_ZERO_NOT_STDIN */
     }
+#endif /* FREECIV_SOCKET_ZERO_NOT_STDIN */
 
-    max_desc = 0;
-    for (i = 0; i < listen_count; i++) {
-      FD_SET(listen_socks[i], &readfs);
-      FD_SET(listen_socks[i], &exceptfs);
-      max_desc = MAX(max_desc, listen_socks[i]);
-    }
-
-    for (i = 0; i < MAX_NUM_CONNECTIONS; i++) {
-      struct connection *pconn = connections + i;
-
-      if (pconn->used && !pconn->server.is_closing) {
-        FD_SET(pconn->sock, &readfs);
-        if (0 < pconn->send_buffer->ndata) {
-          FD_SET(pconn->sock, &writefs);
-        }
-        FD_SET(pconn->sock, &exceptfs);
-        max_desc = MAX(pconn->sock, max_desc);
-      }
-    }
     con_prompt_off();    /* output doesn't generate a new prompt */
 
-    selret = fc_select(max_desc + 1, &readfs, &writefs, &exceptfs, &tv);
+    selret = sernet_wait(TRUE, 1);
     if (selret == 0) {
       /* timeout */
       call_ai_refresh();
@@ -771,7 +1065,7 @@ enum server_events server_sniff_all_input(void)
             lib$stop(status);
           }
           if (ttchar.numchars) {
-            FD_SET(0, &readfs);
+            sock_ready.stdin_read = TRUE;
           } else {
             continue;
           }
@@ -784,22 +1078,16 @@ enum server_events server_sniff_all_input(void)
 #endif /* !__VMS */
       }
     } else if (selret < 0) {
-      log_error("fc_select() failed: %s", fc_strerror(fc_get_errno()));
+      log_error("Waiting for network events failed: %s",
+                fc_strerror(fc_get_errno()));
     }
 
-    excepting = FALSE;
-    for (i = 0; i < listen_count; i++) {
-      if (FD_ISSET(listen_socks[i], &exceptfs)) {
-        excepting = TRUE;
-        break;
-      }
-    }
-    if (excepting) {                  /* handle Ctrl-Z suspend/resume */
+    if (sock_ready.listen_except) {   /* handle Ctrl-Z suspend/resume */
       continue;
     }
     for (i = 0; i < listen_count; i++) {
       s = listen_socks[i];
-      if (FD_ISSET(s, &readfs)) {     /* new players connects */
+      if (sock_ready.listen_read[i]) {  /* new players connects */
         log_verbose("got new connection");
         if (-1 == server_accept_connection(s)) {
           /* There will be a log_error() message from
@@ -816,7 +1104,7 @@ enum server_events server_sniff_all_input(void)
 
       if (pconn->used
           && !pconn->server.is_closing
-          && FD_ISSET(pconn->sock, &exceptfs)) {
+          && sock_ready.conns[i].except) {
         log_verbose("connection (%s) cut due to exception data",
                     conn_description(pconn));
         connection_close_server(pconn, _("network exception"));
@@ -831,7 +1119,7 @@ enum server_events server_sniff_all_input(void)
       current_internal = NULL;
     }
 #else  /* !FREECIV_SOCKET_ZERO_NOT_STDIN */
-    if (!no_input && FD_ISSET(0, &readfs)) {    /* input from server operator */
+    if (!no_input && sock_ready.stdin_read) {   /* input from server operator */
 #ifdef FREECIV_HAVE_LIBREADLINE
       rl_callback_read_char();
       if (readline_handled_input) {
@@ -886,11 +1174,15 @@ enum server_events server_sniff_all_input(void)
 
         if (!pconn->used
             || pconn->server.is_closing
-            || !FD_ISSET(pconn->sock, &readfs)) {
+            || !sock_ready.conns[i].read) {
           continue;
         }
 
         nb = read_socket_data(pconn->sock, pconn->buffer);
+        if (0 == nb) {
+          /* Would block; everything has been read. */
+          sock_ready.conns[i].read = FALSE;
+        }
         if (0 <= nb) {
           /* We read packets; now handle them. */
           incoming_client_packets(pconn);
@@ -909,8 +1201,8 @@ enum server_events server_sniff_all_input(void)
             && !pconn->server.is_closing
             && pconn->send_buffer
             && pconn->send_buffer->ndata > 0) {
-          if (FD_ISSET(pconn->sock, &writefs)) {
-            flush_connection_send_buffer_all(pconn);
+          if (sock_ready.conns[i].write) {
+            sernet_flush_connection(pconn);
           } else {
             cut_lagging_connection(pconn);
           }
@@ -948,6 +1240,34 @@ enum server_events server_sniff_all_input(void)
   return S_E_OTHERWISE;
 }
 
+/*************************************************************************//**
+  Read and handle all the input waiting on the connection socket, then
+  write out what the handlers sent. Used when the input does not come
+  from server_sniff_all_input(), as when replaying a packet trace.
+*****************************************************************************/
+void server_connection_input(struct connection *pconn)
+{
+  int nb;
+
+  do {
+    nb = read_socket_data(pconn->sock, pconn->buffer);
+    if (0 <= nb) {
+      incoming_client_packets(pconn);
+    } else if (-2 == nb) {
+      connection_close_server(pconn, _("client disconnected"));
+    } else {
+      connection_close_server(pconn, _("read error"));
+    }
+  } while (0 < nb && pconn->used && !pconn->server.is_closing);
+
+  conn_list_iterate(game.all_connections, aconn) {
+    if (!aconn->server.is_closing && 0 < aconn->send_buffer->ndata) {
+      flush_connection_send_buffer_all(aconn);
+    }
+  } conn_list_iterate_end;
+  really_close_connections();
+}
+
 /*************************************************************************//**
   Make up a name for the connection, before we get any data from
   it to use as a sensible name.  Name will be 'c' + integer,
@@ -1080,6 +1400,12 @@ int server_make_connection(int new_sock, const char *client_addr,
     struct connection *pconn = &connections[i];
 
     if (!pconn->used) {
+      if (!sernet_watch_connection(i, new_sock)) {
+        fc_closesocket(new_sock);
+
+        return -1;
+      }
+
       connection_common_init(pconn);
       pconn->sock = new_sock;
       pconn->observer = FALSE;
@@ -1172,6 +1498,8 @@ int server_open_socket(void)
 
   /* Loop to create sockets, bind, listen. */
   listen_socks = fc_calloc(name_count, sizeof(listen_socks[0]));
+  sock_ready.listen_read = fc_calloc(name_count,
+                                     sizeof(sock_ready.listen_read[0]));
   listen_count = 0;
 
   fc_sockaddr_list_iterate(list, paddr) {
@@ -1264,7 +1592,9 @@ int server_open_socket(void)
 
   fc_sockaddr_list_destroy(list);
 
-  connections_set_close_callback(server_conn_close_callback);
+#ifdef HAVE_SYS_EPOLL_H
+  sernet_epoll_open();
+#endif
 
   if (srvarg.announce == ANNOUNCE_NONE) {
     return 0;
@@ -1375,6 +1705,7 @@ void init_connections(void)
     pconn->self = conn_list_new();
     conn_list_prepend(pconn->self, pconn);
   }
+  connections_set_close_callback(server_conn_close_callback);
 #if defined(__VMS)
   {
     unsigned long status;
@@ -39,6 +39,7 @@ void close_connections_and_socket(void);
 void init_connections(void);
 int server_make_connection(int new_sock,
                            const char *client_addr, const char *client_ip);
+void server_connection_input(struct connection *pconn);
 void handle_conn_pong(struct connection *pconn);
 void handle_client_heartbeat(struct connection *pconn);
 
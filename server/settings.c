@@ -3186,12 +3186,26 @@ static struct setting settings[] = {
            N_("Whether to do saving in separate thread"),
            /* TRANS: The string between single quotes is a setting name and
             * should not be translated. */
-           N_("If this is turned in, compressing and saving the actual "
-              "file containing the game situation takes place in "
+           N_("If this is turned in, formatting the map data, compressing "
+              "and saving the actual file containing the game situation "
+              "takes place in "
               "the background while game otherwise continues. This way "
               "users are not required to wait for the save to finish."),
            nullptr, nullptr, GAME_DEFAULT_THREADED_SAVE)
 
+  GEN_BOOL("binary_save", game.server.binary_save,
+           SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+           N_("Whether to save games in the binary format"),
+           /* TRANS: The strings between single quotes are setting names
+            * and should not be translated. */
+           N_("If this is turned on, games are saved in the binary "
+              "format instead of the text format. Binary saves are "
+              "written and loaded much faster, but they are not "
+              "compressed, so the 'compress' and 'compresstype' "
+              "settings do not apply to them. They can be converted "
+              "to the text format and back without any loss."),
+           nullptr, nullptr, GAME_DEFAULT_BINARY_SAVE)
+
   GEN_INT("compress", game.server.save_compress_level,
           SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
           N_("Savegame compression level"),
@@ -3210,6 +3224,19 @@ static struct setting settings[] = {
            nullptr, nullptr, nullptr, compresstype_name,
            GAME_DEFAULT_COMPRESS_TYPE)
 
+  GEN_INT("compressthreads", game.server.save_compress_threads,
+          SSET_META, SSET_INTERNAL, SSET_RARE, ALLOW_HACK, ALLOW_HACK,
+          N_("Number of threads compressing savegames"),
+          /* TRANS: 'compresstype' setting name should not be translated. */
+          N_("If more than one, savegames are compressed with that many "
+             "threads working in parallel. Only the \"XZ\" and \"ZSTD\" "
+             "'compresstype' settings support this; the other types "
+             "always use one thread. Compressing in parallel may make the "
+             "saved files slightly larger."),
+          nullptr, nullptr, nullptr,
+          GAME_MIN_COMPRESS_THREADS, GAME_MAX_COMPRESS_THREADS,
+          GAME_DEFAULT_COMPRESS_THREADS)
+
   GEN_STRING("savename", game.server.save_name,
              SSET_META, SSET_INTERNAL, SSET_VITAL, ALLOW_HACK, ALLOW_HACK,
              N_("Definition of the save file name"),
@@ -0,0 +1,251 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <stdio.h>
+
+/* utility */
+#include "log.h"
+#include "mem.h"
+#include "shared.h"
+#include "support.h"
+#include "timing.h"
+
+/* common */
+#include "city.h"
+#include "game.h"
+#include "player.h"
+#include "unit.h"
+#include "version.h"
+
+/* server */
+#include "srv_main.h"
+
+#include "srv_bench.h"
+
+/* Timings of one benchmarked turn */
+struct bench_turn {
+  int turn;
+  int cities;
+  int units;
+  double total;
+  double stage[BENCH_STAGE_COUNT];
+};
+
+static struct {
+  bool active;
+  int turns_wanted;
+  int turns_done;
+  char *output;
+
+  struct timer *turn_timer;
+  struct timer *stage_timer[BENCH_STAGE_COUNT];
+
+  struct bench_turn *results;
+} bench = { .active = FALSE };
+
+/**********************************************************************//**
+  Activate the benchmark. 'turns' turns are run before the game is ended.
+  If 'output_filename' is nullptr, the report goes to stdout.
+**************************************************************************/
+void bench_init(int turns, const char *output_filename)
+{
+  int i;
+
+  fc_assert_ret(turns > 0);
+
+  bench.active = TRUE;
+  bench.turns_wanted = turns;
+  bench.turns_done = 0;
+  bench.output = output_filename != nullptr
+    ? fc_strdup(output_filename) : nullptr;
+
+  bench.turn_timer = timer_new(TIMER_USER, TIMER_ACTIVE, "bench turn");
+  for (i = 0; i < BENCH_STAGE_COUNT; i++) {
+    bench.stage_timer[i] = timer_new(TIMER_USER, TIMER_ACTIVE,
+                                     bench_stage_name(i));
+  }
+
+  bench.results = fc_calloc(turns, sizeof(*bench.results));
+}
+
+/**********************************************************************//**
+  Free benchmark data.
+**************************************************************************/
+void bench_free(void)
+{
+  int i;
+
+  if (!bench.active) {
+    return;
+  }
+
+  timer_destroy(bench.turn_timer);
+  for (i = 0; i < BENCH_STAGE_COUNT; i++) {
+    timer_destroy(bench.stage_timer[i]);
+  }
+  FC_FREE(bench.results);
+  FC_FREE(bench.output);
+
+  bench.active = FALSE;
+}
+
+/**********************************************************************//**
+  Is the server running as a benchmark?
+**************************************************************************/
+bool bench_is_active(void)
+{
+  return bench.active;
+}
+
+/**********************************************************************//**
+  Start accumulating time for the stage.
+**************************************************************************/
+void bench_stage_start(enum bench_stage stage)
+{
+  if (bench.active) {
+    timer_start(bench.stage_timer[stage]);
+  }
+}
+
+/**********************************************************************//**
+  Stop accumulating time for the stage.
+**************************************************************************/
+void bench_stage_stop(enum bench_stage stage)
+{
+  if (bench.active) {
+    timer_stop(bench.stage_timer[stage]);
+  }
+}
+
+/**********************************************************************//**
+  Turn change begins. Resets all the per-turn timers.
+**************************************************************************/
+void bench_turn_begin(void)
+{
+  int i;
+
+  if (!bench.active || bench.turns_done >= bench.turns_wanted) {
+    return;
+  }
+
+  for (i = 0; i < BENCH_STAGE_COUNT; i++) {
+    timer_clear(bench.stage_timer[i]);
+  }
+  timer_clear(bench.turn_timer);
+  timer_start(bench.turn_timer);
+
+  bench.results[bench.turns_done].turn = game.info.turn;
+}
+
+/**********************************************************************//**
+  Turn has been processed. Store its timings.
+  Returns TRUE when the requested number of turns has been run.
+**************************************************************************/
+bool bench_turn_end(void)
+{
+  struct bench_turn *result;
+  int i;
+
+  if (!bench.active) {
+    return FALSE;
+  }
+
+  fc_assert_ret_val(bench.turns_done < bench.turns_wanted, TRUE);
+
+  timer_stop(bench.turn_timer);
+
+  result = &bench.results[bench.turns_done++];
+  result->total = timer_read_seconds(bench.turn_timer);
+  for (i = 0; i < BENCH_STAGE_COUNT; i++) {
+    result->stage[i] = timer_read_seconds(bench.stage_timer[i]);
+  }
+
+  result->cities = 0;
+  result->units = 0;
+  players_iterate(pplayer) {
+    result->cities += city_list_size(pplayer->cities);
+    result->units += unit_list_size(pplayer->units);
+  } players_iterate_end;
+
+  log_normal(_("Benchmark turn %d/%d (game turn %d): %g seconds"),
+             bench.turns_done, bench.turns_wanted, result->turn,
+             result->total);
+
+  return bench.turns_done >= bench.turns_wanted;
+}
+
+/**********************************************************************//**
+  Write the benchmark report as JSON.
+**************************************************************************/
+void bench_report(void)
+{
+  double sum_total = 0.0;
+  double sum_stage[BENCH_STAGE_COUNT] = { 0.0, };
+  FILE *fp;
+  int i, t;
+
+  if (!bench.active) {
+    return;
+  }
+
+  if (bench.output != nullptr) {
+    fp = fc_fopen(bench.output, "w");
+    if (fp == nullptr) {
+      log_error(_("Could not open benchmark report file \"%s\"."),
+                bench.output);
+      return;
+    }
+  } else {
+    fp = stdout;
+  }
+
+  fprintf(fp, "{\n  \"version\": ");
+  fc_fputs_json_string(fp, freeciv_name_version());
+  fprintf(fp, ",\n  \"savegame\": ");
+  fc_fputs_json_string(fp, srvarg.load_filename);
+  fprintf(fp, ",\n  \"players\": %d,\n", player_count());
+  fprintf(fp, "  \"turns\": %d,\n", bench.turns_done);
+
+  fprintf(fp, "  \"per_turn\": [");
+  for (t = 0; t < bench.turns_done; t++) {
+    const struct bench_turn *result = &bench.results[t];
+
+    fprintf(fp, "%s\n    { \"turn\": %d, \"num_cities\": %d, "
+            "\"num_units\": %d, \"total\": %.6f",
+            t > 0 ? "," : "", result->turn, result->cities,
+            result->units, result->total);
+    for (i = 0; i < BENCH_STAGE_COUNT; i++) {
+      fprintf(fp, ", \"%s\": %.6f", bench_stage_name(i), result->stage[i]);
+      sum_stage[i] += result->stage[i];
+    }
+    fprintf(fp, " }");
+    sum_total += result->total;
+  }
+  fprintf(fp, "\n  ],\n");
+
+  fprintf(fp, "  \"totals\": { \"total\": %.6f", sum_total);
+  for (i = 0; i < BENCH_STAGE_COUNT; i++) {
+    fprintf(fp, ", \"%s\": %.6f", bench_stage_name(i), sum_stage[i]);
+  }
+  fprintf(fp, " }\n}\n");
+
+  if (fp != stdout) {
+    fclose(fp);
+  } else {
+    fflush(fp);
+  }
+}
@@ -0,0 +1,52 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__SRV_BENCH_H
+#define FC__SRV_BENCH_H
+
+/* utility */
+#include "support.h"            /* bool type */
+
+/* Headless turn-processing benchmark.
+ *
+ * When active (freeciv-bench), the server runs a fixed number of turns
+ * without waiting for any network input and accumulates wall time per
+ * turn-change stage. Results are written as JSON by bench_report().
+ * All the hooks are no-ops when the benchmark is not active. */
+
+#define SPECENUM_NAME bench_stage
+#define SPECENUM_VALUE0 BENCH_AI
+#define SPECENUM_VALUE0NAME "ai"
+#define SPECENUM_VALUE1 BENCH_CITIES
+#define SPECENUM_VALUE1NAME "cities"
+#define SPECENUM_VALUE2 BENCH_UNITS
+#define SPECENUM_VALUE2NAME "units"
+#define SPECENUM_VALUE3 BENCH_VISION
+#define SPECENUM_VALUE3NAME "vision"
+#define SPECENUM_VALUE4 BENCH_AUTOSAVE
+#define SPECENUM_VALUE4NAME "autosave"
+#define SPECENUM_COUNT BENCH_STAGE_COUNT
+#include "specenum_gen.h"
+
+void bench_init(int turns, const char *output_filename);
+void bench_free(void);
+bool bench_is_active(void);
+
+void bench_stage_start(enum bench_stage stage);
+void bench_stage_stop(enum bench_stage stage);
+
+void bench_turn_begin(void);
+bool bench_turn_end(void);
+
+void bench_report(void);
+
+#endif /* FC__SRV_BENCH_H */
@@ -146,6 +146,12 @@ int main(int argc, char *argv[])
         break;
       }
       free(option);
+    } else if ((option = get_option_malloc("--Threads", argv, &inx, argc, FALSE))) {
+      if (!str_to_int(option, &srvarg.threads) || srvarg.threads < 1) {
+        showhelp = TRUE;
+        break;
+      }
+      free(option);
     } else if (is_option("--exit-on-end", argv[inx])) {
       srvarg.exit_on_end = TRUE;
     } else if ((option = get_option_malloc("--debug", argv, &inx, argc, FALSE))) {
@@ -313,6 +319,11 @@ int main(int argc, char *argv[])
                 /* TRANS: "Serverid" is exactly what user must type, do not translate. */
                 _("Serverid ID"),
                 _("Sets the server id to ID"));
+    cmdhelp_add(help, "T",
+                /* TRANS: "Threads" is exactly what user must type, do not translate. */
+                _("Threads NUMBER"),
+                _("Use NUMBER threads in turn change processing, "
+                  "map generation and tex AI planning"));
     cmdhelp_add(help, "r",
                 /* TRANS: "read" is exactly what user must type, do not translate. */
                 _("read FILE"),
@@ -19,6 +19,7 @@
 
 /* utility */
 #include "astring.h"
+#include "fcthread.h"
 #include "log.h"
 #include "shared.h"
 #include "support.h"
@@ -43,6 +44,7 @@
 
 static struct timer *aitimer[AIT_LAST][2];
 static int recursion[AIT_LAST];
+static fc_thread_id timing_thread;
 
 /* General AI logging functions */
 
@@ -124,12 +126,17 @@ void real_unit_log(const char *file, const char *function, int line,
 
 /**********************************************************************//**
   Measure the time between the calls.  Used to see where in the AI too
-  much CPU is being used.
+  much CPU is being used. Only the thread that initialized the timers
+  is timed, as they are not thread safe.
 **************************************************************************/
 void timing_log_real(enum ai_timer timer, enum ai_timer_activity activity)
 {
   static int turn = -1;
 
+  if (!fc_threads_equal(fc_thread_self(), timing_thread)) {
+    return;
+  }
+
   if (game.info.turn != turn) {
     int i;
 
@@ -219,6 +226,8 @@ void timing_log_init(void)
 {
   int i;
 
+  timing_thread = fc_thread_self();
+
   for (i = 0; i < AIT_LAST; i++) {
     char buf[60];
 
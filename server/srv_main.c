@@ -117,7 +117,9 @@
 #include "sernet.h"
 #include "settings.h"
 #include "spacerace.h"
+#include "srv_bench.h"
 #include "srv_log.h"
+#include "srv_replay.h"
 #include "srv_signal.h"
 #include "stdinhand.h"
 #include "techtools.h"
@@ -127,6 +129,7 @@
 
 /* server/advisors */
 #include "advdata.h"
+#include "advgoto.h"
 #include "autoworkers.h"
 #include "advbuilding.h"
 #include "advspace.h"
@@ -286,6 +289,8 @@ void srv_init(void)
 
   srvarg.quitidle = 0;
 
+  srvarg.threads = 1;
+
   srvarg.fcdb_enabled = FALSE;
   srvarg.fcdb_conf = nullptr;
   srvarg.auth_enabled = FALSE;
@@ -1159,6 +1164,9 @@ static void begin_turn(bool is_new_turn)
 
   event_cache_remove_old();
 
+  /* Map generator and savegame loading set up tiles directly. */
+  bonus_cache_invalidate();
+
   /* Reset this each turn. */
   if (is_new_turn) {
     if (game.info.phase_mode != game.server.phase_mode_stored) {
@@ -1264,6 +1272,9 @@ static void begin_phase(bool is_new_phase)
 {
   log_debug("Begin phase");
 
+  /* The turn change does not tell when it changes paths. */
+  adv_pf_maps_invalidate();
+
   conn_list_do_buffer(game.est_connections);
 
   phase_players_iterate(pplayer) {
@@ -1285,11 +1296,13 @@ static void begin_phase(bool is_new_phase)
   }
 
   /* Must be the first thing as it is needed for lots of functions below! */
+  bench_stage_start(BENCH_AI);
   phase_players_iterate(pplayer) {
     /* Human players also need this for building advice */
     adv_data_phase_init(pplayer, is_new_phase);
     CALL_PLR_AI_FUNC(phase_begin, pplayer, pplayer, is_new_phase);
   } phase_players_iterate_end;
+  bench_stage_stop(BENCH_AI);
 
   if (is_new_phase) {
     /* Unit "end of turn" activities - of course these actually go at
@@ -1331,10 +1344,12 @@ static void begin_phase(bool is_new_phase)
       }
     } whole_map_iterate_end;
 
+    bench_stage_start(BENCH_UNITS);
     phase_players_iterate(pplayer) {
       update_unit_activities(pplayer);
       flush_packets();
     } phase_players_iterate_end;
+    bench_stage_stop(BENCH_UNITS);
 
     /* Execute orders after activities have been completed (roads built,
      * pillage done, etc.). */
@@ -1384,21 +1399,28 @@ static void begin_phase(bool is_new_phase)
 
   if (is_new_phase) {
     /* Try to avoid hiding events under a diplomacy dialog */
+    bench_stage_start(BENCH_AI);
     phase_players_iterate(pplayer) {
       if (is_ai(pplayer)) {
         CALL_PLR_AI_FUNC(diplomacy_actions, pplayer, pplayer);
       }
     } phase_players_iterate_end;
+    bench_stage_stop(BENCH_AI);
 
     /* Spend random movement move points before any controlled actions */
+    bench_stage_start(BENCH_UNITS);
     phase_players_iterate(pplayer) {
       random_movements(pplayer);
     } phase_players_iterate_end;
+    bench_stage_stop(BENCH_UNITS);
 
     log_debug("Aistartturn");
+    bench_stage_start(BENCH_AI);
     ai_start_phase();
+    bench_stage_stop(BENCH_AI);
 
     flush_packets();
+    bench_stage_start(BENCH_UNITS);
     phase_players_iterate(pplayer) {
       unit_list_iterate_safe(pplayer->units, punit) {
         if (punit->activity == ACTIVITY_EXPLORE) {
@@ -1408,12 +1430,15 @@ static void begin_phase(bool is_new_phase)
       execute_unit_orders(pplayer);
       flush_packets();
     } phase_players_iterate_end;
+    bench_stage_stop(BENCH_UNITS);
   } else {
+    bench_stage_start(BENCH_AI);
     phase_players_iterate(pplayer) {
       if (is_ai(pplayer)) {
         CALL_PLR_AI_FUNC(restart_phase, pplayer, pplayer);
       }
     } phase_players_iterate_end;
+    bench_stage_stop(BENCH_AI);
   }
 
   sanity_check();
@@ -1514,6 +1539,7 @@ static void end_phase(void)
   send_city_suppression(TRUE);
 
   /* AI end of turn activities */
+  bench_stage_start(BENCH_AI);
   players_iterate(pplayer) {
     unit_list_iterate(pplayer->units, punit) {
       CALL_PLR_AI_FUNC(unit_turn_end, pplayer, punit);
@@ -1525,12 +1551,14 @@ static void end_phase(void)
       CALL_PLR_AI_FUNC(last_activities, pplayer, pplayer);
     }
   } phase_players_iterate_end;
+  bench_stage_stop(BENCH_AI);
 
   /* Refresh cities */
   phase_players_iterate(pplayer) {
     research_get(pplayer)->free_bulbs = 0;
   } phase_players_iterate_end;
 
+  bench_stage_start(BENCH_CITIES);
   alive_phase_players_iterate(pplayer) {
     int plrid = player_number(pplayer);
     int old_gold;
@@ -1566,11 +1594,14 @@ static void end_phase(void)
 
     flush_packets();
   } alive_phase_players_iterate_end;
+  bench_stage_stop(BENCH_CITIES);
 
   /* Some player/global effect may have changed cities' vision range */
+  bench_stage_start(BENCH_VISION);
   phase_players_iterate(pplayer) {
     refresh_player_cities_vision(pplayer);
   } phase_players_iterate_end;
+  bench_stage_stop(BENCH_VISION);
 
   kill_dying_players();
 
@@ -1582,9 +1613,11 @@ static void end_phase(void)
   } phase_players_iterate_end;
   flush_packets();  /* To curb major city spam */
 
+  bench_stage_start(BENCH_VISION);
   do_reveal_effects();
   do_have_contacts_effect();
   do_border_vision_effect();
+  bench_stage_stop(BENCH_VISION);
 
   phase_players_iterate(pplayer) {
     int plrid = player_number(pplayer);
@@ -1594,7 +1627,9 @@ static void end_phase(void)
       /* Removed */
       continue;
     }
+    bench_stage_start(BENCH_AI);
     CALL_PLR_AI_FUNC(phase_finished, pplayer, pplayer);
+    bench_stage_stop(BENCH_AI);
     /* This has to be after all access to advisor data. */
     /* We used to run this for ai players only, but data phase
        is initialized for human players also. */
@@ -1619,7 +1654,9 @@ static void end_turn(void)
 
   lsend_packet_end_turn(game.est_connections);
 
+  bench_stage_start(BENCH_VISION);
   map_calculate_borders();
+  bench_stage_stop(BENCH_VISION);
 
   /* Update city's counter values */
   players_iterate(pplayer) {
@@ -1973,6 +2010,8 @@ void fc__noreturn server_quit(void)
 
   /* Finalize packet tracing before cleanup */
   packet_trace_done();
+  bench_free();
+  replay_free();
 
   if (game.server.save_timer != nullptr) {
     timer_destroy(game.server.save_timer);
@@ -2963,9 +3002,11 @@ static void srv_running(void)
    * This will freeze the reports and agents at the client.
    *
    * Do this before the body so that the PACKET_THAW_CLIENT packet is
-   * balanced.
+   * balanced. Everything sent while the client is frozen is compressed
+   * as one batch.
    */
   lsend_packet_freeze_client(game.est_connections);
+  conn_list_compression_freeze(game.est_connections);
 
   fc_assert(S_S_RUNNING == server_state());
   while (S_S_RUNNING == server_state()) {
@@ -2974,6 +3015,7 @@ static void srv_running(void)
      * We have to initialize data as well as do some actions.  However when
      * loading a game we don't want to do these actions (like AI unit
      * movement and AI diplomacy). */
+    bench_turn_begin();
     begin_turn(is_new_turn);
 
     if (game.server.num_phases != 1) {
@@ -3006,6 +3048,7 @@ static void srv_running(void)
        * This will thaw the reports and agents at the client.
        */
       lsend_packet_thaw_client(game.est_connections);
+      conn_list_compression_thaw(game.est_connections);
 
 #ifdef LOG_TIMERS
       /* Before sniff (human player activites), report time to now: */
@@ -3022,7 +3065,9 @@ static void srv_running(void)
         if (save_counter >= game.server.save_nturns
             && game.server.save_nturns > 0) {
           save_counter = 0;
+          bench_stage_start(BENCH_AUTOSAVE);
           save_game_auto("Autosave", AS_TURN);
+          bench_stage_stop(BENCH_AUTOSAVE);
         }
         save_counter++;
 
@@ -3041,8 +3086,10 @@ static void srv_running(void)
         log_debug("Unresponsive between turns %g seconds", game.server.turn_change_time);
       }
 
-      while (server_sniff_all_input() == S_E_OTHERWISE) {
-        /* Nothing */
+      if (!bench_is_active()) {
+        while (server_sniff_all_input() == S_E_OTHERWISE) {
+          /* Nothing */
+        }
       }
 
       between_turns = timer_renew(between_turns, TIMER_USER, TIMER_ACTIVE,
@@ -3061,6 +3108,7 @@ static void srv_running(void)
        * This will freeze the reports and agents at the client.
        */
       lsend_packet_freeze_client(game.est_connections);
+      conn_list_compression_freeze(game.est_connections);
 
       end_phase();
 
@@ -3083,6 +3131,11 @@ static void srv_running(void)
     log_debug("Sendinfotometaserver");
     (void) send_server_info_to_metaserver(META_REFRESH);
 
+    if (bench_turn_end()) {
+      /* All the requested benchmark turns have been run. */
+      set_server_state(S_S_OVER);
+    }
+
     if (S_S_OVER != server_state() && check_for_game_over()) {
       set_server_state(S_S_OVER);
       if (game.info.turn > game.server.end_turn) {
@@ -3100,6 +3153,7 @@ static void srv_running(void)
 
   /* This will thaw the reports and agents at the client.  */
   lsend_packet_thaw_client(game.est_connections);
+  conn_list_compression_thaw(game.est_connections);
 
   if (game.server.save_timer != nullptr) {
     timer_destroy(game.server.save_timer);
@@ -3141,7 +3195,10 @@ static void srv_prepare(void)
   /* Initialize packet tracing (checks FREECIV_PACKET_TRACE_DIR env var) */
   packet_trace_init(NULL);
 
-  server_open_socket();
+  if (!bench_is_active() && !replay_is_active()) {
+    /* Benchmark never has any connections, and replay makes its own. */
+    server_open_socket();
+  }
 
 #if IS_BETA_VERSION || IS_DEVEL_VERSION
   con_puts(C_COMMENT, "");
@@ -3574,6 +3631,8 @@ void server_game_free(void)
 {
   CALL_FUNC_EACH_AI(game_free);
 
+  adv_pf_maps_invalidate();
+
   /* Free all the treaties that were left open when game finished. */
   free_treaties();
 
@@ -3634,12 +3693,22 @@ void fc__noreturn srv_main(void)
       event_cache_clear();
     }
 
-    log_normal(_("Now accepting new client connections on port %d."),
-               srvarg.port);
-    /* Remain in S_S_INITIAL until all players are ready. */
-    while (S_E_FORCE_END_OF_SNIFF != server_sniff_all_input()) {
-      /* When force_end_of_sniff is used in pregame, it means that the server
-       * is ready to start (usually set within start_game()). */
+    if (bench_is_active()) {
+      /* Start right away, with the AI playing for everyone. */
+      players_iterate(pplayer) {
+        if (is_human(pplayer)) {
+          toggle_ai_player_direct(nullptr, pplayer);
+        }
+      } players_iterate_end;
+      start_game();
+    } else {
+      log_normal(_("Now accepting new client connections on port %d."),
+                 srvarg.port);
+      /* Remain in S_S_INITIAL until all players are ready. */
+      while (S_E_FORCE_END_OF_SNIFF != server_sniff_all_input()) {
+        /* When force_end_of_sniff is used in pregame, it means that the
+         * server is ready to start (usually set within start_game()). */
+      }
     }
 
     if (S_S_RUNNING > server_state()) {
@@ -3647,6 +3716,7 @@ void fc__noreturn srv_main(void)
        * so don't try to start the game. */
       srv_ready(); /* srv_ready() sets server state to S_S_RUNNING. */
       srv_running();
+      bench_report();
       srv_scores();
     }
 
@@ -51,6 +51,9 @@ struct server_arguments {
   int quitidle;
   /* Exit the server on game ending */
   bool exit_on_end;
+  /* Number of threads to use in turn change processing, in map
+   * generation and in tex AI planning */
+  int threads;
   /* Authentication options */
   bool fcdb_enabled;            /* Defaults to FALSE */
   char *fcdb_conf;              /* Freeciv database configuration file */
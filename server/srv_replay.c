@@ -0,0 +1,557 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include "fc_prehdrs.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+
+/* utility */
+#include "fcthread.h"
+#include "log.h"
+#include "mem.h"
+#include "netintf.h"
+#include "support.h"
+#include "timing.h"
+
+/* common */
+#include "connection.h"
+#include "game.h"
+#include "packet_trace.h"
+#include "packets.h"
+#include "version.h"
+
+/* server */
+#include "srv_main.h"
+
+#include "srv_replay.h"
+
+/* One record of the packet trace */
+struct replay_record {
+  enum packet_type type;
+  int len;
+  int conn_id;
+  int direction;
+  uint64_t timestamp;
+  unsigned char *data;
+  int data_size;
+};
+
+/* Local connection replaying one connection of the trace */
+struct replay_conn {
+  int trace_id;                 /* Connection id in the trace */
+  int conn_id;                  /* Id of the replaying connection */
+  struct connection *pconn;
+  int peer;                     /* Our end of the socket pair */
+  fc_thread drain;
+  bool draining;
+  long bytes_received;          /* Written by the drain thread only */
+};
+
+/* Handling times of one packet type */
+struct replay_type_stats {
+  int count;
+  long bytes;
+  double total;
+  double max;
+};
+
+static struct {
+  bool active;
+  char *trace;
+  float speed;
+  char *output;
+
+  FILE *fp;
+  struct replay_record record;
+
+  struct replay_conn **conns;
+  int num_conns;
+
+  /* Turn ends seen in the trace */
+  bool last_end_turn;
+  int end_turn;
+
+  bool started;
+  uint64_t first_timestamp;
+  struct timer *clock;
+  struct timer *packet_timer;
+
+  int packets;
+  long bytes;
+  int dropped;
+  double busy;
+  int recorded_sent_packets;
+  long recorded_sent_bytes;
+  double elapsed;
+
+  struct replay_type_stats types[PACKET_LAST];
+} replay = { .active = FALSE };
+
+/**********************************************************************//**
+  Read a little-endian unsigned integer of 'size' bytes from the trace.
+**************************************************************************/
+static bool replay_read_uint(FILE *fp, int size, uint64_t *value)
+{
+  unsigned char buf[8];
+  int i;
+
+  fc_assert_ret_val((size_t) size <= sizeof(buf), FALSE);
+
+  if (fread(buf, 1, size, fp) != (size_t) size) {
+    return FALSE;
+  }
+
+  *value = 0;
+  for (i = size - 1; i >= 0; i--) {
+    *value = (*value << 8) | buf[i];
+  }
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Read the next record of the trace. Returns FALSE at the end of the
+  trace.
+**************************************************************************/
+static bool replay_read_record(void)
+{
+  struct replay_record *record = &replay.record;
+  uint64_t type, len, conn_id, direction, timestamp;
+
+  if (!replay_read_uint(replay.fp, 2, &type)) {
+    return FALSE;
+  }
+  if (!replay_read_uint(replay.fp, 4, &len)
+      || !replay_read_uint(replay.fp, 4, &conn_id)
+      || !replay_read_uint(replay.fp, 1, &direction)
+      || !replay_read_uint(replay.fp, 8, &timestamp)
+      || type >= PACKET_LAST || len > MAX_LEN_BUFFER) {
+    log_error(_("Packet trace \"%s\" is corrupt."), replay.trace);
+    return FALSE;
+  }
+
+  if (len > record->data_size) {
+    record->data_size = len;
+    record->data = fc_realloc(record->data, record->data_size);
+  }
+  if (fread(record->data, 1, len, replay.fp) != len) {
+    log_error(_("Packet trace \"%s\" is truncated."), replay.trace);
+    return FALSE;
+  }
+
+  record->type = type;
+  record->len = len;
+  record->conn_id = conn_id;
+  record->direction = direction;
+  record->timestamp = timestamp;
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Drain thread. Throws away what the server sends to the connection, so
+  that the server never finds it lagging.
+**************************************************************************/
+static void replay_drain(void *arg)
+{
+  struct replay_conn *rconn = arg;
+  char buf[4096];
+  int nb;
+
+  while ((nb = fc_readsocket(rconn->peer, buf, sizeof(buf))) > 0) {
+    rconn->bytes_received += nb;
+  }
+}
+
+/**********************************************************************//**
+  Stop the drain thread of the connection, whether the server has closed
+  the connection or not.
+**************************************************************************/
+static void replay_conn_stop(struct replay_conn *rconn)
+{
+#ifdef HAVE_SOCKETPAIR
+  if (rconn->draining) {
+    shutdown(rconn->peer, SHUT_RDWR);
+    fc_thread_wait(&rconn->drain);
+    rconn->draining = FALSE;
+  }
+#endif /* HAVE_SOCKETPAIR */
+}
+
+/**********************************************************************//**
+  Returns the local connection replaying the trace connection, making
+  a new one the first time the trace connection is seen.
+**************************************************************************/
+static struct replay_conn *replay_conn_get(int trace_id)
+{
+  struct replay_conn *rconn;
+  int i;
+
+  for (i = 0; i < replay.num_conns; i++) {
+    if (replay.conns[i]->trace_id == trace_id) {
+      return replay.conns[i];
+    }
+  }
+
+#ifdef HAVE_SOCKETPAIR
+  {
+    int socks[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, socks) != 0) {
+      log_error(_("Cannot create a connection to replay: %s"),
+                fc_strerror(fc_get_errno()));
+      return nullptr;
+    }
+
+    if (server_make_connection(socks[0], "replay", "127.0.0.1") != 0) {
+      fc_closesocket(socks[1]);
+      return nullptr;
+    }
+
+    rconn = fc_calloc(1, sizeof(*rconn));
+    rconn->trace_id = trace_id;
+    rconn->pconn = conn_list_back(game.all_connections);
+    rconn->conn_id = rconn->pconn->id;
+    rconn->peer = socks[1];
+    rconn->draining
+      = (fc_thread_start(&rconn->drain, replay_drain, rconn) == 0);
+  }
+#else  /* HAVE_SOCKETPAIR */
+  log_error(_("Replaying connections is not supported on this platform."));
+  return nullptr;
+#endif /* HAVE_SOCKETPAIR */
+
+  replay.conns = fc_realloc(replay.conns,
+                            (replay.num_conns + 1) * sizeof(*replay.conns));
+  replay.conns[replay.num_conns++] = rconn;
+
+  log_verbose("Replaying trace connection %d as %s.",
+              trace_id, conn_description(rconn->pconn));
+
+  return rconn;
+}
+
+/**********************************************************************//**
+  Is the replaying connection still open?
+**************************************************************************/
+static bool replay_conn_alive(const struct replay_conn *rconn)
+{
+  return (rconn->pconn->used && rconn->pconn->id == rconn->conn_id
+          && !rconn->pconn->server.is_closing);
+}
+
+/**********************************************************************//**
+  Disconnect from the server, as the client did at the end of the trace,
+  and wait until the server has closed the connection.
+**************************************************************************/
+static void replay_conn_close(struct replay_conn *rconn)
+{
+#ifdef HAVE_SOCKETPAIR
+  if (replay_conn_alive(rconn)) {
+    shutdown(rconn->peer, SHUT_WR);
+    server_connection_input(rconn->pconn);
+  }
+  if (rconn->draining) {
+    fc_thread_wait(&rconn->drain);
+    rconn->draining = FALSE;
+  }
+#endif /* HAVE_SOCKETPAIR */
+}
+
+/**********************************************************************//**
+  Write the packet of the record to its connection, and let the server
+  handle it.
+**************************************************************************/
+static void replay_packet(const struct replay_record *record)
+{
+  struct replay_conn *rconn = replay_conn_get(record->conn_id);
+  struct replay_type_stats *stats = &replay.types[record->type];
+  double seconds;
+  int written = 0;
+
+  if (rconn == nullptr || !replay_conn_alive(rconn)) {
+    replay.dropped++;
+    return;
+  }
+
+  if (!replay.started) {
+    replay.started = TRUE;
+    replay.first_timestamp = record->timestamp;
+    timer_start(replay.clock);
+  } else if (replay.speed > 0.0) {
+    double due = (record->timestamp - replay.first_timestamp)
+                 / 1000000.0 / replay.speed;
+    double now = timer_read_seconds(replay.clock);
+
+    if (due > now) {
+      fc_usleep((due - now) * 1000000.0);
+    }
+  }
+
+  timer_clear(replay.packet_timer);
+  timer_start(replay.packet_timer);
+
+  while (written < record->len) {
+    int nb = fc_writesocket(rconn->peer, record->data + written,
+                            record->len - written);
+
+    if (nb <= 0) {
+      timer_stop(replay.packet_timer);
+      replay.dropped++;
+      return;
+    }
+    written += nb;
+  }
+  server_connection_input(rconn->pconn);
+
+  timer_stop(replay.packet_timer);
+  seconds = timer_read_seconds(replay.packet_timer);
+
+  stats->count++;
+  stats->bytes += record->len;
+  stats->total += seconds;
+  stats->max = MAX(stats->max, seconds);
+
+  replay.packets++;
+  replay.bytes += record->len;
+  replay.busy += seconds;
+}
+
+/**********************************************************************//**
+  Activate the replay of the packet trace. 'speed' is the multiple of
+  the recorded pace to replay at, or 0 to replay as fast as possible.
+  If 'output_filename' is nullptr, the report goes to stdout.
+**************************************************************************/
+bool replay_init(const char *trace_filename, float speed,
+                 const char *output_filename)
+{
+  uint64_t magic, version;
+
+  fc_assert_ret_val(speed >= 0.0, FALSE);
+
+  replay.fp = fc_fopen(trace_filename, "rb");
+  if (replay.fp == nullptr) {
+    log_error(_("Could not open packet trace \"%s\"."), trace_filename);
+    return FALSE;
+  }
+  if (!replay_read_uint(replay.fp, 4, &magic)
+      || !replay_read_uint(replay.fp, 4, &version)
+      || magic != PACKET_TRACE_MAGIC || version != PACKET_TRACE_VERSION) {
+    log_error(_("\"%s\" is not a packet trace of a supported version."),
+              trace_filename);
+    fclose(replay.fp);
+    replay.fp = nullptr;
+    return FALSE;
+  }
+
+  replay.active = TRUE;
+  replay.trace = fc_strdup(trace_filename);
+  replay.speed = speed;
+  replay.output = output_filename != nullptr
+    ? fc_strdup(output_filename) : nullptr;
+  replay.end_turn = -1;
+
+  replay.clock = timer_new(TIMER_USER, TIMER_ACTIVE, "replay");
+  replay.packet_timer = timer_new(TIMER_USER, TIMER_ACTIVE,
+                                  "replay packet");
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Free replay data.
+**************************************************************************/
+void replay_free(void)
+{
+  int i;
+
+  if (!replay.active) {
+    return;
+  }
+
+  for (i = 0; i < replay.num_conns; i++) {
+    replay_conn_stop(replay.conns[i]);
+    fc_closesocket(replay.conns[i]->peer);
+    free(replay.conns[i]);
+  }
+  FC_FREE(replay.conns);
+  replay.num_conns = 0;
+
+  if (replay.fp != nullptr) {
+    fclose(replay.fp);
+    replay.fp = nullptr;
+  }
+  FC_FREE(replay.record.data);
+  timer_destroy(replay.clock);
+  timer_destroy(replay.packet_timer);
+  FC_FREE(replay.trace);
+  FC_FREE(replay.output);
+
+  replay.active = FALSE;
+}
+
+/**********************************************************************//**
+  Is the server replaying a packet trace?
+**************************************************************************/
+bool replay_is_active(void)
+{
+  return replay.active;
+}
+
+/**********************************************************************//**
+  Replay the network input up to the next packet of the trace.
+
+  A turn ends where it ended in the trace, i.e., where the server sent
+  the first of the end turn packets to the connections. Even when the
+  replayed packets make the server want to end the turn earlier, the
+  packets that the recording server handled before ending the turn are
+  replayed first. Phases before the last one of the turn end when the
+  server ends them.
+
+  Once the whole trace has been replayed, disconnects, writes the report
+  and quits.
+**************************************************************************/
+enum server_events replay_sniff(void)
+{
+  int i;
+
+  if (force_end_of_sniff
+      && (S_S_RUNNING != server_state()
+          || game.info.phase < game.server.num_phases - 1)) {
+    force_end_of_sniff = FALSE;
+    return S_E_FORCE_END_OF_SNIFF;
+  }
+  if (S_S_RUNNING == server_state() && replay.end_turn == game.info.turn) {
+    /* Also the remaining phases of the turn end. */
+    return S_E_END_OF_TURN_TIMEOUT;
+  }
+
+  while (replay_read_record()) {
+    const struct replay_record *record = &replay.record;
+
+    if (PACKET_TRACE_DIR_SEND == record->direction) {
+      bool turn_ends = (PACKET_END_TURN == record->type
+                        && !replay.last_end_turn);
+
+      replay.last_end_turn = (PACKET_END_TURN == record->type);
+      replay.recorded_sent_packets++;
+      replay.recorded_sent_bytes += record->len;
+
+      if (turn_ends && S_S_RUNNING == server_state()) {
+        replay.end_turn = game.info.turn;
+        if (force_end_of_sniff) {
+          force_end_of_sniff = FALSE;
+          return S_E_FORCE_END_OF_SNIFF;
+        }
+        return S_E_END_OF_TURN_TIMEOUT;
+      }
+      continue;
+    }
+
+    replay.last_end_turn = FALSE;
+    replay_packet(record);
+
+    return S_E_OTHERWISE;
+  }
+
+  for (i = 0; i < replay.num_conns; i++) {
+    replay_conn_close(replay.conns[i]);
+  }
+  log_normal(_("Replayed %d packets of \"%s\"."),
+             replay.packets, replay.trace);
+  replay_report();
+  server_quit();
+}
+
+/**********************************************************************//**
+  Write the replay report as JSON.
+**************************************************************************/
+void replay_report(void)
+{
+  long sent_bytes = 0;
+  bool first = TRUE;
+  FILE *fp;
+  int i;
+
+  if (!replay.active) {
+    return;
+  }
+
+  replay.elapsed = replay.started ? timer_read_seconds(replay.clock) : 0.0;
+  for (i = 0; i < replay.num_conns; i++) {
+    replay_conn_stop(replay.conns[i]);
+    sent_bytes += replay.conns[i]->bytes_received;
+  }
+
+  if (replay.output != nullptr) {
+    fp = fc_fopen(replay.output, "w");
+    if (fp == nullptr) {
+      log_error(_("Could not open replay report file \"%s\"."),
+                replay.output);
+      return;
+    }
+  } else {
+    fp = stdout;
+  }
+
+  fprintf(fp, "{\n  \"version\": ");
+  fc_fputs_json_string(fp, freeciv_name_version());
+  fprintf(fp, ",\n  \"trace\": ");
+  fc_fputs_json_string(fp, replay.trace);
+  fprintf(fp, ",\n  \"speed\": %g,\n", replay.speed);
+  fprintf(fp, "  \"connections\": %d,\n", replay.num_conns);
+  fprintf(fp, "  \"packets\": %d,\n", replay.packets);
+  fprintf(fp, "  \"bytes\": %ld,\n", replay.bytes);
+  fprintf(fp, "  \"dropped\": %d,\n", replay.dropped);
+  fprintf(fp, "  \"elapsed\": %.6f,\n", replay.elapsed);
+  fprintf(fp, "  \"busy\": %.6f,\n", replay.busy);
+  fprintf(fp, "  \"packets_per_second\": %.1f,\n",
+          replay.busy > 0.0 ? replay.packets / replay.busy : 0.0);
+  fprintf(fp, "  \"sent_wire_bytes\": %ld,\n", sent_bytes);
+  fprintf(fp, "  \"recorded_sent_packets\": %d,\n",
+          replay.recorded_sent_packets);
+  fprintf(fp, "  \"recorded_sent_bytes\": %ld,\n",
+          replay.recorded_sent_bytes);
+
+  fprintf(fp, "  \"per_type\": [");
+  for (i = 0; i < PACKET_LAST; i++) {
+    const struct replay_type_stats *stats = &replay.types[i];
+
+    if (stats->count == 0) {
+      continue;
+    }
+    fprintf(fp, "%s\n    { \"type\": ", first ? "" : ",");
+    fc_fputs_json_string(fp, packet_name(i));
+    fprintf(fp, ", \"count\": %d, \"bytes\": %ld, \"total\": %.6f, "
+            "\"mean\": %.9f, \"max\": %.6f }",
+            stats->count, stats->bytes, stats->total,
+            stats->total / stats->count, stats->max);
+    first = FALSE;
+  }
+  fprintf(fp, "\n  ]\n}\n");
+
+  if (fp != stdout) {
+    fclose(fp);
+  } else {
+    fflush(fp);
+  }
+}
@@ -0,0 +1,40 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__SRV_REPLAY_H
+#define FC__SRV_REPLAY_H
+
+/* utility */
+#include "support.h"            /* bool type */
+
+/* server */
+#include "sernet.h"
+
+/* Packet trace replay.
+ *
+ * When active (freeciv-replay), the server takes its network input from
+ * a packet trace recorded by an earlier server (see packet_trace.h)
+ * instead of from the sockets. Every connection of the trace gets a
+ * local connection of its own, and the packets the clients sent are
+ * written to it at the recorded pace, or faster. The time spent
+ * handling each packet is reported as JSON by replay_report(). */
+
+bool replay_init(const char *trace_filename, float speed,
+                 const char *output_filename);
+void replay_free(void);
+bool replay_is_active(void);
+
+enum server_events replay_sniff(void);
+
+void replay_report(void);
+
+#endif /* FC__SRV_REPLAY_H */
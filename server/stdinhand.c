@@ -3810,7 +3810,8 @@ bool load_command(struct connection *caller, const char *filename, bool check,
       get_save_dirs(), get_scenario_dirs(), nullptr
     };
     const char *exts[] = {
-      "sav", "gz", "bz2", "xz", "sav.gz", "sav.bz2", "sav.xz", "sav.zst", nullptr
+      "sav", "gz", "bz2", "xz", "sav.gz", "sav.bz2", "sav.xz", "sav.zst",
+      "sav.bin", nullptr
     };
     const char **ext, *found = nullptr;
     const struct strvec **path;
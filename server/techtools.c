@@ -420,6 +420,7 @@ void found_new_tech(struct research *presearch, Tech_type_id tech_found,
    * global_advances array. */
   if (is_future_tech(tech_found)) {
     presearch->future_tech++;
+    game.effects_epoch++;
   } else {
     research_invention_set(presearch, tech_found, TECH_KNOWN);
     research_update(presearch);
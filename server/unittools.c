@@ -1764,6 +1764,8 @@ bool place_unit(struct unit *punit, struct player *pplayer,
   city_map_update_tile_now(ptile);
   sync_cities();
 
+  adv_pf_maps_invalidate();
+
   CALL_FUNC_EACH_AI(unit_created, punit);
   CALL_PLR_AI_FUNC(unit_got, pplayer, punit);
 
@@ -1809,6 +1811,8 @@ static void server_remove_unit_full(struct unit *punit, bool transported,
   /* The unit is doomed. */
   punit->server.dying = TRUE;
 
+  adv_pf_maps_invalidate();
+
 #if defined(FREECIV_DEBUG) && !defined(FREECIV_NDEBUG)
   unit_list_iterate(ptile->units, pcargo) {
     fc_assert(unit_transport_get(pcargo) != punit);
@@ -3156,12 +3160,8 @@ bool do_paradrop(struct unit *punit, struct tile *ptile,
     const struct player_tile *plrtile = map_get_player_tile(ptile, pplayer);
 
     if (plrtile->site == nullptr) {
-      bv_extras fbv;
-
-      dbv_to_bv(fbv.vec, &(plrtile->extras));
-
       if (!is_native_to_class(unit_class_get(punit), plrtile->terrain,
-                              &fbv)) {
+                              &(plrtile->extras))) {
         notify_player(pplayer, ptile, E_BAD_COMMAND, ftc_server,
                       _("This unit cannot paradrop into %s."),
                       terrain_name_translation(plrtile->terrain));
@@ -3406,6 +3406,7 @@ void unit_transport_load_send(struct unit *punit, struct unit *ptrans)
   } players_iterate_end;
 
   unit_transport_load(punit, ptrans, FALSE);
+  adv_pf_maps_invalidate();
 
   players_iterate(pplayer) {
     if (BV_ISSET(can_see_unit, player_index(pplayer))
@@ -3433,6 +3434,7 @@ static void unit_transport_load_tp_status(struct unit *punit,
   had_cargo = get_transporter_occupancy(ptrans) > 0;
 
   unit_transport_load(punit, ptrans, force);
+  adv_pf_maps_invalidate();
 
   if (!had_cargo) {
     /* Transport's loaded status changed */
@@ -3454,6 +3456,7 @@ void unit_transport_unload_send(struct unit *punit)
   fc_assert_ret(ptrans);
 
   unit_transport_unload(punit);
+  adv_pf_maps_invalidate();
 
   send_unit_info(nullptr, punit);
   send_unit_info(nullptr, ptrans);
@@ -3973,7 +3976,7 @@ static void unit_move_by_data(struct unit_move_data *pdata,
   /* Enhance vision if unit steps into a fortress */
   new_vision = vision_new(pdata->powner, pdesttile);
   punit->server.vision = new_vision;
-  vision_change_sight(new_vision, radius_sq);
+  vision_take_over_sight(new_vision, radius_sq, pdata->old_vision);
   ASSERT_VISION(new_vision);
 }
 
@@ -4109,6 +4112,8 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
   psrctile = unit_tile(punit);
   adj = base_get_direction_for_step(&(wld.map), psrctile, pdesttile, &facing);
 
+  adv_pf_maps_invalidate();
+
   conn_list_do_buffer(game.est_connections);
 
   /* Unload the unit if on a transport. */
@@ -4444,6 +4449,8 @@ bool unit_move(struct unit *punit, struct tile *pdesttile, int move_cost,
 
   conn_list_do_unbuffer(game.est_connections);
 
+  adv_pf_maps_invalidate();
+
   if (unit_lives) {
     CALL_FUNC_EACH_AI(unit_move_seen, punit);
   }
@@ -0,0 +1,179 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+/* Checks that get_packet_from_connection_raw() accepts a compressed
+ * chunk that inflates to exactly the space it first reserves for the
+ * output (8 times the compressed size plus 1024 bytes). Such a chunk
+ * used to make the connection close with a decoding error. */
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+/* utility */
+#include "log.h"
+#include "mem.h"
+
+/* common */
+#include "connection.h"
+#include "packets.h"
+
+/* Must match COMPRESSION_BORDER in packets.c */
+#define TEST_COMPRESSION_BORDER (16 * 1024 + 1)
+
+/* Length the inflated data claims for its first packet. It is more than
+ * the data holds, so the packet is left waiting for more data, and
+ * nothing but the decompression is exercised. */
+#define TEST_PACKET_LEN 16000
+
+static bool closed = FALSE;
+
+/************************************************************************//**
+  Connection close callback.
+****************************************************************************/
+static void test_close_callback(struct connection *pconn)
+{
+  fprintf(stderr, "Connection closed: %s\n",
+          pconn->closing_reason != nullptr ? pconn->closing_reason : "-");
+  closed = TRUE;
+  connection_common_close(pconn);
+}
+
+/************************************************************************//**
+  Fills data with len bytes: the length field of a packet, seed bytes
+  that do not compress well, and zeros.
+****************************************************************************/
+static void test_fill(unsigned char *data, int len, int seed)
+{
+  unsigned int state = 12345;
+  int i;
+
+  memset(data, 0, len);
+  data[0] = TEST_PACKET_LEN >> 8;
+  data[1] = TEST_PACKET_LEN & 0xff;
+  for (i = 2; i < 2 + seed && i < len; i++) {
+    state = state * 1103515245 + 12345;
+    data[i] = state >> 16;
+  }
+}
+
+/************************************************************************//**
+  Compresses len bytes of data the way the sender does, as one sync
+  flushed chunk of a new stream. Returns the compressed size.
+****************************************************************************/
+static uLong test_compress(const unsigned char *data, int len,
+                           unsigned char *out, uLong out_space)
+{
+  z_stream stream;
+  uLong size;
+
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+    return 0;
+  }
+  stream.next_in = (Bytef *) data;
+  stream.avail_in = len;
+  stream.next_out = out;
+  stream.avail_out = out_space;
+  if (deflate(&stream, Z_SYNC_FLUSH) != Z_OK || stream.avail_in > 0) {
+    deflateEnd(&stream);
+    return 0;
+  }
+  size = out_space - stream.avail_out;
+  deflateEnd(&stream);
+
+  return size;
+}
+
+/************************************************************************//**
+  Entry point of the test.
+****************************************************************************/
+int main(int argc, char *argv[])
+{
+  unsigned char *data = nullptr;
+  unsigned char compressed[4096];
+  uLong compressed_size = 0;
+  int len = 0;
+  int seed, i;
+  struct connection conn;
+  enum packet_type type;
+  bool found = FALSE;
+  bool ok;
+
+  log_init(nullptr, LOG_NORMAL, nullptr, nullptr, -1);
+
+  /* Look for data whose size is exactly the first output space for its
+   * compressed size. */
+  for (seed = 100; seed < 400 && !found; seed++) {
+    len = 1024;
+    for (i = 0; i < 10; i++) {
+      data = fc_realloc(data, len);
+      test_fill(data, len, seed);
+      compressed_size = test_compress(data, len, compressed,
+                                      sizeof(compressed));
+      if (compressed_size == 0) {
+        break;
+      }
+      if (8 * compressed_size + 1024 == (uLong) len) {
+        found = TRUE;
+        break;
+      }
+      len = 8 * compressed_size + 1024;
+    }
+  }
+
+  if (!found) {
+    fprintf(stderr, "Found no test data of the right size\n");
+    free(data);
+    log_close();
+
+    return EXIT_FAILURE;
+  }
+
+  memset(&conn, 0, sizeof(conn));
+  connection_common_init(&conn);
+  conn.sock = -1;
+  connections_set_close_callback(test_close_callback);
+
+  /* A normal (not jumbo) compressed packet. */
+  conn.buffer->data[0] = (2 + compressed_size + TEST_COMPRESSION_BORDER) >> 8;
+  conn.buffer->data[1] = (2 + compressed_size + TEST_COMPRESSION_BORDER)
+                         & 0xff;
+  memcpy(conn.buffer->data + 2, compressed, compressed_size);
+  conn.buffer->ndata = 2 + compressed_size;
+
+  (void) get_packet_from_connection_raw(&conn, &type);
+
+  ok = !closed && conn.used
+       && conn.buffer->ndata == len
+       && memcmp(conn.buffer->data, data, len) == 0;
+
+  if (!ok) {
+    fprintf(stderr, "Inflating %lu bytes to %d bytes failed\n",
+            compressed_size, len);
+  }
+
+  if (conn.used) {
+    connection_common_close(&conn);
+  }
+  free(data);
+  log_close();
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
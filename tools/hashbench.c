@@ -0,0 +1,284 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+/* Microbenchmark comparing the genhash storage backends.
+ *
+ * Usage: freeciv-hashbench [ENTRIES [ROUNDS]]
+ *
+ * For each key set, ENTRIES keys are inserted, looked up (hits and
+ * misses), iterated over and removed again, ROUNDS times, with both
+ * backends. Lookups and removals visit the keys in a different order
+ * than they were inserted in. Throughput is printed in millions of
+ * operations per second. */
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* utility */
+#include "fcintl.h"
+#include "genhash.h"
+#include "log.h"
+#include "mem.h"
+#include "support.h"
+#include "timing.h"
+
+#define HASHBENCH_DEFAULT_ENTRIES 10000
+#define HASHBENCH_DEFAULT_ROUNDS 100
+
+enum hashbench_op {
+  HB_INSERT,
+  HB_LOOKUP,
+  HB_MISS,
+  HB_ITERATE,
+  HB_REMOVE,
+  HB_OP_COUNT
+};
+
+static const char *hashbench_op_names[HB_OP_COUNT] = {
+  "insert", "lookup", "miss", "iterate", "remove"
+};
+
+/* Keys of one workload */
+struct hashbench_keys {
+  const char *name;
+  genhash_val_fn_t val_func;
+  genhash_comp_fn_t comp_func;
+  const void **present;
+  const void **shuffled;        /* 'present' in another order */
+  const void **absent;
+  char *strings;
+};
+
+static volatile size_t hashbench_sink;
+
+/************************************************************************//**
+  Shuffle the keys with a fixed seed, so that runs are comparable.
+****************************************************************************/
+static void hashbench_shuffle(const void **keys, int entries)
+{
+  unsigned int state = 12345;
+  int i, j;
+
+  for (i = entries - 1; i > 0; i--) {
+    const void *swap;
+
+    state = state * 1103515245u + 12345u;
+    j = (state >> 8) % (i + 1);
+    swap = keys[i];
+    keys[i] = keys[j];
+    keys[j] = swap;
+  }
+}
+
+/************************************************************************//**
+  Fill the key sets. Integer keys are stored in the pointers themselves,
+  like the city and unit index does. String keys use the supplied string
+  functions.
+****************************************************************************/
+static void hashbench_keys_init(struct hashbench_keys *keys, int kind,
+                                int entries)
+{
+  int i;
+
+  keys->present = fc_malloc(entries * sizeof(*keys->present));
+  keys->shuffled = fc_malloc(entries * sizeof(*keys->shuffled));
+  keys->absent = fc_malloc(entries * sizeof(*keys->absent));
+  keys->strings = nullptr;
+
+  switch (kind) {
+  case 0:
+    /* Consecutive ids. */
+    keys->name = "int-consecutive";
+    keys->val_func = nullptr;
+    keys->comp_func = nullptr;
+    for (i = 0; i < entries; i++) {
+      keys->present[i] = FC_INT_TO_PTR(i + 1);
+      keys->absent[i] = FC_INT_TO_PTR(entries + i + 1);
+    }
+    break;
+  case 1:
+    /* Scattered values. */
+    keys->name = "int-scattered";
+    keys->val_func = nullptr;
+    keys->comp_func = nullptr;
+    for (i = 0; i < entries; i++) {
+      keys->present[i]
+        = FC_INT_TO_PTR(((2u * i + 1) * 40503u) & 0x7FFFFFFF);
+      keys->absent[i]
+        = FC_INT_TO_PTR(((2u * i + 2) * 40503u) & 0x7FFFFFFF);
+    }
+    break;
+  default:
+    /* Strings. */
+    keys->name = "string";
+    keys->val_func = (genhash_val_fn_t) genhash_str_val_func;
+    keys->comp_func = (genhash_comp_fn_t) genhash_str_comp_func;
+    keys->strings = fc_malloc(2 * entries * 16);
+    for (i = 0; i < entries; i++) {
+      char *present = keys->strings + 2 * i * 16;
+      char *absent = present + 16;
+
+      fc_snprintf(present, 16, "key-%d", i);
+      fc_snprintf(absent, 16, "none-%d", i);
+      keys->present[i] = present;
+      keys->absent[i] = absent;
+    }
+    break;
+  }
+
+  memcpy(keys->shuffled, keys->present, entries * sizeof(*keys->shuffled));
+  hashbench_shuffle(keys->shuffled, entries);
+  hashbench_shuffle(keys->absent, entries);
+}
+
+/************************************************************************//**
+  Free the key sets.
+****************************************************************************/
+static void hashbench_keys_free(struct hashbench_keys *keys)
+{
+  free(keys->present);
+  free(keys->shuffled);
+  free(keys->absent);
+  free(keys->strings);
+}
+
+/************************************************************************//**
+  Run the workload with the backend and accumulate seconds per operation.
+****************************************************************************/
+static void hashbench_run(const struct hashbench_keys *keys,
+                          enum genhash_backend backend,
+                          int entries, int rounds,
+                          double seconds[HB_OP_COUNT])
+{
+  struct timer *op_timer = timer_new(TIMER_USER, TIMER_ACTIVE, "hashbench");
+  struct genhash *hash;
+  void *data;
+  int r, i;
+
+  for (i = 0; i < HB_OP_COUNT; i++) {
+    seconds[i] = 0.0;
+  }
+
+  for (r = 0; r < rounds; r++) {
+    size_t found = 0;
+
+    hash = genhash_new(keys->val_func, keys->comp_func);
+    genhash_set_backend(hash, backend);
+
+    timer_clear(op_timer);
+    timer_start(op_timer);
+    for (i = 0; i < entries; i++) {
+      genhash_insert(hash, keys->present[i], keys->present[i]);
+    }
+    timer_stop(op_timer);
+    seconds[HB_INSERT] += timer_read_seconds(op_timer);
+
+    timer_clear(op_timer);
+    timer_start(op_timer);
+    for (i = 0; i < entries; i++) {
+      found += genhash_lookup(hash, keys->shuffled[i], &data);
+    }
+    timer_stop(op_timer);
+    seconds[HB_LOOKUP] += timer_read_seconds(op_timer);
+
+    timer_clear(op_timer);
+    timer_start(op_timer);
+    for (i = 0; i < entries; i++) {
+      found += genhash_lookup(hash, keys->absent[i], &data);
+    }
+    timer_stop(op_timer);
+    seconds[HB_MISS] += timer_read_seconds(op_timer);
+
+    timer_clear(op_timer);
+    timer_start(op_timer);
+    genhash_values_iterate(hash, value) {
+      found += (value != nullptr);
+    } genhash_values_iterate_end;
+    timer_stop(op_timer);
+    seconds[HB_ITERATE] += timer_read_seconds(op_timer);
+
+    timer_clear(op_timer);
+    timer_start(op_timer);
+    for (i = 0; i < entries; i++) {
+      found += genhash_remove(hash, keys->shuffled[i]);
+    }
+    timer_stop(op_timer);
+    seconds[HB_REMOVE] += timer_read_seconds(op_timer);
+
+    fc_assert(found == 3 * (size_t) entries);
+    fc_assert(genhash_size(hash) == 0);
+    hashbench_sink += found;
+
+    genhash_destroy(hash);
+  }
+
+  timer_destroy(op_timer);
+}
+
+/************************************************************************//**
+  Entry point of the genhash microbenchmark.
+****************************************************************************/
+int main(int argc, char *argv[])
+{
+  int entries = HASHBENCH_DEFAULT_ENTRIES;
+  int rounds = HASHBENCH_DEFAULT_ROUNDS;
+  int kind, i;
+
+  if ((argc > 1 && (!str_to_int(argv[1], &entries) || entries <= 0))
+      || (argc > 2 && (!str_to_int(argv[2], &rounds) || rounds <= 0))
+      || argc > 3) {
+    fprintf(stderr, _("Usage: %s [ENTRIES [ROUNDS]]\n"), argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  log_init(nullptr, LOG_NORMAL, nullptr, nullptr, -1);
+
+  printf("%d entries, %d rounds, Mops/s\n", entries, rounds);
+  printf("%-16s %-8s", "keys", "backend");
+  for (i = 0; i < HB_OP_COUNT; i++) {
+    printf(" %9s", hashbench_op_names[i]);
+  }
+  printf("\n");
+
+  for (kind = 0; kind < 3; kind++) {
+    struct hashbench_keys keys;
+    enum genhash_backend backend;
+
+    hashbench_keys_init(&keys, kind, entries);
+
+    for (backend = GENHASH_CHAINED; backend <= GENHASH_OPEN; backend++) {
+      double seconds[HB_OP_COUNT];
+
+      hashbench_run(&keys, backend, entries, rounds, seconds);
+
+      printf("%-16s %-8s", keys.name,
+             backend == GENHASH_OPEN ? "open" : "chained");
+      for (i = 0; i < HB_OP_COUNT; i++) {
+        printf(" %9.2f", seconds[i] > 0.0
+               ? (double) entries * rounds / seconds[i] / 1e6 : 0.0);
+      }
+      printf("\n");
+    }
+
+    hashbench_keys_free(&keys);
+  }
+
+  log_close();
+
+  return EXIT_SUCCESS;
+}
@@ -44,6 +44,7 @@ static char *rs_selected = NULL;
 static char *od_selected = NULL;
 static int fatal_assertions = -1;
 static bool dirty = TRUE;
+static bool images = FALSE;
 
 /**********************************************************************//**
   Parse freeciv-ruleup commandline parameters.
@@ -76,6 +77,10 @@ static void rup_parse_cmdline(int argc, char *argv[])
 		  _("Create directory DIRECTORY for output"));
       cmdhelp_add(help, "c", "clean",
                   _("Clean up the ruleset before saving it."));
+      cmdhelp_add(help, "i", "images",
+                  _("Write precompiled images of the ruleset files, "
+                    "for the server to load faster, instead of "
+                    "updating the ruleset."));
 
       /* The function below prints a header and footer for the options.
        * Furthermore, the options are sorted. */
@@ -114,6 +119,8 @@ static void rup_parse_cmdline(int argc, char *argv[])
 #endif /* FREECIV_NDEBUG */
     } else if (is_option("--clean", argv[i])) {
       dirty = FALSE;
+    } else if (is_option("--images", argv[i])) {
+      images = TRUE;
     } else {
       fc_fprintf(stderr, _("Unrecognized option: \"%s\"\n"), argv[i]);
       cmdline_option_values_free();
@@ -183,37 +190,47 @@ int main(int argc, char **argv)
       fc_snprintf(tgt_dir, sizeof(tgt_dir), "%s.ruleup", rs_selected);
     }
 
-    if (!comments_load()) {
-      /* TRANS: 'Failed to load comments-x.y.txt' where x.y is
-       * freeciv version */
-      log_error(R__("Failed to load %s."), COMMENTS_FILE_NAME);
-
-      /* Reuse fatal_assertions for failed comment loading. */
-      if (0 <= fatal_assertions) {
-        /* Emit a signal. */
-        raise(fatal_assertions);
+    if (images) {
+      /* The ruleset has been loaded above, so the files are known
+       * to be good. */
+      if (save_ruleset_images(rs_selected, tgt_dir)) {
+        log_normal("Saved the images of %s to %s", rs_selected, tgt_dir);
+      } else {
+        exit_status = EXIT_FAILURE;
+      }
+    } else {
+      if (!comments_load()) {
+        /* TRANS: 'Failed to load comments-x.y.txt' where x.y is
+         * freeciv version */
+        log_error(R__("Failed to load %s."), COMMENTS_FILE_NAME);
+
+        /* Reuse fatal_assertions for failed comment loading. */
+        if (0 <= fatal_assertions) {
+          /* Emit a signal. */
+          raise(fatal_assertions);
+        }
       }
-    }
 
-    /* Clean up unused entities added during the ruleset upgrade. */
-    if (!dirty) {
-      int purged = ruleset_purge_unused_entities();
+      /* Clean up unused entities added during the ruleset upgrade. */
+      if (!dirty) {
+        int purged = ruleset_purge_unused_entities();
 
-      if (purged > 0) {
-        log_normal("Purged %d unused entities after the ruleset upgrade",
-                   purged);
-      }
+        if (purged > 0) {
+          log_normal("Purged %d unused entities after the ruleset upgrade",
+                     purged);
+        }
 
-      purged = ruleset_purge_redundant_reqs();
-      if (purged > 0) {
-        log_normal("Purged %d redundant requirements after the ruleset"
-                   " upgrade", purged);
+        purged = ruleset_purge_redundant_reqs();
+        if (purged > 0) {
+          log_normal("Purged %d redundant requirements after the ruleset"
+                     " upgrade", purged);
+        }
       }
-    }
 
-    save_ruleset(tgt_dir, game.control.name, &data);
-    log_normal("Saved %s", tgt_dir);
-    comments_free();
+      save_ruleset(tgt_dir, game.control.name, &data);
+      log_normal("Saved %s", tgt_dir);
+      comments_free();
+    }
   } else {
     log_error(_("Can't load ruleset %s"), rs_selected);
 
@@ -0,0 +1,113 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+/* Converts section files, like savegames, between the text and the
+ * binary formats.
+ *
+ * Usage: freeciv-savconv INPUT OUTPUT
+ *
+ * A binary INPUT is written as text, compressed according to the suffix
+ * of OUTPUT. A text INPUT, compressed or not, is written as binary. */
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* utility */
+#include "fcintl.h"
+#include "ioz.h"
+#include "log.h"
+#include "registry.h"
+#include "registry_bin.h"
+#include "support.h"
+
+#define SAVCONV_COMPRESS_LEVEL 6
+
+/************************************************************************//**
+  Returns the compression method matching the suffix of the file name.
+****************************************************************************/
+static enum fz_method savconv_method(const char *filename)
+{
+  const char *suffix = strrchr(filename, '.');
+
+  if (suffix == nullptr) {
+    return FZ_PLAIN;
+  }
+#ifdef FREECIV_HAVE_LIBZ
+  if (!strcmp(suffix, ".gz")) {
+    return FZ_ZLIB;
+  }
+#endif
+#ifdef FREECIV_HAVE_LIBLZMA
+  if (!strcmp(suffix, ".xz")) {
+    return FZ_XZ;
+  }
+#endif
+#ifdef FREECIV_HAVE_LIBZSTD
+  if (!strcmp(suffix, ".zst")) {
+    return FZ_ZSTD;
+  }
+#endif
+
+  return FZ_PLAIN;
+}
+
+/************************************************************************//**
+  Entry point of the section file converter.
+****************************************************************************/
+int main(int argc, char *argv[])
+{
+  struct section_file *secfile;
+  bool to_binary, saved;
+
+  if (argc != 3) {
+    fprintf(stderr, _("Usage: %s INPUT OUTPUT\n"), argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  log_init(nullptr, LOG_NORMAL, nullptr, nullptr, -1);
+  registry_module_init();
+
+  to_binary = !binfile_is_binary(argv[1]);
+  secfile = secfile_load(argv[1], TRUE);
+  if (secfile == nullptr) {
+    fprintf(stderr, _("Could not load %s: %s\n"), argv[1], secfile_error());
+    registry_module_close();
+    log_close();
+    return EXIT_FAILURE;
+  }
+
+  if (to_binary) {
+    saved = binfile_save(secfile, argv[2]);
+  } else {
+    enum fz_method method = savconv_method(argv[2]);
+
+    saved = secfile_save(secfile, argv[2],
+                         method == FZ_PLAIN ? 0 : SAVCONV_COMPRESS_LEVEL,
+                         method);
+  }
+
+  if (!saved) {
+    fprintf(stderr, _("Could not save %s: %s\n"), argv[2], secfile_error());
+  }
+
+  secfile_destroy(secfile);
+  registry_module_close();
+  log_close();
+
+  return saved ? EXIT_SUCCESS : EXIT_FAILURE;
+}
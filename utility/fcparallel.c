@@ -0,0 +1,117 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+/* utility */
+#include "fcthread.h"
+#include "log.h"
+#include "mem.h"
+#include "shared.h"
+
+#include "fcparallel.h"
+
+/* How many chunks each worker gets on average. More chunks balance
+ * uneven per-index costs better, fewer ones mean less locking. */
+#define CHUNKS_PER_WORKER 4
+
+struct parallel_job {
+  fc_mutex mutex;
+  int next;
+  int count;
+  int chunk;
+  fc_parallel_cb *cb;
+  void *data;
+};
+
+/**********************************************************************//**
+  Worker thread main loop. Keeps taking chunks of indices until there
+  are none left.
+**************************************************************************/
+static void parallel_worker(void *arg)
+{
+  struct parallel_job *job = (struct parallel_job *) arg;
+
+  while (TRUE) {
+    int first, last, i;
+
+    fc_mutex_allocate(&job->mutex);
+    first = job->next;
+    last = MIN(first + job->chunk, job->count);
+    job->next = last;
+    fc_mutex_release(&job->mutex);
+
+    if (first >= last) {
+      break;
+    }
+
+    for (i = first; i < last; i++) {
+      job->cb(i, job->data);
+    }
+  }
+}
+
+/**********************************************************************//**
+  Call cb(idx, data) for every idx in [0, count) using up to 'workers'
+  threads. With less than two workers, or nothing to share, this is
+  a plain loop in the calling thread. If some threads cannot be started,
+  the remaining ones handle all the work.
+**************************************************************************/
+void fc_parallel_for(int count, int workers, fc_parallel_cb *cb,
+                     void *data)
+{
+  struct parallel_job job;
+  fc_thread *threads;
+  int started = 0;
+  int i;
+
+  fc_assert_ret(cb != nullptr);
+
+  workers = MIN(workers, count);
+
+  if (workers <= 1) {
+    for (i = 0; i < count; i++) {
+      cb(i, data);
+    }
+
+    return;
+  }
+
+  fc_mutex_init(&job.mutex);
+  job.next = 0;
+  job.count = count;
+  job.chunk = MAX(count / (workers * CHUNKS_PER_WORKER), 1);
+  job.cb = cb;
+  job.data = data;
+
+  threads = fc_malloc((workers - 1) * sizeof(*threads));
+  for (i = 0; i < workers - 1; i++) {
+    if (fc_thread_start(&threads[started], parallel_worker, &job) == 0) {
+      started++;
+    } else {
+      log_verbose("Could not start parallel worker thread.");
+    }
+  }
+
+  /* Calling thread does its share */
+  parallel_worker(&job);
+
+  for (i = 0; i < started; i++) {
+    fc_thread_wait(&threads[i]);
+  }
+
+  free(threads);
+  fc_mutex_destroy(&job.mutex);
+}
@@ -0,0 +1,43 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+#ifndef FC__FCPARALLEL_H
+#define FC__FCPARALLEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* utility */
+#include "support.h"
+
+/* Data parallel loops on top of fcthread.
+ *
+ * fc_parallel_for() calls the callback once for every index, spreading
+ * the indices over up to 'workers' threads (the calling thread being one
+ * of them), and returns only after all of them have been handled.
+ * Indices are handed out in no particular order, so callbacks must only
+ * read shared state and write to per-index results. Callers that need
+ * deterministic behavior apply those results in their own fixed order
+ * afterwards. Caches that are not safe to update from several threads
+ * have to stay out of the way of all but one thread. */
+
+typedef void (fc_parallel_cb)(int idx, void *data);
+
+void fc_parallel_for(int count, int workers, fc_parallel_cb *cb,
+                     void *data);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* FC__FCPARALLEL_H */
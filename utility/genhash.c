@@ -50,9 +50,20 @@
    data_copy_func: same as 'key_copy_func', but for data.
    data_free_func: same as 'key_free_func', but for data.
 
-   Implementation uses open hashing. Collision resolution is done by
-   separate chaining with linked lists. Resize hash table when deemed
-   necessary by making and populating a new table.
+   Two storage backends are available, selectable per table with
+   genhash_set_backend():
+
+   GENHASH_CHAINED (default): open hashing. Collision resolution is done
+   by separate chaining with linked lists, one allocation per entry.
+
+   GENHASH_OPEN: closed hashing (open addressing) with linear probing and
+   Robin Hood insertion. Entries live directly in a power of two sized
+   array, so inserting does not allocate and lookups touch few cache
+   lines. Deletion shifts the following entries backwards, there are no
+   tombstones. Best suited to hot tables with small keys.
+
+   With both backends, resize hash table when deemed necessary by making
+   and populating a new table.
 ****************************************************************************/
 
 #ifdef HAVE_CONFIG_H
@@ -79,16 +90,27 @@ struct genhash_entry {
   struct genhash_entry *next;
 };
 
+/* Entry of the GENHASH_OPEN backend. */
+struct genhash_cell {
+  void *key;
+  void *data;
+  genhash_val_t hash_val;
+  unsigned int dist;            /* Probe sequence length + 1, 0 if empty. */
+};
+
 /* Contents of the opaque type: */
 struct genhash {
-  struct genhash_entry **buckets;
+  enum genhash_backend backend;
+  struct genhash_entry **buckets;       /* GENHASH_CHAINED */
+  struct genhash_cell *cells;           /* GENHASH_OPEN */
+  unsigned int cell_shift;              /* GENHASH_OPEN */
   genhash_val_fn_t key_val_func;
   genhash_comp_fn_t key_comp_func;
   genhash_copy_fn_t key_copy_func;
   genhash_free_fn_t key_free_func;
   genhash_copy_fn_t data_copy_func;
   genhash_free_fn_t data_free_func;
-  size_t num_buckets;
+  size_t num_buckets;           /* Number of cells for GENHASH_OPEN. */
   size_t num_entries;
   bool no_shrink;               /* Do not auto-shrink when set. */
 };
@@ -97,6 +119,7 @@ struct genhash_iter {
   struct iterator vtable;
   struct genhash_entry *const *bucket, *const *end;
   const struct genhash_entry *iterator;
+  const struct genhash_cell *cell, *cell_end;   /* GENHASH_OPEN */
 };
 
 #define GENHASH_ITER(p) ((struct genhash_iter *) (p))
@@ -186,6 +209,51 @@ static size_t genhash_calc_num_buckets(size_t num_entries)
   return *pframe;
 }
 
+/************************************************************************//**
+  Calculate the number of cells of a GENHASH_OPEN table for a given number
+  of entries. Same restrictions as genhash_calc_num_buckets(), but the
+  result is a power of two.
+****************************************************************************/
+#define MIN_CELLS 32
+static size_t genhash_calc_num_cells(size_t num_entries)
+{
+  size_t num_cells = MIN_CELLS;
+
+  num_entries <<= 1; /* breathing room */
+
+  while (num_cells < num_entries) {
+    num_cells <<= 1;
+  }
+  return num_cells;
+}
+
+/************************************************************************//**
+  Returns the shift used to map hash values to cells in a GENHASH_OPEN
+  table of 'num_cells' cells.
+****************************************************************************/
+static unsigned int genhash_calc_cell_shift(size_t num_cells)
+{
+  unsigned int shift = sizeof(genhash_val_t) * 8;
+
+  fc_assert(num_cells < ((size_t) 1 << shift));
+
+  for (; num_cells > 1; num_cells >>= 1) {
+    shift--;
+  }
+  return shift;
+}
+
+/************************************************************************//**
+  Returns the home cell of the hash value. The hash value is scrambled
+  with Fibonacci hashing first, so that poor hash functions (like the
+  identity of integer keys) do not cluster in a power of two table.
+****************************************************************************/
+static inline size_t genhash_cell_home(genhash_val_t hash_val,
+                                       unsigned int cell_shift)
+{
+  return (genhash_val_t) (hash_val * 0x9E3779B9u) >> cell_shift;
+}
+
 /************************************************************************//**
   Internal constructor, specifying exact number of buckets.
   Allows to specify functions to free the memory allocated for the key and
@@ -209,7 +277,10 @@ genhash_new_nbuckets(genhash_val_fn_t key_val_func,
   log_debug("New genhash table with %lu buckets",
             (long unsigned) num_buckets);
 
+  pgenhash->backend = GENHASH_CHAINED;
   pgenhash->buckets = fc_calloc(num_buckets, sizeof(*pgenhash->buckets));
+  pgenhash->cells = nullptr;
+  pgenhash->cell_shift = 0;
   pgenhash->key_val_func = key_val_func;
   pgenhash->key_comp_func = key_comp_func;
   pgenhash->key_copy_func = key_copy_func;
@@ -292,6 +363,7 @@ void genhash_destroy(struct genhash *pgenhash)
   pgenhash->no_shrink = TRUE;
   genhash_clear(pgenhash);
   free(pgenhash->buckets);
+  free(pgenhash->cells);
   free(pgenhash);
 }
 
@@ -324,6 +396,57 @@ static void genhash_resize_table(struct genhash *pgenhash,
   pgenhash->num_buckets = new_nbuckets;
 }
 
+/************************************************************************//**
+  Put the cell into the first suitable place of the cell array, starting
+  from the home cell 'idx'. Richer entries (closer to their home cell) are
+  displaced in favour of poorer ones.
+****************************************************************************/
+static inline void genhash_cells_place(struct genhash_cell *cells,
+                                       size_t mask, size_t idx,
+                                       struct genhash_cell cell)
+{
+  struct genhash_cell swap;
+
+  for (cell.dist = 1; cells[idx].dist != 0; cell.dist++) {
+    if (cells[idx].dist < cell.dist) {
+      swap = cells[idx];
+      cells[idx] = cell;
+      cell = swap;
+    }
+    idx = (idx + 1) & mask;
+  }
+  cells[idx] = cell;
+}
+
+/************************************************************************//**
+  Resize the GENHASH_OPEN table: re-place all the cells.
+****************************************************************************/
+static void genhash_resize_cells(struct genhash *pgenhash,
+                                 size_t new_ncells)
+{
+  struct genhash_cell *new_cells, *cell, *end;
+  unsigned int new_shift = genhash_calc_cell_shift(new_ncells);
+
+  fc_assert(new_ncells > pgenhash->num_entries);
+
+  new_cells = fc_calloc(new_ncells, sizeof(*new_cells));
+
+  cell = pgenhash->cells;
+  end = cell + pgenhash->num_buckets;
+  for (; cell < end; cell++) {
+    if (cell->dist != 0) {
+      genhash_cells_place(new_cells, new_ncells - 1,
+                          genhash_cell_home(cell->hash_val, new_shift),
+                          *cell);
+    }
+  }
+
+  free(pgenhash->cells);
+  pgenhash->cells = new_cells;
+  pgenhash->cell_shift = new_shift;
+  pgenhash->num_buckets = new_ncells;
+}
+
 /************************************************************************//**
   Call this when an entry might be added or deleted: resizes the genhash
   table if seems like a good idea.  Count deleted entries in check
@@ -346,7 +469,8 @@ static bool genhash_maybe_resize(struct genhash *pgenhash, bool expandingp)
       return FALSE;
     }
   } else {
-    if (pgenhash->num_buckets <= MIN_BUCKETS) {
+    if (pgenhash->num_buckets <= (pgenhash->backend == GENHASH_OPEN
+                                  ? MIN_CELLS : MIN_BUCKETS)) {
       return FALSE;
     }
     limit = MIN_RATIO * pgenhash->num_buckets;
@@ -355,7 +479,9 @@ static bool genhash_maybe_resize(struct genhash *pgenhash, bool expandingp)
     }
   }
 
-  new_nbuckets = genhash_calc_num_buckets(pgenhash->num_entries);
+  new_nbuckets = (pgenhash->backend == GENHASH_OPEN
+                  ? genhash_calc_num_cells(pgenhash->num_entries)
+                  : genhash_calc_num_buckets(pgenhash->num_entries));
 
   log_debug("%s genhash (entries = %lu, buckets =  %lu, new = %lu, "
             "%s limit = %lu)",
@@ -366,7 +492,11 @@ static bool genhash_maybe_resize(struct genhash *pgenhash, bool expandingp)
             (long unsigned) pgenhash->num_buckets,
             (long unsigned) new_nbuckets,
             expandingp ? "up": "down", (long unsigned) limit);
-  genhash_resize_table(pgenhash, new_nbuckets);
+  if (pgenhash->backend == GENHASH_OPEN) {
+    genhash_resize_cells(pgenhash, new_nbuckets);
+  } else {
+    genhash_resize_table(pgenhash, new_nbuckets);
+  }
   return TRUE;
 }
 
@@ -414,6 +544,62 @@ genhash_slot_lookup(const struct genhash *pgenhash,
   return slot;
 }
 
+/************************************************************************//**
+  Return the GENHASH_OPEN cell where key resides, or nullptr if it is not
+  in the table.
+****************************************************************************/
+static inline struct genhash_cell *
+genhash_cell_lookup(const struct genhash *pgenhash,
+                    const void *key,
+                    genhash_val_t hash_val)
+{
+  struct genhash_cell *cell;
+  genhash_comp_fn_t key_comp_func = pgenhash->key_comp_func;
+  size_t mask = pgenhash->num_buckets - 1;
+  size_t idx = genhash_cell_home(hash_val, pgenhash->cell_shift);
+  unsigned int dist;
+
+  /* An entry further than its own home cell would be, cannot be ours. */
+  for (dist = 1; pgenhash->cells[idx].dist >= dist; dist++) {
+    cell = pgenhash->cells + idx;
+    if (key_comp_func != nullptr
+        ? (hash_val == cell->hash_val && key_comp_func(cell->key, key))
+        : key == cell->key) {
+      return cell;
+    }
+    idx = (idx + 1) & mask;
+  }
+  return nullptr;
+}
+
+/************************************************************************//**
+  Store the key and the data to 'pkey' and 'pdata', calling the copy
+  callbacks.
+****************************************************************************/
+static inline void genhash_pair_assign(const struct genhash *pgenhash,
+                                       void **pkey, void **pdata,
+                                       const void *key, const void *data)
+{
+  *pkey = (pgenhash->key_copy_func != nullptr
+           ? pgenhash->key_copy_func(key) : (void *) key);
+  *pdata = (pgenhash->data_copy_func != nullptr
+            ? pgenhash->data_copy_func(data) : (void *) data);
+}
+
+/************************************************************************//**
+  Call the free callbacks for the key and the data.
+****************************************************************************/
+static inline void genhash_pair_release(const struct genhash *pgenhash,
+                                        void *key, void *data)
+{
+  if (pgenhash->key_free_func != nullptr) {
+    pgenhash->key_free_func(key);
+  }
+  if (pgenhash->data_free_func != nullptr) {
+    pgenhash->data_free_func(data);
+  }
+}
+
 /************************************************************************//**
   Function to store from invalid data.
 ****************************************************************************/
@@ -453,10 +639,7 @@ static inline void genhash_slot_create(struct genhash *pgenhash,
 {
   struct genhash_entry *entry = fc_malloc(sizeof(*entry));
 
-  entry->key = (pgenhash->key_copy_func != nullptr
-                ? pgenhash->key_copy_func(key) : (void *) key);
-  entry->data = (pgenhash->data_copy_func != nullptr
-                 ? pgenhash->data_copy_func(data) : (void *) data);
+  genhash_pair_assign(pgenhash, &entry->key, &entry->data, key, data);
   entry->hash_val = hash_val;
   entry->next = *slot;
   *slot = entry;
@@ -470,12 +653,7 @@ static inline void genhash_slot_free(struct genhash *pgenhash,
 {
   struct genhash_entry *entry = *slot;
 
-  if (pgenhash->key_free_func != nullptr) {
-    pgenhash->key_free_func(entry->key);
-  }
-  if (pgenhash->data_free_func != nullptr) {
-    pgenhash->data_free_func(entry->data);
-  }
+  genhash_pair_release(pgenhash, entry->key, entry->data);
 
   *slot = entry->next;
   free(entry);
@@ -490,17 +668,59 @@ static inline void genhash_slot_set(struct genhash *pgenhash,
 {
   struct genhash_entry *entry = *slot;
 
-  if (pgenhash->key_free_func != nullptr) {
-    pgenhash->key_free_func(entry->key);
-  }
-  if (pgenhash->data_free_func != nullptr) {
-    pgenhash->data_free_func(entry->data);
+  genhash_pair_release(pgenhash, entry->key, entry->data);
+  genhash_pair_assign(pgenhash, &entry->key, &entry->data, key, data);
+}
+
+/************************************************************************//**
+  Create a GENHASH_OPEN cell and call the copy callbacks. The key must not
+  be in the table yet.
+****************************************************************************/
+static inline void genhash_cell_create(struct genhash *pgenhash,
+                                       const void *key, const void *data,
+                                       genhash_val_t hash_val)
+{
+  struct genhash_cell cell;
+
+  genhash_pair_assign(pgenhash, &cell.key, &cell.data, key, data);
+  cell.hash_val = hash_val;
+  genhash_cells_place(pgenhash->cells, pgenhash->num_buckets - 1,
+                      genhash_cell_home(hash_val, pgenhash->cell_shift),
+                      cell);
+}
+
+/************************************************************************//**
+  Free the GENHASH_OPEN cell and call the free callbacks. The following
+  entries of the probe sequence are shifted back in place.
+****************************************************************************/
+static inline void genhash_cell_free(struct genhash *pgenhash,
+                                     struct genhash_cell *cell)
+{
+  struct genhash_cell *cells = pgenhash->cells;
+  size_t mask = pgenhash->num_buckets - 1;
+  size_t idx = cell - cells, next = (idx + 1) & mask;
+
+  genhash_pair_release(pgenhash, cell->key, cell->data);
+
+  while (cells[next].dist > 1) {
+    cells[idx] = cells[next];
+    cells[idx].dist--;
+    idx = next;
+    next = (next + 1) & mask;
   }
+  cells[idx].dist = 0;
+}
 
-  entry->key = (pgenhash->key_copy_func != nullptr
-                ? pgenhash->key_copy_func(key) : (void *) key);
-  entry->data = (pgenhash->data_copy_func != nullptr
-                 ? pgenhash->data_copy_func(data) : (void *) data);
+/************************************************************************//**
+  Clear previous values of the cell (with free callback) and call the copy
+  callbacks.
+****************************************************************************/
+static inline void genhash_cell_set(struct genhash *pgenhash,
+                                    struct genhash_cell *cell,
+                                    const void *key, const void *data)
+{
+  genhash_pair_release(pgenhash, cell->key, cell->data);
+  genhash_pair_assign(pgenhash, &cell->key, &cell->data, key, data);
 }
 
 /************************************************************************//**
@@ -517,6 +737,70 @@ bool genhash_set_no_shrink(struct genhash *pgenhash, bool no_shrink)
   return old;
 }
 
+/************************************************************************//**
+  Change the storage backend of the genhash table, moving the existing
+  entries over. Returns the old backend.
+****************************************************************************/
+enum genhash_backend genhash_set_backend(struct genhash *pgenhash,
+                                         enum genhash_backend backend)
+{
+  enum genhash_backend old = pgenhash->backend;
+  struct genhash_entry **bucket, **end, *iter, *next;
+  struct genhash_cell *cell, *cell_end, moved;
+
+  if (backend == old) {
+    return old;
+  }
+
+  if (backend == GENHASH_OPEN) {
+    size_t num_cells = genhash_calc_num_cells(pgenhash->num_entries);
+
+    pgenhash->cells = fc_calloc(num_cells, sizeof(*pgenhash->cells));
+    pgenhash->cell_shift = genhash_calc_cell_shift(num_cells);
+
+    bucket = pgenhash->buckets;
+    end = bucket + pgenhash->num_buckets;
+    for (; bucket < end; bucket++) {
+      for (iter = *bucket; iter != nullptr; iter = next) {
+        next = iter->next;
+        moved.key = iter->key;
+        moved.data = iter->data;
+        moved.hash_val = iter->hash_val;
+        genhash_cells_place(pgenhash->cells, num_cells - 1,
+                            genhash_cell_home(iter->hash_val,
+                                              pgenhash->cell_shift),
+                            moved);
+        free(iter);
+      }
+    }
+    FC_FREE(pgenhash->buckets);
+    pgenhash->num_buckets = num_cells;
+  } else {
+    size_t num_buckets = genhash_calc_num_buckets(pgenhash->num_entries);
+
+    pgenhash->buckets = fc_calloc(num_buckets, sizeof(*pgenhash->buckets));
+
+    cell = pgenhash->cells;
+    cell_end = cell + pgenhash->num_buckets;
+    for (; cell < cell_end; cell++) {
+      if (cell->dist != 0) {
+        bucket = pgenhash->buckets + (cell->hash_val % num_buckets);
+        iter = fc_malloc(sizeof(*iter));
+        iter->key = cell->key;
+        iter->data = cell->data;
+        iter->hash_val = cell->hash_val;
+        iter->next = *bucket;
+        *bucket = iter;
+      }
+    }
+    FC_FREE(pgenhash->cells);
+    pgenhash->num_buckets = num_buckets;
+  }
+  pgenhash->backend = backend;
+
+  return old;
+}
+
 /************************************************************************//**
   Returns the number of entries in the genhash table.
 ****************************************************************************/
@@ -526,7 +810,7 @@ size_t genhash_size(const struct genhash *pgenhash)
 }
 
 /************************************************************************//**
-  Returns the number of buckets in the genhash table.
+  Returns the number of buckets (or cells) in the genhash table.
 ****************************************************************************/
 size_t genhash_capacity(const struct genhash *pgenhash)
 {
@@ -548,6 +832,27 @@ struct genhash *genhash_copy(const struct genhash *pgenhash)
   /* Copy fields. */
   *new_genhash = *pgenhash;
 
+  if (pgenhash->backend == GENHASH_OPEN) {
+    struct genhash_cell *cell, *cell_end;
+
+    /* Same layout, so the cells keep their places. */
+    new_genhash->cells = fc_malloc(pgenhash->num_buckets
+                                   * sizeof(*new_genhash->cells));
+    memcpy(new_genhash->cells, pgenhash->cells,
+           pgenhash->num_buckets * sizeof(*new_genhash->cells));
+
+    cell = new_genhash->cells;
+    cell_end = cell + new_genhash->num_buckets;
+    for (; cell < cell_end; cell++) {
+      if (cell->dist != 0) {
+        genhash_pair_assign(new_genhash, &cell->key, &cell->data,
+                            cell->key, cell->data);
+      }
+    }
+
+    return new_genhash;
+  }
+
   /* But make fresh buckets. */
   new_genhash->buckets = fc_calloc(new_genhash->num_buckets,
                                    sizeof(*new_genhash->buckets));
@@ -575,13 +880,26 @@ struct genhash *genhash_copy(const struct genhash *pgenhash)
 ****************************************************************************/
 void genhash_clear(struct genhash *pgenhash)
 {
-  struct genhash_entry **bucket, **end;
+  if (pgenhash->backend == GENHASH_OPEN) {
+    struct genhash_cell *cell, *end;
+
+    cell = pgenhash->cells;
+    end = cell + pgenhash->num_buckets;
+    for (; cell < end; cell++) {
+      if (cell->dist != 0) {
+        genhash_pair_release(pgenhash, cell->key, cell->data);
+        cell->dist = 0;
+      }
+    }
+  } else {
+    struct genhash_entry **bucket, **end;
 
-  bucket = pgenhash->buckets;
-  end = bucket + pgenhash->num_buckets;
-  for (; bucket < end; bucket++) {
-    while (*bucket != nullptr) {
-      genhash_slot_free(pgenhash, bucket);
+    bucket = pgenhash->buckets;
+    end = bucket + pgenhash->num_buckets;
+    for (; bucket < end; bucket++) {
+      while (*bucket != nullptr) {
+        genhash_slot_free(pgenhash, bucket);
+      }
     }
   }
 
@@ -600,6 +918,17 @@ bool genhash_insert(struct genhash *pgenhash, const void *key,
   genhash_val_t hash_val;
 
   hash_val = genhash_val_calc(pgenhash, key);
+
+  if (pgenhash->backend == GENHASH_OPEN) {
+    if (genhash_cell_lookup(pgenhash, key, hash_val) != nullptr) {
+      return FALSE;
+    }
+    genhash_maybe_expand(pgenhash);
+    genhash_cell_create(pgenhash, key, data, hash_val);
+    pgenhash->num_entries++;
+    return TRUE;
+  }
+
   slot = genhash_slot_lookup(pgenhash, key, hash_val);
   if (*slot != nullptr) {
     return FALSE;
@@ -642,6 +971,30 @@ bool genhash_replace_full(struct genhash *pgenhash, const void *key,
   genhash_val_t hash_val;
 
   hash_val = genhash_val_calc(pgenhash, key);
+
+  if (pgenhash->backend == GENHASH_OPEN) {
+    struct genhash_cell *cell = genhash_cell_lookup(pgenhash, key, hash_val);
+
+    if (cell != nullptr) {
+      /* Replace. */
+      if (old_pkey != nullptr) {
+        *old_pkey = cell->key;
+      }
+      if (old_pdata != nullptr) {
+        *old_pdata = cell->data;
+      }
+      genhash_cell_set(pgenhash, cell, key, data);
+      return TRUE;
+    }
+
+    /* Insert. */
+    genhash_maybe_expand(pgenhash);
+    genhash_default_get(old_pkey, old_pdata);
+    genhash_cell_create(pgenhash, key, data, hash_val);
+    pgenhash->num_entries++;
+    return FALSE;
+  }
+
   slot = genhash_slot_lookup(pgenhash, key, hash_val);
   if (*slot != nullptr) {
     /* Replace. */
@@ -670,6 +1023,20 @@ bool genhash_lookup(const struct genhash *pgenhash, const void *key,
 {
   struct genhash_entry **slot;
 
+  if (pgenhash->backend == GENHASH_OPEN) {
+    const struct genhash_cell *cell
+      = genhash_cell_lookup(pgenhash, key, genhash_val_calc(pgenhash, key));
+
+    if (cell != nullptr) {
+      if (pdata != nullptr) {
+        *pdata = cell->data;
+      }
+      return TRUE;
+    }
+    genhash_default_get(nullptr, pdata);
+    return FALSE;
+  }
+
   slot = genhash_slot_lookup(pgenhash, key, genhash_val_calc(pgenhash, key));
   if (*slot != nullptr) {
     genhash_slot_get(slot, nullptr, pdata);
@@ -700,6 +1067,30 @@ bool genhash_remove_full(struct genhash *pgenhash, const void *key,
 {
   struct genhash_entry **slot;
 
+  if (pgenhash->backend == GENHASH_OPEN) {
+    struct genhash_cell *cell
+      = genhash_cell_lookup(pgenhash, key, genhash_val_calc(pgenhash, key));
+
+    if (cell == nullptr) {
+      genhash_default_get(deleted_pkey, deleted_pdata);
+      return FALSE;
+    }
+
+    if (deleted_pkey != nullptr) {
+      *deleted_pkey = cell->key;
+    }
+    if (deleted_pdata != nullptr) {
+      *deleted_pdata = cell->data;
+    }
+    genhash_cell_free(pgenhash, cell);
+
+    fc_assert(0 < pgenhash->num_entries);
+
+    pgenhash->num_entries--;
+    genhash_maybe_shrink(pgenhash);
+    return TRUE;
+  }
+
   slot = genhash_slot_lookup(pgenhash, key, genhash_val_calc(pgenhash, key));
   if (*slot != nullptr) {
     genhash_slot_get(slot, deleted_pkey, deleted_pdata);
@@ -735,6 +1126,7 @@ bool genhashes_are_equal_full(const struct genhash *pgenhash1,
 {
   struct genhash_entry *const *bucket1, *const *max1, *const *slot2;
   const struct genhash_entry *iter1;
+  void *data2;
 
   /* Check pointers. */
   if (pgenhash1 == pgenhash2) {
@@ -752,6 +1144,20 @@ bool genhashes_are_equal_full(const struct genhash *pgenhash1,
     return FALSE;
   }
 
+  if (pgenhash1->backend == GENHASH_OPEN
+      || pgenhash2->backend == GENHASH_OPEN) {
+    genhash_iterate(pgenhash1, iter) {
+      if (!genhash_lookup(pgenhash2, genhash_iter_key(iter), &data2)
+          || (genhash_iter_value(iter) != data2
+              && (data_comp_func == nullptr
+                  || !data_comp_func(genhash_iter_value(iter), data2)))) {
+        return FALSE;
+      }
+    } genhash_iterate_end;
+
+    return TRUE;
+  }
+
   /* Compare buckets. */
   bucket1 = pgenhash1->buckets;
   max1 = bucket1 + pgenhash1->num_buckets;
@@ -785,6 +1191,10 @@ size_t genhash_iter_sizeof(void)
 void *genhash_iter_key(const struct iterator *genhash_iter)
 {
   struct genhash_iter *iter = GENHASH_ITER(genhash_iter);
+
+  if (iter->cell != nullptr) {
+    return (void *) iter->cell->key;
+  }
   return (void *) iter->iterator->key;
 }
 
@@ -794,6 +1204,10 @@ void *genhash_iter_key(const struct iterator *genhash_iter)
 void *genhash_iter_value(const struct iterator *genhash_iter)
 {
   struct genhash_iter *iter = GENHASH_ITER(genhash_iter);
+
+  if (iter->cell != nullptr) {
+    return (void *) iter->cell->data;
+  }
   return (void *) iter->iterator->data;
 }
 
@@ -817,6 +1231,21 @@ static void genhash_iter_next(struct iterator *genhash_iter)
   }
 }
 
+/************************************************************************//**
+  Iterator interface 'next' function implementation for the GENHASH_OPEN
+  backend.
+****************************************************************************/
+static void genhash_cell_iter_next(struct iterator *genhash_iter)
+{
+  struct genhash_iter *iter = GENHASH_ITER(genhash_iter);
+
+  for (iter->cell++; iter->cell < iter->cell_end; iter->cell++) {
+    if (iter->cell->dist != 0) {
+      return;
+    }
+  }
+}
+
 /************************************************************************//**
   Iterator interface 'get' function implementation. This just returns the
   iterator itself, so you would need to use genhash_iter_get_key/value to
@@ -836,6 +1265,17 @@ static bool genhash_iter_valid(const struct iterator *genhash_iter)
   return iter->bucket < iter->end;
 }
 
+/************************************************************************//**
+  Iterator interface 'valid' function implementation for the GENHASH_OPEN
+  backend.
+****************************************************************************/
+static bool genhash_cell_iter_valid(const struct iterator *genhash_iter)
+{
+  struct genhash_iter *iter = GENHASH_ITER(genhash_iter);
+
+  return iter->cell < iter->cell_end;
+}
+
 /************************************************************************//**
   Common genhash iterator initializer.
 ****************************************************************************/
@@ -848,9 +1288,28 @@ genhash_iter_init_common(struct genhash_iter *iter,
     return invalid_iter_init(ITERATOR(iter));
   }
 
-  iter->vtable.next = genhash_iter_next;
   iter->vtable.get = get;
+
+  if (pgenhash->backend == GENHASH_OPEN) {
+    iter->vtable.next = genhash_cell_iter_next;
+    iter->vtable.valid = genhash_cell_iter_valid;
+    iter->cell = pgenhash->cells;
+    iter->cell_end = pgenhash->cells + pgenhash->num_buckets;
+
+    /* Seek to the first used cell. */
+    for (; iter->cell < iter->cell_end; iter->cell++) {
+      if (iter->cell->dist != 0) {
+        break;
+      }
+    }
+
+    return ITERATOR(iter);
+  }
+
+  iter->vtable.next = genhash_iter_next;
   iter->vtable.valid = genhash_iter_valid;
+  iter->cell = nullptr;
+  iter->cell_end = nullptr;
   iter->bucket = pgenhash->buckets;
   iter->end = pgenhash->buckets + pgenhash->num_buckets;
 
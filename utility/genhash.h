@@ -31,6 +31,12 @@ struct genhash;                 /* opaque */
 /* Hash value type. */
 typedef unsigned int genhash_val_t;
 
+/* Storage backends. */
+enum genhash_backend {
+  GENHASH_CHAINED,              /* Separate chaining (default). */
+  GENHASH_OPEN                  /* Open addressing, Robin Hood probing. */
+};
+
 /* Function typedefs: */
 typedef genhash_val_t (*genhash_val_fn_t) (const void *);
 typedef bool (*genhash_comp_fn_t) (const void *, const void *);
@@ -77,6 +83,9 @@ void genhash_destroy(struct genhash *pgenhash)
 
 bool genhash_set_no_shrink(struct genhash *pgenhash, bool no_shrink)
   fc__attribute((nonnull (1)));
+enum genhash_backend genhash_set_backend(struct genhash *pgenhash,
+                                         enum genhash_backend backend)
+  fc__attribute((nonnull (1)));
 size_t genhash_size(const struct genhash *pgenhash)
   fc__attribute((nonnull (1)));
 size_t genhash_capacity(const struct genhash *pgenhash)
@@ -78,6 +78,7 @@
 #include "log.h"
 #include "mem.h"
 #include "shared.h"             /* TRUE, FALSE */
+#include "string_vector.h"
 #include "support.h"
 
 #include "inputfile.h"
@@ -110,6 +111,8 @@ struct inputfile {
   struct inputfile *included_from; /* nullptr for toplevel file, otherwise
                                       points back to files which this one
                                       has been included from */
+  struct strvec *includes;      /* Names of the included files are
+                                   appended here, if not nullptr */
 };
 
 /* A function to get a specific token type: */
@@ -169,6 +172,7 @@ static void init_zeros(struct inputfile *inf)
   inf->fp = nullptr;
   inf->datafn = nullptr;
   inf->included_from = nullptr;
+  inf->includes = nullptr;
   inf->line_num = inf->cur_line_pos = 0;
   inf->at_eof = inf->in_string = FALSE;
   inf->string_start_line = 0;
@@ -226,7 +230,7 @@ struct inputfile *inf_from_file(const char *filename,
   fc_assert_ret_val(filename != nullptr, nullptr);
   fc_assert_ret_val(0 < strlen(filename), nullptr);
 
-  fp = fz_from_file(filename, "r", -1, 0);
+  fp = fz_from_file(filename, "r", -1, 0, 1);
   if (fp == nullptr) {
     return nullptr;
   }
@@ -355,6 +359,19 @@ bool inf_at_eof(struct inputfile *inf)
   return inf->at_eof;
 }
 
+/*******************************************************************//**
+  Make the inputfile append the names of the files it includes, as
+  given on the '*include' lines, to 'includes'.
+***********************************************************************/
+void inf_record_includes(struct inputfile *inf, struct strvec *includes)
+{
+  if (!inf_sanity_check(inf)) {
+    return;
+  }
+
+  inf->includes = includes;
+}
+
 /*******************************************************************//**
   Check for an include command, which is an isolated line with:
      *include "filename"
@@ -437,6 +454,9 @@ static bool check_include(struct inputfile *inf)
     free(bare_name);
     return FALSE;
   }
+  if (inf->includes != nullptr) {
+    strvec_append(inf->includes, bare_name);
+  }
   free(bare_name);
 
   /* Avoid recursion: (First filename may not have the same path,
@@ -462,6 +482,7 @@ static bool check_include(struct inputfile *inf)
   *new_inf = *inf;
   *inf = temp;
   inf->included_from = new_inf;
+  inf->includes = new_inf->includes;
 
   return TRUE;
 }
@@ -903,7 +924,7 @@ static const char *get_token_value(struct inputfile *inf)
       return nullptr;
     }
     *((char *) c) = trailing; /* Revert. */
-    fp = fz_from_file(rfname, "r", -1, 0);
+    fp = fz_from_file(rfname, "r", -1, 0, 1);
     if (!fp) {
       inf_log(inf, LOG_ERROR,
               _("Cannot open stringfile \"%s\"."), rfname);
@@ -29,6 +29,7 @@ extern "C" {
 #include "support.h"            /* bool type and fc__attribute */
 
 struct inputfile;		/* opaque */
+struct strvec;
 
 typedef const char *(*datafilename_fn_t)(const char *filename);
 
@@ -38,6 +39,7 @@ struct inputfile *inf_from_stream(fz_FILE * stream,
                                   datafilename_fn_t datafn);
 void inf_close(struct inputfile *inf);
 bool inf_at_eof(struct inputfile *inf);
+void inf_record_includes(struct inputfile *inf, struct strvec *includes);
 
 enum inf_token_type {
   INF_TOK_SECTION_NAME,
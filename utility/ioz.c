@@ -89,6 +89,11 @@ struct bzip2_struct {
 #define XZ_DECODER_MEMLIMIT_STEP (25*1024*1024)   /* Increase 25Mb at a time */
 #define XZ_DECODER_MEMLIMIT_FINAL (100*1024*1024) /* 100Mb */
 
+/* The multithreaded encoder compresses blocks of this size independently
+ * of each other. Its default would be three times the dictionary size,
+ * which is larger than most savegames. */
+#define XZ_ENCODER_MT_BLOCK_SIZE (1024*1024)      /* 1Mb */
+
 struct xz_struct {
   lzma_stream stream;
   int out_index;
@@ -220,15 +225,17 @@ fz_FILE *fz_from_memory(char *buffer, int size, bool control)
 
 /************************************************************************//**
   Open file for reading/writing, like fopen().
-  Parameters compress_method and compress_level only apply
+  Parameters compress_method, compress_level and workers only apply
   for writing: for reading try to use the most appropriate
-  available method.
+  available method. If workers is more than one, and the method
+  supports it, that many threads compress the file in parallel.
   Returns nullptr if there was a problem; check errno for details.
   (If errno is 0, and using FZ_ZLIB, probably had zlib error
   Z_MEM_ERROR. Wishlist: better interface for errors?)
 ****************************************************************************/
 fz_FILE *fz_from_file(const char *filename, const char *in_mode,
-                      enum fz_method method, int compress_level)
+                      enum fz_method method, int compress_level,
+                      int workers)
 {
   fz_FILE *fp;
   char mode[64];
@@ -434,7 +441,22 @@ fz_FILE *fz_from_file(const char *filename, const char *in_mode,
       /* xz files are binary files, so we should add "b" to mode! */
       sz_strlcat(mode, "b");
       memset(&fp->u.xz.stream, 0, sizeof(lzma_stream));
-      ret = lzma_easy_encoder(&fp->u.xz.stream, compress_level, LZMA_CHECK_CRC32);
+#if LZMA_VERSION >= 50020002
+      if (workers > 1) {
+        lzma_mt mt;
+
+        memset(&mt, 0, sizeof(mt));
+        mt.threads = workers;
+        mt.block_size = XZ_ENCODER_MT_BLOCK_SIZE;
+        mt.preset = compress_level;
+        mt.check = LZMA_CHECK_CRC32;
+        ret = lzma_stream_encoder_mt(&fp->u.xz.stream, &mt);
+      } else
+#endif /* LZMA_VERSION >= 50020002 */
+      {
+        ret = lzma_easy_encoder(&fp->u.xz.stream, compress_level,
+                                LZMA_CHECK_CRC32);
+      }
       fp->u.xz.error = ret;
       if (ret != LZMA_OK) {
         free(fp);
@@ -471,7 +493,14 @@ fz_FILE *fz_from_file(const char *filename, const char *in_mode,
 
       /* As compress_level parameter is in range 0 - 9, and zstd takes 0 - 22,
        * we scale it a bit */
-      ZSTD_initCStream(fp->u.zstd.cstream, compress_level * 2);
+      ZSTD_CCtx_setParameter(fp->u.zstd.cstream, ZSTD_c_compressionLevel,
+                             compress_level * 2);
+      if (workers > 1) {
+        /* Fails, leaving the compression in this thread, if libzstd
+         * was built without multithreading support. */
+        ZSTD_CCtx_setParameter(fp->u.zstd.cstream, ZSTD_c_nbWorkers,
+                               workers);
+      }
 
       fp->u.zstd.in_buf.size = PLAIN_FILE_BUF_SIZE_ZSTD;
       fp->u.zstd.nonconst_in = fc_malloc(fp->u.zstd.in_buf.size);
@@ -599,13 +628,15 @@ int fz_fclose(fz_FILE *fp)
 #ifdef FREECIV_HAVE_LIBZSTD
   case FZ_ZSTD:
     if (fp->mode == 'w') {
-      fp->u.zstd.error = ZSTD_endStream(fp->u.zstd.cstream, &fp->u.zstd.out_buf);
-      while (fp->u.zstd.out_buf.pos > 0) {
+      /* With worker threads, the end of the stream may take several
+       * calls to come out. */
+      do {
+        fp->u.zstd.error = ZSTD_endStream(fp->u.zstd.cstream,
+                                          &fp->u.zstd.out_buf);
         fwrite(fp->u.zstd.out_buf.dst, 1,
                fp->u.zstd.out_buf.pos, fp->u.zstd.plain);
         fp->u.zstd.out_buf.pos = 0;
-        fp->u.zstd.error = ZSTD_flushStream(fp->u.zstd.cstream, &fp->u.zstd.out_buf);
-      }
+      } while (fp->u.zstd.error > 0 && !ZSTD_isError(fp->u.zstd.error));
       ZSTD_freeCStream(fp->u.zstd.cstream);
     } else {
       ZSTD_freeDStream(fp->u.zstd.dstream);
@@ -53,7 +53,8 @@ enum fz_method {
 };
 
 fz_FILE *fz_from_file(const char *filename, const char *in_mode,
-                      enum fz_method method, int compress_level);
+                      enum fz_method method, int compress_level,
+                      int workers);
 fz_FILE *fz_from_stream(FILE *stream);
 fz_FILE *fz_from_memory(char *buffer, int size, bool control);
 int fz_fclose(fz_FILE *fp);
@@ -21,6 +21,7 @@
 #endif /* FREECIV_HAVE_XML_REGISTRY */
 
 /* utility */
+#include "registry_bin.h"
 #include "registry_xml.h"
 
 #include "registry.h"
@@ -51,6 +52,10 @@ void registry_module_close(void)
 struct section_file *secfile_load(const char *filename,
                                   bool allow_duplicates)
 {
+  if (binfile_is_binary(filename)) {
+    return binfile_load(filename, allow_duplicates);
+  }
+
 #ifdef FREECIV_HAVE_XML_REGISTRY
   struct stat buf;
 
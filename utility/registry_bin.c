@@ -0,0 +1,899 @@
+/***********************************************************************
+ Freeciv - Copyright (C) 1996 - A Kjeldberg, L Gregersen, P Unold
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+***********************************************************************/
+
+/* Binary section files.
+
+   The binary format stores the same section_file the text format does,
+   so that files can be converted between the two formats without any
+   loss. It is meant for the files the server writes and reads back
+   itself, like the autosaves: there is no parsing and no escaping, and
+   the file can be mapped to the memory as such.
+
+   All the numbers are 32 bit unsigned little endian integers, unless
+   told otherwise. The file consists of:
+
+   - The header: the magic "FCSECBIN", the format version, the number of
+     the sections, records, columns and strings, the offsets of their
+     tables and of the column blocks, and the size of the whole file.
+   - The section table: for each section its name, special type, first
+     record and number of records.
+   - The record table: for each entry its type (8 bit), string flags
+     (8 bit), 16 bits of padding, name, value and comment. The value is
+     the boolean or integer value itself, the bits of the float, or the
+     index of the string. Strings and comments refer to the string table.
+   - The column table. A column stores a run of string entries like
+     "t0000", "t0001"... that all have the same length, such as the rows
+     of one map layer, as one fixed width block of characters. For each
+     column the table holds the name prefix, the number of the first row,
+     the digits in the row numbers, the number of rows, the width of the
+     rows and the offset of the block.
+   - The string table: the offsets of the strings followed by the
+     strings themselves, each terminated by a NUL. Every distinct string
+     is stored only once.
+   - The column blocks. */
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+/* utility */
+#include "fcintl.h"
+#include "genhash.h"
+#include "log.h"
+#include "mem.h"
+#include "registry.h"
+#include "section_file.h"
+#include "shared.h"
+
+#include "registry_bin.h"
+
+#define BINFILE_MAGIC "FCSECBIN"
+#define BINFILE_MAGIC_LEN 8
+#define BINFILE_VERSION 1
+
+#define BINFILE_HEADER_SIZE 52
+#define BINFILE_SECTION_SIZE 16
+#define BINFILE_RECORD_SIZE 16
+#define BINFILE_COLUMN_SIZE 24
+
+/* No string. */
+#define BINFILE_NONE 0xFFFFFFFF
+
+/* Record type of a column, next to the values of enum entry_type. */
+#define BINFILE_COLUMN 0x80
+
+/* Longest entry name. */
+#define BINFILE_MAX_NAME 1024
+
+/* Shorter runs of strings are stored as normal records. */
+#define BINFILE_MIN_COLUMN_ROWS 2
+#define BINFILE_MAX_COLUMN_DIGITS 9
+
+/* Flags of string records and columns. */
+#define BINFILE_ESCAPED (1 << 0)
+#define BINFILE_GT_MARKING (1 << 1)
+
+/* Floats are stored as their bits. */
+FC_STATIC_ASSERT(sizeof(float) == sizeof(uint32_t), float_not_32_bits);
+
+/* A growing byte buffer. */
+struct binfile_buf {
+  unsigned char *data;
+  size_t size;
+  size_t alloc;
+};
+
+struct binfile_writer {
+  struct binfile_buf sections;
+  struct binfile_buf records;
+  struct binfile_buf columns;
+  struct binfile_buf string_index;
+  struct binfile_buf string_data;
+  struct binfile_buf column_data;
+  uint32_t num_records;
+  uint32_t num_columns;
+  uint32_t num_strings;
+  struct genhash *strings;      /* String -> index + 1 */
+};
+
+struct binfile_reader {
+  const unsigned char *data;
+  size_t size;
+  uint32_t num_strings;
+  const unsigned char *string_index;
+  const unsigned char *string_data;
+  size_t string_data_size;
+  const unsigned char *column_data;
+  size_t column_data_size;
+};
+
+/**********************************************************************//**
+  Append bytes to the buffer.
+**************************************************************************/
+static void binfile_put_bytes(struct binfile_buf *buf, const void *bytes,
+                              size_t len)
+{
+  if (buf->size + len > buf->alloc) {
+    buf->alloc = MAX(buf->size + len, 2 * buf->alloc + 256);
+    buf->data = fc_realloc(buf->data, buf->alloc);
+  }
+  memcpy(buf->data + buf->size, bytes, len);
+  buf->size += len;
+}
+
+/**********************************************************************//**
+  Append a little endian 32 bit number to the buffer.
+**************************************************************************/
+static void binfile_put_u32(struct binfile_buf *buf, uint32_t value)
+{
+  unsigned char bytes[4];
+
+  bytes[0] = value & 0xFF;
+  bytes[1] = (value >> 8) & 0xFF;
+  bytes[2] = (value >> 16) & 0xFF;
+  bytes[3] = (value >> 24) & 0xFF;
+  binfile_put_bytes(buf, bytes, sizeof(bytes));
+}
+
+/**********************************************************************//**
+  Read a little endian 32 bit number.
+**************************************************************************/
+static inline uint32_t binfile_get_u32(const unsigned char *bytes)
+{
+  return ((uint32_t) bytes[0]
+          | ((uint32_t) bytes[1] << 8)
+          | ((uint32_t) bytes[2] << 16)
+          | ((uint32_t) bytes[3] << 24));
+}
+
+/**********************************************************************//**
+  Returns the index of the string in the string table, adding it there
+  if it's not yet there.
+**************************************************************************/
+static uint32_t binfile_string(struct binfile_writer *writer,
+                               const char *str)
+{
+  void *idx;
+
+  if (str == nullptr) {
+    return BINFILE_NONE;
+  }
+
+  if (genhash_lookup(writer->strings, str, &idx)) {
+    return FC_PTR_TO_INT(idx) - 1;
+  }
+
+  binfile_put_u32(&writer->string_index, writer->string_data.size);
+  binfile_put_bytes(&writer->string_data, str, strlen(str) + 1);
+  genhash_insert(writer->strings, str,
+                 FC_INT_TO_PTR(writer->num_strings + 1));
+
+  return writer->num_strings++;
+}
+
+/**********************************************************************//**
+  Split the entry name to the prefix and the trailing number. Returns
+  FALSE if the name doesn't end in a number.
+**************************************************************************/
+static bool binfile_name_split(const char *name, size_t *prefix_len,
+                               uint32_t *number, int *digits)
+{
+  size_t len = strlen(name);
+  int i;
+
+  *digits = 0;
+  while ((size_t) *digits < len && fc_isdigit(name[len - *digits - 1])) {
+    (*digits)++;
+  }
+
+  if (*digits == 0 || *digits > BINFILE_MAX_COLUMN_DIGITS
+      || (size_t) *digits == len) {
+    return FALSE;
+  }
+
+  *prefix_len = len - *digits;
+  *number = 0;
+  for (i = 0; i < *digits; i++) {
+    *number = *number * 10 + (name[*prefix_len + i] - '0');
+  }
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Returns the string flags of the entry.
+**************************************************************************/
+static int binfile_str_flags(const struct entry *pentry)
+{
+  return ((entry_str_escaped(pentry) ? BINFILE_ESCAPED : 0)
+          | (entry_str_gt_marking(pentry) ? BINFILE_GT_MARKING : 0));
+}
+
+/**********************************************************************//**
+  Can the entry be the first row of a column?
+**************************************************************************/
+static bool binfile_column_head(const struct entry *pentry)
+{
+  size_t prefix_len;
+  uint32_t number;
+  int digits;
+
+  return (entry_type_get(pentry) == ENTRY_STR
+          && entry_comment(pentry) == nullptr
+          && binfile_name_split(entry_name(pentry), &prefix_len, &number,
+                                &digits));
+}
+
+/**********************************************************************//**
+  Is 'pentry' the row 'row' of the column starting with 'head'?
+**************************************************************************/
+static bool binfile_column_row(const struct entry *head,
+                               const struct entry *pentry, uint32_t row)
+{
+  const char *head_name = entry_name(head);
+  const char *name = entry_name(pentry);
+  const char *head_value, *value;
+  size_t head_prefix_len, prefix_len;
+  uint32_t head_number, number;
+  int head_digits, digits;
+
+  if (entry_type_get(pentry) != ENTRY_STR
+      || entry_comment(pentry) != nullptr
+      || binfile_str_flags(pentry) != binfile_str_flags(head)
+      || !binfile_name_split(name, &prefix_len, &number, &digits)) {
+    return FALSE;
+  }
+
+  binfile_name_split(head_name, &head_prefix_len, &head_number,
+                     &head_digits);
+  if (digits != head_digits || number != head_number + row
+      || prefix_len != head_prefix_len
+      || strncmp(name, head_name, prefix_len) != 0) {
+    return FALSE;
+  }
+
+  entry_str_get(head, &head_value);
+  entry_str_get(pentry, &value);
+
+  return strlen(value) == strlen(head_value);
+}
+
+/**********************************************************************//**
+  Add the 'rows' entries starting from 'ents' as a column.
+**************************************************************************/
+static void binfile_write_column(struct binfile_writer *writer,
+                                 const struct entry **ents, uint32_t rows)
+{
+  const char *name = entry_name(ents[0]);
+  char prefix[BINFILE_MAX_NAME];
+  size_t prefix_len;
+  uint32_t number, width, i;
+  int digits;
+  const char *value;
+
+  binfile_name_split(name, &prefix_len, &number, &digits);
+  fc_strlcpy(prefix, name, MIN(prefix_len + 1, sizeof(prefix)));
+  entry_str_get(ents[0], &value);
+  width = strlen(value);
+
+  /* The record refers to the column. */
+  binfile_put_u32(&writer->records,
+                  BINFILE_COLUMN | (binfile_str_flags(ents[0]) << 8));
+  binfile_put_u32(&writer->records, binfile_string(writer, prefix));
+  binfile_put_u32(&writer->records, writer->num_columns++);
+  binfile_put_u32(&writer->records, BINFILE_NONE);
+  writer->num_records++;
+
+  binfile_put_u32(&writer->columns, binfile_string(writer, prefix));
+  binfile_put_u32(&writer->columns, number);
+  binfile_put_u32(&writer->columns, digits);
+  binfile_put_u32(&writer->columns, rows);
+  binfile_put_u32(&writer->columns, width);
+  binfile_put_u32(&writer->columns, writer->column_data.size);
+
+  for (i = 0; i < rows; i++) {
+    entry_str_get(ents[i], &value);
+    binfile_put_bytes(&writer->column_data, value, width);
+  }
+}
+
+/**********************************************************************//**
+  Add the entry as a record. Returns FALSE if the entry cannot be stored
+  in a binary file.
+**************************************************************************/
+static bool binfile_write_record(struct binfile_writer *writer,
+                                 const struct section_file *secfile,
+                                 const struct section *psection,
+                                 const struct entry *pentry)
+{
+  enum entry_type type = entry_type_get(pentry);
+  uint32_t flags = 0;
+  uint32_t value;
+  bool bval;
+  int ival;
+  float fval;
+  const char *sval;
+
+  switch (type) {
+  case ENTRY_BOOL:
+    entry_bool_get(pentry, &bval);
+    value = bval ? 1 : 0;
+    break;
+  case ENTRY_INT:
+    entry_int_get(pentry, &ival);
+    value = (uint32_t) ival;
+    break;
+  case ENTRY_FLOAT:
+    entry_float_get(pentry, &fval);
+    memcpy(&value, &fval, sizeof(value));
+    break;
+  case ENTRY_STR:
+    entry_str_get(pentry, &sval);
+    value = binfile_string(writer, sval);
+    flags = binfile_str_flags(pentry);
+    break;
+  default:
+    SECFILE_LOG(secfile, psection,
+                _("Entry \"%s\" cannot be stored in a binary file."),
+                entry_name(pentry));
+    return FALSE;
+  }
+
+  binfile_put_u32(&writer->records, type | (flags << 8));
+  binfile_put_u32(&writer->records,
+                  binfile_string(writer, entry_name(pentry)));
+  binfile_put_u32(&writer->records, value);
+  binfile_put_u32(&writer->records,
+                  binfile_string(writer, entry_comment(pentry)));
+  writer->num_records++;
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Add the section and its entries.
+**************************************************************************/
+static bool binfile_write_section(struct binfile_writer *writer,
+                                  const struct section_file *secfile,
+                                  const struct section *psection)
+{
+  const struct entry_list *entries = section_entries(psection);
+  size_t num_entries = entry_list_size(entries);
+  const struct entry **ents = fc_malloc(MAX(1, num_entries) * sizeof(*ents));
+  uint32_t first_record = writer->num_records;
+  size_t i = 0;
+  bool ok = TRUE;
+
+  entry_list_iterate(entries, pentry) {
+    ents[i++] = pentry;
+  } entry_list_iterate_end;
+
+  i = 0;
+  while (ok && i < num_entries) {
+    uint32_t rows = 1;
+
+    if (binfile_column_head(ents[i])) {
+      while (i + rows < num_entries
+             && binfile_column_row(ents[i], ents[i + rows], rows)) {
+        rows++;
+      }
+    }
+
+    if (rows >= BINFILE_MIN_COLUMN_ROWS) {
+      binfile_write_column(writer, ents + i, rows);
+      i += rows;
+    } else {
+      ok = binfile_write_record(writer, secfile, psection, ents[i]);
+      i++;
+    }
+  }
+
+  free(ents);
+
+  binfile_put_u32(&writer->sections,
+                  binfile_string(writer, section_name(psection)));
+  binfile_put_u32(&writer->sections, psection->special);
+  binfile_put_u32(&writer->sections, first_record);
+  binfile_put_u32(&writer->sections, writer->num_records - first_record);
+
+  return ok;
+}
+
+/**********************************************************************//**
+  Save the section file in the binary format. Returns TRUE on success.
+  The error can be read with secfile_error().
+**************************************************************************/
+bool binfile_save(const struct section_file *secfile, const char *filename)
+{
+  struct binfile_writer writer;
+  struct binfile_buf header = { nullptr, 0, 0 };
+  char real_filename[1024];
+  size_t offset, total;
+  FILE *fp;
+  bool ok = TRUE;
+
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, secfile != nullptr, FALSE);
+
+  if (filename == nullptr) {
+    filename = secfile->name;
+  }
+
+  memset(&writer, 0, sizeof(writer));
+  writer.strings = genhash_new_nentries_full(
+      (genhash_val_fn_t) genhash_str_val_func,
+      (genhash_comp_fn_t) genhash_str_comp_func,
+      (genhash_copy_fn_t) genhash_str_copy_func,
+      (genhash_free_fn_t) genhash_str_free_func,
+      nullptr, nullptr, 1024);
+
+  section_list_iterate(secfile->sections, psection) {
+    if (!binfile_write_section(&writer, secfile, psection)) {
+      ok = FALSE;
+      break;
+    }
+  } section_list_iterate_end;
+
+  /* Lay out the tables. */
+  offset = BINFILE_HEADER_SIZE;
+  binfile_put_bytes(&header, BINFILE_MAGIC, BINFILE_MAGIC_LEN);
+  binfile_put_u32(&header, BINFILE_VERSION);
+  binfile_put_u32(&header, section_list_size(secfile->sections));
+  binfile_put_u32(&header, writer.num_records);
+  binfile_put_u32(&header, writer.num_columns);
+  binfile_put_u32(&header, writer.num_strings);
+  binfile_put_u32(&header, offset);
+  offset += writer.sections.size;
+  binfile_put_u32(&header, offset);
+  offset += writer.records.size;
+  binfile_put_u32(&header, offset);
+  offset += writer.columns.size;
+  binfile_put_u32(&header, offset);
+  offset += writer.string_index.size + writer.string_data.size;
+  /* Column blocks start at a 4 byte boundary. */
+  offset = (offset + 3) & ~(size_t) 3;
+  binfile_put_u32(&header, offset);
+  total = offset + writer.column_data.size;
+  binfile_put_u32(&header, total);
+  fc_assert(header.size == BINFILE_HEADER_SIZE);
+
+  if (ok && total > BINFILE_NONE) {
+    SECFILE_LOG(secfile, nullptr, _("Too big for a binary file."));
+    ok = FALSE;
+  }
+
+  if (ok) {
+    static const unsigned char padding[4] = { 0, 0, 0, 0 };
+    size_t unpadded = BINFILE_HEADER_SIZE + writer.sections.size
+      + writer.records.size + writer.columns.size
+      + writer.string_index.size + writer.string_data.size;
+
+    interpret_tilde(real_filename, sizeof(real_filename), filename);
+    fp = fc_fopen(real_filename, "wb");
+    if (fp == nullptr) {
+      SECFILE_LOG(secfile, nullptr, _("Could not open %s for writing"),
+                  real_filename);
+      ok = FALSE;
+    } else {
+      const struct binfile_buf *parts[] = {
+        &header, &writer.sections, &writer.records, &writer.columns,
+        &writer.string_index, &writer.string_data
+      };
+      size_t i;
+
+      for (i = 0; ok && i < ARRAY_SIZE(parts); i++) {
+        ok = (parts[i]->size == 0
+              || fwrite(parts[i]->data, parts[i]->size, 1, fp) == 1);
+      }
+      ok = ok && (offset == unpadded
+                  || fwrite(padding, offset - unpadded, 1, fp) == 1);
+      ok = ok && (writer.column_data.size == 0
+                  || fwrite(writer.column_data.data,
+                            writer.column_data.size, 1, fp) == 1);
+      ok = (fclose(fp) == 0) && ok;
+
+      if (!ok) {
+        SECFILE_LOG(secfile, nullptr, _("Could not write to %s"),
+                    real_filename);
+      }
+    }
+  }
+
+  genhash_destroy(writer.strings);
+  free(header.data);
+  free(writer.sections.data);
+  free(writer.records.data);
+  free(writer.columns.data);
+  free(writer.string_index.data);
+  free(writer.string_data.data);
+  free(writer.column_data.data);
+
+  return ok;
+}
+
+/**********************************************************************//**
+  Returns the string of the index, or nullptr if there is no such string.
+**************************************************************************/
+static const char *binfile_get_string(const struct binfile_reader *reader,
+                                      uint32_t idx)
+{
+  uint32_t offset;
+
+  if (idx >= reader->num_strings) {
+    return nullptr;
+  }
+
+  offset = binfile_get_u32(reader->string_index + 4 * idx);
+  if (offset >= reader->string_data_size) {
+    return nullptr;
+  }
+
+  return (const char *) reader->string_data + offset;
+}
+
+/**********************************************************************//**
+  Does the table of 'count' items of 'item_size' bytes at 'offset' fit
+  in the file?
+**************************************************************************/
+static bool binfile_table_fits(const struct binfile_reader *reader,
+                               uint32_t offset, uint32_t count,
+                               size_t item_size)
+{
+  return (offset <= reader->size
+          && (reader->size - offset) / item_size >= count);
+}
+
+/**********************************************************************//**
+  Create the entries of the column in the section.
+**************************************************************************/
+static bool binfile_read_column(struct binfile_reader *reader,
+                                struct section *psection, int flags,
+                                const unsigned char *column)
+{
+  const char *prefix = binfile_get_string(reader, binfile_get_u32(column));
+  uint32_t number = binfile_get_u32(column + 4);
+  int digits = binfile_get_u32(column + 8);
+  uint32_t rows = binfile_get_u32(column + 12);
+  uint32_t width = binfile_get_u32(column + 16);
+  uint32_t offset = binfile_get_u32(column + 20);
+  char name[BINFILE_MAX_NAME];
+  char *value;
+  uint32_t i;
+
+  if (prefix == nullptr || digits > BINFILE_MAX_COLUMN_DIGITS
+      || offset > reader->column_data_size
+      || (width > 0 && (reader->column_data_size - offset) / width < rows)) {
+    return FALSE;
+  }
+
+  value = fc_malloc(width + 1);
+  value[width] = '\0';
+  for (i = 0; i < rows; i++) {
+    struct entry *pentry;
+
+    fc_snprintf(name, sizeof(name), "%s%0*u", prefix, digits, number + i);
+    memcpy(value, reader->column_data + offset + (size_t) i * width, width);
+    pentry = section_entry_str_new(psection, name, value,
+                                   (flags & BINFILE_ESCAPED) != 0);
+    if (pentry == nullptr) {
+      free(value);
+      return FALSE;
+    }
+    if (flags & BINFILE_GT_MARKING) {
+      entry_str_set_gt_marking(pentry, TRUE);
+    }
+  }
+  free(value);
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Create the entry of the record in the section.
+**************************************************************************/
+static bool binfile_read_record(struct binfile_reader *reader,
+                                struct section_file *secfile,
+                                struct section *psection,
+                                const unsigned char *record,
+                                const unsigned char *columns,
+                                uint32_t num_columns)
+{
+  uint32_t type = binfile_get_u32(record) & 0xFF;
+  int flags = (binfile_get_u32(record) >> 8) & 0xFF;
+  const char *name = binfile_get_string(reader, binfile_get_u32(record + 4));
+  uint32_t value = binfile_get_u32(record + 8);
+  uint32_t comment_idx = binfile_get_u32(record + 12);
+  const char *comment = nullptr;
+  struct entry *pentry = nullptr;
+  float fval;
+
+  if (name == nullptr) {
+    return FALSE;
+  }
+
+  if (comment_idx != BINFILE_NONE) {
+    comment = binfile_get_string(reader, comment_idx);
+    if (comment == nullptr) {
+      return FALSE;
+    }
+  }
+
+  switch (type) {
+  case ENTRY_BOOL:
+    pentry = section_entry_bool_new(psection, name, value != 0);
+    break;
+  case ENTRY_INT:
+    pentry = section_entry_int_new(psection, name, (int) value);
+    break;
+  case ENTRY_FLOAT:
+    memcpy(&fval, &value, sizeof(fval));
+    pentry = section_entry_float_new(psection, name, fval);
+    break;
+  case ENTRY_STR:
+    {
+      const char *str = binfile_get_string(reader, value);
+
+      if (str == nullptr) {
+        return FALSE;
+      }
+      if (psection->special != EST_NORMAL) {
+        /* Sets the special properties of the entry too. */
+        pentry = secfile_insert_str_full(secfile, str, nullptr, FALSE,
+                                         (flags & BINFILE_ESCAPED) == 0,
+                                         psection->special, "%s.%s",
+                                         section_name(psection), name);
+      } else {
+        pentry = section_entry_str_new(psection, name, str,
+                                       (flags & BINFILE_ESCAPED) != 0);
+      }
+      if (pentry != nullptr && (flags & BINFILE_GT_MARKING)) {
+        entry_str_set_gt_marking(pentry, TRUE);
+      }
+    }
+    break;
+  case BINFILE_COLUMN:
+    return (value < num_columns
+            && binfile_read_column(reader, psection, flags,
+                                   columns + value * BINFILE_COLUMN_SIZE));
+  default:
+    return FALSE;
+  }
+
+  if (pentry == nullptr) {
+    return FALSE;
+  }
+  if (comment != nullptr) {
+    entry_set_comment(pentry, comment);
+  }
+
+  return TRUE;
+}
+
+/**********************************************************************//**
+  Build the section file from the binary file contents.
+**************************************************************************/
+static struct section_file *binfile_read(const unsigned char *data,
+                                         size_t size, const char *filename,
+                                         bool allow_duplicates)
+{
+  struct binfile_reader reader;
+  struct section_file *secfile;
+  uint32_t num_sections, num_records, num_columns;
+  uint32_t sections_offset, records_offset, columns_offset, strings_offset;
+  uint32_t column_data_offset;
+  uint32_t i;
+  bool ok = TRUE;
+
+  if (size < BINFILE_HEADER_SIZE
+      || memcmp(data, BINFILE_MAGIC, BINFILE_MAGIC_LEN) != 0) {
+    SECFILE_LOG(nullptr, nullptr, _("%s is not a binary section file."),
+                filename);
+    return nullptr;
+  }
+  if (binfile_get_u32(data + 8) != BINFILE_VERSION) {
+    SECFILE_LOG(nullptr, nullptr,
+                _("%s has unsupported binary format version %u."),
+                filename, (unsigned) binfile_get_u32(data + 8));
+    return nullptr;
+  }
+
+  reader.data = data;
+  reader.size = size;
+  num_sections = binfile_get_u32(data + 12);
+  num_records = binfile_get_u32(data + 16);
+  num_columns = binfile_get_u32(data + 20);
+  reader.num_strings = binfile_get_u32(data + 24);
+  sections_offset = binfile_get_u32(data + 28);
+  records_offset = binfile_get_u32(data + 32);
+  columns_offset = binfile_get_u32(data + 36);
+  strings_offset = binfile_get_u32(data + 40);
+  column_data_offset = binfile_get_u32(data + 44);
+
+  if (binfile_get_u32(data + 48) != size
+      || column_data_offset > size
+      || !binfile_table_fits(&reader, sections_offset, num_sections,
+                             BINFILE_SECTION_SIZE)
+      || !binfile_table_fits(&reader, records_offset, num_records,
+                             BINFILE_RECORD_SIZE)
+      || !binfile_table_fits(&reader, columns_offset, num_columns,
+                             BINFILE_COLUMN_SIZE)
+      || !binfile_table_fits(&reader, strings_offset, reader.num_strings,
+                             4)) {
+    SECFILE_LOG(nullptr, nullptr, _("%s is truncated or corrupted."),
+                filename);
+    return nullptr;
+  }
+
+  reader.string_index = data + strings_offset;
+  reader.string_data = reader.string_index + 4 * (size_t) reader.num_strings;
+  reader.column_data = data + column_data_offset;
+  reader.column_data_size = size - column_data_offset;
+  if (reader.column_data < reader.string_data
+      || (reader.num_strings > 0
+          && (reader.column_data == reader.string_data
+              || memchr(reader.string_data, '\0',
+                        reader.column_data - reader.string_data)
+                 == nullptr))) {
+    SECFILE_LOG(nullptr, nullptr, _("%s is truncated or corrupted."),
+                filename);
+    return nullptr;
+  }
+  /* The strings end at the last NUL before the column blocks, so that
+   * none of them can run over. */
+  reader.string_data_size = reader.column_data - reader.string_data;
+  while (reader.string_data_size > 0
+         && reader.string_data[reader.string_data_size - 1] != '\0') {
+    reader.string_data_size--;
+  }
+
+  log_verbose("Reading binary registry from \"%s\"", filename);
+
+  /* Like the text loader, allow duplicates while building the file to
+   * skip the checks, and set the real value at the end. */
+  secfile = secfile_new(TRUE);
+  secfile->name = fc_strdup(filename);
+
+  for (i = 0; ok && i < num_sections; i++) {
+    const unsigned char *psec = data + sections_offset
+      + (size_t) i * BINFILE_SECTION_SIZE;
+    const char *name = binfile_get_string(&reader, binfile_get_u32(psec));
+    uint32_t special = binfile_get_u32(psec + 4);
+    uint32_t first = binfile_get_u32(psec + 8);
+    uint32_t count = binfile_get_u32(psec + 12);
+    struct section *psection;
+    uint32_t j;
+
+    if (name == nullptr || special > EST_COMMENT
+        || first > num_records || count > num_records - first
+        || (psection = secfile_section_new(secfile, name)) == nullptr) {
+      ok = FALSE;
+      break;
+    }
+
+    psection->special = special;
+    if (special == EST_INCLUDE) {
+      secfile->num_includes++;
+    } else if (special == EST_COMMENT) {
+      secfile->num_long_comments++;
+    }
+
+    for (j = 0; ok && j < count; j++) {
+      ok = binfile_read_record(&reader, secfile, psection,
+                               data + records_offset
+                               + (size_t) (first + j) * BINFILE_RECORD_SIZE,
+                               data + columns_offset, num_columns);
+    }
+  }
+
+  if (!ok) {
+    SECFILE_LOG(secfile, nullptr, _("%s is truncated or corrupted."),
+                filename);
+    secfile_destroy(secfile);
+    return nullptr;
+  }
+
+  /* Like the text loader, look the entries up by the hash table. */
+  if (!secfile_hash_entries(secfile, allow_duplicates)) {
+    secfile_destroy(secfile);
+    return nullptr;
+  }
+
+  return secfile;
+}
+
+/**********************************************************************//**
+  Is the file a binary section file?
+**************************************************************************/
+bool binfile_is_binary(const char *filename)
+{
+  char magic[BINFILE_MAGIC_LEN];
+  FILE *fp = fc_fopen(filename, "rb");
+  bool binary;
+
+  if (fp == nullptr) {
+    return FALSE;
+  }
+
+  binary = (fread(magic, sizeof(magic), 1, fp) == 1
+            && memcmp(magic, BINFILE_MAGIC, BINFILE_MAGIC_LEN) == 0);
+  fclose(fp);
+
+  return binary;
+}
+
+/**********************************************************************//**
+  Load a binary section file. The file is mapped to the memory where
+  possible, instead of reading it. Returns nullptr on error.
+**************************************************************************/
+struct section_file *binfile_load(const char *filename,
+                                  bool allow_duplicates)
+{
+  struct section_file *secfile;
+  unsigned char *data;
+  size_t size;
+  FILE *fp = fc_fopen(filename, "rb");
+#ifdef HAVE_SYS_MMAN_H
+  struct stat buf;
+#endif
+
+  if (fp == nullptr) {
+    SECFILE_LOG(nullptr, nullptr, _("Could not open %s for reading"),
+                filename);
+    return nullptr;
+  }
+
+#ifdef HAVE_SYS_MMAN_H
+  if (fstat(fileno(fp), &buf) == 0 && buf.st_size > 0) {
+    size = buf.st_size;
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    if (data != MAP_FAILED) {
+      fclose(fp);
+      secfile = binfile_read(data, size, filename, allow_duplicates);
+      munmap(data, size);
+
+      return secfile;
+    }
+  }
+#endif /* HAVE_SYS_MMAN_H */
+
+  /* Read it all. */
+  size = 0;
+  data = nullptr;
+  while (!feof(fp) && !ferror(fp)) {
+    data = fc_realloc(data, size + 65536);
+    size += fread(data + size, 1, 65536, fp);
+  }
+
+  if (ferror(fp)) {
+    SECFILE_LOG(nullptr, nullptr, _("Could not read %s"), filename);
+    secfile = nullptr;
+  } else {
+    secfile = binfile_read(data, size, filename, allow_duplicates);
+  }
+  fclose(fp);
+  free(data);
+
+  return secfile;
+}
@@ -187,6 +187,12 @@ static void entry_to_file(const struct entry *pentry, fz_FILE *fs);
 static void entry_from_inf_token(struct section *psection, const char *name,
                                  const char *tok, struct inputfile *file);
 
+/* A file being written section by section. */
+struct secfile_writer {
+  fz_FILE *fs;
+  char filename[1024];
+};
+
 /* An 'entry' is a string, integer, boolean or string vector;
  * See enum entry_type in registry.h.
  */
@@ -297,6 +303,28 @@ static bool secfile_hash_delete(struct section_file *secfile,
   return entry_hash_remove(secfile->hash.entries, buf);
 }
 
+/**********************************************************************//**
+  Build the entry hash table of a section file loaded without one, and
+  set whether it allows duplicates. Returns FALSE if there are
+  duplicates although they are not allowed.
+**************************************************************************/
+bool secfile_hash_entries(struct section_file *secfile,
+                          bool allow_duplicates)
+{
+  secfile->allow_duplicates = allow_duplicates;
+  secfile->hash.entries = entry_hash_new_nentries(secfile->num_entries);
+
+  section_list_iterate(secfile->sections, hashing_section) {
+    entry_list_iterate(section_entries(hashing_section), pentry) {
+      if (!secfile_hash_insert(secfile, pentry)) {
+        return FALSE;
+      }
+    } entry_list_iterate_end;
+  } section_list_iterate_end;
+
+  return TRUE;
+}
+
 /**********************************************************************//**
   Base function to load a section file.  Note it closes the inputfile.
 **************************************************************************/
@@ -566,20 +594,7 @@ END:
 
   if (!error) {
     /* Build the entry hash table. */
-    secfile->allow_duplicates = allow_duplicates;
-    secfile->hash.entries = entry_hash_new_nentries(secfile->num_entries);
-
-    section_list_iterate(secfile->sections, hashing_section) {
-      entry_list_iterate(section_entries(hashing_section), pentry) {
-        if (!secfile_hash_insert(secfile, pentry)) {
-          error = TRUE;
-          break;
-        }
-      } entry_list_iterate_end;
-      if (error) {
-        break;
-      }
-    } section_list_iterate_end;
+    error = !secfile_hash_entries(secfile, allow_duplicates);
   }
   if (error) {
     secfile_destroy(secfile);
@@ -604,6 +619,26 @@ struct section_file *secfile_load_section(const char *filename,
                                  filename, section, allow_duplicates);
 }
 
+/**********************************************************************//**
+  Create a section file from a file, like secfile_load(), and append the
+  names of the files it includes to 'includes'. Returns nullptr on error.
+**************************************************************************/
+struct section_file *secfile_load_with_includes(const char *filename,
+                                                bool allow_duplicates,
+                                                struct strvec *includes)
+{
+  char real_filename[1024];
+  struct inputfile *inf;
+
+  interpret_tilde(real_filename, sizeof(real_filename), filename);
+  inf = inf_from_file(real_filename, datafilename);
+  if (inf != nullptr) {
+    inf_record_includes(inf, includes);
+  }
+
+  return secfile_from_input_file(inf, filename, nullptr, allow_duplicates);
+}
+
 /**********************************************************************//**
   Create a section file from a stream. Returns nullptr on error.
 **************************************************************************/
@@ -623,7 +658,7 @@ static bool is_legal_table_entry_name(char c, bool num)
 }
 
 /**********************************************************************//**
-  Save the previously filled in section_file to disk.
+  Write a section to the stream.
 
   There is now limited ability to save in the new tabular format
   (to give smaller savefiles).
@@ -635,266 +670,332 @@ static bool is_legal_table_entry_name(char c, bool num)
   This should be followed by the other column values for u0,
   and then subsequent u1, u2, etc, in strict order with no omissions,
   and with all of the columns for all uN in the same order as for u0.
-
-  If compression_level is non-zero, then compress using zlib.  (Should
-  only supply non-zero compression_level if already know that FREECIV_HAVE_LIBZ.)
-  Below simply specifies FZ_ZLIB method, since fz_fromFile() automatically
-  changes to FZ_PLAIN method when level == 0.
 **************************************************************************/
-bool secfile_save(const struct section_file *secfile, const char *filename,
-                  int compression_level, enum fz_method compression_method)
+static void section_to_file(const struct section *psection, fz_FILE *fs,
+                            const char *real_filename)
 {
-  char real_filename[1024];
   char pentry_name[128];
   const char *col_entry_name;
-  fz_FILE *fs;
   const struct entry_list_link *ent_iter, *save_iter, *col_iter;
   struct entry *pentry, *col_pentry;
   int i;
 
-  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, secfile != nullptr, FALSE);
+  if (psection->special == EST_INCLUDE) {
+    for (ent_iter = entry_list_head(section_entries(psection));
+         ent_iter && (pentry = entry_list_link_data(ent_iter));
+         ent_iter = entry_list_link_next(ent_iter)) {
 
-  if (filename == nullptr) {
-    filename = secfile->name;
-  }
-
-  interpret_tilde(real_filename, sizeof(real_filename), filename);
-  fs = fz_from_file(real_filename, "w",
-                    compression_method, compression_level);
+      fc_assert(!strcmp(entry_name(pentry), "file"));
 
-  if (!fs) {
-    SECFILE_LOG(secfile, nullptr, _("Could not open %s for writing"), real_filename);
+      fz_fprintf(fs, "*include ");
+      entry_to_file(pentry, fs);
+      fz_fprintf(fs, "\n");
+    }
+  } else if (psection->special == EST_COMMENT) {
+    for (ent_iter = entry_list_head(section_entries(psection));
+         ent_iter && (pentry = entry_list_link_data(ent_iter));
+         ent_iter = entry_list_link_next(ent_iter)) {
 
-    return FALSE;
-  }
+      fc_assert(!strcmp(entry_name(pentry), "comment"));
 
-  section_list_iterate(secfile->sections, psection) {
-    if (psection->special == EST_INCLUDE) {
-      for (ent_iter = entry_list_head(section_entries(psection));
-           ent_iter && (pentry = entry_list_link_data(ent_iter));
-           ent_iter = entry_list_link_next(ent_iter)) {
+      entry_to_file(pentry, fs);
+      fz_fprintf(fs, "\n");
+    }
+  } else {
+    fz_fprintf(fs, "\n[%s]\n", section_name(psection));
+
+    /* Following doesn't use entry_list_iterate() because we want to do
+     * tricky things with the iterators...
+     */
+    for (ent_iter = entry_list_head(section_entries(psection));
+         ent_iter && (pentry = entry_list_link_data(ent_iter));
+         ent_iter = entry_list_link_next(ent_iter)) {
+      const char *comment;
+
+      /* Tables: break out of this loop if this is a non-table
+       * entry (pentry and ent_iter unchanged) or after table (pentry
+       * and ent_iter suitably updated, pentry possibly nullptr).
+       * After each table, loop again in case the next entry
+       * is another table.
+       */
+      for (;;) {
+        char *c, *first, base[64];
+        int offset, irow, icol, ncol;
+
+        /* Example: for first table name of "xyz0.blah":
+         *  first points to the original string pentry->name
+         *  base contains "xyz";
+         *  offset = 5 (so first+offset gives "blah")
+         *  note strlen(base) = offset - 2
+         */
 
-        fc_assert(!strcmp(entry_name(pentry), "file"));
+        if (!SAVE_TABLES) {
+          break;
+        }
 
-        fz_fprintf(fs, "*include ");
-        entry_to_file(pentry, fs);
-        fz_fprintf(fs, "\n");
-      }
-    } else if (psection->special == EST_COMMENT) {
-      for (ent_iter = entry_list_head(section_entries(psection));
-           ent_iter && (pentry = entry_list_link_data(ent_iter));
-           ent_iter = entry_list_link_next(ent_iter)) {
+        if (pentry->type == ENTRY_LONG_COMMENT) {
+          break;
+        }
 
-        fc_assert(!strcmp(entry_name(pentry), "comment"));
+        sz_strlcpy(pentry_name, entry_name(pentry));
+        c = first = pentry_name;
+        if (*c == '\0' || !is_legal_table_entry_name(*c, FALSE)) {
+          break;
+        }
+        for (; *c != '\0' && is_legal_table_entry_name(*c, FALSE); c++) {
+          /* nothing */
+        }
+        if (fc_strncmp(c, "0.", 2)) {
+          break;
+        }
+        c += 2;
+        if (*c == '\0' || !is_legal_table_entry_name(*c, TRUE)) {
+          break;
+        }
 
-        entry_to_file(pentry, fs);
-        fz_fprintf(fs, "\n");
-      }
-    } else {
-      fz_fprintf(fs, "\n[%s]\n", section_name(psection));
+        offset = c - first;
+        first[offset - 2] = '\0';
+        sz_strlcpy(base, first);
+        first[offset - 2] = '0';
+        fz_fprintf(fs, "%s={", base);
 
-      /* Following doesn't use entry_list_iterate() because we want to do
-       * tricky things with the iterators...
-       */
-      for (ent_iter = entry_list_head(section_entries(psection));
-           ent_iter && (pentry = entry_list_link_data(ent_iter));
-           ent_iter = entry_list_link_next(ent_iter)) {
-        const char *comment;
-
-        /* Tables: break out of this loop if this is a non-table
-         * entry (pentry and ent_iter unchanged) or after table (pentry
-         * and ent_iter suitably updated, pentry possibly nullptr).
-         * After each table, loop again in case the next entry
-         * is another table.
+        /* Save an iterator at this first entry, which we can later use
+         * to repeatedly iterate over column names:
          */
-        for (;;) {
-          char *c, *first, base[64];
-          int offset, irow, icol, ncol;
-
-          /* Example: for first table name of "xyz0.blah":
-           *  first points to the original string pentry->name
-           *  base contains "xyz";
-           *  offset = 5 (so first+offset gives "blah")
-           *  note strlen(base) = offset - 2
-           */
-
-          if (!SAVE_TABLES) {
-            break;
+        save_iter = ent_iter;
+
+        /* Write the column names, and calculate ncol: */
+        ncol = 0;
+        col_iter = save_iter;
+        for (; (col_pentry = entry_list_link_data(col_iter));
+             col_iter = entry_list_link_next(col_iter)) {
+          if (col_pentry->type == ENTRY_LONG_COMMENT) {
+            continue;
           }
-
-          if (pentry->type == ENTRY_LONG_COMMENT) {
+          col_entry_name = entry_name(col_pentry);
+          if (fc_strncmp(col_entry_name, first, offset)) {
             break;
           }
+          fz_fprintf(fs, "%s\"%s\"", (ncol == 0 ? "" : ","),
+                     col_entry_name + offset);
+          ncol++;
+        }
+        fz_fprintf(fs, "\n");
 
-          sz_strlcpy(pentry_name, entry_name(pentry));
-          c = first = pentry_name;
-          if (*c == '\0' || !is_legal_table_entry_name(*c, FALSE)) {
-            break;
-          }
-          for (; *c != '\0' && is_legal_table_entry_name(*c, FALSE); c++) {
-            /* nothing */
-          }
-          if (fc_strncmp(c, "0.", 2)) {
-            break;
-          }
-          c += 2;
-          if (*c == '\0' || !is_legal_table_entry_name(*c, TRUE)) {
-            break;
-          }
+        /* Iterate over rows and columns, incrementing ent_iter as we go,
+         * and writing values to the table. Have a separate iterator
+         * to the column names to check they all match.
+         */
+        irow = icol = 0;
+        col_iter = save_iter;
+        for (;;) {
+          char expect[128];     /* pentry->name we're expecting */
 
-          offset = c - first;
-          first[offset - 2] = '\0';
-          sz_strlcpy(base, first);
-          first[offset - 2] = '0';
-          fz_fprintf(fs, "%s={", base);
-
-          /* Save an iterator at this first entry, which we can later use
-           * to repeatedly iterate over column names:
-           */
-          save_iter = ent_iter;
-
-          /* Write the column names, and calculate ncol: */
-          ncol = 0;
-          col_iter = save_iter;
-          for (; (col_pentry = entry_list_link_data(col_iter));
-               col_iter = entry_list_link_next(col_iter)) {
-            if (col_pentry->type == ENTRY_LONG_COMMENT) {
-              continue;
-            }
-            col_entry_name = entry_name(col_pentry);
-            if (fc_strncmp(col_entry_name, first, offset)) {
-              break;
-            }
-            fz_fprintf(fs, "%s\"%s\"", (ncol == 0 ? "" : ","),
-                       col_entry_name + offset);
-            ncol++;
-          }
-          fz_fprintf(fs, "\n");
+          pentry = entry_list_link_data(ent_iter);
+          col_pentry = entry_list_link_data(col_iter);
 
-          /* Iterate over rows and columns, incrementing ent_iter as we go,
-           * and writing values to the table. Have a separate iterator
-           * to the column names to check they all match.
-           */
-          irow = icol = 0;
-          col_iter = save_iter;
-          for (;;) {
-            char expect[128];     /* pentry->name we're expecting */
-
-            pentry = entry_list_link_data(ent_iter);
-            col_pentry = entry_list_link_data(col_iter);
-
-            if (pentry && pentry->type == ENTRY_LONG_COMMENT) {
-              if (icol == 0) {
-                entry_to_file(pentry, fs);
-              } else {
-                bugreport_request("In file %s, section %s there was\n"
-                                  "an attempt to insert comment in the middle of table row.",
-                                  real_filename, section_name(psection));
-              }
-              ent_iter = entry_list_link_next(ent_iter);
-              continue;
+          if (pentry && pentry->type == ENTRY_LONG_COMMENT) {
+            if (icol == 0) {
+              entry_to_file(pentry, fs);
             } else {
-
-              fc_snprintf(expect, sizeof(expect), "%s%d.%s",
-                          base, irow, entry_name(col_pentry) + offset);
-
-              /* break out of tabular if doesn't match: */
-              if ((!pentry) || (strcmp(entry_name(pentry), expect) != 0)) {
-                if (icol != 0) {
-                  /* If the second or later row of a table is missing some
-                   * entries that the first row had, we drop out of the tabular
-                   * format.  This is inefficient so we print a warning message;
-                   * the calling code probably needs to be fixed so that it can
-                   * use the more efficient tabular format.
-                   *
-                   * FIXME: If the first row is missing some entries that the
-                   * second or later row has, then we'll drop out of tabular
-                   * format without an error message. */
-                  bugreport_request("In file %s, there is no entry in the registry for\n"
-                                    "%s.%s (or the entries are out of order). This means\n"
-                                    "a less efficient non-tabular format will be used.\n"
-                                    "To avoid this make sure all rows of a table are\n"
-                                    "filled out with an entry for every column.",
-                                    real_filename, section_name(psection), expect);
-                  fz_fprintf(fs, "\n");
-                }
-                fz_fprintf(fs, "}\n");
-                break;
-              }
+              bugreport_request("In file %s, section %s there was\n"
+                                "an attempt to insert comment in the middle of table row.",
+                                real_filename, section_name(psection));
             }
+            ent_iter = entry_list_link_next(ent_iter);
+            continue;
+          } else {
 
-            if (icol > 0) {
-              fz_fprintf(fs, ",");
+            fc_snprintf(expect, sizeof(expect), "%s%d.%s",
+                        base, irow, entry_name(col_pentry) + offset);
+
+            /* break out of tabular if doesn't match: */
+            if ((!pentry) || (strcmp(entry_name(pentry), expect) != 0)) {
+              if (icol != 0) {
+                /* If the second or later row of a table is missing some
+                 * entries that the first row had, we drop out of the tabular
+                 * format.  This is inefficient so we print a warning message;
+                 * the calling code probably needs to be fixed so that it can
+                 * use the more efficient tabular format.
+                 *
+                 * FIXME: If the first row is missing some entries that the
+                 * second or later row has, then we'll drop out of tabular
+                 * format without an error message. */
+                bugreport_request("In file %s, there is no entry in the registry for\n"
+                                  "%s.%s (or the entries are out of order). This means\n"
+                                  "a less efficient non-tabular format will be used.\n"
+                                  "To avoid this make sure all rows of a table are\n"
+                                  "filled out with an entry for every column.",
+                                  real_filename, section_name(psection), expect);
+                fz_fprintf(fs, "\n");
+              }
+              fz_fprintf(fs, "}\n");
+              break;
             }
-            entry_to_file(pentry, fs);
+          }
 
-            ent_iter = entry_list_link_next(ent_iter);
-            col_iter = entry_list_link_next(col_iter);
-
-            icol++;
-            if (icol == ncol) {
-              fz_fprintf(fs, "\n");
-              irow++;
-              icol = 0;
-              col_iter = save_iter;
-            }
+          if (icol > 0) {
+            fz_fprintf(fs, ",");
           }
-          if (!pentry) {
-            break;
+          entry_to_file(pentry, fs);
+
+          ent_iter = entry_list_link_next(ent_iter);
+          col_iter = entry_list_link_next(col_iter);
+
+          icol++;
+          if (icol == ncol) {
+            fz_fprintf(fs, "\n");
+            irow++;
+            icol = 0;
+            col_iter = save_iter;
           }
         }
         if (!pentry) {
           break;
         }
+      }
+      if (!pentry) {
+        break;
+      }
 
-        if (pentry->type == ENTRY_LONG_COMMENT) {
-          entry_to_file(pentry, fs);
-        } else {
-          /* Classic entry. */
-          col_entry_name = entry_name(pentry);
-          fz_fprintf(fs, "%s=", col_entry_name);
-          entry_to_file(pentry, fs);
+      if (pentry->type == ENTRY_LONG_COMMENT) {
+        entry_to_file(pentry, fs);
+      } else {
+        /* Classic entry. */
+        col_entry_name = entry_name(pentry);
+        fz_fprintf(fs, "%s=", col_entry_name);
+        entry_to_file(pentry, fs);
 
-          /* Check for vector. */
-          for (i = 1;; i++) {
-            col_iter = entry_list_link_next(ent_iter);
-            col_pentry = entry_list_link_data(col_iter);
-            if (col_pentry == nullptr || col_pentry->type == ENTRY_LONG_COMMENT) {
-              break;
-            }
-            fc_snprintf(pentry_name, sizeof(pentry_name),
-                        "%s,%d", col_entry_name, i);
-            if (0 != strcmp(pentry_name, entry_name(col_pentry))) {
-              break;
-            }
-            fz_fprintf(fs, ",");
-            entry_to_file(col_pentry, fs);
-            ent_iter = col_iter;
+        /* Check for vector. */
+        for (i = 1;; i++) {
+          col_iter = entry_list_link_next(ent_iter);
+          col_pentry = entry_list_link_data(col_iter);
+          if (col_pentry == nullptr || col_pentry->type == ENTRY_LONG_COMMENT) {
+            break;
           }
-
-          comment = entry_comment(pentry);
-          if (comment) {
-            fz_fprintf(fs, "  # %s\n", comment);
-          } else {
-            fz_fprintf(fs, "\n");
+          fc_snprintf(pentry_name, sizeof(pentry_name),
+                      "%s,%d", col_entry_name, i);
+          if (0 != strcmp(pentry_name, entry_name(col_pentry))) {
+            break;
           }
+          fz_fprintf(fs, ",");
+          entry_to_file(col_pentry, fs);
+          ent_iter = col_iter;
+        }
+
+        comment = entry_comment(pentry);
+        if (comment) {
+          fz_fprintf(fs, "  # %s\n", comment);
+        } else {
+          fz_fprintf(fs, "\n");
         }
       }
     }
-  } section_list_iterate_end;
+  }
+}
 
-  if (0 != fz_ferror(fs)) {
-    SECFILE_LOG(secfile, nullptr, "Error before closing %s: %s",
-                real_filename, fz_strerror(fs));
-    fz_fclose(fs);
-    return FALSE;
+/**********************************************************************//**
+  Open a file for writing the sections of a section file one by one with
+  secfile_writer_push(), so that the caller does not need to keep all of
+  them in memory at once. Compression is as in secfile_save(); workers
+  is the number of threads to compress with. Returns nullptr on error.
+**************************************************************************/
+struct secfile_writer *secfile_writer_open(const char *filename,
+                                           int compression_level,
+                                           enum fz_method compression_method,
+                                           int workers)
+{
+  struct secfile_writer *writer;
+  fz_FILE *fs;
+  char real_filename[1024];
+
+  interpret_tilde(real_filename, sizeof(real_filename), filename);
+  fs = fz_from_file(real_filename, "w",
+                    compression_method, compression_level, workers);
+
+  if (!fs) {
+    SECFILE_LOG(nullptr, nullptr, _("Could not open %s for writing"),
+                real_filename);
+
+    return nullptr;
   }
-  if (0 != fz_fclose(fs)) {
-    SECFILE_LOG(secfile, nullptr, "Error closing %s", real_filename);
+
+  writer = fc_malloc(sizeof(*writer));
+  writer->fs = fs;
+  sz_strlcpy(writer->filename, real_filename);
+
+  return writer;
+}
+
+/**********************************************************************//**
+  Write a section to the file opened with secfile_writer_open(). The
+  section can be freed afterwards.
+**************************************************************************/
+void secfile_writer_push(struct secfile_writer *writer,
+                         const struct section *psection)
+{
+  fc_assert_ret(writer != nullptr);
+  fc_assert_ret(psection != nullptr);
+
+  section_to_file(psection, writer->fs, writer->filename);
+}
+
+/**********************************************************************//**
+  Finish the file opened with secfile_writer_open(), and free the writer.
+  Returns whether the whole file was written successfully.
+**************************************************************************/
+bool secfile_writer_close(struct secfile_writer *writer)
+{
+  bool success = TRUE;
+
+  fc_assert_ret_val(writer != nullptr, FALSE);
+
+  if (0 != fz_ferror(writer->fs)) {
+    SECFILE_LOG(nullptr, nullptr, "Error before closing %s: %s",
+                writer->filename, fz_strerror(writer->fs));
+    fz_fclose(writer->fs);
+    success = FALSE;
+  } else if (0 != fz_fclose(writer->fs)) {
+    SECFILE_LOG(nullptr, nullptr, "Error closing %s", writer->filename);
+    success = FALSE;
+  }
+  free(writer);
+
+  return success;
+}
+
+/**********************************************************************//**
+  Save the previously filled in section_file to disk.
+
+  See section_to_file() for the tabular format used for the entries.
+
+  If compression_level is non-zero, then compress using zlib.  (Should
+  only supply non-zero compression_level if already know that FREECIV_HAVE_LIBZ.)
+  Below simply specifies FZ_ZLIB method, since fz_fromFile() automatically
+  changes to FZ_PLAIN method when level == 0.
+**************************************************************************/
+bool secfile_save(const struct section_file *secfile, const char *filename,
+                  int compression_level, enum fz_method compression_method)
+{
+  struct secfile_writer *writer;
+
+  SECFILE_RETURN_VAL_IF_FAIL(secfile, nullptr, secfile != nullptr, FALSE);
+
+  if (filename == nullptr) {
+    filename = secfile->name;
+  }
+
+  writer = secfile_writer_open(filename, compression_level,
+                               compression_method, 1);
+  if (writer == nullptr) {
     return FALSE;
   }
 
-  return TRUE;
+  section_list_iterate(secfile->sections, psection) {
+    secfile_writer_push(writer, psection);
+  } section_list_iterate_end;
+
+  return secfile_writer_close(writer);
 }
 
 /**********************************************************************//**
@@ -3633,6 +3734,18 @@ bool entry_str_set_gt_marking(struct entry *pentry, bool gt_marking)
   return TRUE;
 }
 
+/**********************************************************************//**
+  Returns if the string would be saved with gettext marking.
+**************************************************************************/
+bool entry_str_gt_marking(const struct entry *pentry)
+{
+  SECFILE_RETURN_VAL_IF_FAIL(nullptr, nullptr, pentry != nullptr, FALSE);
+  SECFILE_RETURN_VAL_IF_FAIL(pentry->psection->secfile, pentry->psection,
+                             ENTRY_STR == pentry->type, FALSE);
+
+  return pentry->string.gt_marking;
+}
+
 /**********************************************************************//**
   Push an entry into a file stream.
 **************************************************************************/
@@ -25,6 +25,8 @@ extern "C" {
 struct section_file;
 struct section;
 struct entry;
+struct secfile_writer;
+struct strvec;
 
 /* Typedefs. */
 typedef const void *secfile_data_t;
@@ -60,11 +62,22 @@ typedef const char * (*secfile_enum_name_data_fn_t) (secfile_data_t data,
 struct section_file *secfile_load_section(const char *filename,
                                           const char *section,
                                           bool allow_duplicates);
+struct section_file *secfile_load_with_includes(const char *filename,
+                                                bool allow_duplicates,
+                                                struct strvec *includes);
 struct section_file *secfile_from_stream(fz_FILE *stream,
                                          bool allow_duplicates);
 
 bool secfile_save(const struct section_file *secfile, const char *filename,
                   int compression_level, enum fz_method compression_method);
+
+struct secfile_writer *secfile_writer_open(const char *filename,
+                                           int compression_level,
+                                           enum fz_method compression_method,
+                                           int workers);
+void secfile_writer_push(struct secfile_writer *writer,
+                         const struct section *psection);
+bool secfile_writer_close(struct secfile_writer *writer);
 void secfile_check_unused(const struct section_file *secfile);
 const char *secfile_name(const struct section_file *secfile);
 
@@ -666,6 +679,7 @@ bool entry_str_get(const struct entry *pentry, const char **value);
 bool entry_str_set(struct entry *pentry, const char *value);
 bool entry_str_escaped(const struct entry *pentry);
 bool entry_str_set_escaped(struct entry *pentry, bool escaped);
+bool entry_str_gt_marking(const struct entry *pentry);
 bool entry_str_set_gt_marking(struct entry *pentry, bool gt_marking);
 
 #ifdef __cplusplus
@@ -83,6 +83,9 @@ void secfile_log(const struct section_file *secfile,
 bool entry_from_token(struct section *psection, const char *name,
                       const char *tok);
 
+bool secfile_hash_entries(struct section_file *secfile,
+                          bool allow_duplicates);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
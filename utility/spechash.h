@@ -91,6 +91,8 @@
  *                               size_t nentries);
  *    void foo_hash_destroy(struct foo_hash *phash);
  *    bool foo_hash_set_no_shrink(struct foo_hash *phash, bool no_shrink);
+ *    enum genhash_backend foo_hash_set_backend(struct foo_hash *phash,
+ *                                              enum genhash_backend backend);
  *    size_t foo_hash_size(const struct foo_hash *phash);
  *    size_t foo_hash_capacity(const struct foo_hash *phash);
  *    struct foo_hash *foo_hash_copy(const struct foo_hash *phash);
@@ -440,6 +442,16 @@ static inline bool SPECHASH_FOO(_hash_set_no_shrink) (SPECHASH_HASH *tthis,
   return genhash_set_no_shrink((struct genhash *) tthis, no_shrink);
 }
 
+/************************************************************************//**
+  Select the storage backend.
+****************************************************************************/
+static inline enum genhash_backend
+SPECHASH_FOO(_hash_set_backend) (SPECHASH_HASH *tthis,
+                                 enum genhash_backend backend)
+{
+  return genhash_set_backend((struct genhash *) tthis, backend);
+}
+
 /************************************************************************//**
   Return the number of elements.
 ****************************************************************************/
@@ -527,6 +527,25 @@ FILE *fc_fopen(const char *filename, const char *opentype)
   return result;
 }
 
+/************************************************************************//**
+  Write string to fp as a JSON string literal, quotes included.
+****************************************************************************/
+void fc_fputs_json_string(FILE *fp, const char *str)
+{
+  fputc('"', fp);
+  for (; *str != '\0'; str++) {
+    if (*str == '"' || *str == '\\') {
+      fputc('\\', fp);
+      fputc(*str, fp);
+    } else if ((unsigned char) *str < 0x20) {
+      fprintf(fp, "\\u%04x", (unsigned char) *str);
+    } else {
+      fputc(*str, fp);
+    }
+  }
+  fputc('"', fp);
+}
+
 /************************************************************************//**
   Wrapper function for gzopen() with filename conversion to local
   encoding on Windows.
@@ -171,6 +171,7 @@ int fc_strcoll(const char *str0, const char *str1);
 int fc_stricoll(const char *str0, const char *str1);
 
 FILE *fc_fopen(const char *filename, const char *opentype);
+void fc_fputs_json_string(FILE *fp, const char *str);
 #ifdef FREECIV_HAVE_LIBZ
 #include <zlib.h>
 gzFile fc_gzopen(const char *filename, const char *opentype);